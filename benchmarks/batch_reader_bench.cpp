@@ -0,0 +1,127 @@
+// Wall time and system calls to re-read thousands of small files per collection cycle.
+//
+// Generates `files` sysfs-style attribute files in a temporary directory and reads all of them
+// once per cycle:
+//   readFile   ProcFS::readFile per file (open, read, close every time), as the collectors do today
+//   pread      BatchFileReader with io_uring disabled: descriptors kept open, one pread per file
+//   io_uring   BatchFileReader: registered descriptors and slot slab, one submission per queue depth
+// "syscalls" is the reader's own count (readFile is open, read, read at EOF and close per file);
+// "read calls" is the syscr delta from /proc/self/io.
+//
+// Usage: batch_reader_bench [files] [cycles] [queue_depth]
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <sys/resource.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "batch_reader.hpp"
+#include "proc_source.hpp"
+
+using SystemProcFS::BatchFileReader;
+
+namespace {
+std::string writeFixture(unsigned files) {
+    char root_template[] = "/tmp/batch_reader_benchXXXXXX";
+    const std::string root = ::mkdtemp(root_template);
+    ::mkdir((root + "/sys").c_str(), 0755);
+    for (unsigned n = 0; n < files; ++n) {
+        std::ofstream(root + "/sys/attr" + std::to_string(n)) << "    1234567     89012 34567890 1 2 3 4 5 6 7 8\n";
+    }
+    return root;
+}
+
+void removeFixture(const std::string& root, unsigned files) {
+    for (unsigned n = 0; n < files; ++n) std::remove((root + "/sys/attr" + std::to_string(n)).c_str());
+    ::rmdir((root + "/sys").c_str());
+    ::rmdir(root.c_str());
+}
+
+unsigned long long readSyscalls() {
+    std::string io;
+    SystemProcFS::DirectoryProcSource("").readFile("/proc/self/io", io);
+    const std::size_t pos = io.find("syscr:");
+    return pos == std::string::npos ? 0 : std::strtoull(io.c_str() + pos + 6, nullptr, 10);
+}
+
+struct Result {
+    double ms_per_cycle;
+    double syscalls_per_cycle;
+    double reads_per_cycle;
+};
+
+template <typename Cycle>
+Result measure(unsigned cycles, Cycle cycle) {
+    cycle(); // Warm-up (and registration for the batch readers)
+    const unsigned long long syscr_before = readSyscalls();
+    const auto start = std::chrono::steady_clock::now();
+    unsigned long long syscalls = 0;
+    for (unsigned c = 0; c < cycles; ++c) syscalls += cycle();
+    const double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    const double syscr = static_cast<double>(readSyscalls()) - static_cast<double>(syscr_before);
+    return Result{ms / cycles, static_cast<double>(syscalls) / cycles, syscr / cycles};
+}
+} // namespace
+
+int main(int argc, char** argv) {
+    const unsigned files = argc > 1 ? static_cast<unsigned>(std::strtoul(argv[1], nullptr, 10)) : 10000;
+    const unsigned cycles = argc > 2 ? static_cast<unsigned>(std::strtoul(argv[2], nullptr, 10)) : 20;
+    const unsigned queue_depth = argc > 3 ? static_cast<unsigned>(std::strtoul(argv[3], nullptr, 10)) : 256;
+
+    // Keeping every file open needs a descriptor per file.
+    rlimit limit{};
+    if (::getrlimit(RLIMIT_NOFILE, &limit) == 0 && limit.rlim_cur < files + 64) {
+        limit.rlim_cur = std::min<rlim_t>(limit.rlim_max, files + 64);
+        ::setrlimit(RLIMIT_NOFILE, &limit);
+    }
+
+    const std::string root = writeFixture(files);
+    {
+        SystemProcFS::ScopedProcSource scoped(std::make_shared<SystemProcFS::DirectoryProcSource>(root));
+        std::vector<std::string> paths;
+        for (unsigned n = 0; n < files; ++n) paths.push_back("/sys/attr" + std::to_string(n));
+
+        std::string buffer;
+        const Result read_file = measure(cycles, [&] {
+            for (const auto& path : paths) SystemProcFS::ProcFS::readFile(path, buffer);
+            return 4ULL * files;
+        });
+
+        BatchFileReader::Options pread_options;
+        pread_options.use_io_uring = false;
+        BatchFileReader pread_reader(pread_options);
+        for (const auto& path : paths) pread_reader.add(path);
+        const Result pread = measure(cycles, [&] {
+            const auto before = pread_reader.stats().syscalls;
+            pread_reader.readAll();
+            return pread_reader.stats().syscalls - before;
+        });
+
+        BatchFileReader::Options uring_options;
+        uring_options.queue_depth = queue_depth;
+        BatchFileReader uring_reader(uring_options);
+        for (const auto& path : paths) uring_reader.add(path);
+        const Result uring = measure(cycles, [&] {
+            const auto before = uring_reader.stats().syscalls;
+            uring_reader.readAll();
+            return uring_reader.stats().syscalls - before;
+        });
+
+        std::printf("%u files, %u cycles, queue depth %u (io_uring reader backend: %s)\n", files, cycles, queue_depth,
+                    SystemProcFS::batchBackendName(uring_reader.backend()));
+        std::printf("%-10s %12s %12s %12s\n", "reader", "ms/cycle", "syscalls", "read calls");
+        std::printf("%-10s %12.2f %12.0f %12.0f\n", "readFile", read_file.ms_per_cycle, read_file.syscalls_per_cycle, read_file.reads_per_cycle);
+        std::printf("%-10s %12.2f %12.0f %12.0f\n", "pread", pread.ms_per_cycle, pread.syscalls_per_cycle, pread.reads_per_cycle);
+        std::printf("%-10s %12.2f %12.0f %12.0f\n", "io_uring", uring.ms_per_cycle, uring.syscalls_per_cycle, uring.reads_per_cycle);
+    }
+    removeFixture(root, files);
+    return 0;
+}
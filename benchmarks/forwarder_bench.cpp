@@ -0,0 +1,121 @@
+// Forwarder throughput and end-to-end latency against a local mock TCP receiver.
+//
+// Each snapshot's timestamp carries its submit time (steady clock, microseconds); the
+// receiver decodes every batch and records receive time minus submit time.
+//
+// Usage: forwarder_bench [snapshots] [batch_size]
+
+#include <algorithm>
+#include <arpa/inet.h>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+#include "forwarder.hpp"
+
+using SystemMetricsSnapshot::MetricsSnapshot;
+using namespace SystemMetricsForwarder;
+
+namespace {
+std::uint64_t nowMicros() {
+    return static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+bool readExact(int fd, std::uint8_t* out, size_t size) {
+    while (size > 0) {
+        ssize_t n = ::recv(fd, out, size, 0);
+        if (n <= 0) return false;
+        out += n;
+        size -= static_cast<size_t>(n);
+    }
+    return true;
+}
+
+// Accepts one connection and decodes length-prefixed batches until EOF.
+void receiver(int listener, std::vector<double>* latencies_us, size_t* received_bytes) {
+    int conn = ::accept(listener, nullptr, nullptr);
+    std::vector<std::uint8_t> batch;
+    std::vector<MetricsSnapshot> snapshots;
+    std::uint8_t prefix[4];
+    while (readExact(conn, prefix, sizeof(prefix))) {
+        size_t length = (size_t(prefix[0]) << 24) | (size_t(prefix[1]) << 16) | (size_t(prefix[2]) << 8) | prefix[3];
+        batch.resize(length);
+        if (!readExact(conn, batch.data(), length)) break;
+        const std::uint64_t received = nowMicros();
+        *received_bytes += length + sizeof(prefix);
+        snapshots.clear();
+        decodeBatch(SystemMetricsCodec::ByteSpan(batch), snapshots);
+        for (const auto& s : snapshots) latencies_us->push_back(static_cast<double>(received - s.timestamp_ms));
+    }
+    ::close(conn);
+}
+
+double percentile(std::vector<double>& values, double p) {
+    if (values.empty()) return 0.0;
+    size_t index = static_cast<size_t>(p * static_cast<double>(values.size() - 1));
+    std::nth_element(values.begin(), values.begin() + static_cast<std::ptrdiff_t>(index), values.end());
+    return values[index];
+}
+} // namespace
+
+int main(int argc, char** argv) {
+    const size_t total = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 200000;
+    const size_t batch_size = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 60;
+
+    int listener = ::socket(AF_INET, SOCK_STREAM, 0);
+    struct sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    if (::bind(listener, reinterpret_cast<struct sockaddr*>(&addr), sizeof(addr)) != 0 || ::listen(listener, 1) != 0) {
+        std::perror("bind/listen");
+        return 1;
+    }
+    socklen_t len = sizeof(addr);
+    ::getsockname(listener, reinterpret_cast<struct sockaddr*>(&addr), &len);
+
+    std::vector<double> latencies;
+    latencies.reserve(total);
+    size_t received_bytes = 0;
+    std::thread receiver_thread(receiver, listener, &latencies, &received_bytes);
+
+    MetricsSnapshot snapshot;
+    snapshot.mem = SystemMemoryStats::MemStats(65536000, 12000000, 40000000, 200000, 16000000, 0, 0);
+    for (int d = 0; d < 8; ++d) snapshot.disks.emplace_back("nvme" + std::to_string(d) + "n1", 0, 0, 0, 0);
+    for (int n = 0; n < 6; ++n) snapshot.nets.emplace_back("eth" + std::to_string(n), 0, 0, 0, 0, 0, 0, 0, 0);
+
+    Forwarder::Stats stats;
+    auto start = std::chrono::steady_clock::now();
+    {
+        Forwarder forwarder(std::make_shared<TcpSink>("127.0.0.1", ntohs(addr.sin_port)),
+                            Forwarder::Options(batch_size, std::chrono::milliseconds(100), 1024));
+        forwarder.start();
+        for (size_t i = 0; i < total; ++i) {
+            snapshot.cpu.user = static_cast<double>(i * 3);
+            snapshot.cpu.idle = static_cast<double>(i * 97);
+            for (auto& d : snapshot.disks) d.read_bytes += 4096;
+            for (auto& n : snapshot.nets) n.bytes_received += 1500;
+            snapshot.timestamp_ms = nowMicros();
+            forwarder.submit(snapshot);
+        }
+        forwarder.flush(std::chrono::seconds(60));
+        stats = forwarder.stats();
+    } // Closes the connection, ending the receiver
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    receiver_thread.join();
+    ::close(listener);
+
+    std::printf("snapshots=%zu batch_size=%zu received=%zu dropped_batches=%llu\n", total, batch_size,
+                latencies.size(), static_cast<unsigned long long>(stats.dropped_batches));
+    std::printf("throughput: %.0f snapshots/s, %.2f MB/s on the wire (%.1f bytes/snapshot)\n", total / seconds,
+                received_bytes / seconds / 1e6, static_cast<double>(received_bytes) / static_cast<double>(total));
+    std::printf("latency (submit -> received, us): p50=%.0f p99=%.0f p99.9=%.0f max=%.0f\n",
+                percentile(latencies, 0.50), percentile(latencies, 0.99), percentile(latencies, 0.999),
+                percentile(latencies, 1.0));
+    return 0;
+}
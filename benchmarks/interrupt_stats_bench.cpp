@@ -0,0 +1,100 @@
+// Cost of one /proc/interrupts sample on a very large host.
+//
+// Generates two /proc/interrupts frames in the kernel's format ("%10u" per online CPU, chip and
+// handler names after the counters) and measures, per sample:
+//   parse      InterruptStatsReader::parse into a reused matrix, at each scan level
+//   subtract   SystemProcFS::subtractCounters over the whole matrix, at each scan level
+//   sample     InterruptCollector::sample: read through a VirtualProcSource (one copy of the
+//              file, standing in for the kernel read), parse, subtract, per-IRQ/per-CPU rates
+//   hottest    InterruptCollector::hottest(10)
+//
+// Usage: interrupt_stats_bench [cpus] [irqs] [samples]
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "interrupt_stats.hpp"
+#include "proc_source.hpp"
+#include "simd_scan.hpp"
+
+using namespace SystemInterruptStats;
+
+namespace {
+std::string makeInterrupts(unsigned cpus, unsigned irqs, unsigned frame) {
+    std::string text = "     ";
+    char cell[32];
+    for (unsigned c = 0; c < cpus; ++c) {
+        std::snprintf(cell, sizeof(cell), "CPU%-8u", c);
+        text += cell;
+    }
+    text += "\n";
+    for (unsigned irq = 0; irq < irqs; ++irq) {
+        std::snprintf(cell, sizeof(cell), "%4u:", irq);
+        text += cell;
+        for (unsigned c = 0; c < cpus; ++c) {
+            std::snprintf(cell, sizeof(cell), " %10u", static_cast<unsigned>((irq * 7919u + c * 104729u) % 400000000u + frame * (irq % 13) * (c % 5)));
+            text += cell;
+        }
+        text += "  IR-PCI-MSI " + std::to_string(irq * 2048) + "-edge      eth" + std::to_string(irq / 64) + "-TxRx-" + std::to_string(irq % 64) + "\n";
+    }
+    return text;
+}
+
+template <typename Body>
+double millisecondsPer(unsigned runs, Body body) {
+    body(); // Warm-up
+    const auto start = std::chrono::steady_clock::now();
+    for (unsigned n = 0; n < runs; ++n) body();
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count() / runs;
+}
+} // namespace
+
+int main(int argc, char** argv) {
+    const unsigned cpus = argc > 1 ? static_cast<unsigned>(std::strtoul(argv[1], nullptr, 10)) : 512;
+    const unsigned irqs = argc > 2 ? static_cast<unsigned>(std::strtoul(argv[2], nullptr, 10)) : 1000;
+    const unsigned samples = argc > 3 ? static_cast<unsigned>(std::strtoul(argv[3], nullptr, 10)) : 50;
+
+    const std::vector<std::string> frames = {makeInterrupts(cpus, irqs, 0), makeInterrupts(cpus, irqs, 1)};
+    std::printf("%u CPUs x %u IRQs: %zu KiB per frame, %u samples\n", cpus, irqs, frames[0].size() / 1024, samples);
+
+    InterruptMatrix matrix;
+    InterruptMatrix next;
+    InterruptStatsReader::parse(frames[0], matrix);
+    InterruptStatsReader::parse(frames[1], next);
+    std::vector<std::uint64_t> delta(matrix.counts.size());
+    std::printf("%-10s %12s %12s\n", "level", "parse ms", "subtract ms");
+    const SystemProcFS::ScanLevel original = SystemProcFS::activeScanLevel();
+    for (SystemProcFS::ScanLevel level : {SystemProcFS::ScanLevel::Scalar, SystemProcFS::ScanLevel::SSE42, SystemProcFS::ScanLevel::AVX2}) {
+        if (SystemProcFS::setScanLevel(level) != level) continue;
+        const double parse_ms = millisecondsPer(samples, [&] { InterruptStatsReader::parse(frames[0], matrix); });
+        const double subtract_ms = millisecondsPer(samples, [&] {
+            SystemProcFS::subtractCounters(matrix.counts.data(), next.counts.data(), delta.data(), delta.size());
+        });
+        std::printf("%-10s %12.3f %12.3f\n", SystemProcFS::scanLevelName(level), parse_ms, subtract_ms);
+    }
+    SystemProcFS::setScanLevel(original);
+
+    auto source = std::make_shared<SystemProcFS::VirtualProcSource>();
+    source->setGenerator("/proc/interrupts", [&frames](std::uint64_t tick) { return frames[tick % 2]; });
+    SystemProcFS::ScopedProcSource scoped(source);
+    InterruptCollector collector(InterruptTable::Hardware);
+    auto now = InterruptCollector::Clock::now();
+    const double sample_ms = millisecondsPer(samples, [&] {
+        source->advance();
+        now += std::chrono::seconds(1);
+        collector.sample(now);
+    });
+    std::printf("%-22s %8.3f ms (default level)\n", "sample", sample_ms);
+
+    std::size_t hot = 0;
+    const double hottest_ms = millisecondsPer(samples, [&] { hot += collector.hottest(10).size(); });
+    const auto top = collector.hottest(1);
+    std::printf("%-22s %8.3f ms (top: IRQ %s, %.0f/s, busiest CPU%u)\n", "hottest(10)", hottest_ms,
+                top.empty() ? "-" : top[0].name.c_str(), top.empty() ? 0.0 : top[0].rate,
+                top.empty() ? 0u : top[0].busiest_cpu);
+    return hot == 0 ? 1 : 0;
+}
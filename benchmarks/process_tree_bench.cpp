@@ -0,0 +1,99 @@
+// Time to scan and roll up a host with many processes.
+//
+// Generates `processes` fake /proc/<pid> directories (stat, io, cgroup) in a temporary directory,
+// arranged as a tree below pid 1 and spread over 200 units and 500 executable names, and samples
+// them through a DirectoryProcSource:
+//   first      the first sample: every process is new (stat, io and cgroup read, groups joined)
+//   steady     later samples: stat and io read, groups adjusted in place, tree rebuilt
+//   top        top(RollupBy, RollupResource, 10) over each grouping
+// then samples the live /proc the same way for comparison.
+//
+// Usage: process_tree_bench [processes] [runs]
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <memory>
+#include <random>
+#include <string>
+
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "proc_source.hpp"
+#include "process_tree.hpp"
+
+using SystemProcessStats::ProcessTreeCollector;
+using SystemProcessStats::RollupBy;
+using SystemProcessStats::RollupResource;
+
+namespace {
+std::string writeFixture(unsigned processes) {
+    char root_template[] = "/tmp/process_tree_benchXXXXXX";
+    const std::string root = ::mkdtemp(root_template);
+    ::mkdir((root + "/proc").c_str(), 0755);
+    std::mt19937 random(42);
+    for (unsigned pid = 1; pid <= processes; ++pid) {
+        // Parents are earlier pids, mostly close by, giving trees a few levels deep.
+        const unsigned ppid = pid == 1 ? 0 : pid - 1 - random() % std::min(pid - 1, 64u);
+        const std::string dir = root + "/proc/" + std::to_string(pid);
+        ::mkdir(dir.c_str(), 0755);
+        std::ofstream(dir + "/stat") << pid << " (exe-" << random() % 500 << ") S " << ppid
+                                     << " 1 1 0 -1 4194560 0 0 0 0 " << random() % 100000 << " " << random() % 100000
+                                     << " 0 0 20 0 1 0 " << pid << " 1000000 " << random() % 100000
+                                     << " 18446744073709551615 1 1 0 0 0 0 0 0 0 0 0 0 17 0 0 0 0 0 0 0 0 0 0 0 0 0 0\n";
+        std::ofstream(dir + "/io") << "rchar: 1\nwchar: 1\nsyscr: 1\nsyscw: 1\nread_bytes: " << random() % 1000000
+                                   << "\nwrite_bytes: " << random() % 1000000 << "\ncancelled_write_bytes: 0\n";
+        std::ofstream(dir + "/cgroup") << "0::/system.slice/unit-" << random() % 200 << ".service\n";
+    }
+    return root;
+}
+
+void removeFixture(const std::string& root, unsigned processes) {
+    for (unsigned pid = 1; pid <= processes; ++pid) {
+        const std::string dir = root + "/proc/" + std::to_string(pid);
+        for (const char* name : {"/stat", "/io", "/cgroup"}) std::remove((dir + name).c_str());
+        ::rmdir(dir.c_str());
+    }
+    ::rmdir((root + "/proc").c_str());
+    ::rmdir(root.c_str());
+}
+
+template <typename Body>
+double measure(unsigned runs, Body body) {
+    const auto start = std::chrono::steady_clock::now();
+    for (unsigned r = 0; r < runs; ++r) body();
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count() / runs;
+}
+
+void report(const char* label, ProcessTreeCollector& collector, unsigned runs) {
+    const double first_ms = measure(1, [&] { collector.sample(); });
+    const double steady_ms = measure(runs, [&] { collector.sample(); });
+    const double top_ms = measure(runs, [&] {
+        for (RollupBy by : {RollupBy::Tree, RollupBy::Executable, RollupBy::Unit}) {
+            collector.top(by, RollupResource::Cpu, 10);
+        }
+    });
+    std::printf("%-8s %10zu %8zu %10.2f %10.2f %10.3f\n", label, collector.stats().processes,
+                collector.stats().groups, first_ms, steady_ms, top_ms);
+}
+} // namespace
+
+int main(int argc, char** argv) {
+    const unsigned processes = argc > 1 ? static_cast<unsigned>(std::strtoul(argv[1], nullptr, 10)) : 50000;
+    const unsigned runs = argc > 2 ? static_cast<unsigned>(std::strtoul(argv[2], nullptr, 10)) : 10;
+
+    std::printf("%-8s %10s %8s %10s %10s %10s\n", "source", "processes", "groups", "first ms", "steady ms", "top ms");
+    const std::string root = writeFixture(processes);
+    {
+        SystemProcFS::ScopedProcSource scoped(std::make_shared<SystemProcFS::DirectoryProcSource>(root));
+        ProcessTreeCollector collector;
+        report("fixture", collector, runs);
+    }
+    removeFixture(root, processes);
+
+    ProcessTreeCollector live;
+    report("live", live, runs);
+    return 0;
+}
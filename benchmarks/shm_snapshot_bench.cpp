@@ -0,0 +1,89 @@
+// Reader throughput of the shared-memory snapshot region with many concurrent readers.
+//
+// A publisher thread rewrites the snapshot continuously (worst case for seqlock retries)
+// or once per millisecond; N reader threads share one ShmReader and copy the snapshot in
+// a loop for a fixed duration.
+//
+// Usage: shm_snapshot_bench [max_readers] [seconds_per_run]
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <unistd.h>
+
+#include "shm_snapshot.hpp"
+
+using SystemMetricsSnapshot::MetricsSnapshot;
+using namespace SystemMetricsShm;
+
+namespace {
+MetricsSnapshot makeSnapshot() {
+    MetricsSnapshot s;
+    s.timestamp_ms = 1;
+    s.cpu = SystemCPUStats::CPUStats(123456, 2345, 34567, 9876543, 1234, 56, 789, 0, 0, 0);
+    s.mem = SystemMemoryStats::MemStats(65536000, 12000000, 40000000, 200000, 16000000, 0, 0);
+    for (int d = 0; d < 8; ++d) s.disks.emplace_back("nvme" + std::to_string(d) + "n1", 1, 2, 3, 4);
+    for (int n = 0; n < 6; ++n) s.nets.emplace_back("eth" + std::to_string(n), 1, 2, 3, 4, 5, 6, 7, 8);
+    return s;
+}
+
+void run(ShmPublisher& publisher, const ShmReader& reader, unsigned readers, bool hot_publisher, double seconds) {
+    std::atomic<bool> stop{false};
+    std::atomic<unsigned long long> total_reads{0};
+    std::atomic<unsigned long long> failed_reads{0};
+
+    std::thread writer([&] {
+        MetricsSnapshot snapshot = makeSnapshot();
+        while (!stop.load(std::memory_order_relaxed)) {
+            ++snapshot.timestamp_ms;
+            ++snapshot.nets[0].bytes_received;
+            publisher.publish(snapshot);
+            if (!hot_publisher) std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    });
+
+    std::vector<std::thread> threads;
+    for (unsigned t = 0; t < readers; ++t) {
+        threads.emplace_back([&] {
+            MetricsSnapshot out;
+            unsigned long long reads = 0, failed = 0;
+            while (!stop.load(std::memory_order_relaxed)) {
+                if (reader.read(out, 64)) ++reads; else ++failed;
+            }
+            total_reads += reads;
+            failed_reads += failed;
+        });
+    }
+    std::this_thread::sleep_for(std::chrono::duration<double>(seconds));
+    stop.store(true);
+    for (auto& t : threads) t.join();
+    writer.join();
+
+    const double per_second = static_cast<double>(total_reads.load()) / seconds;
+    std::printf("%-9s readers=%-3u reads/s=%12.0f  per-reader=%11.0f  ns/read=%7.1f  failed=%llu\n",
+                hot_publisher ? "hot" : "1kHz", readers, per_second, per_second / readers,
+                readers * 1e9 / (per_second > 0 ? per_second : 1), failed_reads.load());
+}
+} // namespace
+
+int main(int argc, char** argv) {
+    const unsigned max_readers = argc > 1 ? static_cast<unsigned>(std::strtoul(argv[1], nullptr, 10))
+                                          : std::thread::hardware_concurrency() * 2;
+    const double seconds = argc > 2 ? std::strtod(argv[2], nullptr) : 1.0;
+
+    ShmPublisher publisher("/metrics_agent_bench_" + std::to_string(::getpid()));
+    ShmReader reader(publisher.name());
+    publisher.publish(makeSnapshot());
+
+    for (bool hot : {false, true}) {
+        for (unsigned readers = 1; readers <= max_readers; readers *= 2) {
+            run(publisher, reader, readers, hot, seconds);
+        }
+    }
+    return 0;
+}
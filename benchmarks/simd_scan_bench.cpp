@@ -0,0 +1,152 @@
+// Parse throughput (GB/s of input text) of the /proc line and field scanner at each scan level.
+//
+// Generates in-memory tables shaped like large hosts' /proc files and parses them repeatedly:
+//   net/dev     container host with many interfaces, via NetStatsReader::parseNetDevLine
+//   diskstats   hundreds of block devices, via DiskStatsReader::parseDiskStatLine
+//   interrupts  one counter column per CPU, split and converted with LineFields/parseDecimal
+// The "iostream" row tokenizes the same text with std::istringstream, as the parsers used to.
+//
+// Usage: simd_scan_bench [seconds_per_run] [interfaces] [disks] [cpus]
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <sstream>
+#include <string>
+#include <string_view>
+
+#include "disk_stats.hpp"
+#include "net_stats.hpp"
+#include "proc_parse.hpp"
+#include "simd_scan.hpp"
+
+using namespace SystemProcFS;
+
+namespace {
+volatile std::uint64_t g_sink = 0; // Keeps the parsed values observable
+
+std::string makeNetDev(unsigned interfaces) {
+    std::string text = "Inter-|   Receive                                                |  Transmit\n"
+                       " face |bytes    packets errs drop fifo frame compressed multicast|bytes    packets errs drop fifo colls carrier compressed\n";
+    for (unsigned n = 0; n < interfaces; ++n) {
+        text += "  eth" + std::to_string(n) + ": 98765432109 123456789 0 12 0 0 0 4321 87654321098 98765432 0 3 0 0 0 0\n";
+    }
+    return text;
+}
+
+std::string makeDiskstats(unsigned disks) {
+    std::string text;
+    for (unsigned d = 0; d < disks; ++d) {
+        text += " 259 " + std::to_string(d) + " nvme" + std::to_string(d) +
+                "n1 123456789 4567 9876543210 456789 234567890 6789 8765432109 567890 0 345678 1024567 0 0 0 0 12345 678\n";
+    }
+    return text;
+}
+
+std::string makeInterrupts(unsigned cpus) {
+    std::string text = "      ";
+    for (unsigned c = 0; c < cpus; ++c) text += " CPU" + std::to_string(c);
+    text += "\n";
+    for (unsigned irq = 0; irq < 64; ++irq) {
+        text += " " + std::to_string(irq) + ":";
+        for (unsigned c = 0; c < cpus; ++c) text += " " + std::to_string(1000003ULL * (irq + 1) * (c + 7));
+        text += "  IR-PCI-MSI 1048576-edge      eth0-TxRx-" + std::to_string(irq) + "\n";
+    }
+    return text;
+}
+
+std::uint64_t parseNetDev(std::string_view text) {
+    std::uint64_t sum = 0;
+    std::string_view line;
+    while (nextLine(text, line)) {
+        std::string_view name;
+        SystemNetStats::NetRecord record;
+        if (SystemNetStats::NetStatsReader::parseNetDevLine(line, name, record)) sum += record.bytes_received;
+    }
+    return sum;
+}
+
+std::uint64_t parseDiskstats(std::string_view text) {
+    std::uint64_t sum = 0;
+    std::string_view line;
+    while (nextLine(text, line)) {
+        std::string_view device;
+        SystemDiskStats::DiskRecord record;
+        if (SystemDiskStats::DiskStatsReader::parseDiskStatLine(line, device, record)) sum += record.read_bytes;
+    }
+    return sum;
+}
+
+// Sums every per-CPU counter; long lines are consumed kMaxFields fields at a time and stop at
+// the first non-numeric field (the interrupt chip and handler names).
+std::uint64_t parseInterrupts(std::string_view text) {
+    std::uint64_t sum = 0;
+    std::string_view line;
+    nextLine(text, line); // CPU header
+    while (nextLine(text, line)) {
+        std::string_view rest = line.substr(line.find(':') + 1);
+        bool more = true;
+        while (more) {
+            const LineFields fields(rest);
+            std::uint64_t value = 0;
+            std::size_t i = 0;
+            for (; i < fields.size() && fields.unsignedAt(i, value); ++i) sum += value;
+            more = i == LineFields::kMaxFields;
+            rest = fields.rest();
+        }
+    }
+    return sum;
+}
+
+std::uint64_t parseIostream(const std::string& text) {
+    std::istringstream in(text);
+    std::string token;
+    std::uint64_t sum = 0;
+    while (in >> token) {
+        if (token[0] >= '0' && token[0] <= '9') sum += std::strtoull(token.c_str(), nullptr, 10);
+    }
+    return sum;
+}
+
+template <typename Parse>
+double gigabytesPerSecond(const std::string& text, double seconds, Parse parse) {
+    using Clock = std::chrono::steady_clock;
+    const auto deadline = Clock::now() + std::chrono::duration<double>(seconds);
+    const auto start = Clock::now();
+    unsigned long long passes = 0;
+    while (Clock::now() < deadline) {
+        g_sink = g_sink + parse(text);
+        ++passes;
+    }
+    const double elapsed = std::chrono::duration<double>(Clock::now() - start).count();
+    return static_cast<double>(passes) * static_cast<double>(text.size()) / elapsed / 1e9;
+}
+} // namespace
+
+int main(int argc, char** argv) {
+    const double seconds = argc > 1 ? std::strtod(argv[1], nullptr) : 0.5;
+    const unsigned interfaces = argc > 2 ? static_cast<unsigned>(std::strtoul(argv[2], nullptr, 10)) : 1024;
+    const unsigned disks = argc > 3 ? static_cast<unsigned>(std::strtoul(argv[3], nullptr, 10)) : 512;
+    const unsigned cpus = argc > 4 ? static_cast<unsigned>(std::strtoul(argv[4], nullptr, 10)) : 256;
+
+    const std::string net_dev = makeNetDev(interfaces);
+    const std::string diskstats = makeDiskstats(disks);
+    const std::string interrupts = makeInterrupts(cpus);
+    std::printf("Inputs: net/dev %zu KiB, diskstats %zu KiB, interrupts %zu KiB; detected level %s\n",
+                net_dev.size() / 1024, diskstats.size() / 1024, interrupts.size() / 1024,
+                scanLevelName(detectedScanLevel()));
+
+    std::printf("%-10s %12s %12s %12s\n", "level", "net/dev", "diskstats", "interrupts");
+    std::printf("%-10s %9.3f GB/s %7.3f GB/s %8.3f GB/s\n", "iostream",
+                gigabytesPerSecond(net_dev, seconds, parseIostream),
+                gigabytesPerSecond(diskstats, seconds, parseIostream),
+                gigabytesPerSecond(interrupts, seconds, parseIostream));
+    for (ScanLevel level : {ScanLevel::Scalar, ScanLevel::SSE42, ScanLevel::AVX2}) {
+        if (setScanLevel(level) != level) continue;
+        std::printf("%-10s %9.3f GB/s %7.3f GB/s %8.3f GB/s\n", scanLevelName(level),
+                    gigabytesPerSecond(net_dev, seconds, [](const std::string& t) { return parseNetDev(t); }),
+                    gigabytesPerSecond(diskstats, seconds, [](const std::string& t) { return parseDiskstats(t); }),
+                    gigabytesPerSecond(interrupts, seconds, [](const std::string& t) { return parseInterrupts(t); }));
+    }
+    return 0;
+}
@@ -0,0 +1,122 @@
+// Encode/decode throughput of the binary snapshot codec, and frame sizes compared
+// with the same snapshot serialized as JSON (nlohmann_json) and Prometheus text.
+//
+// Usage: snapshot_codec_bench [iterations]
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+#include <nlohmann/json.hpp>
+
+#include "prometheus_exporter.hpp"
+#include "snapshot_codec.hpp"
+
+using SystemMetricsSnapshot::MetricsSnapshot;
+using namespace SystemMetricsCodec;
+
+namespace {
+// A host with 8 disks and 6 interfaces whose counters advance a little every second.
+MetricsSnapshot makeSnapshot(unsigned long long step) {
+    MetricsSnapshot s;
+    s.timestamp_ms = 1700000000000ULL + step * 1000;
+    s.cpu = SystemCPUStats::CPUStats(123456 + 37 * step, 23456 + 11 * step, 3456 + step, 9876543 + 350 * step,
+                                     1234 + (step & 1), 56, 789 + step, 0, 0, 0);
+    s.mem = SystemMemoryStats::MemStats(65536000, 12000000 - (step % 100) * 64, 40000000 + (step % 100) * 64,
+                                        200000, 16000000, 8388604, 8388604);
+    for (int d = 0; d < 8; ++d) {
+        s.disks.emplace_back("nvme" + std::to_string(d) + "n1", (1ULL << 36) + step * 40960 * (d + 1),
+                             (1ULL << 37) + step * 81920, 1000000 + step * 3, 2000000 + step * 5);
+    }
+    const char* ifaces[] = {"lo", "eth0", "eth1", "bond0", "docker0", "veth1a2b3c"};
+    for (int n = 0; n < 6; ++n) {
+        s.nets.emplace_back(ifaces[n], (1ULL << 33) + step * 150000 * (n + 1), (1ULL << 32) + step * 90000,
+                            80000000 + step * 120, 60000000 + step * 90, 12, 3, 456, 7);
+    }
+    return s;
+}
+
+std::string toJson(const MetricsSnapshot& s) {
+    nlohmann::json j;
+    j["timestamp_ms"] = s.timestamp_ms;
+    j["cpu"] = {{"user", s.cpu.user}, {"nice", s.cpu.nice}, {"system", s.cpu.system}, {"idle", s.cpu.idle},
+                {"iowait", s.cpu.iowait}, {"irq", s.cpu.irq}, {"softirq", s.cpu.softirq},
+                {"steal", s.cpu.steal}, {"guest", s.cpu.guest}, {"guest_nice", s.cpu.guest_nice}};
+    j["mem"] = {{"total", s.mem.total}, {"free", s.mem.free}, {"available", s.mem.available},
+                {"buffers", s.mem.buffers}, {"cached", s.mem.cached}, {"swap_total", s.mem.swap_total},
+                {"swap_free", s.mem.swap_free}};
+    for (const auto& d : s.disks) {
+        j["disks"].push_back({{"device", d.device}, {"read_bytes", d.read_bytes}, {"write_bytes", d.write_bytes},
+                              {"read_time_ms", d.read_time_ms}, {"write_time_ms", d.write_time_ms}});
+    }
+    for (const auto& n : s.nets) {
+        j["nets"].push_back({{"interface", n.interface_name}, {"bytes_received", n.bytes_received},
+                             {"bytes_sent", n.bytes_sent}, {"packets_received", n.packets_received},
+                             {"packets_sent", n.packets_sent}, {"errors_in", n.errors_in},
+                             {"errors_out", n.errors_out}, {"drops_in", n.drops_in}, {"drops_out", n.drops_out}});
+    }
+    return j.dump();
+}
+
+double secondsSince(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+} // namespace
+
+int main(int argc, char** argv) {
+    const size_t iterations = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 200000;
+    const size_t kDistinct = 256;
+
+    std::vector<MetricsSnapshot> snapshots;
+    for (size_t i = 0; i < kDistinct; ++i) snapshots.push_back(makeSnapshot(i));
+
+    // Sizes: one keyframe, the average delta frame, JSON and Prometheus text.
+    SnapshotEncoder sizing(kDistinct);
+    std::vector<std::uint8_t> frame;
+    sizing.encode(snapshots[0], frame);
+    const size_t keyframe_size = frame.size();
+    size_t delta_total = 0;
+    for (size_t i = 1; i < kDistinct; ++i) {
+        frame.clear();
+        delta_total += sizing.encode(snapshots[i], frame);
+    }
+    std::string prometheus;
+    SystemMetricsExporter::renderPrometheusText(snapshots[1], prometheus);
+    std::printf("sizes (bytes): keyframe=%zu delta(avg)=%.1f json=%zu prometheus_text=%zu\n",
+                keyframe_size, static_cast<double>(delta_total) / (kDistinct - 1),
+                toJson(snapshots[1]).size(), prometheus.size());
+
+    // Encode throughput (default keyframe interval).
+    SnapshotEncoder encoder;
+    std::vector<std::uint8_t> stream;
+    stream.reserve(iterations * 256);
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < iterations; ++i) encoder.encode(snapshots[i % kDistinct], stream, i % kDistinct == 0);
+    double encode_s = secondsSince(start);
+    std::printf("encode: %.0f frames/s, %.1f ns/frame, %.1f MB/s\n", iterations / encode_s,
+                encode_s * 1e9 / iterations, stream.size() / encode_s / 1e6);
+
+    // Decode throughput, reading in place from the concatenated stream.
+    SnapshotDecoder decoder;
+    MetricsSnapshot decoded;
+    size_t offset = 0;
+    start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < iterations; ++i) {
+        offset += decoder.decode(ByteSpan(stream.data() + offset, stream.size() - offset), decoded);
+    }
+    double decode_s = secondsSince(start);
+    std::printf("decode: %.0f frames/s, %.1f ns/frame, %.1f MB/s\n", iterations / decode_s,
+                decode_s * 1e9 / iterations, stream.size() / decode_s / 1e6);
+
+    // JSON serialization for reference.
+    const size_t json_iterations = iterations / 10 + 1;
+    size_t json_bytes = 0;
+    start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < json_iterations; ++i) json_bytes += toJson(snapshots[i % kDistinct]).size();
+    double json_s = secondsSince(start);
+    std::printf("json dump: %.0f docs/s, %.1f ns/doc (%zu bytes total)\n", json_iterations / json_s,
+                json_s * 1e9 / json_iterations, json_bytes);
+    return offset == stream.size() ? 0 : 1;
+}
@@ -0,0 +1,132 @@
+// Time to summarize the host's TCP sockets by state with many sockets open.
+//
+// Forks helper processes that each open loopback connections to their own listener (both ends
+// stay open, so every connection is two ESTABLISHED sockets) until `sockets` sockets exist, then
+// summarizes them repeatedly:
+//   proc        SocketStatsCollector on /proc/net/tcp{,6}: the kernel formats every socket as text
+//   sock_diag   SocketStatsCollector over NETLINK_SOCK_DIAG, all states
+//   listeners   sock_diag asking only for LISTEN sockets: the kernel skips the rest
+//
+// Usage: socket_stats_bench [sockets] [runs]
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "socket_stats.hpp"
+
+using SystemNetStats::SocketStatsCollector;
+using SystemNetStats::SocketSummary;
+using SystemNetStats::TcpState;
+
+namespace {
+// Connections per helper, bounded by the per-process descriptor limit (two per connection).
+unsigned connectionsPerHelper() {
+    rlimit limit{};
+    ::getrlimit(RLIMIT_NOFILE, &limit);
+    limit.rlim_cur = limit.rlim_max;
+    ::setrlimit(RLIMIT_NOFILE, &limit);
+    const rlim_t usable = std::min<rlim_t>(limit.rlim_cur, 1u << 20) - 64;
+    return static_cast<unsigned>(std::min<rlim_t>(usable / 2, 20000)); // Also well inside the ephemeral port range
+}
+
+// Runs in the helper: opens `connections` connections, reports how many, then holds them until
+// the parent closes `release`.
+[[noreturn]] void holdConnections(unsigned connections, int ready, int release) {
+    const int listener = ::socket(AF_INET, SOCK_STREAM, 0);
+    sockaddr_in address{};
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    socklen_t length = sizeof(address);
+    unsigned opened = 0;
+    if (listener >= 0 && ::bind(listener, reinterpret_cast<sockaddr*>(&address), sizeof(address)) == 0 &&
+        ::listen(listener, 1024) == 0 && ::getsockname(listener, reinterpret_cast<sockaddr*>(&address), &length) == 0) {
+        for (; opened < connections; ++opened) {
+            const int client = ::socket(AF_INET, SOCK_STREAM, 0);
+            if (client < 0 || ::connect(client, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0) break;
+            if (::accept(listener, nullptr, nullptr) < 0) break;
+        }
+    }
+    (void)!::write(ready, &opened, sizeof(opened));
+    char byte;
+    (void)!::read(release, &byte, 1);
+    std::_Exit(0);
+}
+
+template <typename Collect>
+double measure(unsigned runs, Collect collect) {
+    collect(); // Warm-up (opens the netlink socket, sizes the buffers)
+    const auto start = std::chrono::steady_clock::now();
+    for (unsigned r = 0; r < runs; ++r) collect();
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count() / runs;
+}
+} // namespace
+
+int main(int argc, char** argv) {
+    const unsigned sockets = argc > 1 ? static_cast<unsigned>(std::strtoul(argv[1], nullptr, 10)) : 100000;
+    const unsigned runs = argc > 2 ? static_cast<unsigned>(std::strtoul(argv[2], nullptr, 10)) : 10;
+
+    const unsigned per_helper = connectionsPerHelper();
+    int ready[2], release[2];
+    if (per_helper == 0 || ::pipe(ready) != 0 || ::pipe(release) != 0) {
+        std::fprintf(stderr, "cannot set up helpers\n");
+        return 1;
+    }
+    std::vector<pid_t> helpers;
+    for (unsigned remaining = (sockets + 1) / 2; remaining > 0;) {
+        const unsigned connections = std::min(remaining, per_helper);
+        const pid_t pid = ::fork();
+        if (pid == 0) {
+            ::close(release[1]);
+            holdConnections(connections, ready[1], release[0]);
+        }
+        if (pid < 0) break;
+        helpers.push_back(pid);
+        remaining -= connections;
+    }
+    ::close(release[0]);
+    unsigned long long opened = 0;
+    for (std::size_t h = 0; h < helpers.size(); ++h) {
+        unsigned count = 0;
+        if (::read(ready[0], &count, sizeof(count)) == static_cast<ssize_t>(sizeof(count))) opened += count;
+    }
+
+    SocketStatsCollector::Options proc_options;
+    proc_options.use_sock_diag = false;
+    SocketStatsCollector proc(proc_options);
+    SocketStatsCollector diag;
+    SocketStatsCollector::Options listen_options;
+    listen_options.states = SystemNetStats::tcpStateBit(TcpState::Listen);
+    SocketStatsCollector listeners(listen_options);
+
+    SocketSummary proc_summary, diag_summary, listen_summary;
+    const double proc_ms = measure(runs, [&] { proc.collect(proc_summary); });
+    const double diag_ms = measure(runs, [&] { diag.collect(diag_summary); });
+    const double listen_ms = measure(runs, [&] { listeners.collect(listen_summary); });
+
+    std::printf("%llu loopback connections in %zu helpers, %u runs (backend: %s)\n", opened, helpers.size(), runs,
+                SystemNetStats::socketBackendName(diag.backend()));
+    std::printf("%-10s %12s %12s %12s %10s\n", "collector", "ms/collect", "sockets", "established", "listeners");
+    std::printf("%-10s %12.2f %12llu %12llu %10zu\n", "proc", proc_ms,
+                static_cast<unsigned long long>(proc_summary.total()),
+                static_cast<unsigned long long>(proc_summary.count(TcpState::Established)), proc_summary.listeners.size());
+    std::printf("%-10s %12.2f %12llu %12llu %10zu\n", "sock_diag", diag_ms,
+                static_cast<unsigned long long>(diag_summary.total()),
+                static_cast<unsigned long long>(diag_summary.count(TcpState::Established)), diag_summary.listeners.size());
+    std::printf("%-10s %12.2f %12llu %12llu %10zu\n", "listeners", listen_ms,
+                static_cast<unsigned long long>(listen_summary.total()),
+                static_cast<unsigned long long>(listen_summary.count(TcpState::Established)), listen_summary.listeners.size());
+
+    ::close(release[1]);
+    for (pid_t pid : helpers) ::waitpid(pid, nullptr, 0);
+    return 0;
+}
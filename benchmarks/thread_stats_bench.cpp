@@ -0,0 +1,85 @@
+// Time to sample every thread of a process with many threads.
+//
+// Starts `threads` idle threads in this process, then samples it repeatedly with:
+//   held        ThreadCollector keeping the task directory and every stat file open (one pread per thread)
+//   reopened    ThreadCollector with max_open_files = 0: open, read and close per thread
+// and reports the per-sample cost and the descriptors each one holds.
+//
+// Usage: thread_stats_bench [threads] [runs]
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <mutex>
+#include <system_error>
+#include <thread>
+#include <vector>
+
+#include <sys/resource.h>
+#include <unistd.h>
+
+#include "thread_stats.hpp"
+
+using SystemProcessStats::ThreadCollector;
+
+namespace {
+template <typename Collect>
+double measure(unsigned runs, Collect collect) {
+    collect(); // Warm-up (opens the stat files, sizes the buffers)
+    const auto start = std::chrono::steady_clock::now();
+    for (unsigned r = 0; r < runs; ++r) collect();
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count() / runs;
+}
+} // namespace
+
+int main(int argc, char** argv) {
+    const unsigned requested = argc > 1 ? static_cast<unsigned>(std::strtoul(argv[1], nullptr, 10)) : 2000;
+    const unsigned runs = argc > 2 ? static_cast<unsigned>(std::strtoul(argv[2], nullptr, 10)) : 20;
+
+    rlimit limit{};
+    ::getrlimit(RLIMIT_NOFILE, &limit);
+    limit.rlim_cur = limit.rlim_max;
+    ::setrlimit(RLIMIT_NOFILE, &limit);
+
+    std::mutex mutex;
+    std::condition_variable done;
+    bool stop = false;
+    std::vector<std::thread> threads;
+    threads.reserve(requested);
+    try {
+        for (unsigned t = 0; t < requested; ++t) {
+            threads.emplace_back([&] {
+                std::unique_lock<std::mutex> lock(mutex);
+                done.wait(lock, [&] { return stop; });
+            });
+        }
+    } catch (const std::system_error&) {
+        // Out of threads: measure with what was started.
+    }
+
+    ThreadCollector held;
+    held.track(static_cast<int>(::getpid()));
+    ThreadCollector::Options reopen_options;
+    reopen_options.max_open_files = 0;
+    ThreadCollector reopened(reopen_options);
+    reopened.track(static_cast<int>(::getpid()));
+
+    const double held_ms = measure(runs, [&] { held.sample(); });
+    const double reopened_ms = measure(runs, [&] { reopened.sample(); });
+
+    std::printf("%zu threads, %u runs\n", threads.size() + 1, runs);
+    std::printf("%-10s %12s %12s %12s\n", "collector", "ms/sample", "opens", "open files");
+    std::printf("%-10s %12.2f %12llu %12zu\n", "held", held_ms,
+                static_cast<unsigned long long>(held.stats().opens), held.stats().open_files);
+    std::printf("%-10s %12.2f %12llu %12zu\n", "reopened", reopened_ms,
+                static_cast<unsigned long long>(reopened.stats().opens), reopened.stats().open_files);
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stop = true;
+    }
+    done.notify_all();
+    for (std::thread& thread : threads) thread.join();
+    return 0;
+}
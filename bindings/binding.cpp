@@ -5,23 +5,65 @@
 #include <chrono> // For std::chrono::milliseconds
 #include <sstream> // For std::stringstream
 #include <map> // Required if any C++ function returns std::map (e.g., if a future getNetStatsPerInterface returns map)
+#include <memory> // For std::make_unique in py::init factories
+#include <mutex> // For Locked collectors
+#include <utility> // For std::forward
 
 // Include your C++ headers for the various stats
+#include "container_stats.hpp"
 #include "cpu_stats.hpp"
+#include "sched_stats.hpp"
+#include "interrupt_stats.hpp"
 #include "mem_stats.hpp"
+#include "numa_stats.hpp"
 #include "disk_stats.hpp"
+#include "fs_stats.hpp"
 #include "net_stats.hpp"
+#include "protocol_stats.hpp"
+#include "socket_stats.hpp"
+#include "softnet_stats.hpp"
+#include "thread_stats.hpp"
+#include "process_tree.hpp"
+#include "proc_source.hpp"
+#include "metrics_snapshot.hpp"
+#include "prometheus_exporter.hpp"
+#include "snapshot_codec.hpp"
+#include "ring_log.hpp"
+#include "forwarder.hpp"
+#include "shm_snapshot.hpp"
 
 namespace py = pybind11;
 
 // Alias namespaces for convenience in bindings
 namespace scs = SystemCPUStats;
+namespace sis = SystemInterruptStats;
 using SystemMemoryStats::MemStats;
 using SystemMemoryStats::MeMStatsReader;
 using SystemDiskStats::DiskStats;
 using SystemDiskStats::DiskStatsReader;
 using SystemNetStats::NetStats; // Corrected from SystemNetworkStats
 using SystemNetStats::NetStatsReader; // Corrected from NetworkStatsReader
+using SystemMetricsSnapshot::MetricsSnapshot;
+using SystemMetricsExporter::PrometheusExporter;
+using SystemMetricsCodec::SnapshotEncoder;
+using SystemMetricsCodec::SnapshotDecoder;
+using SystemMetricsHistory::RingLog;
+namespace smf = SystemMetricsForwarder;
+using SystemMetricsShm::ShmPublisher;
+using SystemMetricsShm::ShmReader;
+
+// The stateful collectors are not thread-safe. Those whose calls are quick keep the GIL, which
+// serializes them with every other call on the object; those that can block for long (mounts that
+// do not answer, large socket dumps) are bound through Locked, and release the GIL but hold a
+// per-object lock instead.
+template <typename Collector>
+struct Locked {
+    template <typename... Args>
+    explicit Locked(Args&&... args) : collector(std::forward<Args>(args)...) {}
+
+    Collector collector;
+    std::mutex mutex;
+};
 
 // --- New structs and functions for throughput calculations ---
 // These are defined here assuming they are utility functions that might not
@@ -168,6 +210,163 @@ PYBIND11_MODULE(py_metrics_agent, m) { // Module name as requested for py_metric
           "Gets CPU usage percentage by taking two snapshots with a specified interval (in milliseconds).",
           py::arg("interval_ms"));
 
+    // Exact integer counters and per-mode utilization
+    py::class_<scs::CPUCounters>(m, "CPUCounters")
+        .def(py::init<>())
+        .def_readwrite("user", &scs::CPUCounters::user)
+        .def_readwrite("nice", &scs::CPUCounters::nice)
+        .def_readwrite("system", &scs::CPUCounters::system)
+        .def_readwrite("idle", &scs::CPUCounters::idle)
+        .def_readwrite("iowait", &scs::CPUCounters::iowait)
+        .def_readwrite("irq", &scs::CPUCounters::irq)
+        .def_readwrite("softirq", &scs::CPUCounters::softirq)
+        .def_readwrite("steal", &scs::CPUCounters::steal)
+        .def_readwrite("guest", &scs::CPUCounters::guest)
+        .def_readwrite("guest_nice", &scs::CPUCounters::guest_nice)
+        .def("total", &scs::CPUCounters::total, "Sum of every mode, counting guest time once.");
+
+    py::class_<scs::CPUCoreCounters>(m, "CPUCoreCounters")
+        .def(py::init<>())
+        .def_readwrite("cpu", &scs::CPUCoreCounters::cpu)
+        .def_readwrite("counters", &scs::CPUCoreCounters::counters);
+
+    py::class_<scs::SystemActivity>(m, "SystemActivity")
+        .def(py::init<>())
+        .def_readwrite("context_switches", &scs::SystemActivity::context_switches)
+        .def_readwrite("forks", &scs::SystemActivity::forks)
+        .def_readwrite("procs_running", &scs::SystemActivity::procs_running)
+        .def_readwrite("procs_blocked", &scs::SystemActivity::procs_blocked)
+        .def_readwrite("boot_time", &scs::SystemActivity::boot_time);
+
+    py::class_<scs::CPUCounterSample>(m, "CPUCounterSample")
+        .def(py::init<>())
+        .def_readwrite("aggregate", &scs::CPUCounterSample::aggregate)
+        .def_readwrite("cpus", &scs::CPUCounterSample::cpus)
+        .def_readwrite("activity", &scs::CPUCounterSample::activity);
+
+    py::class_<scs::ActivityRates>(m, "ActivityRates")
+        .def(py::init<>())
+        .def_readwrite("context_switches", &scs::ActivityRates::context_switches)
+        .def_readwrite("forks", &scs::ActivityRates::forks)
+        .def_readwrite("elapsed_seconds", &scs::ActivityRates::elapsed_seconds);
+
+    py::class_<scs::LoadAverage>(m, "LoadAverage")
+        .def(py::init<>())
+        .def_readwrite("one", &scs::LoadAverage::one)
+        .def_readwrite("five", &scs::LoadAverage::five)
+        .def_readwrite("fifteen", &scs::LoadAverage::fifteen)
+        .def_readwrite("runnable", &scs::LoadAverage::runnable)
+        .def_readwrite("tasks", &scs::LoadAverage::tasks)
+        .def_readwrite("last_pid", &scs::LoadAverage::last_pid);
+
+    py::class_<scs::CPUUtilization>(m, "CPUUtilization")
+        .def(py::init<>())
+        .def_readwrite("user", &scs::CPUUtilization::user)
+        .def_readwrite("nice", &scs::CPUUtilization::nice)
+        .def_readwrite("system", &scs::CPUUtilization::system)
+        .def_readwrite("idle", &scs::CPUUtilization::idle)
+        .def_readwrite("iowait", &scs::CPUUtilization::iowait)
+        .def_readwrite("irq", &scs::CPUUtilization::irq)
+        .def_readwrite("softirq", &scs::CPUUtilization::softirq)
+        .def_readwrite("steal", &scs::CPUUtilization::steal)
+        .def_readwrite("guest", &scs::CPUUtilization::guest)
+        .def_readwrite("guest_nice", &scs::CPUUtilization::guest_nice)
+        .def_readwrite("busy", &scs::CPUUtilization::busy)
+        .def_readwrite("elapsed_seconds", &scs::CPUUtilization::elapsed_seconds);
+
+    py::class_<scs::CPUCoreUtilization>(m, "CPUCoreUtilization")
+        .def(py::init<>())
+        .def_readwrite("cpu", &scs::CPUCoreUtilization::cpu)
+        .def_readwrite("utilization", &scs::CPUCoreUtilization::utilization);
+
+    m.def("get_cpu_counters", static_cast<scs::CPUCounterSample (*)()>(&scs::CPUStatsReader::getCPUCounters),
+        "Reads the aggregate and per-CPU counters as exact integers (clock ticks).");
+    m.def("compute_cpu_utilization",
+          static_cast<scs::CPUUtilization (*)(const scs::CPUCounters&, const scs::CPUCounters&)>(&scs::computeUtilization),
+          "Per-mode utilization (percent) between two readings of the same CPU or of the aggregate.",
+          py::arg("previous"), py::arg("current"));
+    m.def("compute_per_cpu_utilization",
+          static_cast<std::vector<scs::CPUCoreUtilization> (*)(const scs::CPUCounterSample&, const scs::CPUCounterSample&)>(&scs::computeUtilization),
+          "Per-CPU utilization between two samples; CPUs present in only one sample are skipped.",
+          py::arg("previous"), py::arg("current"));
+    m.def("compute_activity_rates", &scs::computeActivityRates,
+          "Context-switch and fork rates (per second) between two SystemActivity readings.",
+          py::arg("previous"), py::arg("current"), py::arg("elapsed_seconds"));
+    m.def("get_load_average", static_cast<scs::LoadAverage (*)()>(&scs::CPUStatsReader::getLoadAverage),
+        "Reads the 1/5/15-minute load averages and task counts from /proc/loadavg.");
+    m.def("cpu_ticks_per_second", &scs::ticksPerSecond, "Clock ticks per second of CPUCounters (USER_HZ on Linux).");
+
+    // Run-queue latency from /proc/schedstat and /proc/<pid>/schedstat
+    py::class_<scs::SchedLatency>(m, "SchedLatency")
+        .def(py::init<>())
+        .def_readonly("running", &scs::SchedLatency::running, "Seconds spent running per second.")
+        .def_readonly("waiting", &scs::SchedLatency::waiting, "Seconds spent runnable but waiting per second.")
+        .def_readonly("timeslices", &scs::SchedLatency::timeslices, "Timeslices per second.")
+        .def_readonly("average_wait_us", &scs::SchedLatency::average_wait_us, "Mean run-queue wait per timeslice.");
+
+    py::class_<scs::SchedCollector>(m, "SchedCollector")
+        .def(py::init<>())
+        .def("track", &scs::SchedCollector::track, py::arg("pid"))
+        .def("untrack", &scs::SchedCollector::untrack, py::arg("pid"))
+        .def_property_readonly("tracked", &scs::SchedCollector::tracked)
+        .def("sample", py::overload_cast<>(&scs::SchedCollector::sample),
+             "Reads /proc/schedstat and every tracked task; from the second sample on, rates cover the interval since the previous one.")
+        .def_property_readonly("has_rates", &scs::SchedCollector::hasRates)
+        .def_property_readonly("has_cpu_stats", &scs::SchedCollector::hasCPUStats,
+             "False on kernels without /proc/schedstat (CONFIG_SCHEDSTATS); tracked tasks are still reported.")
+        .def("rates", [](const scs::SchedCollector& self) {
+                 const scs::SchedRates& rates = self.rates();
+                 std::map<unsigned, scs::SchedLatency> cpus;
+                 for (const auto& cpu : rates.cpus) cpus[cpu.cpu] = cpu.latency;
+                 std::map<int, scs::SchedLatency> tasks;
+                 for (const auto& task : rates.tasks) tasks[task.pid] = task.latency;
+                 return py::make_tuple(rates.total, cpus, tasks);
+             },
+             "(total SchedLatency, {cpu: SchedLatency}, {pid: SchedLatency})");
+
+    // --- Interrupt Statistics Bindings ---
+    py::enum_<sis::InterruptTable>(m, "InterruptTable")
+        .value("HARDWARE", sis::InterruptTable::Hardware)
+        .value("SOFT", sis::InterruptTable::Soft);
+
+    py::class_<sis::InterruptMatrix>(m, "InterruptMatrix")
+        .def(py::init<>())
+        .def_readonly("cpus", &sis::InterruptMatrix::cpus)
+        .def_readonly("names", &sis::InterruptMatrix::names)
+        .def_readonly("descriptions", &sis::InterruptMatrix::descriptions)
+        .def_readonly("counts", &sis::InterruptMatrix::counts, "rows x columns counters, row-major.")
+        .def_property_readonly("rows", &sis::InterruptMatrix::rows)
+        .def_property_readonly("columns", &sis::InterruptMatrix::columns)
+        .def("at", &sis::InterruptMatrix::at, py::arg("row"), py::arg("column"));
+
+    py::class_<sis::InterruptRates>(m, "InterruptRates")
+        .def_readonly("elapsed_seconds", &sis::InterruptRates::elapsed_seconds)
+        .def_readonly("deltas", &sis::InterruptRates::deltas, "Per-IRQ, per-CPU increase over the interval, row-major.")
+        .def_readonly("per_irq", &sis::InterruptRates::per_irq)
+        .def_readonly("per_cpu", &sis::InterruptRates::per_cpu)
+        .def("rate", &sis::InterruptRates::rate, py::arg("row"), py::arg("column"));
+
+    py::class_<sis::HotInterrupt>(m, "HotInterrupt")
+        .def_readonly("name", &sis::HotInterrupt::name)
+        .def_readonly("description", &sis::HotInterrupt::description)
+        .def_readonly("rate", &sis::HotInterrupt::rate)
+        .def_readonly("busiest_cpu", &sis::HotInterrupt::busiest_cpu)
+        .def_readonly("busiest_cpu_rate", &sis::HotInterrupt::busiest_cpu_rate)
+        .def("__repr__", [](const sis::HotInterrupt& hot) {
+            return "<HotInterrupt(name=" + hot.name + ", rate=" + std::to_string(hot.rate) +
+                ", busiest_cpu=" + std::to_string(hot.busiest_cpu) + ")>";
+        });
+
+    py::class_<sis::InterruptCollector>(m, "InterruptCollector")
+        .def(py::init<sis::InterruptTable>(), py::arg("table") = sis::InterruptTable::Hardware)
+        .def("sample", py::overload_cast<>(&sis::InterruptCollector::sample),
+             "Reads the table; from the second sample on, rates cover the interval since the previous one.")
+        .def_property_readonly("current", &sis::InterruptCollector::current, py::return_value_policy::reference_internal)
+        .def_property_readonly("rates", &sis::InterruptCollector::rates, py::return_value_policy::reference_internal)
+        .def_property_readonly("has_rates", &sis::InterruptCollector::hasRates)
+        .def("hottest", &sis::InterruptCollector::hottest,
+             "The k rows with the highest rate over the last interval, highest first.", py::arg("k") = 10);
+
     // --- Disk Statistics Bindings ---
     py::class_<DiskStats>(m, "DiskStats")
         .def(py::init<>()) // Default constructor
@@ -190,12 +389,17 @@ PYBIND11_MODULE(py_metrics_agent, m) { // Module name as requested for py_metric
     // Bind the static functions for DiskStatsReader
     m.def("get_disk_stats_aggregated", // Renamed for clarity for Python consumers
         py::overload_cast<>(&DiskStatsReader::getDiskStats),
-        "Get aggregated disk stats for all physical devices.");
+        "Get aggregated disk stats for all physical devices.",
+        py::call_guard<py::gil_scoped_release>()); // Lets concurrent Python threads share one read
 
     m.def("get_disk_stats_by_device", // Renamed for clarity for Python consumers
         py::overload_cast<const std::string&>(&DiskStatsReader::getDiskStats),
         "Get disk stats for a specific device.",
-        py::arg("device_name"));
+        py::arg("device_name"), py::call_guard<py::gil_scoped_release>());
+
+    m.def("get_disk_stats_for_devices", &DiskStatsReader::getDiskStatsForDevices,
+        "Get disk stats for several devices from one read, as a dict keyed by device name (missing devices are omitted).",
+        py::arg("device_names"), py::call_guard<py::gil_scoped_release>());
 
     // Bind the DiskThroughputResult struct for Python access
     py::class_<DiskThroughputResult>(m, "DiskThroughputResult")
@@ -213,6 +417,49 @@ PYBIND11_MODULE(py_metrics_agent, m) { // Module name as requested for py_metric
         py::arg("current_stats"), py::arg("previous_stats"), py::arg("time_delta_ms"));
 
 
+    // Filesystem capacity (statvfs on every real mount, refreshed with the mount table)
+    py::class_<SystemDiskStats::FilesystemUsage>(m, "FilesystemUsage")
+        .def_readonly("mount_point", &SystemDiskStats::FilesystemUsage::mount_point)
+        .def_readonly("fs_type", &SystemDiskStats::FilesystemUsage::fs_type)
+        .def_readonly("source", &SystemDiskStats::FilesystemUsage::source)
+        .def_readonly("read_only", &SystemDiskStats::FilesystemUsage::read_only)
+        .def_property_readonly("status", [](const SystemDiskStats::FilesystemUsage& u) {
+            return std::string(SystemDiskStats::filesystemStatusName(u.status));
+        })
+        .def_readonly("size_bytes", &SystemDiskStats::FilesystemUsage::size_bytes)
+        .def_readonly("free_bytes", &SystemDiskStats::FilesystemUsage::free_bytes)
+        .def_readonly("available_bytes", &SystemDiskStats::FilesystemUsage::available_bytes)
+        .def_readonly("used_bytes", &SystemDiskStats::FilesystemUsage::used_bytes)
+        .def_readonly("inodes", &SystemDiskStats::FilesystemUsage::inodes)
+        .def_readonly("inodes_free", &SystemDiskStats::FilesystemUsage::inodes_free)
+        .def_property_readonly("used_percent", &SystemDiskStats::FilesystemUsage::usedPercent)
+        .def("__repr__", [](const SystemDiskStats::FilesystemUsage& u) {
+            return "<FilesystemUsage(mount_point='" + u.mount_point + "', fs_type='" + u.fs_type +
+                   "', status=" + SystemDiskStats::filesystemStatusName(u.status) + ")>";
+        });
+
+    using LockedFilesystemCollector = Locked<SystemDiskStats::FilesystemCollector>;
+    py::class_<LockedFilesystemCollector>(m, "FilesystemCollector")
+        .def(py::init([](long long timeout_ms, std::size_t threads, bool include_pseudo) {
+                 SystemDiskStats::FilesystemCollector::Options options;
+                 options.timeout = std::chrono::milliseconds(timeout_ms);
+                 options.threads = threads;
+                 options.include_pseudo = include_pseudo;
+                 return std::make_unique<LockedFilesystemCollector>(options);
+             }),
+             py::arg("timeout_ms") = 1000, py::arg("threads") = 8, py::arg("include_pseudo") = false)
+        .def("collect", [](LockedFilesystemCollector& self) {
+                 std::lock_guard<std::mutex> lock(self.mutex);
+                 return self.collector.collect();
+             },
+             "Capacity of every real mount; mounts that do not answer within the timeout report status 'timed_out'.",
+             py::call_guard<py::gil_scoped_release>())
+        .def_property_readonly("mount_table_reads", [](LockedFilesystemCollector& self) {
+                 std::lock_guard<std::mutex> lock(self.mutex);
+                 return self.collector.mountTableReads();
+             },
+             py::call_guard<py::gil_scoped_release>());
+
     // --- Memory Statistics Bindings ---
     py::class_<MemStats>(m, "MemStats")
         .def(py::init<>()) // Default constructor
@@ -234,6 +481,177 @@ PYBIND11_MODULE(py_metrics_agent, m) { // Module name as requested for py_metric
     m.def("get_mem_stats", &MeMStatsReader::getMemStats,
         "Retrieves current memory statistics.");
 
+    // --- Container (cgroup) Statistics Bindings ---
+    namespace scont = SystemContainerStats;
+    py::class_<scont::ContainerCollector>(m, "ContainerCollector")
+        .def(py::init([](double limits_refresh_seconds) {
+                 scont::ContainerCollector::Options options;
+                 options.limits_refresh = std::chrono::milliseconds(static_cast<long long>(limits_refresh_seconds * 1000));
+                 return std::make_unique<scont::ContainerCollector>(options);
+             }),
+             py::arg("limits_refresh_seconds") = 10.0)
+        .def("sample", py::overload_cast<>(&scont::ContainerCollector::sample),
+             "Reads the cgroup's usage counters (and its limits when due); from the second sample on, usage covers the interval since the previous one.")
+        .def_property_readonly("has_rates", &scont::ContainerCollector::hasRates)
+        .def_property_readonly("limit_reads", &scont::ContainerCollector::limitReads)
+        .def("limits", [](const scont::ContainerCollector& self) {
+                 const scont::CgroupLimits& limits = self.limits();
+                 py::dict out;
+                 out["cgroup_version"] = scont::cgroupVersionName(self.paths().version);
+                 out["cpu_cores"] = limits.cpu_cores;
+                 out["cpu_quota"] = limits.cpu_quota;
+                 out["cpuset_cpus"] = limits.cpuset_cpus;
+                 out["host_cpus"] = limits.host_cpus;
+                 out["memory_bytes"] = limits.memory_bytes;
+                 out["memory_limited"] = limits.memory_limited;
+                 out["host_memory_bytes"] = limits.host_memory_bytes;
+                 return out;
+             })
+        .def("usage", [](const scont::ContainerCollector& self) {
+                 const scont::ContainerUsage& usage = self.usage();
+                 py::dict out;
+                 out["elapsed_seconds"] = usage.elapsed_seconds;
+                 out["cpu_cores"] = usage.cpu_cores;
+                 out["cpu_percent"] = usage.cpu_percent;
+                 out["throttled_percent"] = usage.throttled_percent;
+                 out["throttled_seconds"] = usage.throttled_seconds;
+                 out["memory_working_set_bytes"] = usage.memory_working_set_bytes;
+                 out["memory_percent"] = usage.memory_percent;
+                 return out;
+             },
+             "CPU and memory use relative to the cgroup's quota and limit.");
+
+    // --- NUMA Statistics Bindings ---
+    namespace sns = SystemNumaStats;
+    py::class_<sns::NumaCollector>(m, "NumaCollector")
+        .def(py::init<>(), "Reads the NUMA topology once; it is reused by every sample.")
+        .def("sample", py::overload_cast<>(&sns::NumaCollector::sample),
+             "Reads every node and /proc/stat; from the second sample on, rates cover the interval since the previous one.")
+        .def_property_readonly("has_rates", &sns::NumaCollector::hasRates)
+        .def("topology", [](const sns::NumaCollector& self) {
+                 std::map<unsigned, std::vector<unsigned>> cpus;
+                 for (const auto& node : self.topology().nodes()) cpus[node.node] = node.cpus;
+                 return cpus;
+             },
+             "{node: [cpu, ...]}")
+        .def("nodes", [](const sns::NumaCollector& self) {
+                 py::list out;
+                 for (const auto& node : self.current()) {
+                     py::dict row;
+                     row["node"] = node.node;
+                     row["mem_total_kb"] = node.memory.total;
+                     row["mem_free_kb"] = node.memory.free;
+                     row["mem_used_kb"] = node.memory.used;
+                     row["mem_used_percent"] = node.memory.usedPercent();
+                     row["file_pages_kb"] = node.memory.file_pages;
+                     row["anon_pages_kb"] = node.memory.anon_pages;
+                     row["numa_hit"] = node.counters.numa_hit;
+                     row["numa_miss"] = node.counters.numa_miss;
+                     row["numa_foreign"] = node.counters.numa_foreign;
+                     out.append(row);
+                 }
+                 return out;
+             },
+             "Latest memory and allocation counters, one dict per node.")
+        .def("rates", [](const sns::NumaCollector& self) {
+                 py::list out;
+                 for (const auto& node : self.rates().nodes) {
+                     py::dict row;
+                     row["node"] = node.node;
+                     row["numa_hit"] = node.numa_hit;
+                     row["numa_miss"] = node.numa_miss;
+                     row["numa_foreign"] = node.numa_foreign;
+                     row["local_node"] = node.local_node;
+                     row["other_node"] = node.other_node;
+                     row["cpu_busy_percent"] = node.cpu.busy;
+                     row["cpu_iowait_percent"] = node.cpu.iowait;
+                     row["cpus"] = node.cpus;
+                     out.append(row);
+                 }
+                 return out;
+             },
+             "Per-second allocation rates and CPU utilization over the last interval, one dict per node.");
+
+    // --- Per-thread Statistics Bindings ---
+    namespace sps = SystemProcessStats;
+    py::class_<sps::ThreadCollector>(m, "ThreadCollector")
+        .def(py::init([](std::size_t max_open_files) {
+                 sps::ThreadCollector::Options options;
+                 options.max_open_files = max_open_files;
+                 return std::make_unique<sps::ThreadCollector>(options);
+             }),
+             py::arg("max_open_files") = 4096)
+        .def("track", &sps::ThreadCollector::track, py::arg("pid"))
+        .def("untrack", &sps::ThreadCollector::untrack, py::arg("pid"))
+        .def_property_readonly("tracked", &sps::ThreadCollector::tracked)
+        .def("sample", py::overload_cast<>(&sps::ThreadCollector::sample),
+             "Reads every thread of every tracked process; from the second sample on, usage covers the interval since the previous one.")
+        .def_property_readonly("has_rates", &sps::ThreadCollector::hasRates)
+        .def("hottest", [](const sps::ThreadCollector& self, std::size_t count) {
+                 py::list out;
+                 for (const auto& thread : self.hottest(count)) {
+                     py::dict row;
+                     row["pid"] = thread.pid;
+                     row["tid"] = thread.tid;
+                     row["name"] = thread.name;
+                     row["state"] = std::string(1, thread.state);
+                     row["processor"] = thread.processor;
+                     row["cpu_percent"] = thread.cpu_percent;
+                     row["user_percent"] = thread.user_percent;
+                     row["system_percent"] = thread.system_percent;
+                     out.append(row);
+                 }
+                 return out;
+             },
+             py::arg("count") = 10,
+             "The busiest threads over all tracked processes, busiest first; 100 = one CPU kept busy.")
+        .def("process_cpu_percent", [](const sps::ThreadCollector& self) {
+                 std::map<int, double> out;
+                 for (const auto& process : self.usage()) out[process.pid] = process.cpu_percent;
+                 return out;
+             },
+             "{pid: summed thread CPU percent}");
+
+    // --- Process Tree Rollup Bindings ---
+    py::enum_<sps::RollupBy>(m, "RollupBy")
+        .value("TREE", sps::RollupBy::Tree)
+        .value("EXECUTABLE", sps::RollupBy::Executable)
+        .value("UNIT", sps::RollupBy::Unit);
+
+    py::enum_<sps::RollupResource>(m, "RollupResource")
+        .value("CPU", sps::RollupResource::Cpu)
+        .value("RSS", sps::RollupResource::Rss)
+        .value("IO", sps::RollupResource::Io);
+
+    py::class_<sps::Rollup>(m, "Rollup")
+        .def(py::init<>())
+        .def_readonly("name", &sps::Rollup::name)
+        .def_readonly("pid", &sps::Rollup::pid, "Top process of a tree rollup; 0 otherwise.")
+        .def_readonly("processes", &sps::Rollup::processes)
+        .def_readonly("cpu_percent", &sps::Rollup::cpu_percent)
+        .def_readonly("rss_bytes", &sps::Rollup::rss_bytes)
+        .def_readonly("read_bytes_per_second", &sps::Rollup::read_bytes_per_second)
+        .def_readonly("write_bytes_per_second", &sps::Rollup::write_bytes_per_second);
+
+    py::class_<sps::ProcessTreeCollector>(m, "ProcessTreeCollector")
+        .def(py::init([](bool read_io) {
+                 sps::ProcessTreeCollector::Options options;
+                 options.read_io = read_io;
+                 return std::make_unique<sps::ProcessTreeCollector>(options);
+             }),
+             py::arg("read_io") = true)
+        .def("sample", py::overload_cast<>(&sps::ProcessTreeCollector::sample),
+             "Scans /proc and updates the rollups; from the second sample on, they cover the interval since the previous one.")
+        .def_property_readonly("has_rates", &sps::ProcessTreeCollector::hasRates)
+        .def("top", &sps::ProcessTreeCollector::top, py::arg("by"), py::arg("resource"), py::arg("count") = 10,
+             "The groups using the most of a resource, largest first.")
+        .def("subtree", [](const sps::ProcessTreeCollector& self, int pid) -> py::object {
+                 sps::Rollup rollup;
+                 if (!self.subtree(pid, rollup)) return py::none();
+                 return py::cast(rollup);
+             },
+             py::arg("pid"), "Rollup of a process and its descendants, or None if it was not seen.");
+
     // --- Network Statistics Bindings ---
     // Bind NetThroughputResult struct
     py::class_<NetThroughputResult>(m, "NetThroughputResult")
@@ -276,15 +694,371 @@ PYBIND11_MODULE(py_metrics_agent, m) { // Module name as requested for py_metric
     // All methods are static, so no need for a constructor binding for the class itself
     m.def("get_net_stats_aggregated", // Renamed for clarity for Python consumers
         py::overload_cast<>(&NetStatsReader::getNetStats),
-        "Retrieves aggregated network statistics across all active interfaces.");
+        "Retrieves aggregated network statistics across all active interfaces.",
+        py::call_guard<py::gil_scoped_release>());
 
     m.def("get_net_stats_by_interface", // Renamed for clarity for Python consumers
         py::overload_cast<const std::string&>(&NetStatsReader::getNetStats),
         "Retrieves network statistics for a specific network interface.",
-        py::arg("interface_name"));
+        py::arg("interface_name"), py::call_guard<py::gil_scoped_release>());
+
+    m.def("get_net_stats_for_interfaces", &NetStatsReader::getNetStatsForInterfaces,
+        "Retrieves statistics for several interfaces from one read, as a dict keyed by interface name (missing interfaces are omitted).",
+        py::arg("interface_names"), py::call_guard<py::gil_scoped_release>());
+
+    // Per-CPU packet processing from /proc/net/softnet_stat, as one dict per CPU
+    m.def("get_softnet_stats", []() {
+            std::vector<SystemNetStats::SoftnetCPU> cpus;
+            {
+                py::gil_scoped_release release;
+                cpus = SystemNetStats::SoftnetStatsReader::getSoftnetStats();
+            }
+            py::list out;
+            for (const auto& cpu : cpus) {
+                py::dict row;
+                row["cpu"] = cpu.cpu;
+                for (std::size_t i = 0; i < SystemNetStats::kSoftnetCounterCount; ++i) {
+                    row[SystemNetStats::softnetCounterName(static_cast<SystemNetStats::SoftnetCounter>(i))] = cpu.counters[i];
+                }
+                row["backlog"] = cpu.backlog;
+                out.append(row);
+            }
+            return out;
+        },
+        "Reads /proc/net/softnet_stat: [{cpu, processed, dropped, time_squeeze, received_rps, flow_limit_count, backlog}].");
+
+    py::class_<SystemNetStats::SoftnetCollector>(m, "SoftnetCollector")
+        .def(py::init<>())
+        .def("sample", py::overload_cast<>(&SystemNetStats::SoftnetCollector::sample),
+             "Reads /proc/net/softnet_stat; from the second sample on, rates cover the interval since the previous one.")
+        .def_property_readonly("has_rates", &SystemNetStats::SoftnetCollector::hasRates)
+        .def("rates", [](const SystemNetStats::SoftnetCollector& self) {
+                 py::list out;
+                 for (const auto& cpu : self.rates().cpus) {
+                     py::dict row;
+                     row["cpu"] = cpu.cpu;
+                     for (std::size_t i = 0; i < SystemNetStats::kSoftnetCounterCount; ++i) {
+                         row[SystemNetStats::softnetCounterName(static_cast<SystemNetStats::SoftnetCounter>(i))] = cpu.per_second[i];
+                     }
+                     out.append(row);
+                 }
+                 return out;
+             },
+             "Per-second rates over the last interval, one dict per CPU present in both samples.");
+
+    // Protocol counters from /proc/net/snmp and /proc/net/netstat, keyed by "Section.Key" names
+    py::class_<SystemNetStats::ProtocolStatsCollector>(m, "ProtocolStatsCollector")
+        .def(py::init<>())
+        .def("sample", py::overload_cast<>(&SystemNetStats::ProtocolStatsCollector::sample),
+             "Reads both files; from the second sample on, rates cover the interval since the previous one.")
+        .def_property_readonly("has_rates", &SystemNetStats::ProtocolStatsCollector::hasRates)
+        .def("counters", [](const SystemNetStats::ProtocolStatsCollector& self) {
+                 std::map<std::string, unsigned long long> out;
+                 for (std::size_t i = 0; i < SystemNetStats::kProtocolCounterCount; ++i) {
+                     const auto counter = static_cast<SystemNetStats::ProtocolCounter>(i);
+                     if (self.current().has(counter)) out[SystemNetStats::protocolCounterName(counter)] = self.current()[counter];
+                 }
+                 return out;
+             },
+             "Latest reading as {name: value}; counters the kernel does not report are omitted.")
+        .def("rates", [](const SystemNetStats::ProtocolStatsCollector& self) {
+                 std::map<std::string, double> out;
+                 for (std::size_t i = 0; i < SystemNetStats::kProtocolCounterCount; ++i) {
+                     const auto counter = static_cast<SystemNetStats::ProtocolCounter>(i);
+                     if (self.current().has(counter) && !SystemNetStats::isProtocolGauge(counter)) {
+                         out[SystemNetStats::protocolCounterName(counter)] = self.rates()[counter];
+                     }
+                 }
+                 return out;
+             },
+             "Per-second rates over the last interval as {name: rate}; gauges (Tcp.CurrEstab) are omitted.");
+
+    // TCP socket-state summary (sock_diag, or /proc/net/tcp as a fallback)
+    py::class_<SystemNetStats::ListenBacklog>(m, "ListenBacklog")
+        .def_readonly("port", &SystemNetStats::ListenBacklog::port)
+        .def_readonly("sockets", &SystemNetStats::ListenBacklog::sockets)
+        .def_readonly("queued", &SystemNetStats::ListenBacklog::queued)
+        .def_readonly("limit", &SystemNetStats::ListenBacklog::limit)
+        .def("__repr__", [](const SystemNetStats::ListenBacklog& b) {
+                 return "<ListenBacklog port=" + std::to_string(b.port) + ", queued=" + std::to_string(b.queued) +
+                        ", limit=" + std::to_string(b.limit) + ">";
+             });
+
+    using LockedSocketStatsCollector = Locked<SystemNetStats::SocketStatsCollector>;
+    py::class_<LockedSocketStatsCollector>(m, "SocketStatsCollector")
+        .def(py::init([](bool include_ipv6, bool use_sock_diag) {
+                 SystemNetStats::SocketStatsCollector::Options options;
+                 options.include_ipv6 = include_ipv6;
+                 options.use_sock_diag = use_sock_diag;
+                 return std::make_unique<LockedSocketStatsCollector>(options);
+             }),
+             py::arg("include_ipv6") = true, py::arg("use_sock_diag") = true)
+        .def("collect", [](LockedSocketStatsCollector& self) {
+                 SystemNetStats::SocketSummary summary;
+                 {
+                     py::gil_scoped_release release;
+                     std::lock_guard<std::mutex> lock(self.mutex);
+                     self.collector.collect(summary);
+                 }
+                 std::map<std::string, unsigned long long> states;
+                 for (std::size_t s = 1; s < SystemNetStats::kTcpStateSlots; ++s) {
+                     states[SystemNetStats::tcpStateName(static_cast<SystemNetStats::TcpState>(s))] = summary.states[s];
+                 }
+                 return py::make_tuple(states, summary.listeners);
+             },
+             "Returns ({state name: socket count}, [ListenBacklog ascending by port]).")
+        .def_property_readonly("backend", [](LockedSocketStatsCollector& self) {
+                 py::gil_scoped_release release;
+                 std::lock_guard<std::mutex> lock(self.mutex);
+                 return std::string(SystemNetStats::socketBackendName(self.collector.backend()));
+             });
 
     // Bind the calculateNetworkThroughput function
     m.def("calculate_network_throughput", &calculateNetworkThroughput,
         "Calculates network throughput (KB/s) between two NetStats snapshots.",
         py::arg("current_stats"), py::arg("previous_stats"), py::arg("time_delta_ms"));
+
+    // --- /proc Source Bindings ---
+    // Base class must be registered so VirtualProcSource instances can be passed to set_proc_source.
+    py::class_<SystemProcFS::ProcSource, std::shared_ptr<SystemProcFS::ProcSource>>(m, "ProcSource");
+
+    py::class_<SystemProcFS::VirtualProcSource, SystemProcFS::ProcSource,
+               std::shared_ptr<SystemProcFS::VirtualProcSource>>(m, "VirtualProcSource")
+        .def(py::init<>())
+        .def("set_file", &SystemProcFS::VirtualProcSource::setFile,
+             "Registers a virtual file with fixed contents.", py::arg("path"), py::arg("contents"))
+        .def("set_sequence", &SystemProcFS::VirtualProcSource::setSequence,
+             "Registers a virtual file that replays one frame per tick.", py::arg("path"), py::arg("frames"))
+        .def("remove_file", [](SystemProcFS::VirtualProcSource& self, const std::string& path) { self.removeFile(path); },
+             "Removes a virtual file.", py::arg("path"))
+        .def("advance", &SystemProcFS::VirtualProcSource::advance,
+             "Advances the scripted clock.", py::arg("steps") = 1)
+        .def_property_readonly("tick", &SystemProcFS::VirtualProcSource::tick);
+
+    m.def("set_proc_source",
+        [](std::shared_ptr<SystemProcFS::ProcSource> source) { SystemProcFS::ProcFS::setSource(std::move(source)); },
+        "Makes every reader use the given source instead of the live /proc.",
+        py::arg("source"));
+
+    m.def("set_proc_root", &SystemProcFS::ProcFS::setRoot,
+        "Makes every reader resolve /proc and /sys paths below the given directory (e.g. a recorded fixture).",
+        py::arg("root"));
+
+    m.def("reset_proc_source", &SystemProcFS::ProcFS::reset,
+        "Restores the default /proc source (the live host, or METRICS_AGENT_PROC_ROOT if set).");
+
+    // --- Snapshot Bindings ---
+    py::class_<MetricsSnapshot>(m, "MetricsSnapshot")
+        .def(py::init<>())
+        .def_readwrite("timestamp_ms", &MetricsSnapshot::timestamp_ms)
+        .def_readwrite("cpu", &MetricsSnapshot::cpu)
+        .def_readwrite("mem", &MetricsSnapshot::mem)
+        .def_readwrite("disks", &MetricsSnapshot::disks)
+        .def_readwrite("nets", &MetricsSnapshot::nets)
+        .def("__repr__", [](const MetricsSnapshot &s) {
+            return "<MetricsSnapshot timestamp_ms=" + std::to_string(s.timestamp_ms) +
+                   ", disks=" + std::to_string(s.disks.size()) +
+                   ", nets=" + std::to_string(s.nets.size()) + ">";
+        });
+
+    m.def("collect_snapshot", py::overload_cast<>(&SystemMetricsSnapshot::SnapshotCollector::collect),
+        "Collects CPU, memory, per-device disk and per-interface network stats in one call.");
+
+    m.def("get_all_disk_stats", &DiskStatsReader::getAllDiskStats,
+        "Get disk stats for every physical device as a list.", py::call_guard<py::gil_scoped_release>());
+
+    m.def("get_all_net_stats", &NetStatsReader::getAllNetStats,
+        "Get network stats for every interface as a list.", py::call_guard<py::gil_scoped_release>());
+
+    // --- Read Cache Bindings ---
+    py::class_<SystemProcFS::CacheStats>(m, "CacheStats")
+        .def_readonly("loads", &SystemProcFS::CacheStats::loads)
+        .def_readonly("hits", &SystemProcFS::CacheStats::hits)
+        .def_readonly("coalesced", &SystemProcFS::CacheStats::coalesced)
+        .def("__repr__", [](const SystemProcFS::CacheStats& s) {
+            return "<CacheStats loads=" + std::to_string(s.loads) + ", hits=" + std::to_string(s.hits) +
+                   ", coalesced=" + std::to_string(s.coalesced) + ">";
+        });
+
+    m.def("set_disk_stats_cache_max_age",
+        [](long long max_age_ms) { DiskStatsReader::setCacheMaxAge(std::chrono::milliseconds(max_age_ms)); },
+        "Shares one /proc/diskstats parse between callers for up to max_age_ms (0 = only concurrent callers).",
+        py::arg("max_age_ms"));
+    m.def("get_disk_stats_cache_stats", &DiskStatsReader::cacheStats);
+    m.def("invalidate_disk_stats_cache", &DiskStatsReader::invalidateCache);
+
+    m.def("set_net_stats_cache_max_age",
+        [](long long max_age_ms) { NetStatsReader::setCacheMaxAge(std::chrono::milliseconds(max_age_ms)); },
+        "Shares one interface-list parse between callers for up to max_age_ms (0 = only concurrent callers).",
+        py::arg("max_age_ms"));
+    m.def("get_net_stats_cache_stats", &NetStatsReader::cacheStats);
+    m.def("invalidate_net_stats_cache", &NetStatsReader::invalidateCache);
+
+    // --- Prometheus Exporter Bindings ---
+    m.def("render_prometheus_text",
+        [](const MetricsSnapshot& snapshot) {
+            std::string text;
+            SystemMetricsExporter::renderPrometheusText(snapshot, text);
+            return text;
+        },
+        "Renders a snapshot in the Prometheus text exposition format.",
+        py::arg("snapshot"));
+
+    py::class_<PrometheusExporter>(m, "PrometheusExporter")
+        .def(py::init([](const std::string& bind_address, std::uint16_t port, bool enable_gzip, long long collection_interval_ms) {
+                 return new PrometheusExporter(PrometheusExporter::Options(
+                     bind_address, port, enable_gzip, std::chrono::milliseconds(collection_interval_ms)));
+             }),
+             py::arg("bind_address") = "127.0.0.1", py::arg("port") = 9100,
+             py::arg("enable_gzip") = true, py::arg("collection_interval_ms") = 1000)
+        .def("start", &PrometheusExporter::start, "Starts serving /metrics.")
+        .def("stop", &PrometheusExporter::stop, "Stops the server.", py::call_guard<py::gil_scoped_release>())
+        .def("collect", &PrometheusExporter::collect, "Runs one collection cycle and publishes it.",
+             py::call_guard<py::gil_scoped_release>())
+        .def("publish", &PrometheusExporter::publish, "Publishes an externally collected snapshot.", py::arg("snapshot"))
+        .def("attach_history", &PrometheusExporter::attachHistory,
+             "Appends every collected snapshot to a RingLog (None detaches) and republishes its newest entry.",
+             py::arg("history"))
+        .def("attach_shared_memory", &PrometheusExporter::attachSharedMemory,
+             "Also publishes every collected snapshot through a ShmPublisher (None detaches).",
+             py::arg("publisher"))
+        .def_property_readonly("port", &PrometheusExporter::port)
+        .def_property_readonly("running", &PrometheusExporter::running);
+
+    // --- Snapshot Codec Bindings ---
+    py::class_<SnapshotEncoder>(m, "SnapshotEncoder")
+        .def(py::init<std::size_t>(), py::arg("keyframe_interval") = 60)
+        .def("encode",
+            [](SnapshotEncoder& self, const MetricsSnapshot& snapshot, bool force_keyframe) {
+                std::vector<std::uint8_t> frame;
+                self.encode(snapshot, frame, force_keyframe);
+                return py::bytes(reinterpret_cast<const char*>(frame.data()), frame.size());
+            },
+            "Encodes a snapshot as one binary frame (a keyframe or a delta against the previous frame).",
+            py::arg("snapshot"), py::arg("force_keyframe") = false)
+        .def("reset", &SnapshotEncoder::reset, "Forgets all state so that the next frame is a keyframe.");
+
+    py::class_<SnapshotDecoder>(m, "SnapshotDecoder")
+        .def(py::init<>())
+        .def("decode",
+            [](SnapshotDecoder& self, py::bytes frame) {
+                std::string_view view(frame);
+                MetricsSnapshot snapshot;
+                self.decode(SystemMetricsCodec::ByteSpan(reinterpret_cast<const std::uint8_t*>(view.data()), view.size()),
+                            snapshot);
+                return snapshot;
+            },
+            "Decodes one frame produced by SnapshotEncoder.",
+            py::arg("frame"))
+        .def("reset", &SnapshotDecoder::reset, "Forgets all state; the next frame must be a keyframe.");
+
+    // --- Ring Log Bindings ---
+    py::class_<RingLog, std::shared_ptr<RingLog>>(m, "RingLog")
+        .def(py::init([](const std::string& path, std::size_t capacity, bool read_only) {
+                 return std::make_shared<RingLog>(path, capacity,
+                                                  read_only ? RingLog::Mode::ReadOnly : RingLog::Mode::ReadWrite);
+             }),
+             py::arg("path"), py::arg("capacity") = RingLog::kDefaultCapacity, py::arg("read_only") = false)
+        .def("append", py::overload_cast<const MetricsSnapshot&>(&RingLog::append),
+             "Appends a snapshot and returns its sequence number.", py::arg("snapshot"))
+        .def("replay", &RingLog::replay, "Returns the stored snapshots, oldest first.", py::arg("max_records") = 0)
+        .def("latest",
+             [](const RingLog& self) -> py::object {
+                 MetricsSnapshot snapshot;
+                 if (!self.latest(snapshot)) return py::none();
+                 return py::cast(snapshot);
+             },
+             "Returns the newest stored snapshot, or None if the log is empty.")
+        .def("sync", &RingLog::sync, "Flushes the mapping to disk.")
+        .def_property_readonly("first_sequence", &RingLog::firstSequence)
+        .def_property_readonly("next_sequence", &RingLog::nextSequence)
+        .def_property_readonly("capacity", &RingLog::capacity)
+        .def("__len__", &RingLog::size);
+
+    // --- Forwarder Bindings ---
+    py::class_<smf::Sink, std::shared_ptr<smf::Sink>>(m, "Sink")
+        .def("describe", &smf::Sink::describe);
+    py::class_<smf::FileSink, smf::Sink, std::shared_ptr<smf::FileSink>>(m, "FileSink")
+        .def(py::init<const std::string&>(), py::arg("path"));
+    py::class_<smf::UnixSocketSink, smf::Sink, std::shared_ptr<smf::UnixSocketSink>>(m, "UnixSocketSink")
+        .def(py::init([](const std::string& path, long long send_timeout_ms) {
+                 return std::make_shared<smf::UnixSocketSink>(path, std::chrono::milliseconds(send_timeout_ms));
+             }),
+             py::arg("path"), py::arg("send_timeout_ms") = 2000);
+    py::class_<smf::TcpSink, smf::Sink, std::shared_ptr<smf::TcpSink>>(m, "TcpSink")
+        .def(py::init([](const std::string& host, std::uint16_t port, long long send_timeout_ms) {
+                 return std::make_shared<smf::TcpSink>(host, port, std::chrono::milliseconds(send_timeout_ms));
+             }),
+             py::arg("host"), py::arg("port"), py::arg("send_timeout_ms") = 2000);
+
+    py::class_<smf::Forwarder::Stats>(m, "ForwarderStats")
+        .def_readonly("submitted", &smf::Forwarder::Stats::submitted)
+        .def_readonly("batches_sent", &smf::Forwarder::Stats::batches_sent)
+        .def_readonly("bytes_sent", &smf::Forwarder::Stats::bytes_sent)
+        .def_readonly("send_failures", &smf::Forwarder::Stats::send_failures)
+        .def_readonly("spooled_batches", &smf::Forwarder::Stats::spooled_batches)
+        .def_readonly("dropped_batches", &smf::Forwarder::Stats::dropped_batches)
+        .def_readonly("queued_batches", &smf::Forwarder::Stats::queued_batches)
+        .def_readonly("spool_batches", &smf::Forwarder::Stats::spool_batches);
+
+    py::class_<smf::Forwarder>(m, "Forwarder")
+        .def(py::init([](std::shared_ptr<smf::Sink> sink, std::size_t batch_size, long long batch_delay_ms,
+                         std::size_t max_queued_batches, const std::string& spool_path, std::size_t spool_capacity,
+                         bool compress) {
+                 return new smf::Forwarder(std::move(sink), smf::Forwarder::Options(
+                     batch_size, std::chrono::milliseconds(batch_delay_ms), max_queued_batches, spool_path,
+                     spool_capacity, compress ? smf::Compression::Deflate : smf::Compression::None));
+             }),
+             py::arg("sink"), py::arg("batch_size") = 60, py::arg("batch_delay_ms") = 5000,
+             py::arg("max_queued_batches") = 64, py::arg("spool_path") = "", py::arg("spool_capacity") = 64u << 20,
+             py::arg("compress") = true)
+        .def("start", &smf::Forwarder::start, "Starts the sender thread.")
+        .def("stop", &smf::Forwarder::stop, "Stops the sender, spooling unsent batches.",
+             py::call_guard<py::gil_scoped_release>())
+        .def("submit", &smf::Forwarder::submit, "Adds a snapshot to the open batch.", py::arg("snapshot"))
+        .def("flush",
+             [](smf::Forwarder& self, long long timeout_ms) { return self.flush(std::chrono::milliseconds(timeout_ms)); },
+             "Sends everything pending; returns False on timeout.", py::arg("timeout_ms") = 5000,
+             py::call_guard<py::gil_scoped_release>())
+        .def("stats", &smf::Forwarder::stats)
+        .def_property_readonly("running", &smf::Forwarder::running);
+
+    m.def("decode_batch",
+        [](py::bytes batch) {
+            std::string_view view(batch);
+            std::vector<MetricsSnapshot> snapshots;
+            smf::decodeBatch(SystemMetricsCodec::ByteSpan(reinterpret_cast<const std::uint8_t*>(view.data()), view.size()),
+                             snapshots);
+            return snapshots;
+        },
+        "Decodes a forwarder batch into a list of snapshots.", py::arg("batch"));
+
+    // --- Shared-Memory Snapshot Bindings ---
+    py::class_<ShmPublisher, std::shared_ptr<ShmPublisher>>(m, "ShmPublisher")
+        .def(py::init<std::string, std::size_t, std::size_t>(),
+             py::arg("name") = SystemMetricsShm::kDefaultShmName, py::arg("max_disks") = 64, py::arg("max_nets") = 64)
+        .def("publish", &ShmPublisher::publish, "Publishes a snapshot as the latest one.", py::arg("snapshot"))
+        .def_property_readonly("publish_count", &ShmPublisher::publishCount)
+        .def_property_readonly("name", &ShmPublisher::name);
+
+    py::class_<ShmReader>(m, "ShmReader")
+        .def(py::init<std::string>(), py::arg("name") = SystemMetricsShm::kDefaultShmName)
+        .def("read",
+             [](const ShmReader& self) -> py::object {
+                 MetricsSnapshot snapshot;
+                 if (!self.read(snapshot)) return py::none();
+                 return py::cast(std::move(snapshot));
+             },
+             "Returns the latest published snapshot, or None if nothing is available.")
+        .def("read_if_changed",
+             [](const ShmReader& self, std::uint64_t last_sequence) -> py::tuple {
+                 MetricsSnapshot snapshot;
+                 if (!self.readIfChanged(snapshot, last_sequence)) return py::make_tuple(py::none(), last_sequence);
+                 return py::make_tuple(std::move(snapshot), last_sequence);
+             },
+             "Returns (snapshot, sequence) if something was published after `last_sequence`, else (None, last_sequence).",
+             py::arg("last_sequence"))
+        .def("reopen", &ShmReader::reopen, "Maps the region currently registered under the name.")
+        .def_property_readonly("sequence", &ShmReader::sequence)
+        .def_property_readonly("stale", &ShmReader::stale);
 }
@@ -0,0 +1,120 @@
+#ifndef BATCH_READER_HPP
+#define BATCH_READER_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace SystemProcFS {
+
+    /// @brief Mechanism a BatchFileReader uses for its reads.
+    enum class BatchBackend {
+        IoUring, ///< One io_uring submission per queue-depth chunk of files
+        Pread    ///< One pread per file on descriptors kept open between batches
+    };
+
+    /// @brief Counters for a BatchFileReader, for comparing backends.
+    struct BatchReaderStats {
+        std::uint64_t batches = 0;   ///< readAll() calls
+        std::uint64_t reads = 0;     ///< File reads completed, successfully or not
+        std::uint64_t failures = 0;  ///< Reads that failed
+        std::uint64_t syscalls = 0;  ///< open/pread/io_uring_enter/io_uring_register calls made directly
+                                     ///< (reads through a non-disk ProcFS source are not counted)
+        std::uint64_t overflows = 0; ///< Files larger than their slot, re-read in full with a plain read
+        std::uint64_t opens = 0;     ///< Files opened, when added or for a read past max_open_files
+        std::size_t open_files = 0;  ///< Descriptors held now
+    };
+
+    /// @brief Re-reads a fixed set of small /proc or /sys files every cycle with as few syscalls as possible.
+    /// Files are opened once when added and re-read from offset 0 by each readAll(), which the
+    /// kernel answers with fresh contents. On Linux with io_uring available, the descriptors and a
+    /// single slab of per-file slots are registered with the ring, and reads are submitted a
+    /// queue-depth at a time (one io_uring_enter per chunk); otherwise each file costs one pread.
+    /// io_uring cannot complete /proc reads inline and hands each one to a kernel worker thread,
+    /// which costs more than the pread it saves, so readers of /proc files use the pread backend.
+    /// Files can be removed as the set changes (e.g. processes exit); their indices are reused.
+    /// Paths are resolved through the active ProcFS source when added; files of sources without
+    /// an on-disk representation (e.g. VirtualProcSource) are read through ProcFS::readFile instead.
+    /// Not thread-safe: use one reader per collecting thread.
+    class BatchFileReader {
+    public:
+        struct Options {
+            std::size_t slot_size = 4096;  ///< Bytes reserved per file; larger files fall back to a plain read
+            unsigned queue_depth = 256;    ///< Reads in flight per io_uring submission
+            bool use_io_uring = true;      ///< false forces the pread backend
+            std::size_t max_open_files = static_cast<std::size_t>(-1); ///< Past this many descriptors, further
+                                                                       ///< files are opened and closed by each read
+        };
+
+        BatchFileReader();
+        explicit BatchFileReader(Options options);
+        ~BatchFileReader();
+
+        BatchFileReader(const BatchFileReader&) = delete;
+        BatchFileReader& operator=(const BatchFileReader&) = delete;
+
+        /// @brief Registers a file by logical path (e.g. "/proc/1234/stat").
+        /// A file that cannot be opened is still registered; each read tries to open it again.
+        /// @return The file's index, used with contents(), ok() and remove(); a removed file's index may be reused.
+        std::size_t add(std::string_view path);
+
+        /// @brief Closes file `index` and frees its index for a later add(). Other indices are unchanged.
+        /// @throws std::out_of_range if `index` is not a registered file.
+        void remove(std::size_t index);
+
+        /// @brief Number of registered files.
+        std::size_t size() const;
+
+        /// @brief Reads every registered file.
+        /// @return The number of files read successfully.
+        std::size_t readAll();
+
+        /// @brief Contents of file `index` from the last readAll(); empty if that read failed.
+        /// The view stays valid until the next readAll() or add().
+        /// @throws std::out_of_range if `index` is not a registered file.
+        std::string_view contents(std::size_t index) const;
+
+        /// @brief Whether file `index` was read successfully by the last readAll().
+        /// @throws std::out_of_range if `index` is not a registered file.
+        bool ok(std::size_t index) const;
+
+        BatchBackend backend() const;
+        BatchReaderStats stats() const;
+
+    private:
+        class Ring; // io_uring instance; defined in batch_reader.cpp
+
+        struct File {
+            std::string path;        // Logical path, for sources without on-disk files
+            std::string resolved;    // On-disk path; empty for sources without files
+            int fd = -1;             // Kept open between batches; -1 when read through the source
+            int registered = -1;     // Index in the ring's registered file table, -1 if not registered
+            std::size_t length = 0;  // Bytes read by the last batch
+            bool ok = false;
+            std::string overflow;    // Full contents of a file larger than its slot
+            bool used = false;       // false for a removed file whose index is free
+        };
+
+        void readSlot(File& file, std::size_t index);
+        void completeSlot(File& file, long result);
+        bool readWithRing();
+        const File& file(std::size_t index) const;
+
+        Options options_;
+        std::vector<File> files_;
+        std::vector<std::size_t> free_; // Indices of removed files
+        std::unique_ptr<char[]> slab_; // slot_size bytes per file
+        std::size_t slab_slots_ = 0;
+        std::unique_ptr<Ring> ring_;
+        bool ring_dirty_ = true; // Files or slab changed since they were registered with the ring
+        BatchReaderStats stats_;
+    };
+
+    const char* batchBackendName(BatchBackend backend);
+
+} // namespace SystemProcFS
+
+#endif // BATCH_READER_HPP
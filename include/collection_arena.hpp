@@ -0,0 +1,88 @@
+#ifndef COLLECTION_ARENA_HPP
+#define COLLECTION_ARENA_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <memory_resource>
+#include <optional>
+
+namespace SystemMetricsArena {
+
+    /// @brief Usage report for a CollectionArena, for sizing it.
+    struct ArenaStats {
+        std::size_t bytes_in_use = 0;           ///< Bytes handed out since the last reset()
+        std::size_t high_water_mark = 0;        ///< Largest bytes_in_use seen over the arena's lifetime
+        std::size_t capacity = 0;               ///< Size of the block reused by every cycle
+        std::uint64_t cycles = 0;               ///< Number of reset() calls
+        std::uint64_t upstream_allocations = 0; ///< Overflow blocks requested from the upstream resource
+    };
+
+    /// @brief Collection-scoped bump allocator, released wholesale after each cycle.
+    /// Containers built on resource() (e.g. FixedSnapshot) allocate by bumping a pointer in a
+    /// block owned by the arena, without touching the global heap or its locks. When a cycle
+    /// outgrows the block, overflow comes from the upstream resource and the next reset() grows
+    /// the block to the high-water mark, so a steady workload stops reaching upstream at all.
+    /// Not thread-safe: use one arena per collecting thread.
+    class CollectionArena {
+    public:
+        /// @param initial_capacity Size of the reusable block in bytes (0 selects a small default).
+        /// @param upstream Source of the block and of overflow allocations.
+        explicit CollectionArena(std::size_t initial_capacity = 64 * 1024,
+                                 std::pmr::memory_resource* upstream = std::pmr::new_delete_resource());
+        ~CollectionArena();
+
+        CollectionArena(const CollectionArena&) = delete;
+        CollectionArena& operator=(const CollectionArena&) = delete;
+
+        /// @brief The resource to build per-cycle containers on.
+        std::pmr::memory_resource* resource() { return &counter_; }
+
+        /// @brief Releases everything allocated since the previous reset.
+        /// Every container built on resource() must be destroyed or abandoned first.
+        void reset();
+
+        ArenaStats stats() const;
+
+    private:
+        // Counts what the collectors ask for, then forwards to the bump allocator.
+        class CountingResource : public std::pmr::memory_resource {
+        public:
+            explicit CountingResource(CollectionArena& arena) : arena_(arena) {}
+
+        private:
+            void* do_allocate(std::size_t bytes, std::size_t alignment) override;
+            void do_deallocate(void* p, std::size_t bytes, std::size_t alignment) override;
+            bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override;
+
+            CollectionArena& arena_;
+        };
+
+        // Counts the overflow blocks the bump allocator requests from upstream.
+        class UpstreamResource : public std::pmr::memory_resource {
+        public:
+            UpstreamResource(CollectionArena& arena, std::pmr::memory_resource* upstream)
+                : arena_(arena), upstream_(upstream) {}
+
+        private:
+            void* do_allocate(std::size_t bytes, std::size_t alignment) override;
+            void do_deallocate(void* p, std::size_t bytes, std::size_t alignment) override;
+            bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override;
+
+            CollectionArena& arena_;
+            std::pmr::memory_resource* upstream_;
+        };
+
+        void allocateBlock(std::size_t capacity);
+
+        std::pmr::memory_resource* upstream_;
+        UpstreamResource upstream_counter_;
+        CountingResource counter_;
+        void* block_ = nullptr;
+        std::size_t capacity_ = 0;
+        std::optional<std::pmr::monotonic_buffer_resource> monotonic_;
+        ArenaStats stats_;
+    };
+
+} // namespace SystemMetricsArena
+
+#endif // COLLECTION_ARENA_HPP
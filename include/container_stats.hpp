@@ -0,0 +1,140 @@
+#ifndef CONTAINER_STATS_HPP
+#define CONTAINER_STATS_HPP
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "fs_stats.hpp"
+
+namespace SystemContainerStats {
+
+    enum class CgroupVersion {
+        None, ///< No cgroup filesystem found for the process
+        V1,   ///< Per-controller hierarchies
+        V2    ///< The unified hierarchy
+    };
+
+    const char* cgroupVersionName(CgroupVersion version);
+
+    /// @brief Directories of the calling process's cgroup, one per controller used.
+    /// Under v2 they are all the same directory.
+    struct CgroupPaths {
+        CgroupVersion version = CgroupVersion::None;
+        std::string cpu;     ///< CPU quota and throttling
+        std::string cpuacct; ///< CPU usage
+        std::string cpuset;  ///< Allowed CPUs
+        std::string memory;  ///< Memory limit and usage
+    };
+
+    /// @brief Locates the cgroup of the calling process.
+    class CgroupResolver {
+    public:
+        /// @brief Resolves the controllers from /proc/self/cgroup text and the mount table.
+        /// A controller mounted as a v1 hierarchy wins over the unified hierarchy (hybrid hosts
+        /// mount cgroup2 without controllers); the v2 "0::" entry is used otherwise.
+        /// @throws std::runtime_error if a /proc/self/cgroup line is malformed.
+        static CgroupPaths parse(std::string_view proc_self_cgroup, const std::vector<SystemDiskStats::MountEntry>& mounts);
+
+        /// @brief Reads /proc/self/cgroup and /proc/self/mountinfo through the active ProcFS source.
+        /// @throws std::runtime_error if either file cannot be read or parsed.
+        static CgroupPaths resolve();
+
+    private:
+        CgroupResolver() = delete;
+    };
+
+    /// @brief Limits of the cgroup, resolved against the host where the cgroup sets none.
+    struct CgroupLimits {
+        double cpu_cores = 0.0;            ///< Smallest of quota / period, cpuset size and host CPUs
+        bool cpu_quota = false;            ///< A CFS quota is set (cpu.max or cpu.cfs_quota_us)
+        std::uint64_t cpu_quota_us = 0;
+        std::uint64_t cpu_period_us = 0;
+        unsigned cpuset_cpus = 0;          ///< CPUs the cgroup may run on
+        unsigned host_cpus = 0;
+        std::uint64_t memory_bytes = 0;    ///< memory.max / memory.limit_in_bytes, or host memory if unlimited
+        bool memory_limited = false;
+        std::uint64_t host_memory_bytes = 0;
+    };
+
+    /// @brief Cumulative cgroup-local counters and current usage.
+    struct CgroupCounters {
+        std::uint64_t cpu_usage_ns = 0;
+        std::uint64_t periods = 0;            ///< CFS enforcement periods that had runnable tasks
+        std::uint64_t throttled_periods = 0;  ///< ... in which the cgroup hit its quota
+        std::uint64_t throttled_ns = 0;       ///< Time spent throttled
+        std::uint64_t memory_usage_bytes = 0; ///< Including page cache
+        std::uint64_t memory_inactive_file_bytes = 0;
+
+        /// @brief Usage minus inactive page cache, the figure the OOM killer and kubelet look at.
+        std::uint64_t memoryWorkingSetBytes() const {
+            return memory_usage_bytes > memory_inactive_file_bytes ? memory_usage_bytes - memory_inactive_file_bytes : 0;
+        }
+    };
+
+    /// @brief Usage relative to the cgroup's limits over an interval.
+    struct ContainerUsage {
+        double elapsed_seconds = 0.0;
+        double cpu_cores = 0.0;              ///< CPUs kept busy on average
+        double cpu_percent = 0.0;            ///< cpu_cores / limit cpu_cores, in percent
+        double throttled_percent = 0.0;      ///< Share of enforcement periods that were throttled
+        double throttled_seconds = 0.0;      ///< Throttled time per second
+        std::uint64_t memory_working_set_bytes = 0;
+        double memory_percent = 0.0;         ///< Working set / limit memory_bytes, in percent
+    };
+
+    /// @brief Reports CPU and memory use relative to the quota and limit of the agent's own cgroup,
+    /// where CPUStatsReader and MeMStatsReader report the whole host. The cgroup is located once;
+    /// /proc/self/cgroup and the limit files are re-read every `limits_refresh` and re-parsed only
+    /// when their contents changed, so most samples read just the usage counters. Not thread-safe.
+    class ContainerCollector {
+    public:
+        using Clock = std::chrono::steady_clock;
+
+        struct Options {
+            std::chrono::milliseconds limits_refresh{10000};
+        };
+
+        ContainerCollector();
+        explicit ContainerCollector(Options options);
+
+        /// @brief Reads the usage counters now, and the limits if they are due. From the second
+        /// sample on, usage() covers the interval since the previous sample.
+        /// @throws std::runtime_error if no cgroup is found or a cgroup file cannot be read or parsed.
+        void sample();
+        void sample(Clock::time_point now);
+
+        const CgroupPaths& paths() const { return paths_; }
+        const CgroupLimits& limits() const { return limits_; }
+        const CgroupCounters& current() const { return current_; }
+        bool hasRates() const { return samples_ >= 2; }
+        const ContainerUsage& usage() const { return usage_; }
+
+        /// @brief How many times the limits were parsed (the first sample and every change since).
+        std::uint64_t limitReads() const { return limit_reads_; }
+
+    private:
+        void refreshLimits(Clock::time_point now);
+        void readCounters(CgroupCounters& out);
+
+        Options options_;
+        CgroupPaths paths_;
+        CgroupLimits limits_;
+        std::string cgroup_text_; // /proc/self/cgroup as of the last resolve
+        std::string limits_text_; // Raw limit files as of the last parse
+        std::string scratch_;
+        std::string buffer_;
+        CgroupCounters current_;
+        CgroupCounters previous_;
+        ContainerUsage usage_;
+        Clock::time_point limits_time_{};
+        Clock::time_point last_time_{};
+        std::uint64_t limit_reads_ = 0;
+        std::uint64_t samples_ = 0;
+    };
+
+} // namespace SystemContainerStats
+
+#endif // CONTAINER_STATS_HPP
@@ -2,9 +2,11 @@
 #define SYSTEM_CPU_STATS_H
 
 #include <string>      // For std::string
+#include <string_view> // For the /proc/loadavg parser
 #include <vector>      // For std::vector (if needed in future, currently not directly used)
 #include <stdexcept>   // For standard exceptions like std::runtime_error
 #include <istream>     // For std::istream in the overloaded getCPUStats
+#include <cstdint>     // For std::uint64_t counters
 
 namespace SystemCPUStats {
 struct CPUStats {
@@ -50,6 +52,119 @@ struct CPUStats {
 /// @note This function requires the caller to manage the previous state and time delta.
 double calculateUsagePercentage(const CPUStats& curr, const CPUStats& prev, long long time_delta_ms);
 
+/// @brief Exact per-mode CPU time counters, in the platform's clock ticks (see ticksPerSecond()).
+/// On Linux these are the /proc/stat columns in USER_HZ; `guest` and `guest_nice` are already
+/// included in `user` and `nice` there, so total() leaves them out.
+struct CPUCounters {
+    std::uint64_t user = 0;
+    std::uint64_t nice = 0;
+    std::uint64_t system = 0;
+    std::uint64_t idle = 0;
+    std::uint64_t iowait = 0;
+    std::uint64_t irq = 0;
+    std::uint64_t softirq = 0;
+    std::uint64_t steal = 0;
+    std::uint64_t guest = 0;
+    std::uint64_t guest_nice = 0;
+
+    /// @brief Sum of every mode, counting guest time once (as part of user and nice).
+    std::uint64_t total() const {
+        return user + nice + system + idle + iowait + irq + softirq + steal;
+    }
+};
+
+/// @brief Counters of one online CPU.
+struct CPUCoreCounters {
+    unsigned cpu = 0;     ///< CPU number (the N in "cpuN")
+    CPUCounters counters;
+};
+
+/// @brief System-wide scheduler activity from the lines of /proc/stat after the CPU lines.
+/// All zero on platforms other than Linux.
+struct SystemActivity {
+    std::uint64_t context_switches = 0; ///< "ctxt": context switches since boot
+    std::uint64_t forks = 0;            ///< "processes": processes and threads created since boot
+    std::uint64_t procs_running = 0;    ///< Tasks currently runnable
+    std::uint64_t procs_blocked = 0;    ///< Tasks currently blocked on I/O
+    std::uint64_t boot_time = 0;        ///< "btime": boot time in seconds since the Unix epoch
+};
+
+/// @brief One reading of the aggregate and per-CPU counters, taken in a single pass.
+struct CPUCounterSample {
+    CPUCounters aggregate;
+    std::vector<CPUCoreCounters> cpus; ///< Online CPUs, in the order the kernel lists them
+    SystemActivity activity;           ///< From the same read of /proc/stat
+};
+
+/// @brief Context-switch and fork rates between two readings, per second.
+struct ActivityRates {
+    double context_switches = 0.0;
+    double forks = 0.0;
+    double elapsed_seconds = 0.0;
+};
+
+/// @brief Load averages and task counts from /proc/loadavg.
+struct LoadAverage {
+    double one = 0.0;           ///< Over 1 minute
+    double five = 0.0;          ///< Over 5 minutes
+    double fifteen = 0.0;       ///< Over 15 minutes
+    std::uint64_t runnable = 0; ///< Tasks currently runnable (0 where the platform does not report it)
+    std::uint64_t tasks = 0;    ///< Tasks in the system (0 where the platform does not report it)
+    std::uint64_t last_pid = 0; ///< Most recently assigned pid (0 where the platform does not report it)
+};
+
+/// @brief Share of elapsed CPU time spent in each mode over an interval, in percent.
+struct CPUUtilization {
+    double user = 0.0;       ///< Includes guest
+    double nice = 0.0;       ///< Includes guest_nice
+    double system = 0.0;
+    double idle = 0.0;
+    double iowait = 0.0;
+    double irq = 0.0;
+    double softirq = 0.0;
+    double steal = 0.0;
+    double guest = 0.0;
+    double guest_nice = 0.0;
+    double busy = 0.0;             ///< Everything except idle and iowait
+    double elapsed_seconds = 0.0;  ///< CPU time covered by the interval (summed over CPUs)
+};
+
+/// @brief Per-CPU utilization, for CPUs present in both samples.
+struct CPUCoreUtilization {
+    unsigned cpu = 0;
+    CPUUtilization utilization;
+};
+
+/// @brief Clock ticks per second of CPUCounters: sysconf(_SC_CLK_TCK) (USER_HZ) on Linux and
+/// macOS, 10,000,000 (100 ns units) on Windows.
+std::uint64_t ticksPerSecond();
+
+/// @brief Converts CPU counter ticks to seconds. See ticksPerSecond().
+double ticksToSeconds(std::uint64_t ticks);
+
+/// @brief Increase of one counter between two readings.
+/// A counter that went backwards is treated as having wrapped if its previous value sat in the
+/// top half of the 32-bit range (a 32-bit kernel or hypervisor counter), and otherwise as reset
+/// (e.g. iowait stepping back, or a CPU's idle time restarting after it comes back online), which
+/// contributes 0.
+std::uint64_t counterDelta(std::uint64_t previous, std::uint64_t current);
+
+/// @brief Per-mode utilization between two readings of the same CPU (or of the aggregate).
+/// The percentages are computed from per-mode deltas in one pass and sum to 100 (guest modes
+/// aside, which are part of user and nice). All zero if no time elapsed.
+CPUUtilization computeUtilization(const CPUCounters& previous, const CPUCounters& current);
+
+/// @brief Per-CPU utilization between two samples, matched by CPU number.
+/// CPUs that went offline or came online between the samples (present in only one) are skipped.
+std::vector<CPUCoreUtilization> computeUtilization(const CPUCounterSample& previous, const CPUCounterSample& current);
+
+/// @brief Context-switch and fork rates between two readings taken `elapsed_seconds` apart.
+/// All zero if no time elapsed.
+ActivityRates computeActivityRates(const SystemActivity& previous, const SystemActivity& current, double elapsed_seconds);
+
+/// @brief Converts counters to the legacy floating-point CPUStats (`usage_percent` 0.0).
+CPUStats toCPUStats(const CPUCounters& counters);
+
 // ---
 
 /// @brief Utility class for reading system CPU statistics.
@@ -72,6 +187,35 @@ public:
     /// @throws std::runtime_error if the data from the stream cannot be parsed correctly.
     static CPUStats getCPUStats(std::istream& input);
 
+    /// @brief Allocation-free variant of getCPUStats() for repeated sampling.
+    /// @param out Receives the aggregate CPU times (`usage_percent` is set to 0.0).
+    /// @param buffer Scratch space for the file contents, reused across calls.
+    /// @throws std::runtime_error if the CPU statistics cannot be read or parsed.
+    static void getCPUStats(CPUStats& out, std::string& buffer);
+
+    /// @brief Reads the aggregate and per-CPU counters as exact integers.
+    /// @return The sample; `cpus` is empty on platforms without per-CPU counters (Windows).
+    /// @throws std::runtime_error if the CPU counters cannot be read or parsed.
+    static CPUCounterSample getCPUCounters();
+
+    /// @brief Allocation-free variant of getCPUCounters() for repeated sampling.
+    /// @param out Receives the sample; the capacity of `out.cpus` is reused across calls.
+    /// @param buffer Scratch space for the file contents, reused across calls.
+    /// @throws std::runtime_error if the CPU counters cannot be read or parsed.
+    static void getCPUCounters(CPUCounterSample& out, std::string& buffer);
+
+    /// @brief Reads the load averages and task counts (/proc/loadavg on Linux, getloadavg() on macOS).
+    /// @throws std::runtime_error if they cannot be read or parsed, or on other platforms.
+    static LoadAverage getLoadAverage();
+
+    /// @brief Allocation-free variant of getLoadAverage() for repeated sampling.
+    /// @param buffer Scratch space for the file contents, reused across calls.
+    static void getLoadAverage(LoadAverage& out, std::string& buffer);
+
+    /// @brief Parses /proc/loadavg ("0.52 0.58 0.59 2/1234 56789").
+    /// @throws std::runtime_error if the text is malformed.
+    static LoadAverage parseLoadAverage(std::string_view text);
+
 private:
     // Prevent instantiation of this utility class.
     CPUStatsReader() = delete;
@@ -81,18 +225,22 @@ private:
     CPUStatsReader(const CPUStatsReader&) = delete;
     CPUStatsReader& operator=(const CPUStatsReader&) = delete;
 
-    // Platform-specific raw CPUStats retrieval functions
+    // Platform-specific raw counter retrieval functions
 #if defined(_WIN32)
-    static CPUStats getRawWindowsCpuStats();
+    static void getRawWindowsCpuCounters(CPUCounterSample& out);
 #elif defined(__linux__)
-    static CPUStats getRawLinuxCpuStats();
+    static void getRawLinuxCpuCounters(CPUCounterSample& out, std::string& buffer);
 #elif defined(__APPLE__)
-    static CPUStats getRawMacCpuStats();
+    static void getRawMacCpuCounters(CPUCounterSample& out);
 #else
     // Fallback for unsupported platforms if no specific implementation is defined
-    static CPUStats getRawUnsupportedCpuStats();
+    static void getRawUnsupportedCpuCounters(CPUCounterSample& out);
 #endif
 
+    /// @brief Stores a "ctxt", "btime", "processes", "procs_running" or "procs_blocked" line of
+    /// /proc/stat in `out`; other lines are ignored.
+    static void parseActivityLine(std::string_view line, SystemActivity& out);
+
     /// @brief Helper function to parse a /proc/stat-like line.
     /// This function is private as it's an internal detail of how data is read from streams.
     static CPUStats parseProcStatLine(std::istream& input_stream);
@@ -1,11 +1,17 @@
 #ifndef DISK_STATS_HPP
 #define DISK_STATS_HPP
 
+#include <chrono>
 #include <string>
+#include <string_view>
 #include <map>
+#include <memory_resource>
 #include <vector>
 #include <utility> // For std::move
 
+#include "name_index.hpp"
+#include "read_cache.hpp"
+
 namespace SystemDiskStats {
     // Structure to hold disk I/O statistics for a single device.
     struct DiskStats {
@@ -20,6 +26,20 @@ namespace SystemDiskStats {
                   unsigned long long rt = 0, unsigned long long wt = 0)
             : device(std::move(dev)), read_bytes(rb), write_bytes(wb), read_time_ms(rt), write_time_ms(wt) {}
     };
+
+    /// @brief Trivially copyable counterpart of DiskStats, keyed by an interned device name.
+    /// Used by the allocation-free collection path (see DiskStatsReader::getAllDiskRecords()).
+    struct DiskRecord {
+        SystemMetricsIndex::NameId device = SystemMetricsIndex::kNoName; ///< Interned device name
+        unsigned long long read_bytes = 0;
+        unsigned long long write_bytes = 0;
+        unsigned long long read_time_ms = 0;
+        unsigned long long write_time_ms = 0;
+    };
+
+    /// @brief Expands a record back into a DiskStats, looking up its interned name.
+    DiskStats toDiskStats(const DiskRecord& record);
+
     // Class to read and provide disk statistics from the system.
     class DiskStatsReader {
     public:
@@ -31,9 +51,37 @@ namespace SystemDiskStats {
         /// @return A DiskStats object for the specified device.
         /// @throws std::runtime_error if the device is not found or data cannot be read.
         static DiskStats getDiskStats(const std::string& device_name);
+        /// @brief Retrieves statistics for several devices from a single read.
+        /// @param device_names The devices to look up; duplicates are collapsed.
+        /// @return The requested devices that were found, keyed by name. Missing devices are omitted.
+        /// @throws std::runtime_error if the data cannot be read.
+        static std::map<std::string, DiskStats> getDiskStatsForDevices(const std::vector<std::string>& device_names);
+        /// @brief Retrieves per-device statistics for all physical devices.
+        /// @return One DiskStats entry per physical device, in the order reported by the system.
+        /// @throws std::runtime_error if the data cannot be read.
+        static std::vector<DiskStats> getAllDiskStats();
+        /// @brief Sets how long one parse of the device list is shared by later callers.
+        /// Concurrent callers always share a single in-flight read; the default of 0 adds no staleness.
+        static void setCacheMaxAge(std::chrono::milliseconds max_age);
+        /// @brief Returns the load/hit/coalesce counters of the device-list cache.
+        static SystemProcFS::CacheStats cacheStats();
+        /// @brief Forces the next call to re-read the device list.
+        static void invalidateCache();
         /// @brief Helper to parse a line from /proc/diskstats
         /// @returns  the relevant fields to populate a DiskStats object.
         static DiskStats parseDiskStatLine(const std::string& line);
+        /// @brief Allocation-free parse of a /proc/diskstats line. Fills every field of `record` except `device`.
+        /// @param device Receives the device name as a view into `line`.
+        /// @return false if the line has fewer than 14 fields or a non-numeric counter.
+        static bool parseDiskStatLine(std::string_view line, std::string_view& device, DiskRecord& record);
+        /// @brief Returns true for whole physical drives; partitions and loop, ram, dm- and zd devices are excluded.
+        static bool isPhysicalDevice(std::string_view device_name);
+        /// @brief Reads one record per physical device into `out`, bypassing the read cache.
+        /// On Linux this performs no heap allocation once `out` and `buffer` have grown to fit the host.
+        /// @param out Receives the records; it allocates from its own memory resource (e.g. a CollectionArena).
+        /// @param buffer Scratch space for the file contents, reused across calls.
+        /// @throws std::runtime_error if the data cannot be read.
+        static void getAllDiskRecords(std::pmr::vector<DiskRecord>& out, std::string& buffer);
 #if defined(__WIN32__) || defined(__WIN64__)
         /// @brief Windows-specific implementation to retrieve disk statistics.
         /// @return A DiskStats object containing the disk statistics for Windows.
@@ -0,0 +1,224 @@
+#ifndef FORWARDER_HPP
+#define FORWARDER_HPP
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "metrics_snapshot.hpp"
+#include "ring_log.hpp"
+#include "snapshot_codec.hpp"
+
+namespace SystemMetricsForwarder {
+
+    /// @brief Batch payload compression.
+    enum class Compression : std::uint8_t {
+        None = 0,
+        Deflate = 1 ///< zlib deflate; only available when built with zlib
+    };
+
+    // Batch layout:
+    //   'M' 'B' version:u8 compression:u8 snapshot_count:varint raw_size:varint body
+    // The body (compressed as a whole) is a sequence of SnapshotCodec frames starting with a
+    // keyframe, so every batch decodes on its own.
+
+    /// @brief Decodes a batch produced by Forwarder.
+    /// @param batch Encoded batch.
+    /// @param out Receives the snapshots in submission order (appended).
+    /// @return Number of snapshots decoded.
+    /// @throws std::runtime_error on malformed input or an unsupported compression.
+    std::size_t decodeBatch(SystemMetricsCodec::ByteSpan batch, std::vector<SystemMetricsSnapshot::MetricsSnapshot>& out);
+
+    /// @brief Destination for encoded batches.
+    class Sink {
+    public:
+        virtual ~Sink() = default;
+
+        /// @brief Delivers one batch.
+        /// @throws std::runtime_error if the batch could not be delivered; the forwarder retries later.
+        virtual void send(SystemMetricsCodec::ByteSpan batch) = 0;
+
+        /// @brief Human-readable destination used in log messages.
+        virtual std::string describe() const = 0;
+    };
+
+    /// @brief Appends batches to a file, each prefixed with its length as a 4-byte big-endian integer.
+    class FileSink : public Sink {
+    public:
+        /// @throws std::runtime_error if the file cannot be opened.
+        explicit FileSink(const std::string& path);
+        ~FileSink() override;
+
+        void send(SystemMetricsCodec::ByteSpan batch) override;
+        std::string describe() const override { return "file:" + path_; }
+
+    private:
+        std::string path_;
+        int fd_ = -1;
+    };
+
+    /// @brief Base for connection-oriented sinks. Batches are length-prefixed like FileSink.
+    /// The connection is opened lazily and re-established after any failure.
+    class StreamSink : public Sink {
+    public:
+        ~StreamSink() override;
+
+        void send(SystemMetricsCodec::ByteSpan batch) override;
+
+    protected:
+        /// @param send_timeout Writes that stall longer than this fail, letting the forwarder spool.
+        explicit StreamSink(std::chrono::milliseconds send_timeout);
+
+        /// @brief Opens a connected socket.
+        /// @throws std::runtime_error on failure.
+        virtual int connectSocket() = 0;
+
+        std::chrono::milliseconds send_timeout_;
+
+    private:
+        void closeSocket();
+
+        int fd_ = -1;
+    };
+
+    /// @brief Sends batches over a Unix domain stream socket.
+    class UnixSocketSink : public StreamSink {
+    public:
+        explicit UnixSocketSink(std::string path, std::chrono::milliseconds send_timeout = std::chrono::milliseconds(2000));
+        std::string describe() const override { return "unix:" + path_; }
+
+    protected:
+        int connectSocket() override;
+
+    private:
+        std::string path_;
+    };
+
+    /// @brief Sends batches over TCP.
+    class TcpSink : public StreamSink {
+    public:
+        TcpSink(std::string host, std::uint16_t port, std::chrono::milliseconds send_timeout = std::chrono::milliseconds(2000));
+        std::string describe() const override { return "tcp:" + host_ + ":" + std::to_string(port_); }
+
+    protected:
+        int connectSocket() override;
+
+    private:
+        std::string host_;
+        std::uint16_t port_;
+    };
+
+    /// @brief Batches snapshots, compresses them and ships them to a sink from a background thread.
+    ///
+    /// Memory is bounded by Options::max_queued_batches. When the queue is full the oldest batch
+    /// moves to the on-disk spool (if configured) or is dropped; submit() never blocks. Spooled
+    /// batches are older than anything in memory and are sent first, so ordering is preserved; a
+    /// batch in flight when the queue overflows is spooled first, ahead of the batches it displaces.
+    class Forwarder {
+    public:
+        struct Options {
+            std::size_t max_batch_snapshots;             ///< Seal a batch after this many snapshots
+            std::chrono::milliseconds max_batch_delay;   ///< ... or when its first snapshot is this old
+            std::size_t max_queued_batches;              ///< In-memory queue bound
+            std::string spool_path;                      ///< RingLog file for overflow; empty disables spooling
+            std::size_t spool_capacity;                  ///< Spool data region size for new files
+            Compression compression;
+            int compression_level;                       ///< zlib level (1 = fastest)
+            std::chrono::milliseconds max_retry_backoff; ///< Upper bound for the exponential retry delay
+
+            Options(std::size_t batch_snapshots = 60,
+                    std::chrono::milliseconds batch_delay = std::chrono::milliseconds(5000),
+                    std::size_t queued_batches = 64,
+                    std::string spool = std::string(),
+                    std::size_t spool_bytes = 64u << 20,
+                    Compression comp = Compression::Deflate,
+                    int level = 1,
+                    std::chrono::milliseconds retry_backoff = std::chrono::milliseconds(5000))
+                : max_batch_snapshots(batch_snapshots), max_batch_delay(batch_delay),
+                  max_queued_batches(queued_batches), spool_path(std::move(spool)), spool_capacity(spool_bytes),
+                  compression(comp), compression_level(level), max_retry_backoff(retry_backoff) {}
+        };
+
+        struct Stats {
+            std::uint64_t submitted = 0;       ///< Snapshots accepted by submit()
+            std::uint64_t batches_sent = 0;    ///< Batches delivered to the sink
+            std::uint64_t bytes_sent = 0;      ///< Encoded bytes delivered
+            std::uint64_t send_failures = 0;   ///< Failed delivery attempts
+            std::uint64_t spooled_batches = 0; ///< Batches moved to the spool
+            std::uint64_t dropped_batches = 0; ///< Batches lost to the drop-oldest policy
+            std::size_t queued_batches = 0;    ///< Batches currently held in memory
+            std::size_t spool_batches = 0;     ///< Batches currently held in the spool
+        };
+
+        /// @throws std::invalid_argument if sink is null or a size limit is 0.
+        /// @throws std::runtime_error if the spool cannot be opened.
+        explicit Forwarder(std::shared_ptr<Sink> sink, Options options = Options());
+        ~Forwarder();
+
+        Forwarder(const Forwarder&) = delete;
+        Forwarder& operator=(const Forwarder&) = delete;
+
+        /// @brief Starts the sender thread.
+        /// @throws std::logic_error if already running.
+        void start();
+
+        /// @brief Seals the open batch, stops the sender and moves unsent batches to the spool
+        /// (when configured). Safe to call more than once.
+        void stop();
+
+        /// @brief Returns true between start() and stop().
+        bool running() const;
+
+        /// @brief Adds a snapshot to the open batch. Never blocks on the sink.
+        void submit(const SystemMetricsSnapshot::MetricsSnapshot& snapshot);
+
+        /// @brief Seals the open batch and waits until everything queued or spooled has been sent.
+        /// @return true if the pipeline drained within `timeout`.
+        bool flush(std::chrono::milliseconds timeout);
+
+        /// @brief Returns a copy of the counters.
+        Stats stats() const;
+
+    private:
+        using Batch = std::vector<std::uint8_t>;
+
+        void sealLocked();
+        void enqueueLocked(Batch batch);
+        void spillLocked();
+        void senderLoop();
+        bool sendOne(std::unique_lock<std::mutex>& lock);
+
+        std::shared_ptr<Sink> sink_;
+        Options options_;
+        std::unique_ptr<SystemMetricsHistory::RingLog> spool_;
+
+        mutable std::mutex mutex_;
+        std::condition_variable work_cv_;     // Wakes the sender
+        std::condition_variable drained_cv_;  // Wakes flush()
+        bool running_ = false;
+        bool stopping_ = false;
+        bool sending_ = false;                // A batch is in flight outside the lock
+        bool inflight_queued_ = false;        // ... and it was taken from the queue
+        bool inflight_spooled_ = false;       // ... and a spill has already copied it to the spool
+        std::uint64_t inflight_seq_ = 0;      // Its spool sequence when inflight_spooled_
+        const Batch* inflight_ = nullptr;     // The batch in flight when inflight_queued_
+
+        SystemMetricsCodec::SnapshotEncoder encoder_;
+        Batch open_raw_;                      // Codec frames of the open batch
+        std::size_t open_count_ = 0;
+        std::chrono::steady_clock::time_point open_since_;
+        std::deque<Batch> queue_;
+        Stats stats_;
+        std::thread sender_;
+    };
+
+} // namespace SystemMetricsForwarder
+
+#endif // FORWARDER_HPP
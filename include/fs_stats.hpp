@@ -0,0 +1,136 @@
+#ifndef FS_STATS_HPP
+#define FS_STATS_HPP
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace SystemDiskStats {
+
+    /// @brief One line of /proc/self/mountinfo.
+    struct MountEntry {
+        std::uint32_t mount_id = 0;
+        std::uint32_t major = 0;   ///< Device number of the filesystem (0 for most virtual filesystems)
+        std::uint32_t minor = 0;
+        std::string root;          ///< Directory of the filesystem mounted here (not "/" for bind mounts)
+        std::string mount_point;   ///< Octal escapes ("\040" for a space) decoded
+        std::string fs_type;       ///< e.g. "ext4", "nfs4", "tmpfs"
+        std::string source;        ///< e.g. "/dev/sda1", "server:/export"
+        bool read_only = false;    ///< Mounted "ro"
+        std::string super_options; ///< Filesystem options, e.g. "rw,cpu,cpuacct" for a cgroup v1 hierarchy
+    };
+
+    /// @brief Parser for the /proc/<pid>/mountinfo format.
+    class MountInfoReader {
+    public:
+        /// @brief Parses every line into `out`, reusing its storage.
+        /// @throws std::runtime_error if a line lacks the "-" separator or a mandatory field.
+        static void parse(std::string_view text, std::vector<MountEntry>& out);
+
+        /// @brief Whether a filesystem type never holds user data (proc, sysfs, cgroup, devpts, ...).
+        /// tmpfs and overlay are real capacity and are not pseudo filesystems.
+        static bool isPseudoFilesystem(std::string_view fs_type);
+
+    private:
+        MountInfoReader() = delete;
+    };
+
+    /// @brief Outcome of the last capacity query of a mount.
+    enum class FilesystemStatus {
+        Ok,
+        Failed,   ///< statvfs returned an error (e.g. permission denied)
+        TimedOut  ///< No answer within the collector's timeout; sizes are from the last successful query
+    };
+
+    const char* filesystemStatusName(FilesystemStatus status);
+
+    /// @brief Capacity of one mounted filesystem.
+    struct FilesystemUsage {
+        std::string mount_point;
+        std::string fs_type;
+        std::string source;
+        bool read_only = false;
+        FilesystemStatus status = FilesystemStatus::Ok;
+        std::uint64_t size_bytes = 0;
+        std::uint64_t free_bytes = 0;      ///< Free, including blocks reserved for root
+        std::uint64_t available_bytes = 0; ///< Free to unprivileged users
+        std::uint64_t used_bytes = 0;
+        std::uint64_t inodes = 0;
+        std::uint64_t inodes_free = 0;
+
+        /// @brief Used space as df reports it: used / (used + available), in percent. 0 for an empty filesystem.
+        double usedPercent() const;
+    };
+
+    /// @brief Reports the capacity of every real mounted filesystem.
+    ///
+    /// /proc/self/mountinfo is parsed once and re-read only when poll() reports POLLPRI on a
+    /// descriptor kept open on it, which the kernel raises whenever the mount table changes. Pseudo
+    /// filesystems and further mounts of an already listed device (bind mounts) are skipped. The
+    /// remaining mounts are queried with statvfs on a pool of worker threads, and collect() waits
+    /// at most Options::timeout for them: a mount that does not answer in time (a hung NFS server)
+    /// is reported as TimedOut with its last known sizes, and is not queried again until the
+    /// pending call returns, so a hung mount ties up at most one worker. Workers are detached; the
+    /// destructor never waits for one stuck in the kernel.
+    ///
+    /// With a replayed ProcFS source (fixtures) the mount table is read through the source on every
+    /// collect() and re-parsed when it changes; mount points are still queried on the live host.
+    /// Not thread-safe.
+    class FilesystemCollector {
+    public:
+        /// @brief Fills the size fields of `usage` for `mount_point`; returns false on failure.
+        using StatFunction = std::function<bool(const std::string& mount_point, FilesystemUsage& usage)>;
+
+        struct Options {
+            std::chrono::milliseconds timeout{1000}; ///< Longest collect() waits for capacity queries
+            std::size_t threads = 8;                 ///< Concurrent queries, not counting hung ones
+            bool include_pseudo = false;             ///< Keep pseudo filesystems
+            StatFunction stat;                       ///< Empty: statvfs(). Replaceable for tests.
+        };
+
+        FilesystemCollector();
+        explicit FilesystemCollector(Options options);
+        ~FilesystemCollector();
+
+        FilesystemCollector(const FilesystemCollector&) = delete;
+        FilesystemCollector& operator=(const FilesystemCollector&) = delete;
+
+        /// @brief Queries every mount into `out`, in mount table order, reusing its storage.
+        /// Returns after at most about Options::timeout.
+        /// @throws std::runtime_error if the mount table cannot be read or parsed.
+        void collect(std::vector<FilesystemUsage>& out);
+
+        std::vector<FilesystemUsage> collect();
+
+        /// @brief Mounts queried by collect(), after filtering.
+        const std::vector<MountEntry>& mounts() const { return mounts_; }
+
+        /// @brief How many times the mount table was parsed.
+        std::uint64_t mountTableReads() const { return mount_table_reads_; }
+
+    private:
+        struct Pool;
+        struct Query;
+
+        void refreshMounts();
+        void applyMountTable();
+
+        Options options_;
+        std::shared_ptr<Pool> pool_;               // Shared with the worker threads
+        std::vector<MountEntry> mounts_;
+        std::vector<std::shared_ptr<Query>> queries_; // One per entry of mounts_
+        std::vector<MountEntry> parsed_;
+        std::string text_;
+        int fd_ = -1;                              // Open on /proc/self/mountinfo for the live host
+        bool loaded_ = false;
+        std::uint64_t mount_table_reads_ = 0;
+    };
+
+} // namespace SystemDiskStats
+
+#endif // FS_STATS_HPP
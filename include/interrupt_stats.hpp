@@ -0,0 +1,134 @@
+#ifndef INTERRUPT_STATS_HPP
+#define INTERRUPT_STATS_HPP
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace SystemInterruptStats {
+
+    /// @brief Which per-CPU interrupt table to read.
+    enum class InterruptTable {
+        Hardware, ///< /proc/interrupts: IRQ lines and architecture counters (NMI, LOC, ...)
+        Soft      ///< /proc/softirqs: softirq vectors (NET_RX, TIMER, ...)
+    };
+
+    /// @brief Path of a table's /proc file ("/proc/interrupts" or "/proc/softirqs").
+    const char* tablePath(InterruptTable table);
+
+    /// @brief One reading of a per-CPU interrupt table as a dense row-major matrix.
+    /// Rows are the table's lines (IRQs or softirq vectors), columns its online CPUs. Parsing
+    /// into an existing matrix reuses its storage, so repeated samples do not allocate once the
+    /// layout is stable.
+    struct InterruptMatrix {
+        std::vector<unsigned> cpus;            ///< CPU number of each column, from the header line
+        std::vector<std::string> names;        ///< Row labels without the colon ("24", "NMI", "NET_RX")
+        std::vector<std::string> descriptions; ///< Text after the counters (chip, hwirq, handlers); empty for softirqs
+        std::vector<std::uint64_t> counts;     ///< rows() x columns() counters, row-major
+
+        std::size_t rows() const { return names.size(); }
+        std::size_t columns() const { return cpus.size(); }
+
+        /// @brief Counters of row `row`, one per column.
+        const std::uint64_t* row(std::size_t row) const { return counts.data() + row * cpus.size(); }
+
+        std::uint64_t at(std::size_t row, std::size_t column) const { return counts[row * cpus.size() + column]; }
+
+        /// @brief Index of the row labelled `name`, or -1.
+        long find(std::string_view name) const;
+    };
+
+    /// @brief Interrupt rates between two readings of the same table, laid out like the current one.
+    struct InterruptRates {
+        double elapsed_seconds = 0.0;
+        std::size_t columns = 0;
+        std::vector<std::uint64_t> deltas; ///< Per-IRQ, per-CPU increase over the interval (row-major)
+        std::vector<double> per_irq;       ///< Interrupts per second of each row, summed over CPUs
+        std::vector<double> per_cpu;       ///< Interrupts per second of each column, summed over rows
+
+        /// @brief Interrupts per second of one row on one CPU.
+        double rate(std::size_t row, std::size_t column) const {
+            return elapsed_seconds > 0.0 ? static_cast<double>(deltas[row * columns + column]) / elapsed_seconds : 0.0;
+        }
+    };
+
+    /// @brief A row ranked by its interrupt rate, with the CPU that takes most of it.
+    struct HotInterrupt {
+        std::string name;
+        std::string description;
+        double rate = 0.0;             ///< Interrupts per second over all CPUs
+        unsigned busiest_cpu = 0;      ///< CPU number handling the largest share
+        double busiest_cpu_rate = 0.0; ///< Interrupts per second on that CPU
+    };
+
+    /// @brief Parser for the /proc/interrupts and /proc/softirqs text format.
+    class InterruptStatsReader {
+    public:
+        /// @brief Parses a whole table into `out`, reusing its storage.
+        /// Rows with fewer counters than CPUs (e.g. ERR and MIS, which are system-wide) are padded
+        /// with zeros.
+        /// @throws std::runtime_error if the CPU header line is missing or malformed.
+        static void parse(std::string_view text, InterruptMatrix& out);
+
+        /// @brief Reads and parses a table through the active ProcFS source.
+        /// @param buffer Scratch space for the file contents, reused across calls.
+        /// @throws std::runtime_error if the file cannot be read or parsed.
+        static void read(InterruptTable table, InterruptMatrix& out, std::string& buffer);
+
+    private:
+        InterruptStatsReader() = delete;
+    };
+
+    /// @brief Samples one interrupt table repeatedly and derives per-IRQ and per-CPU rates.
+    /// Two matrices are kept and swapped, so steady-state sampling parses into storage left by the
+    /// sample before last and subtracts the whole counter array in one vectorized pass
+    /// (SystemProcFS::subtractCounters). Rows and CPUs that appear or disappear between samples
+    /// (device hotplug, CPU hotplug) are matched by label and CPU number; new ones start at zero.
+    /// Not thread-safe.
+    class InterruptCollector {
+    public:
+        using Clock = std::chrono::steady_clock;
+
+        explicit InterruptCollector(InterruptTable table);
+
+        /// @brief Reads the table now. From the second sample on, rates() covers the interval
+        /// since the previous sample.
+        /// @throws std::runtime_error if the table cannot be read or parsed.
+        void sample();
+        void sample(Clock::time_point now);
+
+        InterruptTable table() const { return table_; }
+
+        /// @brief The most recent reading.
+        const InterruptMatrix& current() const { return matrices_[current_]; }
+
+        /// @brief Whether rates() covers an interval (at least two samples were taken).
+        bool hasRates() const { return samples_ >= 2; }
+
+        /// @brief Rates between the last two samples, laid out like current(). Empty before hasRates().
+        const InterruptRates& rates() const { return rates_; }
+
+        /// @brief The `k` rows with the highest rate over the last interval, highest first.
+        /// Rows with a rate of zero are left out.
+        std::vector<HotInterrupt> hottest(std::size_t k) const;
+
+    private:
+        const std::uint64_t* alignedPrevious();
+
+        InterruptTable table_;
+        InterruptMatrix matrices_[2];
+        std::size_t current_ = 0;
+        std::string buffer_;
+        std::vector<std::uint64_t> aligned_; // Previous counters rearranged to the current layout
+        std::vector<std::uint64_t> cpu_totals_;
+        InterruptRates rates_;
+        Clock::time_point last_time_{};
+        std::uint64_t samples_ = 0;
+    };
+
+} // namespace SystemInterruptStats
+
+#endif // INTERRUPT_STATS_HPP
@@ -0,0 +1,182 @@
+#ifndef KEY_VALUE_READER_HPP
+#define KEY_VALUE_READER_HPP
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+
+#include "proc_source.hpp"
+
+namespace SystemProcFS {
+
+    /// @brief Binds one key of a "key value" /proc table to a struct member.
+    template <typename Record>
+    struct KeyField {
+        std::string_view key;
+        unsigned long long Record::*member;
+    };
+
+    /// @brief Single-pass reader for "key value" tables such as /proc/meminfo, /proc/vmstat and
+    /// cgroup memory.stat, driven by a schema fixed at compile time.
+    ///
+    /// A schema is a struct providing:
+    /// @code
+    ///   using Record = MemStats;                          // Struct being filled
+    ///   static constexpr std::string_view name = "meminfo"; // Used in error messages
+    ///   static constexpr char separator = ':';            // Ends the key (' ' for vmstat-style files)
+    ///   static constexpr std::string_view unit = "kB";    // Required unit after the value ("" for none)
+    ///   static constexpr KeyField<MemStats> fields[] = {  // One line per field
+    ///       {"MemTotal", &MemStats::total}, ...};
+    /// @endcode
+    /// The schema's keys are placed in a collision-free hash table computed at compile time, so a
+    /// line is dispatched by hashing its key once and confirming the single candidate slot; lines
+    /// for keys outside the schema cost one hash and no comparisons against every key.
+    template <typename Schema>
+    class KeyValueProcReader {
+    public:
+        using Record = typename Schema::Record;
+
+        static constexpr std::size_t kFieldCount = sizeof(Schema::fields) / sizeof(Schema::fields[0]);
+
+        /// @brief Parses `text`, assigning every schema field found. Fields absent from the text
+        /// keep their previous values; keys outside the schema are skipped. Stops early once every
+        /// field has been seen.
+        /// @return The number of schema fields assigned.
+        /// @throws std::runtime_error if a schema key has a malformed value or unit.
+        static std::size_t parse(std::string_view text, Record& out) {
+            std::size_t assigned = 0;
+            std::uint64_t seen = 0; // Bit per field; duplicates are assigned but counted once
+            while (!text.empty() && (kFieldCount > 64 || assigned < kFieldCount)) {
+                const std::size_t eol = text.find('\n');
+                const std::string_view line = text.substr(0, eol);
+                text = eol == std::string_view::npos ? std::string_view() : text.substr(eol + 1);
+
+                const std::size_t key_end = line.find(Schema::separator);
+                if (key_end == std::string_view::npos || key_end == 0) continue;
+                const std::string_view key = line.substr(0, key_end);
+                const int index = lookup(key);
+                if (index < 0) continue;
+
+                out.*(Schema::fields[index].member) = parseValue(line.substr(key_end + 1), line);
+                if (index < 64) {
+                    const std::uint64_t bit = std::uint64_t(1) << index;
+                    if (!(seen & bit)) {
+                        seen |= bit;
+                        ++assigned;
+                    }
+                } else {
+                    ++assigned;
+                }
+            }
+            return assigned;
+        }
+
+        /// @brief Reads `path` through the active ProcFS source into `buffer` and parses it into `out`.
+        /// @return false if the file cannot be read.
+        /// @throws std::runtime_error if a schema key has a malformed value or unit.
+        static bool read(std::string_view path, Record& out, std::string& buffer) {
+            if (!ProcFS::readFile(path, buffer)) return false;
+            parse(buffer, out);
+            return true;
+        }
+
+        /// @brief Returns the schema index of `key`, or -1 if the key is not in the schema.
+        static int lookup(std::string_view key) {
+            const int index = kTable.slots[hash(key, kTable.seed) & (kTableSize - 1)];
+            if (index < 0) return -1;
+            const std::string_view expected = Schema::fields[index].key;
+            // The table is collision-free, so one length check and one memcmp confirm the hit.
+            if (expected.size() != key.size() || std::memcmp(expected.data(), key.data(), key.size()) != 0) {
+                return -1;
+            }
+            return index;
+        }
+
+    private:
+        static constexpr std::size_t tableSizeFor(std::size_t n) {
+            std::size_t size = 8;
+            while (size < n * 2) size <<= 1;
+            return size;
+        }
+
+        static constexpr std::size_t kTableSize = tableSizeFor(kFieldCount);
+
+        // FNV-1a, seeded so that the compile-time search can try alternatives.
+        static constexpr std::uint32_t hash(std::string_view key, std::uint32_t seed) {
+            std::uint32_t h = 2166136261u ^ seed;
+            for (char c : key) {
+                h ^= static_cast<unsigned char>(c);
+                h *= 16777619u;
+            }
+            return h ^ (h >> 15);
+        }
+
+        struct Table {
+            std::uint32_t seed = 0;
+            bool found = false;
+            std::array<int, kTableSize> slots{};
+        };
+
+        // Tries seeds until every schema key lands in its own slot.
+        static constexpr Table buildTable() {
+            Table table;
+            for (std::uint32_t seed = 0; seed < 100000; ++seed) {
+                for (auto& slot : table.slots) slot = -1;
+                bool collision = false;
+                for (std::size_t i = 0; i < kFieldCount && !collision; ++i) {
+                    const std::size_t slot = hash(Schema::fields[i].key, seed) & (kTableSize - 1);
+                    if (table.slots[slot] >= 0) {
+                        collision = true;
+                    } else {
+                        table.slots[slot] = static_cast<int>(i);
+                    }
+                }
+                if (!collision) {
+                    table.seed = seed;
+                    table.found = true;
+                    return table;
+                }
+            }
+            return table;
+        }
+
+        static constexpr Table kTable = buildTable();
+        static_assert(kTable.found, "KeyValueProcReader: no collision-free seed found (duplicate keys in the schema?)");
+
+        static unsigned long long parseValue(std::string_view rest, std::string_view line) {
+            std::size_t i = 0;
+            while (i < rest.size() && (rest[i] == ' ' || rest[i] == '\t')) ++i;
+            const std::size_t digits_begin = i;
+            unsigned long long value = 0;
+            bool overflow = false;
+            while (i < rest.size() && rest[i] >= '0' && rest[i] <= '9') {
+                const unsigned digit = static_cast<unsigned>(rest[i] - '0');
+                overflow |= value > (std::numeric_limits<unsigned long long>::max() - digit) / 10;
+                value = value * 10 + digit;
+                ++i;
+            }
+            // Whatever follows the digits must be exactly the schema's unit (or nothing).
+            std::size_t unit_begin = i;
+            while (unit_begin < rest.size() && (rest[unit_begin] == ' ' || rest[unit_begin] == '\t')) ++unit_begin;
+            std::size_t unit_end = rest.size();
+            while (unit_end > unit_begin && (rest[unit_end - 1] == ' ' || rest[unit_end - 1] == '\t' ||
+                                              rest[unit_end - 1] == '\r')) {
+                --unit_end;
+            }
+            if (i == digits_begin || overflow ||
+                rest.substr(unit_begin, unit_end - unit_begin) != Schema::unit ||
+                (unit_begin == i && unit_end > unit_begin)) {
+                throw std::runtime_error("Malformed " + std::string(Schema::name) + " line: " + std::string(line));
+            }
+            return value;
+        }
+    };
+
+} // namespace SystemProcFS
+
+#endif // KEY_VALUE_READER_HPP
@@ -37,6 +37,12 @@ namespace SystemMemoryStats {
         /// @throws std::runtime_error if memory statistics are not supported on the platform or if there's a system error.
         static MemStats getMemStats();
 
+        /// @brief Allocation-free variant of getMemStats() for repeated sampling.
+        /// @param out Receives the memory statistics.
+        /// @param buffer Scratch space for the file contents, reused across calls.
+        /// @throws std::runtime_error if memory statistics cannot be read or a known field is malformed.
+        static void getMemStats(MemStats& out, std::string& buffer);
+
 #if defined(__linux__)
         /// @brief Linux-specific helper to parse a line from /proc/meminfo.
         /// Extracts the numerical value for a given key.
@@ -0,0 +1,91 @@
+#ifndef METRICS_SNAPSHOT_HPP
+#define METRICS_SNAPSHOT_HPP
+
+#include <cstdint>
+#include <memory_resource>
+#include <string>
+#include <vector>
+
+#include "collection_arena.hpp"
+
+#include "cpu_stats.hpp"
+#include "mem_stats.hpp"
+#include "disk_stats.hpp"
+#include "net_stats.hpp"
+
+namespace SystemMetricsSnapshot {
+
+    /// @brief One collection cycle's worth of raw statistics from every reader.
+    /// This is the unit that exporters, encoders and loggers operate on.
+    struct MetricsSnapshot {
+        std::uint64_t timestamp_ms;                   ///< Wall-clock time of the collection (milliseconds since the Unix epoch)
+        SystemCPUStats::CPUStats cpu;                 ///< Aggregate CPU times
+        SystemMemoryStats::MemStats mem;              ///< System memory
+        std::vector<SystemDiskStats::DiskStats> disks; ///< Per-device disk statistics
+        std::vector<SystemNetStats::NetStats> nets;    ///< Per-interface network statistics
+
+        MetricsSnapshot() : timestamp_ms(0) {}
+    };
+
+    /// @brief Allocation-free counterpart of MetricsSnapshot: trivially copyable records keyed by
+    /// interned names. The record vectors allocate from the resource given at construction,
+    /// typically a CollectionArena; reusing one FixedSnapshot across collections keeps their capacity.
+    struct FixedSnapshot {
+        std::uint64_t timestamp_ms = 0;
+        SystemCPUStats::CPUStats cpu;
+        SystemMemoryStats::MemStats mem;
+        std::pmr::vector<SystemDiskStats::DiskRecord> disks;
+        std::pmr::vector<SystemNetStats::NetRecord> nets;
+
+        explicit FixedSnapshot(std::pmr::memory_resource* resource = std::pmr::get_default_resource())
+            : disks(resource), nets(resource) {}
+
+        /// @brief Expands into a MetricsSnapshot, materialising device and interface names.
+        void expand(MetricsSnapshot& out) const;
+    };
+
+    /// @brief Collects FixedSnapshots with no heap allocation once its buffers have warmed up
+    /// (on Linux, for a host whose devices and interfaces stay the same).
+    /// Owns the scratch buffer files are read into, so use one collector per collecting thread.
+    class RecordCollector {
+    public:
+        /// @brief Collects into `out`, bypassing the per-reader read caches.
+        /// @throws std::runtime_error if any reader fails. `out` is left partially updated in that case.
+        void collect(FixedSnapshot& out);
+
+        /// @brief Collects a snapshot whose records live in `arena`.
+        /// The snapshot must not be used after the arena's next reset().
+        /// @throws std::runtime_error if any reader fails.
+        FixedSnapshot collect(SystemMetricsArena::CollectionArena& arena);
+
+    private:
+        std::string buffer_;
+    };
+
+    /// @brief Utility class that fills a MetricsSnapshot from all readers.
+    class SnapshotCollector {
+    public:
+        /// @brief Collects a fresh snapshot from the CPU, memory, disk and network readers.
+        /// @return The collected snapshot, timestamped with the current wall-clock time.
+        /// @throws std::runtime_error if any reader fails.
+        static MetricsSnapshot collect();
+
+        /// @brief Collects into an existing snapshot, reusing its vectors' capacity.
+        /// @param out The snapshot to overwrite.
+        /// @throws std::runtime_error if any reader fails. `out` is left partially updated in that case.
+        static void collect(MetricsSnapshot& out);
+
+        /// @brief Returns the current wall-clock time in milliseconds since the Unix epoch.
+        static std::uint64_t nowMs();
+
+    private:
+        // Prevent instantiation of this utility class.
+        SnapshotCollector() = delete;
+        ~SnapshotCollector() = delete;
+        SnapshotCollector(const SnapshotCollector&) = delete;
+        SnapshotCollector& operator=(const SnapshotCollector&) = delete;
+    };
+
+} // namespace SystemMetricsSnapshot
+
+#endif // METRICS_SNAPSHOT_HPP
@@ -0,0 +1,88 @@
+#ifndef NAME_INDEX_HPP
+#define NAME_INDEX_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <limits>
+#include <memory>
+#include <shared_mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace SystemMetricsIndex {
+
+    /// @brief Process-wide identifier of an interned device or interface name.
+    using NameId = std::uint32_t;
+
+    /// @brief Returned by lookups for names that were never interned.
+    constexpr NameId kNoName = std::numeric_limits<NameId>::max();
+
+    /// @brief Maps names to small dense ids that stay valid for the life of the process.
+    /// Device and interface names are interned once and then compared and hashed as integers
+    /// from one sample to the next. Interned names are never released, which is fine for the
+    /// bounded set of devices a host reports.
+    class NameInterner {
+    public:
+        /// @brief Returns the interner shared by all readers.
+        static NameInterner& global();
+
+        /// @brief Returns the id of `name`, interning it first if needed.
+        /// @throws std::length_error if the id space is exhausted.
+        NameId intern(std::string_view name);
+
+        /// @brief Returns the id of `name`, or kNoName if it was never interned. Never allocates.
+        NameId find(std::string_view name) const;
+
+        /// @brief Returns the name an id was interned from.
+        /// @throws std::out_of_range if `id` was not issued by this interner.
+        std::string_view name(NameId id) const;
+
+        /// @brief Number of interned names.
+        std::size_t size() const;
+
+    private:
+        mutable std::shared_mutex mutex_;
+        std::deque<std::string> names_;                     // Stable storage; indexed by id
+        std::unordered_map<std::string_view, NameId> ids_;  // Views into names_
+    };
+
+    /// @brief Read-only open-addressing index from interned name to position in a sample.
+    /// Built once per distinct device layout (linear probing, load factor at most 1/2) and
+    /// shared by every sample that reports the same names in the same order.
+    class NameIndex {
+    public:
+        static constexpr std::size_t npos = std::numeric_limits<std::size_t>::max();
+
+        NameIndex() = default;
+
+        /// @brief Indexes `ids`, mapping ids[i] to position i. Later duplicates are ignored.
+        explicit NameIndex(std::vector<NameId> ids);
+
+        /// @brief Returns the position of `id`, or npos if it is not indexed.
+        std::size_t find(NameId id) const;
+
+        /// @brief Returns `previous` if it was built from exactly `ids`, otherwise a new index.
+        /// Lets consecutive samples with an unchanged device layout share one index.
+        static std::shared_ptr<const NameIndex> reuseOrBuild(const std::shared_ptr<const NameIndex>& previous,
+                                                             std::vector<NameId> ids);
+
+        /// @brief Number of indexed positions.
+        std::size_t size() const { return ids_.size(); }
+
+    private:
+        struct Slot {
+            NameId id = kNoName;
+            std::uint32_t position = 0;
+        };
+
+        std::vector<NameId> ids_;
+        std::vector<Slot> slots_; // Power-of-two size
+        std::size_t mask_ = 0;
+    };
+
+} // namespace SystemMetricsIndex
+
+#endif // NAME_INDEX_HPP
@@ -1,10 +1,17 @@
 #ifndef NET_STATS_HPP
 #define NET_STATS_HPP
 
+#include <chrono>
+#include <map>
+#include <memory_resource>
 #include <string>
+#include <string_view>
 #include <vector> // For returning a collection of stats from raw getters
 #include <stdexcept> // For std::runtime_error
 
+#include "name_index.hpp"
+#include "read_cache.hpp"
+
 // Forward declarations for platform-specific data structures or includes
 // Note: Actual platform-specific headers will be included in the .cpp implementation files.
 
@@ -36,6 +43,23 @@ namespace SystemNetStats {
               drops_in(di), drops_out(dou) {}
     };
 
+    /// @brief Trivially copyable counterpart of NetStats, keyed by an interned interface name.
+    /// Used by the allocation-free collection path (see NetStatsReader::getAllNetRecords()).
+    struct NetRecord {
+        SystemMetricsIndex::NameId interface_name = SystemMetricsIndex::kNoName; ///< Interned interface name
+        unsigned long long bytes_received = 0;
+        unsigned long long bytes_sent = 0;
+        unsigned long long packets_received = 0;
+        unsigned long long packets_sent = 0;
+        unsigned long long errors_in = 0;
+        unsigned long long errors_out = 0;
+        unsigned long long drops_in = 0;
+        unsigned long long drops_out = 0;
+    };
+
+    /// @brief Expands a record back into a NetStats, looking up its interned name.
+    NetStats toNetStats(const NetRecord& record);
+
     /// @brief Class to read and provide network interface statistics from the system.
     /// Provides a cross-platform interface for accessing network statistics.
     class NetStatsReader {
@@ -54,6 +78,44 @@ namespace SystemNetStats {
         /// or if network statistics are not supported on the platform.
         static NetStats getNetStats(const std::string& interface_name);
 
+        /// @brief Retrieves statistics for several interfaces from a single read.
+        /// @param interface_names The interfaces to look up; duplicates are collapsed.
+        /// @return The requested interfaces that were found, keyed by name. Missing interfaces are omitted.
+        /// @throws std::runtime_error if network statistics cannot be read.
+        static std::map<std::string, NetStats> getNetStatsForInterfaces(const std::vector<std::string>& interface_names);
+
+        /// @brief Retrieves per-interface statistics for all reported interfaces.
+        /// @return One NetStats entry per interface, after the platform's virtual-interface filtering.
+        /// @throws std::runtime_error if network statistics are not supported on the platform
+        /// or if there's an error during retrieval.
+        static std::vector<NetStats> getAllNetStats();
+
+        /// @brief Sets how long one parse of the interface list is shared by later callers.
+        /// Concurrent callers always share a single in-flight read; the default of 0 adds no staleness.
+        static void setCacheMaxAge(std::chrono::milliseconds max_age);
+
+        /// @brief Returns the load/hit/coalesce counters of the interface-list cache.
+        static SystemProcFS::CacheStats cacheStats();
+
+        /// @brief Forces the next call to re-read the interface list.
+        static void invalidateCache();
+
+        /// @brief Allocation-free parse of a /proc/net/dev interface line. Fills every field of
+        /// `record` except `interface_name`.
+        /// @param interface_name Receives the interface name (without the colon) as a view into `line`.
+        /// @return false if the line has no colon, too few fields or a non-numeric counter.
+        static bool parseNetDevLine(std::string_view line, std::string_view& interface_name, NetRecord& record);
+
+        /// @brief Returns false for virtual interfaces that are filtered out of every report (veth, docker, br-).
+        static bool isReportedInterface(std::string_view interface_name);
+
+        /// @brief Reads one record per reported interface into `out`, bypassing the read cache.
+        /// On Linux this performs no heap allocation once `out` and `buffer` have grown to fit the host.
+        /// @param out Receives the records; it allocates from its own memory resource (e.g. a CollectionArena).
+        /// @param buffer Scratch space for the file contents, reused across calls.
+        /// @throws std::runtime_error if network statistics cannot be read.
+        static void getAllNetRecords(std::pmr::vector<NetRecord>& out, std::string& buffer);
+
     private:
         /// @brief Private helper to dispatch to the correct platform-specific function.
         /// This centralizes the platform selection logic, returning a vector of raw stats.
@@ -66,13 +128,6 @@ namespace SystemNetStats {
         static std::vector<NetStats> getRawLinuxNetStats();
         static std::vector<NetStats> getRawMacNetStats();
         static std::vector<NetStats> getRawUnsupportedNetStats();
-
-        // Add any platform-specific parsing helpers here if needed,
-        // similar to parseDiskStatLine in disk_stats.
-        // For example, on Linux, you might have:
-        // #if defined(__linux__)
-        // static NetStats parseNetDevLine(const std::string& line, const std::string& interface_name);
-        // #endif
     };
 
 } // namespace SystemNetStats
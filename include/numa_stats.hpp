@@ -0,0 +1,164 @@
+#ifndef NUMA_STATS_HPP
+#define NUMA_STATS_HPP
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "cpu_stats.hpp"
+
+namespace SystemNumaStats {
+
+    /// @brief CPUs and distances of one NUMA node.
+    struct NumaNodeTopology {
+        unsigned node = 0;
+        std::vector<unsigned> cpus;      ///< Ascending
+        std::vector<unsigned> distances; ///< Relative access cost to each node, in node order (10 = local)
+    };
+
+    /// @brief NUMA layout from /sys/devices/system/node. It only changes with CPU or memory hotplug,
+    /// so collectors read it once and keep it.
+    class NumaTopology {
+    public:
+        /// @brief Reads every node through the active ProcFS source.
+        /// A kernel without NUMA support has no node directory and yields an empty topology.
+        /// @throws std::runtime_error if a node's cpulist or distance file is malformed.
+        static NumaTopology read();
+
+        /// @brief Parses a kernel CPU list such as "0-3,8-11" (an empty list is allowed).
+        /// @throws std::runtime_error if the list is malformed.
+        static std::vector<unsigned> parseCpuList(std::string_view text);
+
+        /// @brief Builds a topology from already known nodes (for tests and replayed data).
+        explicit NumaTopology(std::vector<NumaNodeTopology> nodes = {});
+
+        /// @brief Nodes ascending by number.
+        const std::vector<NumaNodeTopology>& nodes() const { return nodes_; }
+
+        /// @brief Node of a CPU, or -1 if the CPU belongs to no known node.
+        int nodeOfCpu(unsigned cpu) const {
+            return cpu < node_of_cpu_.size() ? node_of_cpu_[cpu] : -1;
+        }
+
+    private:
+        std::vector<NumaNodeTopology> nodes_;
+        std::vector<int> node_of_cpu_; // Indexed by CPU number
+    };
+
+    /// @brief Memory of one node from node<N>/meminfo, in kB like SystemMemoryStats::MemStats.
+    struct NumaMemory {
+        unsigned long long total = 0;
+        unsigned long long free = 0;
+        unsigned long long used = 0;
+        unsigned long long active = 0;
+        unsigned long long inactive = 0;
+        unsigned long long file_pages = 0;
+        unsigned long long anon_pages = 0;
+        unsigned long long slab = 0;
+
+        /// @brief used / total in percent; 0 for a node without memory.
+        double usedPercent() const;
+    };
+
+    /// @brief Allocation counters of one node from node<N>/numastat, in pages.
+    struct NumaCounters {
+        unsigned long long numa_hit = 0;       ///< Allocated here as intended
+        unsigned long long numa_miss = 0;      ///< Allocated here although intended for another node
+        unsigned long long numa_foreign = 0;   ///< Intended for here but allocated on another node
+        unsigned long long interleave_hit = 0; ///< Interleave policy allocations that got this node
+        unsigned long long local_node = 0;     ///< Allocated here by a process running here
+        unsigned long long other_node = 0;     ///< Allocated here by a process running on another node
+    };
+
+    /// @brief One reading of one node.
+    struct NumaNodeStats {
+        unsigned node = 0;
+        NumaMemory memory;
+        NumaCounters counters;
+    };
+
+    /// @brief Per-second allocation rates and CPU utilization of one node over an interval.
+    struct NumaNodeRates {
+        unsigned node = 0;
+        double numa_hit = 0.0;
+        double numa_miss = 0.0;
+        double numa_foreign = 0.0;
+        double interleave_hit = 0.0;
+        double local_node = 0.0;
+        double other_node = 0.0;
+        SystemCPUStats::CPUUtilization cpu; ///< Over the node's CPUs online in both samples
+        std::size_t cpus = 0;               ///< How many CPUs `cpu` covers
+    };
+
+    struct NumaRates {
+        double elapsed_seconds = 0.0;
+        std::vector<NumaNodeRates> nodes; ///< Same order as the topology
+    };
+
+    /// @brief Parsers for the per-node files.
+    class NumaStatsReader {
+    public:
+        /// @brief Parses node<N>/meminfo ("Node 0 MemTotal:  5865208 kB" lines) into `out`.
+        /// @throws std::runtime_error if a known key has a malformed value or unit.
+        static void parseMeminfo(std::string_view text, NumaMemory& out);
+
+        /// @brief Parses node<N>/numastat ("numa_hit 96062690" lines) into `out`.
+        /// @throws std::runtime_error if a known key has a malformed value.
+        static void parseNumastat(std::string_view text, NumaCounters& out);
+
+        /// @brief Reads the memory and counters of every node in `topology`.
+        /// @param buffer Scratch space for the file contents, reused across calls.
+        /// @throws std::runtime_error if a node's files cannot be read or parsed.
+        static void read(const NumaTopology& topology, std::vector<NumaNodeStats>& out, std::string& buffer);
+
+    private:
+        NumaStatsReader() = delete;
+    };
+
+    /// @brief Samples per-node memory and allocation counters together with /proc/stat, and reports
+    /// per-node allocation rates and CPU utilization, the latter by adding up the per-CPU tick
+    /// counters (SystemCPUStats::CPUStatsReader::getCPUCounters) of each node's CPUs. The topology
+    /// is read once, at construction. Not thread-safe.
+    class NumaCollector {
+    public:
+        using Clock = std::chrono::steady_clock;
+
+        /// @brief Reads the topology now.
+        /// @throws std::runtime_error as NumaTopology::read.
+        NumaCollector();
+
+        explicit NumaCollector(NumaTopology topology);
+
+        /// @brief Reads every node and /proc/stat now. From the second sample on, rates() covers the
+        /// interval since the previous sample.
+        /// @throws std::runtime_error if a file cannot be read or parsed.
+        void sample();
+        void sample(Clock::time_point now);
+
+        const NumaTopology& topology() const { return topology_; }
+        const std::vector<NumaNodeStats>& current() const { return current_; }
+        bool hasRates() const { return samples_ >= 2; }
+        const NumaRates& rates() const { return rates_; }
+
+    private:
+        void computeRates(double elapsed_seconds);
+
+        NumaTopology topology_;
+        std::string buffer_;
+        std::vector<NumaNodeStats> current_;
+        std::vector<NumaNodeStats> previous_;
+        SystemCPUStats::CPUCounterSample cpu_current_;
+        SystemCPUStats::CPUCounterSample cpu_previous_;
+        std::vector<const SystemCPUStats::CPUCounters*> previous_by_cpu_; // Scratch, indexed by CPU number
+        std::vector<SystemCPUStats::CPUCounters> node_sums_;              // Scratch: previous, current per node
+        NumaRates rates_;
+        Clock::time_point last_time_{};
+        std::uint64_t samples_ = 0;
+    };
+
+} // namespace SystemNumaStats
+
+#endif // NUMA_STATS_HPP
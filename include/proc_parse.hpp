@@ -0,0 +1,40 @@
+#ifndef PROC_PARSE_HPP
+#define PROC_PARSE_HPP
+
+#include <cstdint>
+#include <string_view>
+
+namespace SystemProcFS {
+
+    /// @brief Splits off the next line of `text` (without its '\n') into `line`.
+    /// @return false once `text` is exhausted.
+    bool nextLine(std::string_view& text, std::string_view& line);
+
+    /// @brief Allocation-free tokenizer over whitespace-separated /proc fields.
+    /// Views returned by the scanner point into the scanned text.
+    class FieldScanner {
+    public:
+        explicit FieldScanner(std::string_view text) : text_(text) {}
+
+        /// @brief Reads the next whitespace-separated field.
+        /// @return false if no fields remain.
+        bool next(std::string_view& field);
+
+        /// @brief Reads the next field as an unsigned decimal integer.
+        /// @return false if no fields remain or the field is not entirely digits (or overflows).
+        bool nextUnsigned(std::uint64_t& value);
+
+        /// @brief Skips `count` fields.
+        /// @return false if fewer than `count` fields remained.
+        bool skip(unsigned count);
+
+        /// @brief The unscanned remainder of the text.
+        std::string_view rest() const { return text_; }
+
+    private:
+        std::string_view text_;
+    };
+
+} // namespace SystemProcFS
+
+#endif // PROC_PARSE_HPP
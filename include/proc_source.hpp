@@ -0,0 +1,155 @@
+#ifndef PROC_SOURCE_HPP
+#define PROC_SOURCE_HPP
+
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace SystemProcFS {
+
+    /// @brief Abstract source of /proc and /sys file contents.
+    /// Every Linux reader goes through the active source instead of opening absolute
+    /// paths directly, so recorded fixtures can be replayed in place of the live host.
+    class ProcSource {
+    public:
+        virtual ~ProcSource() = default;
+
+        /// @brief Reads the whole file at a logical path (e.g. "/proc/stat") into `out`.
+        /// `out` is cleared first and its capacity is reused across calls.
+        /// @return false if the file does not exist or cannot be read.
+        virtual bool readFile(std::string_view path, std::string& out) const = 0;
+
+        /// @brief Lists the entry names of a logical directory (e.g. "/proc" or "/proc/net").
+        /// @return The entry names (without "." and ".."), or an empty vector if the directory does not exist.
+        virtual std::vector<std::string> listDirectory(std::string_view path) const = 0;
+
+        /// @brief Maps a logical path onto a real filesystem path.
+        /// @return The on-disk path, or an empty string if this source has no on-disk representation.
+        virtual std::string resolvePath(std::string_view path) const = 0;
+    };
+
+    /// @brief Source backed by a directory tree. An empty root reads the live host.
+    /// A non-empty root (e.g. "/srv/fixtures/host42") is prepended to every logical path.
+    class DirectoryProcSource : public ProcSource {
+    public:
+        explicit DirectoryProcSource(std::string root = "");
+
+        bool readFile(std::string_view path, std::string& out) const override;
+        std::vector<std::string> listDirectory(std::string_view path) const override;
+        std::string resolvePath(std::string_view path) const override;
+
+        const std::string& root() const { return root_; }
+
+    private:
+        std::string root_;
+    };
+
+    /// @brief In-memory filesystem with scripted counter evolution.
+    /// Files are either static contents, a recorded sequence of frames, or a generator
+    /// called with the current tick. advance() moves every scripted file forward.
+    /// Collectors that report rates also offer sample(Clock::time_point), which takes the sample
+    /// time from the caller, so a replay advanced one tick per sample can stand for any interval.
+    /// A sample() that throws leaves their readings and rates as they were, so the next rates
+    /// cover the interval since the last sample that succeeded.
+    class VirtualProcSource : public ProcSource {
+    public:
+        /// @brief Produces the contents of a file for a given tick.
+        using Generator = std::function<std::string(std::uint64_t tick)>;
+
+        /// @brief Registers a file with fixed contents.
+        void setFile(std::string path, std::string contents);
+
+        /// @brief Registers a file that replays `frames` in order, one per tick.
+        /// The last frame is repeated once the sequence is exhausted.
+        /// @throws std::invalid_argument if `frames` is empty.
+        void setSequence(std::string path, std::vector<std::string> frames);
+
+        /// @brief Registers a file whose contents are computed from the current tick.
+        /// @throws std::invalid_argument if `generator` is empty.
+        void setGenerator(std::string path, Generator generator);
+
+        /// @brief Removes a file (e.g. to simulate a device or process disappearing).
+        void removeFile(std::string_view path);
+
+        /// @brief Advances the scripted clock by `steps` ticks.
+        void advance(std::uint64_t steps = 1);
+
+        /// @brief Returns the current tick (starts at 0).
+        std::uint64_t tick() const;
+
+        bool readFile(std::string_view path, std::string& out) const override;
+        std::vector<std::string> listDirectory(std::string_view path) const override;
+        std::string resolvePath(std::string_view path) const override;
+
+    private:
+        struct Entry {
+            std::string contents;
+            std::vector<std::string> frames;
+            Generator generator;
+        };
+
+        mutable std::mutex mutex_;
+        std::map<std::string, Entry, std::less<>> files_;
+        std::uint64_t tick_ = 0;
+    };
+
+    /// @brief Process-wide access point for the active ProcSource.
+    /// Defaults to the live host, or to a DirectoryProcSource rooted at the
+    /// METRICS_AGENT_PROC_ROOT environment variable when it is set.
+    class ProcFS {
+    public:
+        /// @brief Installs a new active source. Passing nullptr restores the default source.
+        static void setSource(std::shared_ptr<const ProcSource> source);
+
+        /// @brief Shorthand for installing a DirectoryProcSource rooted at `root`.
+        static void setRoot(const std::string& root);
+
+        /// @brief Restores the default source.
+        static void reset();
+
+        /// @brief Returns the active source.
+        static std::shared_ptr<const ProcSource> source();
+
+        /// @brief Returns a counter that changes every time the active source is replaced.
+        /// Caches keyed on file contents use it to drop results read from a previous source.
+        static std::uint64_t generation();
+
+        /// @brief Reads a file through the active source. See ProcSource::readFile.
+        static bool readFile(std::string_view path, std::string& out);
+
+        /// @brief Lists a directory through the active source. See ProcSource::listDirectory.
+        static std::vector<std::string> listDirectory(std::string_view path);
+
+        /// @brief Resolves a path through the active source. See ProcSource::resolvePath.
+        static std::string resolvePath(std::string_view path);
+
+    private:
+        // Prevent instantiation of this utility class.
+        ProcFS() = delete;
+        ~ProcFS() = delete;
+        ProcFS(const ProcFS&) = delete;
+        ProcFS& operator=(const ProcFS&) = delete;
+    };
+
+    /// @brief RAII helper that installs a source for the lifetime of the object
+    /// and restores the previously active source afterwards. Intended for tests and benchmarks.
+    class ScopedProcSource {
+    public:
+        explicit ScopedProcSource(std::shared_ptr<const ProcSource> source);
+        ~ScopedProcSource();
+
+        ScopedProcSource(const ScopedProcSource&) = delete;
+        ScopedProcSource& operator=(const ScopedProcSource&) = delete;
+
+    private:
+        std::shared_ptr<const ProcSource> previous_;
+    };
+
+} // namespace SystemProcFS
+
+#endif // PROC_SOURCE_HPP
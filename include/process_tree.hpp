@@ -0,0 +1,190 @@
+#ifndef PROCESS_TREE_HPP
+#define PROCESS_TREE_HPP
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "batch_reader.hpp"
+#include "thread_stats.hpp"
+
+namespace SystemProcessStats {
+
+    /// @brief How processes are grouped into rollups.
+    enum class RollupBy {
+        Tree,       ///< Each top-level process tree (a child of a root such as init or kthreadd) with all
+                    ///< its descendants; roots count only themselves
+        Executable, ///< Command name (comm, at most 15 characters)
+        Unit        ///< systemd unit (the deepest .service or .scope of the cgroup), else the cgroup path
+    };
+
+    /// @brief Resource rollups are ranked by.
+    enum class RollupResource {
+        Cpu,
+        Rss,
+        Io ///< Storage reads plus writes
+    };
+
+    const char* rollupByName(RollupBy by);
+
+    /// @brief Returns the unit a process belongs to from its /proc/<pid>/cgroup text: the deepest
+    /// ".service" or ".scope" component of the v2 ("0::") path, or of the v1 name=systemd path
+    /// when there is no v2 entry; the whole path if it names no unit (e.g. "/docker/<id>").
+    /// @return "/" for an empty or unparsable file (e.g. a kernel thread on a v1 host).
+    std::string cgroupServiceName(std::string_view proc_pid_cgroup);
+
+    /// @brief Resource use of a group of processes over the last interval.
+    struct Rollup {
+        std::string name;                    ///< Group key: comm of the tree's top process, executable or unit
+        int pid = 0;                         ///< Top process of a RollupBy::Tree rollup; 0 otherwise
+        std::size_t processes = 0;
+        double cpu_percent = 0.0;            ///< 100 = one CPU kept busy
+        std::uint64_t rss_bytes = 0;
+        double read_bytes_per_second = 0.0;  ///< From /proc/<pid>/io read_bytes
+        double write_bytes_per_second = 0.0; ///< From /proc/<pid>/io write_bytes
+    };
+
+    /// @brief Work done by a ProcessTreeCollector, for judging its cost.
+    struct ProcessTreeStats {
+        std::uint64_t scans = 0;             ///< /proc listings
+        std::uint64_t stat_reads = 0;
+        std::uint64_t io_reads = 0;
+        std::uint64_t cgroup_reads = 0;      ///< One per new process
+        std::uint64_t processes_added = 0;
+        std::uint64_t processes_removed = 0;
+        std::size_t processes = 0;           ///< Processes known now
+        std::size_t groups = 0;              ///< Executable and unit groups held now
+    };
+
+    /// @brief Scans every process under /proc and rolls CPU, RSS and storage IO up by process tree,
+    /// executable and systemd unit, for dashboards that cannot use per-pid series.
+    ///
+    /// A sample lists /proc and re-reads each process's stat (and io) file in one BatchFileReader
+    /// batch, then merges the pid-sorted listing with the known processes. The files stay open
+    /// while the process lives; a reused pid whose old descriptor fails is picked up a sample later. Executable and unit rollups are kept up to date
+    /// incrementally: a process joins its groups once, when first seen (the only time its cgroup file
+    /// is read), adjusts their RSS by its change on later samples, moves groups only when it execs a
+    /// new command, and leaves them when it exits. Tree rollups are rebuilt every sample in one linear
+    /// pass, adding each process into its parent leaves-first with an explicit stack. A reused pid is
+    /// told apart by its start time. CPU and IO are reported for processes seen in both samples of
+    /// an interval. Not thread-safe.
+    class ProcessTreeCollector {
+    public:
+        using Clock = std::chrono::steady_clock;
+
+        struct Options {
+            bool read_io = true; ///< Read /proc/<pid>/io (needs ptrace access to other users' processes)
+            std::size_t max_open_files = 4096; ///< stat and io descriptors kept open; further files are
+                                               ///< opened and closed on every read
+        };
+
+        ProcessTreeCollector();
+        explicit ProcessTreeCollector(Options options);
+
+        /// @brief Scans /proc and updates every rollup. From the second sample on, rollups cover
+        /// the interval since the previous sample.
+        /// @throws std::runtime_error if /proc cannot be listed or a stat or io file is malformed;
+        /// the rollups are left as they were before the call.
+        void sample();
+        void sample(Clock::time_point now);
+
+        bool hasRates() const { return samples_ >= 2; }
+
+        /// @brief The `count` groups using the most of `resource`, largest first.
+        std::vector<Rollup> top(RollupBy by, RollupResource resource, std::size_t count) const;
+
+        /// @brief Rolls up `pid` and all its descendants into `out`.
+        /// @return false if `pid` was not present in the last sample.
+        bool subtree(int pid, Rollup& out) const;
+
+        ProcessTreeStats stats() const;
+
+    private:
+        // Per-interval deltas (and the RSS gauge) of a process, subtree or group.
+        struct Usage {
+            std::uint64_t cpu_ticks = 0;
+            std::uint64_t rss_bytes = 0;
+            std::uint64_t read_bytes = 0;
+            std::uint64_t write_bytes = 0;
+            std::size_t processes = 0;
+        };
+
+        struct Process {
+            int pid = 0;
+            int ppid = 0;
+            std::uint64_t start_time = 0;
+            std::string comm;
+            std::uint64_t cpu_ticks = 0;   // utime + stime, cumulative
+            std::uint64_t read_bytes = 0;  // Cumulative
+            std::uint64_t write_bytes = 0; // Cumulative
+            std::uint32_t executable = 0;  // Group ids
+            std::uint32_t unit = 0;
+            Usage usage;                   // This interval
+        };
+
+        static constexpr std::size_t kNoFile = static_cast<std::size_t>(-1);
+
+        // Indices of a listed process's files in reader_.
+        struct Files {
+            int pid = 0;
+            std::size_t stat = kNoFile;
+            std::size_t io = kNoFile;
+        };
+
+        struct Read {
+            TaskStat stat;
+            unsigned long long read_bytes = 0;
+            unsigned long long write_bytes = 0;
+            bool ok = false;
+        };
+
+        // Groups of one RollupBy dimension, by dense id. Ids of emptied groups are reused.
+        struct Dimension {
+            std::vector<std::string> names;
+            std::vector<Usage> usage;
+            std::unordered_map<std::string, std::uint32_t> ids;
+            std::vector<std::uint32_t> free;
+        };
+
+        void list();
+        void openFiles(Files& files);
+        void closeFiles(Files& files);
+        void readProcess(Files& files, Read& out);
+        void add(const Read& read, int pid);
+        void update(Process& process, const Read& read);
+        void remove(const Process& process);
+        void buildTree();
+
+        static std::uint32_t join(Dimension& dimension, std::string_view name, std::uint64_t rss_bytes);
+        static void leave(Dimension& dimension, std::uint32_t id, std::uint64_t rss_bytes);
+        Rollup toRollup(const Usage& usage) const;
+
+        Options options_;
+        SystemProcFS::BatchFileReader reader_;
+        std::uint64_t page_size_ = 4096;
+        std::vector<Process> processes_; // Ascending by pid
+        std::vector<Process> merged_;    // Scratch for the merge
+        std::vector<int> pids_;          // Scratch: the /proc listing
+        std::vector<Files> files_;       // Parallel to pids_
+        std::vector<Files> listed_;      // Scratch for merging files_ with the listing
+        std::vector<Read> reads_;        // Scratch, parallel to pids_
+        Dimension executables_;
+        Dimension units_;
+        std::vector<int> parent_;        // Tree scratch, parallel to processes_: parent index or -1
+        std::vector<std::size_t> pending_;
+        std::vector<std::size_t> stack_;
+        std::vector<Usage> subtrees_;
+        std::string buffer_;
+        ProcessTreeStats stats_;
+        Clock::time_point last_time_{};
+        double elapsed_ = 0.0;
+        std::uint64_t samples_ = 0;
+    };
+
+} // namespace SystemProcessStats
+
+#endif // PROCESS_TREE_HPP
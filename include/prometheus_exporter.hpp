@@ -0,0 +1,146 @@
+#ifndef PROMETHEUS_EXPORTER_HPP
+#define PROMETHEUS_EXPORTER_HPP
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#include "metrics_snapshot.hpp"
+
+namespace SystemMetricsHistory {
+    class RingLog;
+}
+namespace SystemMetricsShm {
+    class ShmPublisher;
+}
+
+namespace SystemMetricsExporter {
+
+    /// @brief Renders a snapshot in the Prometheus text exposition format (version 0.0.4).
+    /// @param snapshot The snapshot to render.
+    /// @param out Destination buffer. It is cleared first; its capacity is reused.
+    void renderPrometheusText(const SystemMetricsSnapshot::MetricsSnapshot& snapshot, std::string& out);
+
+    /// @brief A fully rendered HTTP response for one collection cycle.
+    /// The headers are rendered alongside the body so that serving a scrape is a single writev.
+    struct Exposition {
+        std::string body;          ///< Prometheus text body
+        std::string header;        ///< HTTP response header for the identity body
+        std::string gzip_body;     ///< gzip-compressed body (empty if gzip is disabled or unavailable)
+        std::string gzip_header;   ///< HTTP response header for the gzip body
+        std::uint64_t generation;  ///< Increments with every publish; 0 means nothing has been published
+
+        Exposition() : generation(0) {}
+    };
+
+    /// @brief Double-buffered cache of the rendered exposition.
+    /// publish() renders into the back buffer and swaps it to the front. Readers take a
+    /// shared reference to the front buffer, so a buffer still being written to a socket
+    /// is never overwritten; it is only recycled once every reader has released it.
+    class ExpositionCache {
+    public:
+        /// @param enable_gzip Whether to also cache a gzip-compressed copy of each body.
+        explicit ExpositionCache(bool enable_gzip = true);
+
+        /// @brief Renders `snapshot` into the back buffer and makes it the current exposition.
+        void publish(const SystemMetricsSnapshot::MetricsSnapshot& snapshot);
+
+        /// @brief Returns the current exposition. Never null.
+        std::shared_ptr<const Exposition> current() const;
+
+        /// @brief Returns true if gzip bodies are produced (requested and compiled in).
+        bool gzipEnabled() const { return enable_gzip_; }
+
+    private:
+        bool enable_gzip_;
+        std::mutex publish_mutex_;              // Serialises publishers
+        mutable std::mutex front_mutex_;        // Guards the front_ pointer swap only
+        std::shared_ptr<const Exposition> front_;
+        std::shared_ptr<Exposition> back_;
+        std::uint64_t generation_ = 0;
+    };
+
+    /// @brief Minimal HTTP/1.1 server exposing /metrics from an ExpositionCache.
+    /// Scrapes are served from the pre-rendered buffers with no per-request formatting.
+    class PrometheusExporter {
+    public:
+        struct Options {
+            std::string bind_address;                       ///< IPv4 address to bind (default loopback)
+            std::uint16_t port;                             ///< TCP port; 0 picks an ephemeral port
+            bool enable_gzip;                               ///< Serve gzip bodies to clients that accept them
+            std::chrono::milliseconds collection_interval;  ///< Background collection period; 0 disables the collector thread
+
+            Options(std::string address = "127.0.0.1", std::uint16_t p = 9100, bool gzip = true,
+                    std::chrono::milliseconds interval = std::chrono::milliseconds(1000))
+                : bind_address(std::move(address)), port(p), enable_gzip(gzip), collection_interval(interval) {}
+        };
+
+        explicit PrometheusExporter(Options options = Options());
+        ~PrometheusExporter();
+
+        PrometheusExporter(const PrometheusExporter&) = delete;
+        PrometheusExporter& operator=(const PrometheusExporter&) = delete;
+
+        /// @brief Binds the listening socket and starts the server (and collector) threads.
+        /// @throws std::runtime_error if the socket cannot be bound, or on unsupported platforms.
+        /// @throws std::logic_error if the exporter is already running.
+        void start();
+
+        /// @brief Stops the threads and closes all sockets. Safe to call more than once.
+        void stop();
+
+        /// @brief Returns true between start() and stop().
+        bool running() const { return running_.load(); }
+
+        /// @brief Returns the bound port (useful when Options::port was 0).
+        std::uint16_t port() const { return bound_port_; }
+
+        /// @brief Runs one collection cycle: collects a snapshot and publishes it.
+        /// Reader failures are logged and the previous exposition stays in place.
+        /// @return true if a new exposition was published.
+        bool collect();
+
+        /// @brief Publishes an externally collected snapshot.
+        void publish(const SystemMetricsSnapshot::MetricsSnapshot& snapshot);
+
+        /// @brief Appends every collected snapshot to `history` (nullptr detaches).
+        /// If the log already holds snapshots from a previous run, the newest one is published
+        /// immediately so that scrapes are served before the first collection completes.
+        void attachHistory(std::shared_ptr<SystemMetricsHistory::RingLog> history);
+
+        /// @brief Also writes every collected snapshot to a shared-memory region, so that local
+        /// consumers can read it with ShmReader instead of parsing /proc themselves (nullptr detaches).
+        void attachSharedMemory(std::shared_ptr<SystemMetricsShm::ShmPublisher> publisher);
+
+        /// @brief Returns the underlying cache.
+        const ExpositionCache& cache() const { return cache_; }
+
+    private:
+        void serveLoop();
+        void collectLoop();
+
+        Options options_;
+        ExpositionCache cache_;
+        SystemMetricsSnapshot::MetricsSnapshot scratch_; // Reused across collection cycles
+        std::mutex collect_mutex_;
+        std::shared_ptr<SystemMetricsHistory::RingLog> history_; // Guarded by collect_mutex_
+        std::shared_ptr<SystemMetricsShm::ShmPublisher> shm_;     // Guarded by collect_mutex_
+
+        std::atomic<bool> running_{false};
+        int listen_fd_ = -1;
+        int wake_fds_[2] = {-1, -1}; // Self-pipe used to interrupt poll() on stop()
+        std::uint16_t bound_port_ = 0;
+        std::thread server_thread_;
+        std::thread collector_thread_;
+        std::mutex stop_mutex_;
+        std::condition_variable stop_cv_;
+    };
+
+} // namespace SystemMetricsExporter
+
+#endif // PROMETHEUS_EXPORTER_HPP
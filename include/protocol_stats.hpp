@@ -0,0 +1,166 @@
+#ifndef PROTOCOL_STATS_HPP
+#define PROTOCOL_STATS_HPP
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace SystemNetStats {
+
+    /// @brief IP/TCP/UDP counters collected from /proc/net/snmp and /proc/net/netstat.
+    /// The enumerator is the counter's index in ProtocolCounters, fixed at compile time.
+    enum class ProtocolCounter : std::size_t {
+        // /proc/net/snmp
+        IpInReceives,
+        IpInDiscards,
+        IpOutRequests,
+        IpOutDiscards,
+        IpOutNoRoutes,
+        TcpActiveOpens,
+        TcpPassiveOpens,
+        TcpAttemptFails,
+        TcpEstabResets,
+        TcpCurrEstab,       ///< Gauge: connections currently ESTABLISHED or CLOSE_WAIT
+        TcpInSegs,
+        TcpOutSegs,
+        TcpRetransSegs,
+        TcpInErrs,
+        TcpOutRsts,
+        TcpInCsumErrors,
+        UdpInDatagrams,
+        UdpNoPorts,
+        UdpInErrors,
+        UdpOutDatagrams,
+        UdpRcvbufErrors,
+        UdpSndbufErrors,
+        UdpInCsumErrors,
+        // /proc/net/netstat
+        TcpExtSyncookiesSent,
+        TcpExtSyncookiesFailed,
+        TcpExtListenOverflows,
+        TcpExtListenDrops,
+        TcpExtTCPReqQFullDrop,
+        TcpExtTCPLostRetransmit,
+        TcpExtTCPFastRetrans,
+        TcpExtTCPSlowStartRetrans,
+        TcpExtTCPTimeouts,
+        TcpExtTCPSynRetrans,
+        TcpExtTCPAbortOnTimeout,
+        TcpExtTCPAbortOnMemory,
+        TcpExtTCPBacklogDrop,
+        TcpExtTCPRcvQDrop,
+        TcpExtTCPOFODrop,
+        TcpExtTCPMemoryPressures,
+        IpExtInOctets,
+        IpExtOutOctets,
+        Count
+    };
+
+    constexpr std::size_t kProtocolCounterCount = static_cast<std::size_t>(ProtocolCounter::Count);
+
+    /// @brief "Section.Key" name of a counter as it appears in the /proc file (e.g. "TcpExt.ListenOverflows").
+    const char* protocolCounterName(ProtocolCounter counter);
+
+    /// @brief Whether a counter is a gauge (TcpCurrEstab) rather than a monotonic count.
+    bool isProtocolGauge(ProtocolCounter counter);
+
+    /// @brief One reading of every protocol counter.
+    struct ProtocolCounters {
+        std::array<std::uint64_t, kProtocolCounterCount> values{};
+        std::array<bool, kProtocolCounterCount> present{}; ///< false for counters this kernel does not report
+
+        std::uint64_t operator[](ProtocolCounter counter) const { return values[static_cast<std::size_t>(counter)]; }
+        bool has(ProtocolCounter counter) const { return present[static_cast<std::size_t>(counter)]; }
+    };
+
+    /// @brief Per-second rates between two readings. Gauges and absent counters are 0.
+    struct ProtocolRates {
+        double elapsed_seconds = 0.0;
+        std::array<std::uint64_t, kProtocolCounterCount> deltas{};
+        std::array<double, kProtocolCounterCount> per_second{};
+
+        double operator[](ProtocolCounter counter) const { return per_second[static_cast<std::size_t>(counter)]; }
+    };
+
+    /// @brief Column-to-counter mapping of one /proc/net/snmp-style file.
+    /// These files are pairs of lines: a header ("Tcp: RtoAlgorithm RtoMin ...") naming the columns
+    /// of the value line under it ("Tcp: 1 200 ..."). The mapping is built from the header lines on
+    /// first use and kept while they stay byte-for-byte the same, so later parses skip every key
+    /// lookup and only convert the mapped columns.
+    class ProtocolTableLayout {
+    public:
+        /// @brief Parses one file, setting the counters it maps (other counters are left untouched).
+        /// @throws std::runtime_error if a header has no value line, the two disagree on their
+        /// section, or a mapped column is not an unsigned number.
+        void parse(std::string_view text, ProtocolCounters& out);
+
+        /// @brief How many parses had to (re)build the mapping.
+        std::uint64_t builds() const { return builds_; }
+
+    private:
+        struct Section {
+            std::string header; // Cached header line, compared on every parse
+            std::vector<std::pair<std::uint32_t, std::uint32_t>> columns; // (value column, counter index), ascending
+        };
+
+        static void buildSection(std::string_view header, Section& section);
+
+        std::vector<Section> sections_;
+        std::uint64_t builds_ = 0;
+    };
+
+    /// @brief One-shot reads of the protocol counters.
+    class ProtocolStatsReader {
+    public:
+        /// @brief Parses one /proc/net/snmp- or /proc/net/netstat-formatted text without caching its layout.
+        /// @throws std::runtime_error as ProtocolTableLayout::parse.
+        static void parse(std::string_view text, ProtocolCounters& out);
+
+        /// @brief Reads /proc/net/snmp and /proc/net/netstat through the active ProcFS source.
+        /// A missing /proc/net/netstat leaves its counters absent.
+        /// @throws std::runtime_error if /proc/net/snmp cannot be read, or either file cannot be parsed.
+        static ProtocolCounters getProtocolCounters();
+
+    private:
+        ProtocolStatsReader() = delete;
+    };
+
+    /// @brief Samples the protocol counters repeatedly, reusing both files' layouts and its buffer,
+    /// and computes rates against the previous sample (wrap- and reset-safe, see
+    /// SystemCPUStats::counterDelta). Not thread-safe.
+    class ProtocolStatsCollector {
+    public:
+        using Clock = std::chrono::steady_clock;
+
+        /// @brief Reads both files now. From the second sample on, rates() covers the interval
+        /// since the previous sample.
+        /// @throws std::runtime_error as ProtocolStatsReader::getProtocolCounters.
+        void sample();
+        void sample(Clock::time_point now);
+
+        const ProtocolCounters& current() const { return current_; }
+        bool hasRates() const { return samples_ >= 2; }
+        const ProtocolRates& rates() const { return rates_; }
+
+        /// @brief Layout (re)builds so far, over both files; stays at 2 while the kernel's columns are stable.
+        std::uint64_t layoutBuilds() const { return snmp_.builds() + netstat_.builds(); }
+
+    private:
+        ProtocolTableLayout snmp_;
+        ProtocolTableLayout netstat_;
+        std::string buffer_;
+        ProtocolCounters current_;
+        ProtocolCounters previous_;
+        ProtocolRates rates_;
+        Clock::time_point last_time_{};
+        std::uint64_t samples_ = 0;
+    };
+
+} // namespace SystemNetStats
+
+#endif // PROTOCOL_STATS_HPP
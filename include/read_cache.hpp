@@ -0,0 +1,123 @@
+#ifndef READ_CACHE_HPP
+#define READ_CACHE_HPP
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <utility>
+
+#include "proc_source.hpp"
+
+namespace SystemProcFS {
+
+    /// @brief Counters describing how a CoalescingCache served its callers.
+    struct CacheStats {
+        std::uint64_t loads = 0;     ///< Calls that ran the loader
+        std::uint64_t hits = 0;      ///< Calls served from a result still inside the staleness window
+        std::uint64_t coalesced = 0; ///< Calls that waited for another caller's in-flight load
+    };
+
+    /// @brief Singleflight cache for a value parsed from /proc.
+    /// At most one caller runs the loader at a time; callers arriving while it runs wait for
+    /// it and share its result (or its exception). A completed result is reused until it is
+    /// older than the staleness window or the active ProcFS source is replaced.
+    /// A window of 0 only coalesces overlapping calls, so sequential callers always see fresh data.
+    template <typename T>
+    class CoalescingCache {
+    public:
+        using Clock = std::chrono::steady_clock;
+
+        explicit CoalescingCache(std::chrono::milliseconds max_age = std::chrono::milliseconds(0))
+            : max_age_(max_age) {}
+
+        CoalescingCache(const CoalescingCache&) = delete;
+        CoalescingCache& operator=(const CoalescingCache&) = delete;
+
+        /// @brief Returns the cached value, running `loader` (a callable returning T) if it is stale.
+        /// @throws Whatever `loader` throws, to the caller that ran it and to every caller that waited on it.
+        template <typename Loader>
+        std::shared_ptr<const T> get(Loader&& loader) {
+            const std::uint64_t generation = ProcFS::generation();
+            std::unique_lock<std::mutex> lock(mutex_);
+            if (flight_) {
+                // Join the in-flight load rather than starting another one, and return its outcome
+                // even if the cache is invalidated or reloaded before this caller wakes.
+                ++stats_.coalesced;
+                const std::shared_ptr<Flight> flight = flight_;
+                done_.wait(lock, [&] { return flight->done; });
+                if (flight->error) std::rethrow_exception(flight->error);
+                return flight->value;
+            }
+            if (value_ && generation_ == generation && Clock::now() - loaded_at_ <= max_age_) {
+                ++stats_.hits;
+                return value_;
+            }
+
+            ++stats_.loads;
+            const std::shared_ptr<Flight> flight = std::make_shared<Flight>();
+            flight_ = flight;
+            lock.unlock();
+            try {
+                flight->value = std::make_shared<const T>(loader());
+            } catch (...) {
+                flight->error = std::current_exception();
+            }
+            lock.lock();
+            if (!flight->error) {
+                value_ = flight->value;
+                loaded_at_ = Clock::now();
+                generation_ = generation; // A source swapped mid-load makes the next call reload
+            }
+            flight->done = true;
+            flight_.reset();
+            lock.unlock();
+            done_.notify_all();
+            if (flight->error) std::rethrow_exception(flight->error);
+            return flight->value;
+        }
+
+        /// @brief Drops the cached value so that the next call reloads. An in-flight load still completes.
+        void invalidate() {
+            std::lock_guard<std::mutex> lock(mutex_);
+            value_.reset();
+        }
+
+        void setMaxAge(std::chrono::milliseconds max_age) {
+            std::lock_guard<std::mutex> lock(mutex_);
+            max_age_ = max_age;
+        }
+
+        std::chrono::milliseconds maxAge() const {
+            std::lock_guard<std::mutex> lock(mutex_);
+            return max_age_;
+        }
+
+        CacheStats stats() const {
+            std::lock_guard<std::mutex> lock(mutex_);
+            return stats_;
+        }
+
+    private:
+        // Outcome of one load, shared by the caller that ran it and the callers that joined it.
+        struct Flight {
+            std::shared_ptr<const T> value;
+            std::exception_ptr error;
+            bool done = false; // Guarded by mutex_
+        };
+
+        mutable std::mutex mutex_;
+        std::condition_variable done_;
+        std::chrono::milliseconds max_age_;
+        std::shared_ptr<const T> value_;
+        Clock::time_point loaded_at_{};
+        std::uint64_t generation_ = 0;
+        std::shared_ptr<Flight> flight_; // The load in progress, if any
+        CacheStats stats_;
+    };
+
+} // namespace SystemProcFS
+
+#endif // READ_CACHE_HPP
@@ -0,0 +1,130 @@
+#ifndef RING_LOG_HPP
+#define RING_LOG_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "metrics_snapshot.hpp"
+#include "snapshot_codec.hpp"
+
+namespace SystemMetricsHistory {
+
+    // File layout:
+    //   [0, 4096)            two header slots of 128 bytes each (A at 0, B at 128)
+    //   [4096, 4096 + cap)   circular data region
+    // Each header slot carries a commit counter and a CRC; the writer alternates slots so that a
+    // torn header write always leaves the other slot intact, and readers pick the valid slot with
+    // the highest commit counter.
+    // Records are 8-byte aligned: {length:u32, crc32:u32, sequence:u64, payload[length]}. The CRC
+    // covers the sequence and the payload. A record never straddles the end of the region; the
+    // writer leaves a wrap marker (length 0xFFFFFFFF) and continues at offset 0.
+
+    /// @brief Fixed-size, memory-mapped circular log of binary records.
+    /// Appending overwrites the oldest records once the region is full. The file is reopened
+    /// in place after a restart: only the two header slots are read, and records are accessed
+    /// directly through the mapping.
+    class RingLog {
+    public:
+        enum class Mode {
+            ReadWrite, ///< Create the file if needed and allow appends
+            ReadOnly   ///< Open an existing file for offline replay
+        };
+
+        /// @brief Default size of the data region (8 MiB, roughly two days of 1 Hz keyframes on a small host).
+        static constexpr std::size_t kDefaultCapacity = 8u << 20;
+
+        /// @brief Opens or creates a ring log.
+        /// @param path File to map.
+        /// @param capacity Size of the data region for new files. Existing files keep their own capacity.
+        /// @param mode ReadWrite or ReadOnly.
+        /// @throws std::invalid_argument if capacity is smaller than 4096 bytes or larger than 4 GiB.
+        /// @throws std::runtime_error if the file cannot be opened or mapped, or (in ReadOnly mode)
+        ///         if it holds no valid header. In ReadWrite mode an unreadable file is reinitialized.
+        explicit RingLog(const std::string& path, std::size_t capacity = kDefaultCapacity, Mode mode = Mode::ReadWrite);
+        ~RingLog();
+
+        RingLog(const RingLog&) = delete;
+        RingLog& operator=(const RingLog&) = delete;
+
+        /// @brief Appends one record, evicting the oldest records as needed.
+        /// @return The sequence number assigned to the record.
+        /// @throws std::logic_error if the log is read-only.
+        /// @throws std::invalid_argument if the record cannot fit in the data region.
+        std::uint64_t append(SystemMetricsCodec::ByteSpan payload);
+
+        /// @brief Encodes a snapshot as a self-contained keyframe and appends it.
+        /// Keyframes are used so that any record can be decoded after older ones are evicted.
+        std::uint64_t append(const SystemMetricsSnapshot::MetricsSnapshot& snapshot);
+
+        /// @brief Drops every record with a sequence number below `sequence`, oldest first.
+        /// Lets the log act as a persistent FIFO: readers consume from the front with forEach().
+        /// @return Number of records dropped.
+        /// @throws std::logic_error if the log is read-only.
+        std::size_t discardBefore(std::uint64_t sequence);
+
+        /// @brief Calls `visitor(sequence, payload)` for each record from oldest to newest.
+        /// Payloads point into the mapping and are only valid during the call. The visitor returns
+        /// false to stop early. Records that fail their CRC end the walk.
+        /// @return Number of records visited.
+        std::size_t forEach(const std::function<bool(std::uint64_t, SystemMetricsCodec::ByteSpan)>& visitor) const;
+
+        /// @brief Decodes every stored snapshot, oldest first.
+        /// @param max_records Keep only the newest `max_records` snapshots (0 = all).
+        std::vector<SystemMetricsSnapshot::MetricsSnapshot> replay(std::size_t max_records = 0) const;
+
+        /// @brief Decodes the newest stored snapshot.
+        /// @return false if the log is empty.
+        bool latest(SystemMetricsSnapshot::MetricsSnapshot& out) const;
+
+        /// @brief Flushes the mapping to disk (msync with MS_SYNC).
+        void sync();
+
+        /// @brief Sequence number of the oldest stored record.
+        std::uint64_t firstSequence() const;
+        /// @brief Sequence number the next append will receive.
+        std::uint64_t nextSequence() const;
+        /// @brief Number of stored records.
+        std::size_t size() const;
+        /// @brief Size of the data region in bytes.
+        std::size_t capacity() const { return capacity_; }
+        /// @brief Returns true if the log was opened read-only.
+        bool readOnly() const { return mode_ == Mode::ReadOnly; }
+
+    private:
+        struct State {
+            std::uint64_t commit;     // Header commit counter
+            std::uint64_t head;       // Offset where the next record goes
+            std::uint64_t tail;       // Offset of the oldest record
+            std::uint64_t first_seq;  // Sequence number at `tail`
+            std::uint64_t next_seq;   // Sequence number of the next record
+            std::uint64_t used;       // Bytes between tail and head, including wrap padding
+            std::uint64_t last;       // Offset of the newest record
+        };
+
+        void initialize();
+        bool loadHeader();
+        void recoverUncommitted();
+        void commitHeader();
+        bool recordAt(std::uint64_t offset, std::uint64_t expected_seq, std::uint64_t& next_offset,
+                      SystemMetricsCodec::ByteSpan& payload) const;
+        void evictOldest();
+
+        std::string path_;
+        Mode mode_;
+        int fd_ = -1;
+        std::uint8_t* map_ = nullptr;
+        std::size_t map_size_ = 0;
+        std::size_t capacity_ = 0;
+        State state_{};
+        mutable std::mutex mutex_;
+        SystemMetricsCodec::SnapshotEncoder encoder_{1};
+        std::vector<std::uint8_t> scratch_;
+    };
+
+} // namespace SystemMetricsHistory
+
+#endif // RING_LOG_HPP
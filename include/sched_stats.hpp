@@ -0,0 +1,151 @@
+#ifndef SCHED_STATS_HPP
+#define SCHED_STATS_HPP
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "batch_reader.hpp"
+
+namespace SystemCPUStats {
+
+    /// @brief Scheduler counters of one CPU: a "cpuN" line of /proc/schedstat (format versions 15+).
+    struct SchedCPUCounters {
+        unsigned cpu = 0;
+        std::uint64_t schedule_calls = 0; ///< Calls to schedule()
+        std::uint64_t idle_schedules = 0; ///< schedule() calls that left the CPU idle
+        std::uint64_t wakeups = 0;        ///< try_to_wake_up() calls on this CPU
+        std::uint64_t local_wakeups = 0;  ///< ... that woke a task already on this CPU
+        std::uint64_t run_time_ns = 0;    ///< Time tasks spent running on this CPU
+        std::uint64_t run_delay_ns = 0;   ///< Time runnable tasks spent waiting in this CPU's run queue
+        std::uint64_t timeslices = 0;     ///< Timeslices run on this CPU
+    };
+
+    /// @brief One reading of /proc/schedstat.
+    struct SchedStat {
+        unsigned version = 0;
+        std::vector<SchedCPUCounters> cpus; ///< Online CPUs, in the order the kernel lists them
+    };
+
+    /// @brief Scheduler counters of one task from /proc/<pid>/schedstat.
+    struct TaskSchedCounters {
+        std::uint64_t run_time_ns = 0;
+        std::uint64_t run_delay_ns = 0;
+        std::uint64_t timeslices = 0;
+    };
+
+    /// @brief Run-queue latency over an interval.
+    struct SchedLatency {
+        double running = 0.0;          ///< Seconds spent running per second (1.0 = one CPU kept busy)
+        double waiting = 0.0;          ///< Seconds spent runnable but waiting per second (mean tasks queued)
+        double timeslices = 0.0;       ///< Timeslices per second
+        double average_wait_us = 0.0;  ///< Mean run-queue wait per timeslice; 0 if none ran
+    };
+
+    /// @brief Latency of one CPU over an interval.
+    struct SchedCPULatency {
+        unsigned cpu = 0;
+        SchedLatency latency;
+    };
+
+    /// @brief Latency of one tracked task over an interval.
+    struct TaskSchedLatency {
+        int pid = 0;
+        SchedLatency latency;
+    };
+
+    /// @brief Latency between two samples.
+    struct SchedRates {
+        double elapsed_seconds = 0.0;
+        std::vector<SchedCPULatency> cpus;   ///< CPUs present in both samples; empty without /proc/schedstat
+        SchedLatency total;                  ///< Over `cpus`; average_wait_us is timeslice-weighted
+        std::vector<TaskSchedLatency> tasks; ///< Tracked tasks read in both samples, in tracking order
+    };
+
+    /// @brief Parsers for /proc/schedstat and /proc/<pid>/schedstat, the run-queue counterpart of
+    /// CPUStatsReader: /proc/stat says how busy a CPU was, these say how long work waited for it.
+    class SchedStatsReader {
+    public:
+        /// @brief Parses /proc/schedstat into `out`, reusing the capacity of `out.cpus`.
+        /// Scheduling-domain lines are skipped.
+        /// @throws std::runtime_error if the version is older than 15 or a cpu line is malformed.
+        static void parse(std::string_view text, SchedStat& out);
+
+        /// @brief Parses a /proc/<pid>/schedstat line ("run_time run_delay timeslices").
+        /// @throws std::runtime_error if the line is malformed.
+        static void parseTask(std::string_view text, TaskSchedCounters& out);
+
+        /// @brief Reads /proc/schedstat through the active ProcFS source.
+        /// @throws std::runtime_error if the file cannot be read (kernels without CONFIG_SCHEDSTATS
+        /// do not have it) or parsed.
+        static SchedStat getSchedStats();
+
+        /// @brief Reads /proc/<pid>/schedstat. For a process these are its main thread's counters;
+        /// a thread id reads that thread.
+        /// @param buffer Scratch space for the file contents, reused across calls.
+        /// @return false if the task no longer exists.
+        /// @throws std::runtime_error if the file is malformed.
+        static bool readTask(int pid, TaskSchedCounters& out, std::string& buffer);
+
+    private:
+        SchedStatsReader() = delete;
+    };
+
+    /// @brief Samples /proc/schedstat and the schedstat of tracked tasks, and reports run-queue latency
+    /// (time spent runnable but not running, and its mean per timeslice) per CPU, over all CPUs and
+    /// per task. A host without /proc/schedstat still gets per-task latency, which only needs
+    /// CONFIG_SCHED_INFO. The tasks' schedstat files are kept open and re-read in one
+    /// BatchFileReader batch per sample. Tasks that exit are untracked at the next sample. Not thread-safe.
+    class SchedCollector {
+    public:
+        using Clock = std::chrono::steady_clock;
+
+        SchedCollector();
+
+        /// @brief Adds a process or thread id; its rates start with the second sample that reads it.
+        void track(int pid);
+        void untrack(int pid);
+        const std::vector<int>& tracked() const { return pids_; }
+
+        /// @brief Reads /proc/schedstat (if present) and every tracked task now. From the second
+        /// sample on, rates() covers the interval since the previous sample.
+        /// @throws std::runtime_error if a file is malformed.
+        void sample();
+        void sample(Clock::time_point now);
+
+        /// @brief Whether the last sample found /proc/schedstat.
+        bool hasCPUStats() const { return !current_.cpus.empty(); }
+        const SchedStat& current() const { return current_; }
+        bool hasRates() const { return samples_ >= 2; }
+        const SchedRates& rates() const { return rates_; }
+
+    private:
+        struct Task {
+            int pid = 0;
+            std::size_t file = 0; // Index of its schedstat file in reader_
+            TaskSchedCounters previous;
+            TaskSchedCounters current;
+            TaskSchedCounters next; // Read this sample, not yet committed
+            bool exited = false;
+            std::uint64_t samples = 0;
+        };
+
+        void computeCPURates(double scale);
+
+        std::string buffer_;
+        SystemProcFS::BatchFileReader reader_;
+        SchedStat current_;
+        SchedStat previous_;
+        std::vector<int> pids_;
+        std::vector<Task> tasks_; // Same order as pids_
+        SchedRates rates_;
+        Clock::time_point last_time_{};
+        std::uint64_t samples_ = 0;
+    };
+
+} // namespace SystemCPUStats
+
+#endif // SCHED_STATS_HPP
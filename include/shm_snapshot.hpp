@@ -0,0 +1,127 @@
+#ifndef SHM_SNAPSHOT_HPP
+#define SHM_SNAPSHOT_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "metrics_snapshot.hpp"
+
+namespace SystemMetricsShm {
+
+    /// @brief Default POSIX shared-memory object name.
+    constexpr const char* kDefaultShmName = "/metrics_agent_snapshot";
+
+    /// @brief Longest device or interface name stored in the region; longer names are truncated.
+    constexpr std::size_t kMaxShmNameLength = 31;
+
+    // Region layout: a header followed by an array of 64-bit words holding the snapshot.
+    // The words are written and read with relaxed atomic operations bracketed by a seqlock
+    // sequence counter (odd while a write is in progress), so readers never block the publisher
+    // and never observe a torn snapshot.
+    //   words[0]        timestamp_ms
+    //   words[1..11]    CPU fields as IEEE-754 bit patterns (including usage_percent)
+    //   words[12..18]   memory fields
+    //   words[19..20]   disk count, interface count
+    //   disks           4 name words + 4 counters each
+    //   interfaces      4 name words + 8 counters each
+
+    struct ShmHeader;
+
+    /// @brief Writes the latest snapshot into a POSIX shared-memory region.
+    /// Only one publisher per region name is supported. Creating a publisher replaces any
+    /// existing region with that name and marks the old one stale for readers still mapping it.
+    class ShmPublisher {
+    public:
+        /// @param name Shared-memory object name (must start with '/').
+        /// @param max_disks Disk slots reserved in the region; extra disks are not published.
+        /// @param max_nets Interface slots reserved in the region; extra interfaces are not published.
+        /// @throws std::invalid_argument if the name is malformed or a limit is 0.
+        /// @throws std::runtime_error if the region cannot be created or mapped.
+        explicit ShmPublisher(std::string name = kDefaultShmName, std::size_t max_disks = 64, std::size_t max_nets = 64);
+
+        /// @brief Marks the region stale and removes the name.
+        ~ShmPublisher();
+
+        ShmPublisher(const ShmPublisher&) = delete;
+        ShmPublisher& operator=(const ShmPublisher&) = delete;
+
+        /// @brief Publishes `snapshot` as the latest one. Wait-free for readers; never allocates.
+        void publish(const SystemMetricsSnapshot::MetricsSnapshot& snapshot);
+
+        /// @brief Number of publishes so far.
+        std::uint64_t publishCount() const;
+
+        const std::string& name() const { return name_; }
+
+    private:
+        std::string name_;
+        ShmHeader* header_ = nullptr;
+        std::size_t map_size_ = 0;
+        std::uint64_t inode_ = 0; // Identifies our region when deciding whether to unlink the name
+    };
+
+    /// @brief Reads the latest snapshot from a region written by ShmPublisher.
+    /// After construction, reads make no system calls and take no locks. One reader can be
+    /// shared by any number of threads, including one calling reopen() while others read.
+    class ShmReader {
+    public:
+        /// @throws std::runtime_error if the region does not exist or is not a snapshot region.
+        explicit ShmReader(std::string name = kDefaultShmName);
+        ~ShmReader();
+
+        ShmReader(const ShmReader&) = delete;
+        ShmReader& operator=(const ShmReader&) = delete;
+
+        /// @brief Copies a consistent snapshot into `out`, reusing its storage.
+        /// @param max_attempts Retries allowed while the publisher is mid-write.
+        /// @return false if nothing has been published yet, the region is stale (see reopen()),
+        ///         or every attempt overlapped a write.
+        bool read(SystemMetricsSnapshot::MetricsSnapshot& out, unsigned max_attempts = 1000) const;
+
+        /// @brief Like read(), but returns false without copying if nothing was published since
+        /// the sequence recorded in `last_sequence`, which is updated on success.
+        bool readIfChanged(SystemMetricsSnapshot::MetricsSnapshot& out, std::uint64_t& last_sequence,
+                           unsigned max_attempts = 1000) const;
+
+        /// @brief Current sequence number (even when idle, advances by 2 per publish).
+        std::uint64_t sequence() const;
+
+        /// @brief Returns true once the publisher that created the mapped region has gone away
+        /// or been replaced.
+        bool stale() const;
+
+        /// @brief Maps the region currently registered under the name. Reads already under way
+        /// finish on the replaced region, which stays mapped until a later reopen() (or the
+        /// destructor) finds no read under way.
+        /// @throws std::runtime_error if it does not exist; the current region stays in use.
+        void reopen();
+
+        /// @brief Replaced regions still mapped because reads were under way when they were replaced.
+        std::size_t retired() const;
+
+    private:
+        struct Mapping {
+            const ShmHeader* header = nullptr;
+            std::size_t size = 0;
+        };
+
+        static bool readAttempt(const ShmHeader* header, SystemMetricsSnapshot::MetricsSnapshot& out,
+                                std::uint64_t& sequence);
+        Mapping map() const;
+        static void unmap(const Mapping& mapping);
+
+        std::string name_;
+        std::atomic<const ShmHeader*> header_{nullptr};
+        Mapping current_;                // Guarded by reopen_mutex_ after construction
+        std::vector<Mapping> retired_;   // Replaced by reopen(), kept while reads may use them
+        mutable std::atomic<std::size_t> active_reads_{0}; // Calls holding a header loaded from header_
+        mutable std::mutex reopen_mutex_;
+    };
+
+} // namespace SystemMetricsShm
+
+#endif // SHM_SNAPSHOT_HPP
@@ -0,0 +1,100 @@
+#ifndef SIMD_SCAN_HPP
+#define SIMD_SCAN_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+namespace SystemProcFS {
+
+    /// @brief Instruction sets the scanner can run on, in increasing order of width.
+    enum class ScanLevel {
+        Scalar, ///< Portable byte loop
+        SSE42,  ///< 16-byte blocks, vectorized decimal conversion
+        AVX2    ///< 32-byte blocks for newline and field-boundary scans
+    };
+
+    /// @brief The widest level the running CPU supports (Scalar on non-x86 builds).
+    ScanLevel detectedScanLevel();
+
+    /// @brief The level currently used by the scanner; defaults to detectedScanLevel().
+    ScanLevel activeScanLevel();
+
+    /// @brief Selects the level used by the scanner, clamped to detectedScanLevel().
+    /// Intended for tests and benchmarks comparing implementations.
+    /// @return The level actually selected.
+    ScanLevel setScanLevel(ScanLevel level);
+
+    const char* scanLevelName(ScanLevel level);
+
+    /// @brief Returns the offset of the first '\n' in `text`, or std::string_view::npos.
+    std::size_t findNewline(std::string_view text);
+
+    /// @brief Parses `digits` as an unsigned decimal integer.
+    /// @return false if `digits` is empty, contains a non-digit or overflows 64 bits.
+    bool parseDecimal(std::string_view digits, std::uint64_t& value);
+
+    /// @brief Parses the run of blank-separated unsigned decimals at the start of `text`, such as the
+    /// per-CPU columns of /proc/interrupts. Stops after `max_values` numbers, at the end of `text`, or
+    /// at the first field that is not entirely digits (e.g. "IO-APIC" or "2-edge"), which is left
+    /// unconsumed.
+    /// @param consumed Receives the offset just past the last number parsed (0 if none).
+    /// @return The number of values written to `values`.
+    std::size_t parseUnsignedRun(std::string_view text, std::uint64_t* values, std::size_t max_values,
+                                 std::size_t& consumed);
+
+    /// @brief Parses `count` right-aligned unsigned decimals printed in fixed-width columns, such as the
+    /// kernel's " %10u" per-CPU columns (width 11). Column i is text[i * width, (i + 1) * width) and
+    /// must be spaces followed by at least one digit. Columns are converted independently, without
+    /// searching for field boundaries, which makes this several times faster than parseUnsignedRun().
+    /// @return false if `text` is too short or a column is not in that form (`values` is then unspecified).
+    bool parseFixedWidthColumns(std::string_view text, std::size_t width, std::uint64_t* values, std::size_t count);
+
+    /// @brief Parses `count` eight-digit hexadecimal columns printed every `width` bytes, such as the
+    /// kernel's "%08x " fields in /proc/net/softnet_stat (width 9). Column i is text[i * width, i * width + 8);
+    /// upper and lower case digits are accepted. Each column is converted as one 64-bit word (SWAR)
+    /// unless the scalar level is selected.
+    /// @return false if `width` is less than 8, `text` is too short or a column is not all hex digits
+    /// (`values` is then unspecified).
+    bool parseFixedWidthHex(std::string_view text, std::size_t width, std::uint64_t* values, std::size_t count);
+
+    /// @brief Computes `delta[i]` = increase of counter i from `previous[i]` to `current[i]` for a
+    /// whole array at once, following SystemCPUStats::counterDelta: a counter that went backwards
+    /// from the top half of the 32-bit range to the bottom half wrapped, any other decrease is a
+    /// reset and yields 0. `delta` may alias `previous` or `current`.
+    void subtractCounters(const std::uint64_t* previous, const std::uint64_t* current, std::uint64_t* delta,
+                          std::size_t count);
+
+    /// @brief Whitespace-separated fields of one line, located in a single block-at-a-time pass.
+    /// Up to kMaxFields fields are split; anything after them is available from rest().
+    /// Views returned point into the line, which must outlive this object.
+    class LineFields {
+    public:
+        static constexpr std::size_t kMaxFields = 32;
+
+        explicit LineFields(std::string_view line);
+
+        /// @brief Number of fields split (at most kMaxFields).
+        std::size_t size() const { return count_; }
+
+        std::string_view operator[](std::size_t index) const {
+            return line_.substr(begin_[index], end_[index] - begin_[index]);
+        }
+
+        /// @brief Parses field `index` as an unsigned decimal integer.
+        /// @return false if the field does not exist or is not a valid unsigned 64-bit number.
+        bool unsignedAt(std::size_t index, std::uint64_t& value) const;
+
+        /// @brief The line after the last split field (empty unless the line has more than kMaxFields fields).
+        std::string_view rest() const { return line_.substr(count_ == 0 ? line_.size() : end_[count_ - 1]); }
+
+    private:
+        std::string_view line_;
+        std::uint32_t begin_[kMaxFields];
+        std::uint32_t end_[kMaxFields];
+        std::size_t count_ = 0;
+    };
+
+} // namespace SystemProcFS
+
+#endif // SIMD_SCAN_HPP
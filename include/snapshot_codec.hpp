@@ -0,0 +1,119 @@
+#ifndef SNAPSHOT_CODEC_HPP
+#define SNAPSHOT_CODEC_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "metrics_snapshot.hpp"
+
+namespace SystemMetricsCodec {
+
+    /// @brief Current wire format version. Decoders reject frames with any other version.
+    constexpr std::uint8_t kFormatVersion = 1;
+
+    /// @brief Non-owning view of an encoded buffer.
+    struct ByteSpan {
+        const std::uint8_t* data;
+        std::size_t size;
+
+        ByteSpan(const std::uint8_t* d = nullptr, std::size_t n = 0) : data(d), size(n) {}
+        ByteSpan(const std::vector<std::uint8_t>& buffer) : data(buffer.data()), size(buffer.size()) {}
+    };
+
+    /// @brief Fixed-size prefix of every frame.
+    struct FrameHeader {
+        std::uint8_t version;   ///< Wire format version
+        bool keyframe;          ///< True if the frame is self-contained (absolute values and full name table)
+    };
+
+    /// @brief Reads the header of an encoded frame without decoding it.
+    /// @throws std::runtime_error if the buffer is too short or does not start with the frame magic.
+    FrameHeader peekFrameHeader(ByteSpan frame);
+
+    // Frame layout (all integers are LEB128 varints unless noted):
+    //   'M' 'S' version:u8 flags:u8          flags bit 0 = keyframe
+    //   timestamp_ms                          absolute in keyframes, zigzag delta otherwise
+    //   10 CPU counters, 7 memory counters    absolute in keyframes, zigzag delta otherwise
+    //   new_name_count, {length, bytes}...    names interned since the previous frame, ids assigned in order
+    //   disk_count, {id<<1|has_base, 4 counters}...
+    //   net_count,  {id<<1|has_base, 8 counters}...
+    // Per-device counters are deltas when has_base is set (the device was present in the
+    // previous frame), absolute otherwise. Keyframes reset the name table.
+    // CPU times are carried as integral ticks; usage_percent is derived and not encoded.
+
+    /// @brief Stateful encoder producing delta-encoded frames.
+    class SnapshotEncoder {
+    public:
+        /// @param keyframe_interval Emit a keyframe every this many frames (1 = every frame is a keyframe).
+        /// @throws std::invalid_argument if keyframe_interval is 0.
+        explicit SnapshotEncoder(std::size_t keyframe_interval = 60);
+
+        /// @brief Appends one encoded frame to `out`.
+        /// @param snapshot The snapshot to encode.
+        /// @param out Destination buffer; the frame is appended after any existing contents.
+        /// @param force_keyframe Emit a self-contained keyframe regardless of the interval.
+        /// @return The number of bytes appended.
+        std::size_t encode(const SystemMetricsSnapshot::MetricsSnapshot& snapshot,
+                           std::vector<std::uint8_t>& out, bool force_keyframe = false);
+
+        /// @brief Forgets all state so that the next frame is a keyframe.
+        void reset();
+
+    private:
+        struct DeviceBase {
+            std::uint64_t values[8];
+            std::uint64_t frame; // Frame index in which these values were last written
+        };
+
+        std::uint32_t internName(const std::string& name, std::vector<const std::string*>& new_names);
+
+        std::size_t keyframe_interval_;
+        std::uint64_t frame_index_ = 0;       // Index of the next frame
+        std::uint64_t frames_since_key_ = 0;
+        bool have_previous_ = false;
+        std::uint64_t prev_timestamp_ = 0;
+        std::uint64_t prev_fixed_[17] = {};   // 10 CPU + 7 memory counters
+        std::unordered_map<std::string, std::uint32_t> name_ids_;
+        std::vector<DeviceBase> disk_bases_;   // Indexed by name id
+        std::vector<DeviceBase> net_bases_;    // Indexed by name id
+        std::vector<std::uint32_t> scratch_ids_; // Per-frame name ids, reused across frames
+    };
+
+    /// @brief Stateful decoder mirroring SnapshotEncoder.
+    /// Frames are decoded in place from the caller's buffer; no intermediate copy is made,
+    /// and the output snapshot's vectors and strings are reused across calls.
+    class SnapshotDecoder {
+    public:
+        /// @brief Decodes one frame into `out`.
+        /// @param frame Buffer starting at a frame boundary.
+        /// @param out Snapshot to overwrite.
+        /// @return Number of bytes consumed from `frame` (frames can be concatenated).
+        /// @throws std::runtime_error on malformed or truncated input, an unsupported version,
+        ///         or a delta frame without a preceding keyframe.
+        std::size_t decode(ByteSpan frame, SystemMetricsSnapshot::MetricsSnapshot& out);
+
+        /// @brief Forgets all state; the next frame must be a keyframe.
+        void reset();
+
+    private:
+        struct DeviceBase {
+            std::uint64_t values[8];
+            std::uint64_t frame;
+        };
+
+        std::uint64_t frame_index_ = 0;
+        bool have_previous_ = false;
+        std::uint64_t prev_timestamp_ = 0;
+        std::uint64_t prev_fixed_[17] = {};
+        std::vector<std::string> names_;       // Indexed by name id
+        std::vector<DeviceBase> disk_bases_;
+        std::vector<DeviceBase> net_bases_;
+    };
+
+} // namespace SystemMetricsCodec
+
+#endif // SNAPSHOT_CODEC_HPP
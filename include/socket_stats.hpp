@@ -0,0 +1,122 @@
+#ifndef SOCKET_STATS_HPP
+#define SOCKET_STATS_HPP
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace SystemNetStats {
+
+    /// @brief TCP socket states, numbered as the kernel reports them (include/net/tcp_states.h).
+    enum class TcpState : std::uint8_t {
+        Established = 1,
+        SynSent,
+        SynRecv,
+        FinWait1,
+        FinWait2,
+        TimeWait,
+        Close,
+        CloseWait,
+        LastAck,
+        Listen,
+        Closing,
+        NewSynRecv ///< Pending connection request; sock_diag reports these as SynRecv
+    };
+
+    /// @brief Slots in SocketSummary::states, indexed by state number (slot 0 is unused).
+    constexpr std::size_t kTcpStateSlots = 13;
+
+    /// @brief Bit for `state` in a state mask (the kernel's TCPF_* flags).
+    constexpr std::uint32_t tcpStateBit(TcpState state) { return 1u << static_cast<unsigned>(state); }
+
+    /// @brief Mask selecting every TCP state.
+    constexpr std::uint32_t kAllTcpStates = 0xFFFu << 1;
+
+    /// @brief Upper-case kernel name of a state ("ESTABLISHED", "TIME_WAIT", ...).
+    const char* tcpStateName(TcpState state);
+
+    /// @brief Accept-queue usage of every listening socket on one port (IPv4 and IPv6 combined).
+    struct ListenBacklog {
+        std::uint16_t port = 0;
+        std::uint32_t sockets = 0; ///< Listening sockets on the port (e.g. SO_REUSEPORT groups)
+        std::uint64_t queued = 0;  ///< Connections waiting to be accepted
+        std::uint64_t limit = 0;   ///< Sum of the sockets' backlog limits (0 when read from /proc/net/tcp)
+    };
+
+    /// @brief TCP socket counts per state and per-port listen backlog, aggregated without keeping
+    /// per-socket records.
+    struct SocketSummary {
+        std::array<std::uint64_t, kTcpStateSlots> states{};
+        std::vector<ListenBacklog> listeners; ///< Ascending by port
+
+        std::uint64_t count(TcpState state) const { return states[static_cast<std::size_t>(state)]; }
+
+        /// @brief Sockets counted in every state.
+        std::uint64_t total() const;
+    };
+
+    /// @brief How a SocketStatsCollector gets its data.
+    enum class SocketBackend {
+        SockDiag, ///< NETLINK_SOCK_DIAG dump, streamed and aggregated in a reused buffer
+        ProcNet   ///< Text parse of /proc/net/tcp and /proc/net/tcp6
+    };
+
+    const char* socketBackendName(SocketBackend backend);
+
+    /// @brief Summarizes the host's TCP sockets by state, and listening ports by accept queue.
+    /// On Linux the kernel is asked over NETLINK_SOCK_DIAG for only the requested states and no
+    /// optional attributes, and the multipart reply is folded into the summary message by message.
+    /// When sock_diag is unavailable, or the active ProcFS source is not the live host (fixtures),
+    /// /proc/net/tcp and /proc/net/tcp6 are parsed instead. The netlink socket and receive buffer are
+    /// kept between calls. Not thread-safe.
+    class SocketStatsCollector {
+    public:
+        struct Options {
+            std::uint32_t states = kAllTcpStates; ///< tcpStateBit() mask of states to count
+            bool include_ipv6 = true;
+            bool use_sock_diag = true;            ///< false forces the /proc/net/tcp backend
+        };
+
+        SocketStatsCollector();
+        explicit SocketStatsCollector(Options options);
+        ~SocketStatsCollector();
+
+        SocketStatsCollector(const SocketStatsCollector&) = delete;
+        SocketStatsCollector& operator=(const SocketStatsCollector&) = delete;
+
+        /// @brief Takes a new summary into `out`, reusing its listener storage.
+        /// @throws std::runtime_error if neither backend can read the socket table.
+        void collect(SocketSummary& out);
+
+        SocketSummary collect();
+
+        /// @brief Backend used by the last collect() (the preferred one before the first call).
+        SocketBackend backend() const { return backend_; }
+
+        /// @brief Adds the sockets of one /proc/net/tcp or /proc/net/tcp6 table whose state is in `states`.
+        /// Listeners are appended unmerged; see finishListeners().
+        /// @throws std::runtime_error if a socket line is malformed.
+        static void parseProcNetTcp(std::string_view text, std::uint32_t states, SocketSummary& out);
+
+        /// @brief Sorts `out.listeners` by port and merges entries for the same port.
+        static void finishListeners(SocketSummary& out);
+
+    private:
+        bool collectSockDiag(SocketSummary& out);
+        void dumpFamily(unsigned char family, SocketSummary& out);
+        void collectProcNet(SocketSummary& out);
+
+        Options options_;
+        SocketBackend backend_;
+        int fd_ = -1;                      // NETLINK_SOCK_DIAG socket, opened on first use
+        std::uint32_t sequence_ = 0;
+        std::vector<std::uint32_t> buffer_; // Netlink receive buffer (4-byte aligned for nlmsghdr)
+        std::string text_;                  // /proc/net/tcp contents
+    };
+
+} // namespace SystemNetStats
+
+#endif // SOCKET_STATS_HPP
@@ -0,0 +1,103 @@
+#ifndef SOFTNET_STATS_HPP
+#define SOFTNET_STATS_HPP
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace SystemNetStats {
+
+    /// @brief Per-CPU packet-processing counters from /proc/net/softnet_stat.
+    /// The enumerator is the counter's index in SoftnetCPU::counters.
+    enum class SoftnetCounter : std::size_t {
+        Processed,      ///< Packets taken off the CPU's backlog and NAPI queues
+        Dropped,        ///< Packets dropped because the input backlog was full (net.core.netdev_max_backlog)
+        TimeSqueeze,    ///< NET_RX rounds that ran out of budget or time with work left (net.core.netdev_budget)
+        ReceivedRps,    ///< Times this CPU was woken by another to process RPS/RFS packets
+        FlowLimitCount, ///< Packets dropped by the per-flow limit
+        Count
+    };
+
+    constexpr std::size_t kSoftnetCounterCount = static_cast<std::size_t>(SoftnetCounter::Count);
+
+    /// @brief Snake-case name of a counter ("processed", "time_squeeze", ...).
+    const char* softnetCounterName(SoftnetCounter counter);
+
+    /// @brief One /proc/net/softnet_stat row.
+    struct SoftnetCPU {
+        unsigned cpu = 0; ///< CPU number (the row number on kernels before 5.10, which do not print it)
+        std::array<std::uint64_t, kSoftnetCounterCount> counters{}; ///< 32-bit in the kernel; they wrap
+        std::uint64_t backlog = 0; ///< Packets currently queued for the CPU (5.10+, otherwise 0)
+
+        std::uint64_t operator[](SoftnetCounter counter) const { return counters[static_cast<std::size_t>(counter)]; }
+    };
+
+    /// @brief Per-second rates of one CPU between two readings.
+    struct SoftnetCPURates {
+        unsigned cpu = 0;
+        std::array<std::uint64_t, kSoftnetCounterCount> deltas{};
+        std::array<double, kSoftnetCounterCount> per_second{};
+
+        double operator[](SoftnetCounter counter) const { return per_second[static_cast<std::size_t>(counter)]; }
+    };
+
+    /// @brief Rates between two readings of every CPU.
+    struct SoftnetRates {
+        double elapsed_seconds = 0.0;
+        std::vector<SoftnetCPURates> cpus; ///< CPUs present in both readings, ascending by CPU number
+        std::array<double, kSoftnetCounterCount> total_per_second{}; ///< Sum over `cpus`
+
+        double total(SoftnetCounter counter) const { return total_per_second[static_cast<std::size_t>(counter)]; }
+    };
+
+    /// @brief Parser for /proc/net/softnet_stat: one line per online CPU of "%08x " fields.
+    class SoftnetStatsReader {
+    public:
+        /// @brief Parses the whole file into `out`, reusing its storage. Rows are ascending by CPU.
+        /// @throws std::runtime_error if a line is not a run of eight-digit hex fields, or has
+        /// fewer than the 11 every supported kernel prints.
+        static void parse(std::string_view text, std::vector<SoftnetCPU>& out);
+
+        /// @brief Reads /proc/net/softnet_stat through the active ProcFS source.
+        /// @throws std::runtime_error if the file cannot be read or parsed.
+        static std::vector<SoftnetCPU> getSoftnetStats();
+
+    private:
+        SoftnetStatsReader() = delete;
+    };
+
+    /// @brief Samples /proc/net/softnet_stat repeatedly and derives per-CPU rates, telling apart
+    /// packets dropped because a CPU's backlog was full from NET_RX rounds cut short by the budget.
+    /// Deltas are wrap-safe for the kernel's 32-bit counters (see SystemCPUStats::counterDelta), and
+    /// CPUs are matched by number, so CPUs going offline or online are skipped for one interval.
+    /// Not thread-safe.
+    class SoftnetCollector {
+    public:
+        using Clock = std::chrono::steady_clock;
+
+        /// @brief Reads the file now. From the second sample on, rates() covers the interval since
+        /// the previous sample.
+        /// @throws std::runtime_error as SoftnetStatsReader::getSoftnetStats.
+        void sample();
+        void sample(Clock::time_point now);
+
+        const std::vector<SoftnetCPU>& current() const { return current_; }
+        bool hasRates() const { return samples_ >= 2; }
+        const SoftnetRates& rates() const { return rates_; }
+
+    private:
+        std::string buffer_;
+        std::vector<SoftnetCPU> current_;
+        std::vector<SoftnetCPU> previous_;
+        SoftnetRates rates_;
+        Clock::time_point last_time_{};
+        std::uint64_t samples_ = 0;
+    };
+
+} // namespace SystemNetStats
+
+#endif // SOFTNET_STATS_HPP
@@ -0,0 +1,187 @@
+#ifndef THREAD_STATS_HPP
+#define THREAD_STATS_HPP
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "batch_reader.hpp"
+
+namespace SystemProcessStats {
+
+    /// @brief Fields of /proc/<pid>/stat or /proc/<pid>/task/<tid>/stat. CPU times are in clock
+    /// ticks (SystemCPUStats::ticksPerSecond()).
+    struct TaskStat {
+        int pid = 0;                  ///< Process id, or thread id for a task file
+        std::string comm;             ///< Command or thread name (parentheses removed)
+        char state = '?';             ///< R, S, D, Z, T, ...
+        int ppid = 0;
+        std::uint64_t utime = 0;
+        std::uint64_t stime = 0;
+        std::uint64_t num_threads = 0;
+        std::uint64_t start_time = 0; ///< Ticks after boot; tells a reused id from the original task
+        std::uint64_t rss_pages = 0;
+        int processor = -1;           ///< CPU the task last ran on
+    };
+
+    /// @brief Parser for the /proc/<pid>/stat line format.
+    class TaskStatReader {
+    public:
+        /// @brief Parses one stat line into `out`, reusing the capacity of `out.comm`. The name is
+        /// taken up to the last ')', as it may itself hold spaces and parentheses.
+        /// @throws std::runtime_error if the line is malformed.
+        static void parse(std::string_view text, TaskStat& out);
+
+    private:
+        TaskStatReader() = delete;
+    };
+
+    /// @brief CPU use of one thread over an interval, in percent of one CPU.
+    struct ThreadUsage {
+        int pid = 0;
+        int tid = 0;
+        std::string name;
+        char state = '?';
+        int processor = -1;
+        double cpu_percent = 0.0;    ///< user + system; 100 = one CPU kept busy
+        double user_percent = 0.0;
+        double system_percent = 0.0;
+    };
+
+    /// @brief Threads of one tracked process over an interval.
+    struct ProcessThreads {
+        int pid = 0;
+        std::vector<ThreadUsage> threads; ///< Threads seen in both samples, ascending by tid
+        double cpu_percent = 0.0;         ///< Sum over `threads`
+        std::size_t new_threads = 0;      ///< Threads that appeared this sample (reported from the next one)
+    };
+
+    /// @brief Work done by a ThreadCollector, for judging its cost.
+    struct ThreadCollectorStats {
+        std::uint64_t directory_scans = 0; ///< Task directory listings
+        std::uint64_t opens = 0;           ///< Thread stat files opened
+        std::uint64_t reads = 0;           ///< Thread stat files read
+        std::uint64_t threads_added = 0;
+        std::uint64_t threads_removed = 0;
+        std::size_t open_files = 0;        ///< Descriptors held now
+    };
+
+    /// @brief Samples every thread of a set of tracked processes and reports per-thread CPU use, to
+    /// find a single saturated thread (an event loop, a GC thread) that process totals hide.
+    ///
+    /// Each process keeps its /proc/<pid>/task directory open, and each thread its stat file in a
+    /// BatchFileReader, which re-reads all of them in one batch per sample. A sample lists the task
+    /// directories and merges them with the known, tid-sorted threads, so only threads that appeared
+    /// are opened and only those that exited are closed. Past `max_open_files` descriptors further
+    /// threads are opened and closed on every read instead. Sources without on-disk files (e.g.
+    /// VirtualProcSource) are read through ProcFS. Tracked processes that exit are untracked at the
+    /// next sample. Not thread-safe.
+    class ThreadCollector {
+    public:
+        using Clock = std::chrono::steady_clock;
+
+        struct Options {
+            std::size_t max_open_files = 4096; ///< Thread stat descriptors kept open, over all processes
+        };
+
+        ThreadCollector();
+        explicit ThreadCollector(Options options);
+        ~ThreadCollector();
+
+        ThreadCollector(const ThreadCollector&) = delete;
+        ThreadCollector& operator=(const ThreadCollector&) = delete;
+
+        /// @brief Adds a process; its threads are reported from the second sample on.
+        void track(int pid);
+        void untrack(int pid);
+        std::vector<int> tracked() const;
+
+        /// @brief Scans and reads every thread of every tracked process now. From the second sample
+        /// on, usage() covers the interval since the previous sample.
+        /// @throws std::runtime_error if a stat file is malformed.
+        void sample();
+        void sample(Clock::time_point now);
+
+        bool hasRates() const { return samples_ >= 2; }
+
+        /// @brief Per-process thread usage, in tracking order.
+        const std::vector<ProcessThreads>& usage() const { return usage_; }
+
+        /// @brief The `count` busiest threads over all tracked processes, busiest first.
+        std::vector<ThreadUsage> hottest(std::size_t count) const;
+
+        ThreadCollectorStats stats() const;
+
+    private:
+        // A thread's stat file in reader_, removed from it when destroyed. Moving clears the source.
+        struct StatFile {
+            SystemProcFS::BatchFileReader* reader = nullptr; // nullptr when no file is held
+            std::size_t index = 0;
+
+            StatFile() = default;
+            StatFile(SystemProcFS::BatchFileReader& owner, std::size_t file) : reader(&owner), index(file) {}
+            StatFile(const StatFile&) = delete;
+            StatFile& operator=(const StatFile&) = delete;
+            StatFile(StatFile&& other) noexcept : reader(other.reader), index(other.index) { other.reader = nullptr; }
+            StatFile& operator=(StatFile&& other) noexcept {
+                if (this != &other) {
+                    reset();
+                    reader = other.reader;
+                    index = other.index;
+                    other.reader = nullptr;
+                }
+                return *this;
+            }
+            ~StatFile() { reset(); }
+
+            void reset() {
+                if (reader != nullptr) reader->remove(index);
+                reader = nullptr;
+            }
+        };
+
+        // Closes a DIR* (defined in the source, which has <dirent.h>).
+        struct DirectoryCloser {
+            void operator()(void* directory) const;
+        };
+
+        struct Thread {
+            int tid = 0;
+            StatFile file;               // None after a failed read
+            TaskStat previous;
+            TaskStat current;
+            TaskStat next;               // Read this sample, not yet committed
+            bool fresh = true;           // Not read in an earlier sample yet
+            bool read = false;           // `next` holds this sample's reading
+        };
+
+        struct Process {
+            int pid = 0;
+            std::unique_ptr<void, DirectoryCloser> directory; // DIR* of the open task directory; null when
+                                                              // listed by path
+            std::vector<Thread> threads; // Ascending by tid
+            bool exited = false;         // Found gone by this sample's scan
+        };
+
+        bool scan(Process& process);
+        void openThread(const Process& process, Thread& thread);
+        bool readThread(Thread& thread);
+
+        Options options_;
+        SystemProcFS::BatchFileReader reader_;
+        std::vector<Process> processes_;
+        std::vector<int> tids_;          // Scratch: the task directory listing
+        std::vector<Thread> merged_;     // Scratch for the merge
+        std::vector<ProcessThreads> usage_;
+        ThreadCollectorStats stats_;
+        Clock::time_point last_time_{};
+        std::uint64_t samples_ = 0;
+    };
+
+} // namespace SystemProcessStats
+
+#endif // THREAD_STATS_HPP
@@ -11,6 +11,29 @@ ext_modules = [
             "src/mem_stats.cpp",
             "src/disk_stats.cpp",
             "src/net_stats.cpp",
+            "src/logger.cpp",
+            "src/proc_source.cpp",
+            "src/metrics_snapshot.cpp",
+            "src/prometheus_exporter.cpp",
+            "src/snapshot_codec.cpp",
+            "src/ring_log.cpp",
+            "src/forwarder.cpp",
+            "src/shm_snapshot.cpp",
+            "src/name_index.cpp",
+            "src/proc_parse.cpp",
+            "src/collection_arena.cpp",
+            "src/simd_scan.cpp",
+            "src/batch_reader.cpp",
+            "src/interrupt_stats.cpp",
+            "src/protocol_stats.cpp",
+            "src/socket_stats.cpp",
+            "src/softnet_stats.cpp",
+            "src/fs_stats.cpp",
+            "src/numa_stats.cpp",
+            "src/sched_stats.cpp",
+            "src/container_stats.cpp",
+            "src/thread_stats.cpp",
+            "src/process_tree.cpp",
         ],
         include_dirs=[
             pybind11.get_include(),
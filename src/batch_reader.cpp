@@ -0,0 +1,423 @@
+#include "batch_reader.hpp"
+#include "proc_source.hpp" // For resolving logical paths
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+#if defined(__linux__) && defined(__has_include)
+#if __has_include(<linux/io_uring.h>)
+#define METRICS_AGENT_HAVE_IO_URING 1
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#endif
+#endif
+
+namespace SystemProcFS {
+
+#if defined(METRICS_AGENT_HAVE_IO_URING)
+
+// Minimal io_uring driver over the raw syscalls: one submission queue of read requests and the
+// matching completion queue, plus registration of the file table and the slot slab.
+class BatchFileReader::Ring {
+public:
+    // Returns nullptr when the kernel (or a seccomp policy) does not offer io_uring.
+    static std::unique_ptr<Ring> create(unsigned entries) {
+        io_uring_params params;
+        std::memset(&params, 0, sizeof(params));
+        const int fd = static_cast<int>(::syscall(__NR_io_uring_setup, entries, &params));
+        if (fd < 0) return nullptr;
+        std::unique_ptr<Ring> ring(new Ring(fd));
+        if (!ring->map(params)) return nullptr;
+        return ring;
+    }
+
+    ~Ring() {
+        if (sqes_ != nullptr) ::munmap(sqes_, sqes_size_);
+        if (cq_ptr_ != nullptr && cq_ptr_ != sq_ptr_) ::munmap(cq_ptr_, cq_size_);
+        if (sq_ptr_ != nullptr) ::munmap(sq_ptr_, sq_size_);
+        ::close(fd_);
+    }
+
+    unsigned capacity() const { return sq_entries_; }
+
+    // Registers `fds` as the fixed file table, replacing any previous one.
+    bool registerFiles(const std::vector<int>& fds) {
+        if (files_registered_) {
+            ::syscall(__NR_io_uring_register, fd_, IORING_UNREGISTER_FILES, nullptr, 0);
+            files_registered_ = false;
+        }
+        if (fds.empty()) return false;
+        files_registered_ = ::syscall(__NR_io_uring_register, fd_, IORING_REGISTER_FILES, fds.data(),
+                                      static_cast<unsigned>(fds.size())) == 0;
+        return files_registered_;
+    }
+
+    // Registers [base, base + length) as fixed buffer 0, replacing any previous registration.
+    bool registerBuffer(void* base, std::size_t length) {
+        if (buffer_registered_) {
+            ::syscall(__NR_io_uring_register, fd_, IORING_UNREGISTER_BUFFERS, nullptr, 0);
+            buffer_registered_ = false;
+        }
+        iovec region{base, length};
+        buffer_registered_ = ::syscall(__NR_io_uring_register, fd_, IORING_REGISTER_BUFFERS, &region, 1) == 0;
+        return buffer_registered_;
+    }
+
+    bool filesRegistered() const { return files_registered_; }
+    bool bufferRegistered() const { return buffer_registered_; }
+
+    // Queues a read of `length` bytes at offset 0. The caller keeps the number queued within capacity().
+    void prepareRead(int fd, bool fixed_file, char* buffer, unsigned length, std::uint64_t user_data) {
+        const unsigned tail = *sq_tail_;
+        const unsigned slot = tail & *sq_mask_;
+        io_uring_sqe& sqe = sqes_[slot];
+        std::memset(&sqe, 0, sizeof(sqe));
+        sqe.opcode = buffer_registered_ ? IORING_OP_READ_FIXED : IORING_OP_READ;
+        sqe.flags = fixed_file ? IOSQE_FIXED_FILE : 0;
+        sqe.fd = fd;
+        sqe.off = 0;
+        sqe.addr = reinterpret_cast<std::uint64_t>(buffer);
+        sqe.len = length;
+        sqe.buf_index = 0;
+        sqe.user_data = user_data;
+        sq_array_[slot] = slot;
+        __atomic_store_n(sq_tail_, tail + 1, __ATOMIC_RELEASE);
+    }
+
+    // Submits everything queued and waits for `wait_for` completions.
+    // @return The number of io_uring_enter calls made, or -1 on failure.
+    int submitAndWait(unsigned to_submit, unsigned wait_for) {
+        int calls = 0;
+        while (to_submit > 0 || wait_for > ready()) {
+            const long submitted = ::syscall(__NR_io_uring_enter, fd_, to_submit, wait_for, IORING_ENTER_GETEVENTS, nullptr, 0);
+            ++calls;
+            if (submitted < 0) {
+                if (errno == EINTR) continue;
+                return -1;
+            }
+            to_submit -= std::min<unsigned>(to_submit, static_cast<unsigned>(submitted));
+        }
+        return calls;
+    }
+
+    // Hands every available completion to `on_complete(user_data, result)`.
+    template <typename OnComplete>
+    unsigned reap(OnComplete on_complete) {
+        unsigned head = *cq_head_;
+        const unsigned tail = __atomic_load_n(cq_tail_, __ATOMIC_ACQUIRE);
+        unsigned count = 0;
+        for (; head != tail; ++head, ++count) {
+            const io_uring_cqe& cqe = cqes_[head & *cq_mask_];
+            on_complete(cqe.user_data, cqe.res);
+        }
+        __atomic_store_n(cq_head_, head, __ATOMIC_RELEASE);
+        return count;
+    }
+
+private:
+    explicit Ring(int fd) : fd_(fd) {}
+
+    unsigned ready() const { return __atomic_load_n(cq_tail_, __ATOMIC_ACQUIRE) - *cq_head_; }
+
+    bool map(const io_uring_params& params) {
+        sq_size_ = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+        cq_size_ = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+        const bool single_mmap = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+        if (single_mmap) sq_size_ = cq_size_ = std::max(sq_size_, cq_size_);
+
+        sq_ptr_ = ::mmap(nullptr, sq_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd_, IORING_OFF_SQ_RING);
+        if (sq_ptr_ == MAP_FAILED) { sq_ptr_ = nullptr; return false; }
+        if (single_mmap) {
+            cq_ptr_ = sq_ptr_;
+        } else {
+            cq_ptr_ = ::mmap(nullptr, cq_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd_, IORING_OFF_CQ_RING);
+            if (cq_ptr_ == MAP_FAILED) { cq_ptr_ = nullptr; return false; }
+        }
+        sqes_size_ = params.sq_entries * sizeof(io_uring_sqe);
+        void* sqes = ::mmap(nullptr, sqes_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd_, IORING_OFF_SQES);
+        if (sqes == MAP_FAILED) return false;
+        sqes_ = static_cast<io_uring_sqe*>(sqes);
+
+        char* sq = static_cast<char*>(sq_ptr_);
+        char* cq = static_cast<char*>(cq_ptr_);
+        sq_tail_ = reinterpret_cast<unsigned*>(sq + params.sq_off.tail);
+        sq_mask_ = reinterpret_cast<unsigned*>(sq + params.sq_off.ring_mask);
+        sq_array_ = reinterpret_cast<unsigned*>(sq + params.sq_off.array);
+        cq_head_ = reinterpret_cast<unsigned*>(cq + params.cq_off.head);
+        cq_tail_ = reinterpret_cast<unsigned*>(cq + params.cq_off.tail);
+        cq_mask_ = reinterpret_cast<unsigned*>(cq + params.cq_off.ring_mask);
+        cqes_ = reinterpret_cast<io_uring_cqe*>(cq + params.cq_off.cqes);
+        sq_entries_ = params.sq_entries;
+        return true;
+    }
+
+    int fd_;
+    void* sq_ptr_ = nullptr;
+    void* cq_ptr_ = nullptr;
+    std::size_t sq_size_ = 0;
+    std::size_t cq_size_ = 0;
+    io_uring_sqe* sqes_ = nullptr;
+    std::size_t sqes_size_ = 0;
+    unsigned* sq_tail_ = nullptr;
+    unsigned* sq_mask_ = nullptr;
+    unsigned* sq_array_ = nullptr;
+    unsigned* cq_head_ = nullptr;
+    unsigned* cq_tail_ = nullptr;
+    unsigned* cq_mask_ = nullptr;
+    io_uring_cqe* cqes_ = nullptr;
+    unsigned sq_entries_ = 0;
+    bool files_registered_ = false;
+    bool buffer_registered_ = false;
+};
+
+#else
+
+class BatchFileReader::Ring {};
+
+#endif // METRICS_AGENT_HAVE_IO_URING
+
+// --- BatchFileReader ---
+
+BatchFileReader::BatchFileReader() : BatchFileReader(Options()) {}
+
+BatchFileReader::BatchFileReader(Options options) : options_(options) {
+    if (options_.slot_size == 0) throw std::invalid_argument("BatchFileReader slot_size must be positive");
+    if (options_.queue_depth == 0) throw std::invalid_argument("BatchFileReader queue_depth must be positive");
+#if defined(METRICS_AGENT_HAVE_IO_URING)
+    if (options_.use_io_uring) ring_ = Ring::create(options_.queue_depth);
+#endif
+}
+
+BatchFileReader::~BatchFileReader() {
+    ring_.reset(); // Drops the ring's references to the registered files first
+#if defined(__unix__) || defined(__APPLE__)
+    for (const File& file : files_) {
+        if (file.fd >= 0) ::close(file.fd);
+    }
+#endif
+}
+
+std::size_t BatchFileReader::add(std::string_view path) {
+    File file;
+    file.path = std::string(path);
+    file.used = true;
+#if defined(__unix__) || defined(__APPLE__)
+    file.resolved = ProcFS::resolvePath(path);
+    if (!file.resolved.empty() && stats_.open_files < options_.max_open_files) {
+        file.fd = ::open(file.resolved.c_str(), O_RDONLY | O_CLOEXEC);
+        ++stats_.syscalls;
+        ++stats_.opens;
+        if (file.fd >= 0) ++stats_.open_files;
+    }
+#endif
+    if (file.fd >= 0) ring_dirty_ = true;
+
+    if (!free_.empty()) {
+        const std::size_t index = free_.back();
+        free_.pop_back();
+        files_[index] = std::move(file);
+        return index;
+    }
+    files_.push_back(std::move(file));
+    if (files_.size() > slab_slots_) {
+        slab_slots_ = std::max<std::size_t>(16, slab_slots_ * 2);
+        slab_.reset(new char[slab_slots_ * options_.slot_size]);
+        for (File& existing : files_) {
+            if (!existing.resolved.empty() && existing.overflow.empty()) { // Old slot contents are gone
+                existing.ok = false;
+                existing.length = 0;
+            }
+        }
+        ring_dirty_ = true;
+    }
+    return files_.size() - 1;
+}
+
+void BatchFileReader::remove(std::size_t index) {
+    file(index); // Throws for an index that is not registered
+    File& removed = files_[index];
+#if defined(__unix__) || defined(__APPLE__)
+    if (removed.fd >= 0) {
+        ::close(removed.fd);
+        --stats_.open_files;
+        ring_dirty_ = true; // The ring keeps its own reference until the table is registered again
+    }
+#endif
+    removed = File();
+    free_.push_back(index);
+}
+
+std::size_t BatchFileReader::size() const {
+    return files_.size() - free_.size();
+}
+
+std::size_t BatchFileReader::readAll() {
+    ++stats_.batches;
+    if (!ring_ || !readWithRing()) {
+        for (std::size_t i = 0; i < files_.size(); ++i) {
+            if (files_[i].used) readSlot(files_[i], i);
+        }
+    }
+    return static_cast<std::size_t>(std::count_if(files_.begin(), files_.end(), [](const File& f) { return f.ok; }));
+}
+
+bool BatchFileReader::readWithRing() {
+#if defined(METRICS_AGENT_HAVE_IO_URING)
+    if (ring_dirty_) {
+        std::vector<int> fds;
+        for (File& file : files_) {
+            file.registered = file.fd >= 0 ? static_cast<int>(fds.size()) : -1;
+            if (file.fd >= 0) fds.push_back(file.fd);
+        }
+        ring_->registerFiles(fds);
+        ring_->registerBuffer(slab_.get(), slab_slots_ * options_.slot_size);
+        stats_.syscalls += 2;
+        ring_dirty_ = false;
+    }
+
+    const bool fixed_files = ring_->filesRegistered();
+    auto on_complete = [this](std::uint64_t index, int result) {
+        completeSlot(files_[index], result);
+    };
+    std::size_t next = 0;
+    while (next < files_.size()) {
+        unsigned queued = 0;
+        for (; next < files_.size() && queued < ring_->capacity(); ++next) {
+            File& file = files_[next];
+            if (!file.used) continue;
+            if (file.fd < 0) {
+                readSlot(file, next); // Not on disk or not kept open
+                continue;
+            }
+            ring_->prepareRead(fixed_files ? file.registered : file.fd, fixed_files,
+                               slab_.get() + next * options_.slot_size, static_cast<unsigned>(options_.slot_size), next);
+            ++queued;
+        }
+        if (queued == 0) break;
+        const int calls = ring_->submitAndWait(queued, queued);
+        if (calls < 0) {
+            // The ring is unusable (e.g. forbidden after setup); this and later batches use pread.
+            ring_.reset();
+            return false;
+        }
+        stats_.syscalls += static_cast<std::uint64_t>(calls);
+        ring_->reap(on_complete);
+    }
+    return true;
+#else
+    return false;
+#endif
+}
+
+void BatchFileReader::readSlot(File& file, std::size_t index) {
+    if (file.resolved.empty()) {
+        ++stats_.reads;
+        file.ok = ProcFS::readFile(file.path, file.overflow);
+        file.length = file.ok ? file.overflow.size() : 0;
+        if (!file.ok) ++stats_.failures;
+        return;
+    }
+#if defined(__unix__) || defined(__APPLE__)
+    const bool transient = file.fd < 0; // Past max_open_files, or the open failed when added
+    if (transient) {
+        file.fd = ::open(file.resolved.c_str(), O_RDONLY | O_CLOEXEC);
+        ++stats_.syscalls;
+        ++stats_.opens;
+        if (file.fd < 0) {
+            completeSlot(file, -errno);
+            return;
+        }
+    }
+    const ssize_t result = ::pread(file.fd, slab_.get() + index * options_.slot_size, options_.slot_size, 0);
+    ++stats_.syscalls;
+    completeSlot(file, result < 0 ? -errno : static_cast<long>(result));
+    if (transient) {
+        ::close(file.fd);
+        ++stats_.syscalls;
+        file.fd = -1;
+    }
+#else
+    (void)index;
+#endif
+}
+
+void BatchFileReader::completeSlot(File& file, long result) {
+    ++stats_.reads;
+    file.overflow.clear();
+    if (result < 0) {
+        file.ok = false;
+        file.length = 0;
+        ++stats_.failures;
+        return;
+    }
+    file.ok = true;
+    file.length = static_cast<std::size_t>(result);
+#if defined(__unix__) || defined(__APPLE__)
+    if (file.length == options_.slot_size) {
+        // The slot may have truncated the file: re-read it whole from offset 0 into a growing buffer.
+        ++stats_.overflows;
+        std::size_t capacity = options_.slot_size * 2;
+        while (true) {
+            file.overflow.resize(capacity);
+            const ssize_t n = ::pread(file.fd, &file.overflow[0], capacity, 0);
+            ++stats_.syscalls;
+            if (n < 0) {
+                file.ok = false;
+                file.length = 0;
+                file.overflow.clear();
+                ++stats_.failures;
+                return;
+            }
+            if (static_cast<std::size_t>(n) < capacity) {
+                file.overflow.resize(static_cast<std::size_t>(n));
+                file.length = file.overflow.size();
+                break;
+            }
+            capacity *= 2;
+        }
+    }
+#endif
+}
+
+const BatchFileReader::File& BatchFileReader::file(std::size_t index) const {
+    if (index >= files_.size() || !files_[index].used) throw std::out_of_range("BatchFileReader: no file at index " + std::to_string(index));
+    return files_[index];
+}
+
+std::string_view BatchFileReader::contents(std::size_t index) const {
+    const File& f = file(index);
+    if (!f.ok) return std::string_view();
+    if (f.resolved.empty() || !f.overflow.empty()) return f.overflow;
+    return std::string_view(slab_.get() + index * options_.slot_size, f.length);
+}
+
+bool BatchFileReader::ok(std::size_t index) const {
+    return file(index).ok;
+}
+
+BatchBackend BatchFileReader::backend() const {
+    return ring_ ? BatchBackend::IoUring : BatchBackend::Pread;
+}
+
+BatchReaderStats BatchFileReader::stats() const {
+    return stats_;
+}
+
+const char* batchBackendName(BatchBackend backend) {
+    switch (backend) {
+        case BatchBackend::IoUring: return "io_uring";
+        case BatchBackend::Pread: return "pread";
+    }
+    return "unknown";
+}
+
+} // namespace SystemProcFS
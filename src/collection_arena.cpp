@@ -0,0 +1,91 @@
+#include "collection_arena.hpp"
+
+#include <algorithm>
+
+namespace SystemMetricsArena {
+
+namespace { // Anonymous namespace for internal helpers
+constexpr std::size_t kMinCapacity = 4096;
+constexpr std::size_t kBlockAlignment = alignof(std::max_align_t);
+
+std::size_t roundUpToPowerOfTwo(std::size_t n) {
+    std::size_t p = kMinCapacity;
+    while (p < n) p <<= 1;
+    return p;
+}
+} // namespace
+
+// --- CountingResource ---
+
+void* CollectionArena::CountingResource::do_allocate(std::size_t bytes, std::size_t alignment) {
+    void* p = arena_.monotonic_->allocate(bytes, alignment);
+    arena_.stats_.bytes_in_use += bytes;
+    arena_.stats_.high_water_mark = std::max(arena_.stats_.high_water_mark, arena_.stats_.bytes_in_use);
+    return p;
+}
+
+void CollectionArena::CountingResource::do_deallocate(void* p, std::size_t bytes, std::size_t alignment) {
+    // Memory is only reclaimed by reset(); forwarding keeps the monotonic resource's contract.
+    arena_.monotonic_->deallocate(p, bytes, alignment);
+}
+
+bool CollectionArena::CountingResource::do_is_equal(const std::pmr::memory_resource& other) const noexcept {
+    return this == &other;
+}
+
+// --- UpstreamResource ---
+
+void* CollectionArena::UpstreamResource::do_allocate(std::size_t bytes, std::size_t alignment) {
+    ++arena_.stats_.upstream_allocations;
+    return upstream_->allocate(bytes, alignment);
+}
+
+void CollectionArena::UpstreamResource::do_deallocate(void* p, std::size_t bytes, std::size_t alignment) {
+    upstream_->deallocate(p, bytes, alignment);
+}
+
+bool CollectionArena::UpstreamResource::do_is_equal(const std::pmr::memory_resource& other) const noexcept {
+    return this == &other;
+}
+
+// --- CollectionArena ---
+
+CollectionArena::CollectionArena(std::size_t initial_capacity, std::pmr::memory_resource* upstream)
+    : upstream_(upstream ? upstream : std::pmr::new_delete_resource()),
+      upstream_counter_(*this, upstream_),
+      counter_(*this) {
+    allocateBlock(roundUpToPowerOfTwo(initial_capacity));
+}
+
+CollectionArena::~CollectionArena() {
+    monotonic_.reset();
+    upstream_->deallocate(block_, capacity_, kBlockAlignment);
+}
+
+void CollectionArena::allocateBlock(std::size_t capacity) {
+    monotonic_.reset(); // Releases any overflow blocks
+    if (block_ != nullptr) {
+        upstream_->deallocate(block_, capacity_, kBlockAlignment);
+    }
+    block_ = upstream_->allocate(capacity, kBlockAlignment);
+    capacity_ = capacity;
+    stats_.capacity = capacity;
+    monotonic_.emplace(block_, capacity_, &upstream_counter_);
+}
+
+void CollectionArena::reset() {
+    ++stats_.cycles;
+    if (stats_.bytes_in_use > capacity_) {
+        // The cycle overflowed; size the block so that the next one fits, with room for alignment padding.
+        allocateBlock(roundUpToPowerOfTwo(stats_.bytes_in_use + stats_.bytes_in_use / 8));
+    } else {
+        monotonic_->release();
+    }
+    stats_.bytes_in_use = 0;
+}
+
+ArenaStats CollectionArena::stats() const {
+    return stats_;
+}
+
+} // namespace SystemMetricsArena
@@ -0,0 +1,410 @@
+#include "container_stats.hpp"
+#include "cpu_stats.hpp"
+#include "key_value_reader.hpp"
+#include "mem_stats.hpp"
+#include "numa_stats.hpp"
+#include "proc_parse.hpp"
+#include "proc_source.hpp"
+#include "simd_scan.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <thread>
+
+namespace SystemContainerStats {
+
+namespace { // Anonymous namespace for internal helpers
+
+// cgroup v1 reports "no limit" as PAGE_COUNTER_MAX pages, just under 2^63 bytes.
+constexpr std::uint64_t kV1Unlimited = 1ULL << 62;
+
+struct CpuStat {
+    unsigned long long usage_usec = 0;     // v2 only
+    unsigned long long nr_periods = 0;
+    unsigned long long nr_throttled = 0;
+    unsigned long long throttled_usec = 0; // v2
+    unsigned long long throttled_time = 0; // v1, in ns
+};
+
+struct CpuStatV2Schema {
+    using Record = CpuStat;
+    static constexpr std::string_view name = "cpu.stat";
+    static constexpr char separator = ' ';
+    static constexpr std::string_view unit = "";
+    static constexpr SystemProcFS::KeyField<CpuStat> fields[] = {
+        {"usage_usec", &CpuStat::usage_usec},
+        {"nr_periods", &CpuStat::nr_periods},
+        {"nr_throttled", &CpuStat::nr_throttled},
+        {"throttled_usec", &CpuStat::throttled_usec},
+    };
+};
+
+struct CpuStatV1Schema {
+    using Record = CpuStat;
+    static constexpr std::string_view name = "cpu.stat";
+    static constexpr char separator = ' ';
+    static constexpr std::string_view unit = "";
+    static constexpr SystemProcFS::KeyField<CpuStat> fields[] = {
+        {"nr_periods", &CpuStat::nr_periods},
+        {"nr_throttled", &CpuStat::nr_throttled},
+        {"throttled_time", &CpuStat::throttled_time},
+    };
+};
+
+struct MemoryStat {
+    unsigned long long inactive_file = 0;
+};
+
+struct MemoryStatV2Schema {
+    using Record = MemoryStat;
+    static constexpr std::string_view name = "memory.stat";
+    static constexpr char separator = ' ';
+    static constexpr std::string_view unit = "";
+    static constexpr SystemProcFS::KeyField<MemoryStat> fields[] = {
+        {"inactive_file", &MemoryStat::inactive_file},
+    };
+};
+
+// v1 "total_" keys include descendant cgroups, like every v2 key.
+struct MemoryStatV1Schema {
+    using Record = MemoryStat;
+    static constexpr std::string_view name = "memory.stat";
+    static constexpr char separator = ' ';
+    static constexpr std::string_view unit = "";
+    static constexpr SystemProcFS::KeyField<MemoryStat> fields[] = {
+        {"total_inactive_file", &MemoryStat::inactive_file},
+    };
+};
+
+std::string_view trim(std::string_view text) {
+    const std::size_t begin = text.find_first_not_of(" \t\n");
+    if (begin == std::string_view::npos) return std::string_view();
+    return text.substr(begin, text.find_last_not_of(" \t\n") + 1 - begin);
+}
+
+bool hasOption(std::string_view options, std::string_view option) {
+    while (!options.empty()) {
+        const std::size_t comma = options.find(',');
+        if (options.substr(0, comma) == option) return true;
+        if (comma == std::string_view::npos) break;
+        options.remove_prefix(comma + 1);
+    }
+    return false;
+}
+
+// Directory of `cgroup` (a /proc/self/cgroup path) within a hierarchy mounted at `mount`.
+std::string cgroupDirectory(const SystemDiskStats::MountEntry& mount, std::string_view cgroup) {
+    // A mount of a subtree (root "/docker/<id>" without a cgroup namespace) shows paths below it.
+    if (mount.root != "/" && cgroup.compare(0, mount.root.size(), mount.root) == 0) cgroup.remove_prefix(mount.root.size());
+    else if (mount.root != "/") cgroup = "/";
+    if (cgroup.empty() || cgroup == "/") return mount.mount_point;
+    return mount.mount_point + std::string(cgroup);
+}
+
+// The nearest ancestor of `dir` (itself included) holding `marker`. A cgroup path taken from the
+// host's view may not exist in the container's mount; its closest visible ancestor is then the
+// container's own cgroup.
+std::string nearestWith(std::string dir, std::string_view marker) {
+    while (!dir.empty()) {
+        const std::vector<std::string> entries = SystemProcFS::ProcFS::listDirectory(dir);
+        if (std::find(entries.begin(), entries.end(), marker) != entries.end()) return dir;
+        const std::size_t slash = dir.rfind('/');
+        if (slash == std::string::npos || slash == 0) break;
+        dir.resize(slash);
+    }
+    return std::string();
+}
+
+// Reads a file holding one decimal number. Returns false if the file is missing.
+bool readNumber(const std::string& path, std::string& buffer, std::uint64_t& value) {
+    if (path.empty() || !SystemProcFS::ProcFS::readFile(path, buffer)) return false;
+    const std::string_view text = trim(buffer);
+    if (!SystemProcFS::parseDecimal(text, value)) throw std::runtime_error("Malformed " + path + ": " + buffer);
+    return true;
+}
+
+void readRequired(const std::string& path, std::string& buffer, std::uint64_t& value) {
+    if (!readNumber(path, buffer, value)) throw std::runtime_error("Failed to read " + path + ".");
+}
+
+// Appends a file to the limits text, marking missing files so that appearing or vanishing counts
+// as a change.
+void appendFile(const std::string& path, std::string& buffer, std::string& out) {
+    if (!path.empty() && SystemProcFS::ProcFS::readFile(path, buffer)) out += buffer;
+    else out += "<missing>";
+    out += '\0';
+}
+
+// Splits the limits text back into its files, in append order.
+std::string_view nextSection(std::string_view& text) {
+    const std::size_t end = text.find('\0');
+    const std::string_view section = text.substr(0, end);
+    text = end == std::string_view::npos ? std::string_view() : text.substr(end + 1);
+    return section == "<missing>" ? std::string_view() : section;
+}
+
+unsigned countCpus(std::string_view list) {
+    return static_cast<unsigned>(SystemNumaStats::NumaTopology::parseCpuList(list).size());
+}
+
+} // namespace
+
+const char* cgroupVersionName(CgroupVersion version) {
+    switch (version) {
+        case CgroupVersion::None: return "none";
+        case CgroupVersion::V1: return "v1";
+        case CgroupVersion::V2: return "v2";
+    }
+    return "unknown";
+}
+
+// --- CgroupResolver ---
+
+CgroupPaths CgroupResolver::parse(std::string_view proc_self_cgroup,
+                                  const std::vector<SystemDiskStats::MountEntry>& mounts) {
+    CgroupPaths paths;
+    std::string unified;
+    std::string_view line;
+    while (SystemProcFS::nextLine(proc_self_cgroup, line)) {
+        if (line.empty()) continue;
+        // "hierarchy-id:controller-list:cgroup-path"; the path may itself contain ':'.
+        const std::size_t first = line.find(':');
+        const std::size_t second = first == std::string_view::npos ? first : line.find(':', first + 1);
+        if (second == std::string_view::npos) throw std::runtime_error("Malformed /proc/self/cgroup line: " + std::string(line));
+        const std::string_view controllers = line.substr(first + 1, second - first - 1);
+        const std::string_view cgroup = line.substr(second + 1);
+
+        if (line.compare(0, first, "0") == 0 && controllers.empty()) {
+            for (const auto& mount : mounts) {
+                if (mount.fs_type != "cgroup2") continue;
+                unified = cgroupDirectory(mount, cgroup);
+                break;
+            }
+            continue;
+        }
+        for (const auto& mount : mounts) {
+            if (mount.fs_type != "cgroup") continue;
+            // The hierarchy whose mount options name the same controllers.
+            std::string_view wanted = controllers;
+            bool matches = !wanted.empty();
+            while (matches && !wanted.empty()) {
+                const std::size_t comma = wanted.find(',');
+                matches = hasOption(mount.super_options, wanted.substr(0, comma));
+                wanted = comma == std::string_view::npos ? std::string_view() : wanted.substr(comma + 1);
+            }
+            if (!matches) continue;
+            const std::string dir = cgroupDirectory(mount, cgroup);
+            if (hasOption(controllers, "cpu")) paths.cpu = dir;
+            if (hasOption(controllers, "cpuacct")) paths.cpuacct = dir;
+            if (hasOption(controllers, "cpuset")) paths.cpuset = dir;
+            if (hasOption(controllers, "memory")) paths.memory = dir;
+            break;
+        }
+    }
+    if (!paths.cpu.empty() || !paths.cpuacct.empty() || !paths.memory.empty()) {
+        paths.version = CgroupVersion::V1;
+    } else if (!unified.empty()) {
+        paths.version = CgroupVersion::V2;
+        paths.cpu = paths.cpuacct = paths.cpuset = paths.memory = unified;
+    }
+    return paths;
+}
+
+CgroupPaths CgroupResolver::resolve() {
+    std::string cgroup, mountinfo;
+    if (!SystemProcFS::ProcFS::readFile("/proc/self/cgroup", cgroup)) {
+        throw std::runtime_error("Failed to read /proc/self/cgroup.");
+    }
+    if (!SystemProcFS::ProcFS::readFile("/proc/self/mountinfo", mountinfo)) {
+        throw std::runtime_error("Failed to read /proc/self/mountinfo.");
+    }
+    std::vector<SystemDiskStats::MountEntry> mounts;
+    SystemDiskStats::MountInfoReader::parse(mountinfo, mounts);
+    CgroupPaths paths = parse(cgroup, mounts);
+    if (paths.version == CgroupVersion::V2) {
+        paths.cpu = nearestWith(paths.cpu, "cgroup.controllers");
+        paths.cpuacct = paths.cpuset = paths.memory = paths.cpu;
+    } else if (paths.version == CgroupVersion::V1) {
+        paths.cpu = nearestWith(paths.cpu, "cpu.cfs_quota_us");
+        paths.cpuacct = nearestWith(paths.cpuacct, "cpuacct.usage");
+        paths.cpuset = nearestWith(paths.cpuset, "cpuset.cpus");
+        paths.memory = nearestWith(paths.memory, "memory.usage_in_bytes");
+    }
+    return paths;
+}
+
+// --- ContainerCollector ---
+
+ContainerCollector::ContainerCollector() : ContainerCollector(Options()) {}
+
+ContainerCollector::ContainerCollector(Options options) : options_(options) {}
+
+void ContainerCollector::sample() {
+    sample(Clock::now());
+}
+
+void ContainerCollector::sample(Clock::time_point now) {
+    if (samples_ == 0 || now - limits_time_ >= options_.limits_refresh) refreshLimits(now);
+    CgroupCounters counters;
+    readCounters(counters);
+    previous_ = current_;
+    current_ = counters;
+    ++samples_;
+    const Clock::time_point previous_time = last_time_;
+    last_time_ = now;
+    if (samples_ < 2) return;
+
+    usage_ = ContainerUsage();
+    usage_.elapsed_seconds = std::chrono::duration<double>(now - previous_time).count();
+    usage_.memory_working_set_bytes = current_.memoryWorkingSetBytes();
+    if (limits_.memory_bytes > 0) {
+        usage_.memory_percent = 100.0 * static_cast<double>(usage_.memory_working_set_bytes) /
+                                static_cast<double>(limits_.memory_bytes);
+    }
+    if (usage_.elapsed_seconds <= 0.0) return;
+    using SystemCPUStats::counterDelta;
+    usage_.cpu_cores = static_cast<double>(counterDelta(previous_.cpu_usage_ns, current_.cpu_usage_ns)) * 1e-9 /
+                       usage_.elapsed_seconds;
+    if (limits_.cpu_cores > 0.0) usage_.cpu_percent = 100.0 * usage_.cpu_cores / limits_.cpu_cores;
+    const std::uint64_t periods = counterDelta(previous_.periods, current_.periods);
+    if (periods > 0) {
+        usage_.throttled_percent =
+            100.0 * static_cast<double>(counterDelta(previous_.throttled_periods, current_.throttled_periods)) /
+            static_cast<double>(periods);
+    }
+    usage_.throttled_seconds = static_cast<double>(counterDelta(previous_.throttled_ns, current_.throttled_ns)) *
+                               1e-9 / usage_.elapsed_seconds;
+}
+
+void ContainerCollector::refreshLimits(Clock::time_point now) {
+    limits_time_ = now;
+    // Moving the process to another cgroup changes /proc/self/cgroup; re-resolve and restart the
+    // interval, as the previous counters belong to the old cgroup.
+    if (!SystemProcFS::ProcFS::readFile("/proc/self/cgroup", scratch_)) {
+        throw std::runtime_error("Failed to read /proc/self/cgroup.");
+    }
+    if (samples_ == 0 || scratch_ != cgroup_text_) {
+        paths_ = CgroupResolver::resolve();
+        cgroup_text_ = scratch_;
+        samples_ = 0;
+        if (paths_.version == CgroupVersion::None) {
+            throw std::runtime_error("No cgroup filesystem found for this process.");
+        }
+    }
+
+    const bool v2 = paths_.version == CgroupVersion::V2;
+    scratch_.clear();
+    if (v2) {
+        appendFile(paths_.cpu + "/cpu.max", buffer_, scratch_);
+        appendFile(paths_.cpuset + "/cpuset.cpus.effective", buffer_, scratch_);
+        appendFile(paths_.memory + "/memory.max", buffer_, scratch_);
+    } else {
+        appendFile(paths_.cpu.empty() ? std::string() : paths_.cpu + "/cpu.cfs_quota_us", buffer_, scratch_);
+        appendFile(paths_.cpu.empty() ? std::string() : paths_.cpu + "/cpu.cfs_period_us", buffer_, scratch_);
+        appendFile(paths_.cpuset.empty() ? std::string() : paths_.cpuset + "/cpuset.cpus", buffer_, scratch_);
+        appendFile(paths_.memory.empty() ? std::string() : paths_.memory + "/memory.limit_in_bytes", buffer_, scratch_);
+    }
+    appendFile("/sys/devices/system/cpu/online", buffer_, scratch_);
+    if (limit_reads_ > 0 && scratch_ == limits_text_) return;
+
+    // The text is kept only with the limits parsed from it, so a failed refresh is retried.
+    CgroupLimits limits;
+    std::string_view text = scratch_;
+    std::uint64_t memory_limit = UINT64_MAX;
+    if (v2) {
+        // cpu.max: "$MAX $PERIOD", MAX being "max" without a quota.
+        const std::string_view cpu_max = trim(nextSection(text));
+        SystemProcFS::FieldScanner fields(cpu_max);
+        std::string_view quota;
+        if (!cpu_max.empty()) {
+            if (!fields.next(quota) || !fields.nextUnsigned(limits.cpu_period_us) ||
+                (quota != "max" && !SystemProcFS::parseDecimal(quota, limits.cpu_quota_us))) {
+                throw std::runtime_error("Malformed " + paths_.cpu + "/cpu.max: " + std::string(cpu_max));
+            }
+            limits.cpu_quota = quota != "max";
+        }
+        const std::string_view cpuset = nextSection(text);
+        if (!trim(cpuset).empty()) limits.cpuset_cpus = countCpus(cpuset);
+        const std::string_view memory_max = trim(nextSection(text));
+        if (!memory_max.empty() && memory_max != "max" && !SystemProcFS::parseDecimal(memory_max, memory_limit)) {
+            throw std::runtime_error("Malformed " + paths_.memory + "/memory.max: " + std::string(memory_max));
+        }
+    } else {
+        const std::string_view quota = trim(nextSection(text));
+        const std::string_view period = trim(nextSection(text));
+        if (!quota.empty() && quota != "-1") {
+            if (!SystemProcFS::parseDecimal(quota, limits.cpu_quota_us) ||
+                !SystemProcFS::parseDecimal(period, limits.cpu_period_us)) {
+                throw std::runtime_error("Malformed CFS quota in " + paths_.cpu + ": " + std::string(quota) + "/" +
+                                         std::string(period));
+            }
+            limits.cpu_quota = true;
+        } else if (!period.empty()) {
+            SystemProcFS::parseDecimal(period, limits.cpu_period_us);
+        }
+        const std::string_view cpuset = nextSection(text);
+        if (!trim(cpuset).empty()) limits.cpuset_cpus = countCpus(cpuset);
+        const std::string_view memory = trim(nextSection(text));
+        if (!memory.empty() && !SystemProcFS::parseDecimal(memory, memory_limit)) {
+            throw std::runtime_error("Malformed " + paths_.memory + "/memory.limit_in_bytes: " + std::string(memory));
+        }
+        if (memory_limit >= kV1Unlimited) memory_limit = UINT64_MAX;
+    }
+    const std::string_view online = nextSection(text);
+    limits.host_cpus = trim(online).empty() ? std::max(1u, std::thread::hardware_concurrency()) : countCpus(online);
+
+    limits.cpu_cores = static_cast<double>(limits.host_cpus);
+    if (limits.cpuset_cpus > 0) limits.cpu_cores = std::min(limits.cpu_cores, static_cast<double>(limits.cpuset_cpus));
+    if (limits.cpu_quota && limits.cpu_period_us > 0) {
+        limits.cpu_cores = std::min(limits.cpu_cores, static_cast<double>(limits.cpu_quota_us) /
+                                                          static_cast<double>(limits.cpu_period_us));
+    }
+
+    SystemMemoryStats::MemStats host;
+    SystemMemoryStats::MeMStatsReader::getMemStats(host, buffer_);
+    limits.host_memory_bytes = host.total * 1024;
+    limits.memory_limited = memory_limit < limits.host_memory_bytes;
+    limits.memory_bytes = limits.memory_limited ? memory_limit : limits.host_memory_bytes;
+
+    limits_text_.swap(scratch_);
+    limits_ = limits;
+    ++limit_reads_;
+}
+
+void ContainerCollector::readCounters(CgroupCounters& out) {
+    out = CgroupCounters();
+    CpuStat cpu;
+    MemoryStat memory;
+    if (paths_.version == CgroupVersion::V2) {
+        if (!SystemProcFS::KeyValueProcReader<CpuStatV2Schema>::read(paths_.cpu + "/cpu.stat", cpu, buffer_)) {
+            throw std::runtime_error("Failed to read " + paths_.cpu + "/cpu.stat.");
+        }
+        out.cpu_usage_ns = cpu.usage_usec * 1000;
+        out.throttled_ns = cpu.throttled_usec * 1000;
+        SystemProcFS::KeyValueProcReader<MemoryStatV2Schema>::read(paths_.memory + "/memory.stat", memory, buffer_);
+        if (!readNumber(paths_.memory + "/memory.current", buffer_, out.memory_usage_bytes)) {
+            // The root cgroup (an agent running on the host) has no memory.current.
+            SystemMemoryStats::MemStats host;
+            SystemMemoryStats::MeMStatsReader::getMemStats(host, buffer_);
+            out.memory_usage_bytes = (host.total - std::min(host.total, host.available)) * 1024;
+            memory.inactive_file = 0;
+        }
+    } else {
+        if (!paths_.cpuacct.empty()) readRequired(paths_.cpuacct + "/cpuacct.usage", buffer_, out.cpu_usage_ns);
+        if (!paths_.cpu.empty()) {
+            SystemProcFS::KeyValueProcReader<CpuStatV1Schema>::read(paths_.cpu + "/cpu.stat", cpu, buffer_);
+        }
+        out.throttled_ns = cpu.throttled_time;
+        if (!paths_.memory.empty()) {
+            readRequired(paths_.memory + "/memory.usage_in_bytes", buffer_, out.memory_usage_bytes);
+            SystemProcFS::KeyValueProcReader<MemoryStatV1Schema>::read(paths_.memory + "/memory.stat", memory, buffer_);
+        }
+    }
+    out.periods = cpu.nr_periods;
+    out.throttled_periods = cpu.nr_throttled;
+    out.memory_inactive_file_bytes = memory.inactive_file;
+}
+
+} // namespace SystemContainerStats
@@ -1,16 +1,23 @@
 #include "cpu_stats.hpp" // Include the redesigned header
+#include "proc_source.hpp" // For the pluggable /proc source
+#include "proc_parse.hpp"  // Allocation-free field scanning
+#include "simd_scan.hpp"   // Field splitting and decimal conversion
 
+#include <algorithm>   // For std::min
 #include <fstream>     // For std::ifstream
 #include <sstream>     // For std::stringstream
-#include <limits>      // For std::numeric_limits<double>::epsilon()
+#include <string_view>
+#include <limits>      // For std::numeric_limits
 #include <chrono>      // For std::chrono::steady_clock
+#include <cstdlib>     // For getloadavg on macOS
 
 // Platform-specific includes
 #ifdef _WIN32
 #include <windows.h>
 #elif __linux__
-#include <unistd.h> // For sysconf(_SC_CLK_TCK), though not used for percentage
+#include <unistd.h> // For sysconf(_SC_CLK_TCK)
 #elif __APPLE__
+#include <unistd.h> // For sysconf(_SC_CLK_TCK)
 #include <mach/mach.h>
 #include <mach/mach_host.h>
 #endif
@@ -73,10 +80,159 @@ CPUStats CPUStatsReader::parseProcStatLine(std::istream& input_stream) {
 }
 
 
-// --- Platform-specific raw CPUStats retrieval ---
+// --- Integer counters ---
 
+namespace { // Anonymous namespace for internal helpers
+constexpr std::size_t kCounterFields = 10; // user .. guest_nice
+constexpr std::size_t kMinCounterFields = 4; // user nice system idle (kernels before 2.5.41 stop here)
+
+std::uint64_t CPUCounters::* const kCounterMembers[kCounterFields] = {
+    &CPUCounters::user, &CPUCounters::nice, &CPUCounters::system, &CPUCounters::idle, &CPUCounters::iowait,
+    &CPUCounters::irq, &CPUCounters::softirq, &CPUCounters::steal, &CPUCounters::guest, &CPUCounters::guest_nice};
+
+// Parses the values of a "cpu"/"cpuN" line (label already split off as fields[0]).
+// Columns missing on older kernels are left at 0 once at least `min_fields` are present.
+bool parseCpuCounters(const SystemProcFS::LineFields& fields, std::size_t min_fields, CPUCounters& out) {
+    if (fields.size() < 1 + min_fields) return false;
+    out = CPUCounters();
+    const std::size_t available = (std::min)(fields.size() - 1, kCounterFields);
+    for (std::size_t i = 0; i < available; ++i) {
+        std::uint64_t ticks = 0;
+        if (!fields.unsignedAt(i + 1, ticks)) return false;
+        out.*kCounterMembers[i] = ticks;
+    }
+    return true;
+}
+
+// Returns true for "cpuN" labels and sets `cpu` to N.
+bool parseCpuNumber(std::string_view label, unsigned& cpu) {
+    if (label.size() <= 3) return false;
+    std::uint64_t n = 0;
+    if (!SystemProcFS::parseDecimal(label.substr(3), n) || n > (std::numeric_limits<unsigned>::max)()) return false;
+    cpu = static_cast<unsigned>(n);
+    return true;
+}
+
+// Lines of /proc/stat after the CPU lines that SystemActivity keeps.
+struct ActivityField {
+    std::string_view key;
+    std::uint64_t SystemActivity::* member;
+};
+constexpr ActivityField kActivityFields[] = {
+    {"ctxt", &SystemActivity::context_switches},
+    {"btime", &SystemActivity::boot_time},
+    {"processes", &SystemActivity::forks},
+    {"procs_running", &SystemActivity::procs_running},
+    {"procs_blocked", &SystemActivity::procs_blocked},
+};
+
+// Parses a load average such as "0.58" without going through the locale-dependent strtod.
+bool parseLoad(std::string_view field, double& out) {
+    const std::size_t dot = field.find('.');
+    std::uint64_t whole = 0, fraction = 0;
+    if (!SystemProcFS::parseDecimal(field.substr(0, dot), whole)) return false;
+    out = static_cast<double>(whole);
+    if (dot == std::string_view::npos) return true;
+    const std::string_view digits = field.substr(dot + 1);
+    if (digits.empty() || digits.size() > 9 || !SystemProcFS::parseDecimal(digits, fraction)) return false;
+    double scale = 1.0;
+    for (std::size_t i = 0; i < digits.size(); ++i) scale *= 10.0;
+    out += static_cast<double>(fraction) / scale;
+    return true;
+}
+
+double percentOf(std::uint64_t part, std::uint64_t whole) {
+    return whole == 0 ? 0.0 : static_cast<double>(part) * 100.0 / static_cast<double>(whole);
+}
+} // namespace
+
+std::uint64_t ticksPerSecond() {
 #ifdef _WIN32
-CPUStats CPUStatsReader::getRawWindowsCpuStats() {
+    return 10000000ULL; // FILETIME resolution (100 ns)
+#elif defined(__linux__) || defined(__APPLE__)
+    static const std::uint64_t ticks = [] {
+        const long hz = ::sysconf(_SC_CLK_TCK);
+        return hz > 0 ? static_cast<std::uint64_t>(hz) : 100ULL;
+    }();
+    return ticks;
+#else
+    return 100ULL;
+#endif
+}
+
+double ticksToSeconds(std::uint64_t ticks) {
+    // Split to keep full precision for counters beyond 2^53 ticks.
+    const std::uint64_t hz = ticksPerSecond();
+    return static_cast<double>(ticks / hz) + static_cast<double>(ticks % hz) / static_cast<double>(hz);
+}
+
+std::uint64_t counterDelta(std::uint64_t previous, std::uint64_t current) {
+    if (current >= previous) return current - previous;
+    constexpr std::uint64_t kWrap32 = 1ULL << 32;
+    if (previous < kWrap32 && previous >= kWrap32 / 2 && current < kWrap32 / 2) {
+        return kWrap32 - previous + current;
+    }
+    return 0; // Reset or backwards step
+}
+
+CPUUtilization computeUtilization(const CPUCounters& previous, const CPUCounters& current) {
+    std::uint64_t deltas[kCounterFields];
+    std::uint64_t total = 0;
+    for (std::size_t i = 0; i < kCounterFields; ++i) {
+        deltas[i] = counterDelta(previous.*kCounterMembers[i], current.*kCounterMembers[i]);
+        if (i < 8) total += deltas[i]; // Guest modes are already part of user and nice
+    }
+    CPUUtilization result;
+    if (total == 0) return result;
+    result.user = percentOf(deltas[0], total);
+    result.nice = percentOf(deltas[1], total);
+    result.system = percentOf(deltas[2], total);
+    result.idle = percentOf(deltas[3], total);
+    result.iowait = percentOf(deltas[4], total);
+    result.irq = percentOf(deltas[5], total);
+    result.softirq = percentOf(deltas[6], total);
+    result.steal = percentOf(deltas[7], total);
+    result.guest = percentOf(deltas[8], total);
+    result.guest_nice = percentOf(deltas[9], total);
+    result.busy = percentOf(total - deltas[3] - deltas[4], total);
+    result.elapsed_seconds = ticksToSeconds(total);
+    return result;
+}
+
+std::vector<CPUCoreUtilization> computeUtilization(const CPUCounterSample& previous, const CPUCounterSample& current) {
+    std::vector<CPUCoreUtilization> result;
+    result.reserve(current.cpus.size());
+    // The kernel lists online CPUs in ascending order, so a merge pass matches them up.
+    std::size_t p = 0;
+    for (const CPUCoreCounters& core : current.cpus) {
+        while (p < previous.cpus.size() && previous.cpus[p].cpu < core.cpu) ++p;
+        if (p < previous.cpus.size() && previous.cpus[p].cpu == core.cpu) {
+            result.push_back(CPUCoreUtilization{core.cpu, computeUtilization(previous.cpus[p].counters, core.counters)});
+        }
+    }
+    return result;
+}
+
+ActivityRates computeActivityRates(const SystemActivity& previous, const SystemActivity& current, double elapsed_seconds) {
+    ActivityRates rates;
+    if (elapsed_seconds <= 0.0) return rates;
+    rates.elapsed_seconds = elapsed_seconds;
+    rates.context_switches = static_cast<double>(counterDelta(previous.context_switches, current.context_switches)) / elapsed_seconds;
+    rates.forks = static_cast<double>(counterDelta(previous.forks, current.forks)) / elapsed_seconds;
+    return rates;
+}
+
+CPUStats toCPUStats(const CPUCounters& c) {
+    return CPUStats(static_cast<double>(c.user), static_cast<double>(c.nice), static_cast<double>(c.system),
+                    static_cast<double>(c.idle), static_cast<double>(c.iowait), static_cast<double>(c.irq),
+                    static_cast<double>(c.softirq), static_cast<double>(c.steal), static_cast<double>(c.guest),
+                    static_cast<double>(c.guest_nice), 0.0);
+}
+
+// --- Platform-specific raw counter retrieval ---
+
+#ifdef _WIN32
+void CPUStatsReader::getRawWindowsCpuCounters(CPUCounterSample& out) {
     FILETIME idleTime, kernelTime, userTime;
     if (!GetSystemTimes(&idleTime, &kernelTime, &userTime)) {
         throw std::runtime_error("Failed to get system times on Windows.");
@@ -87,33 +243,69 @@ CPUStats CPUStatsReader::getRawWindowsCpuStats() {
     uKernel.LowPart = kernelTime.dwLowDateTime; uKernel.HighPart = kernelTime.dwHighDateTime;
     uUser.LowPart = userTime.dwLowDateTime; uUser.HighPart = userTime.dwHighDateTime;
 
-    CPUStats currentStats;
-    currentStats.idle = static_cast<double>(uIdle.QuadPart);
-    currentStats.user = static_cast<double>(uUser.QuadPart);
-    currentStats.system = static_cast<double>(uKernel.QuadPart - uIdle.QuadPart); // System (kernel) time excluding idle
-
-    // Other fields are not directly available or have different meanings in GetSystemTimes
-    currentStats.nice = 0.0; currentStats.iowait = 0.0; currentStats.irq = 0.0;
-    currentStats.softirq = 0.0; currentStats.steal = 0.0; currentStats.guest = 0.0;
-    currentStats.guest_nice = 0.0;
-    currentStats.usage_percent = 0.0; // Not calculated by this raw data retrieval
-    return currentStats;
+    out.aggregate = CPUCounters();
+    out.aggregate.idle = uIdle.QuadPart;
+    out.aggregate.user = uUser.QuadPart;
+    out.aggregate.system = uKernel.QuadPart - uIdle.QuadPart; // System (kernel) time excluding idle
+    // Other modes are not available from GetSystemTimes, nor are per-CPU times.
+    out.cpus.clear();
 }
 
 #elif __linux__
-CPUStats CPUStatsReader::getRawLinuxCpuStats() {
-    std::ifstream proc_stat("/proc/stat");
-    if (!proc_stat.is_open()) {
+void CPUStatsReader::getRawLinuxCpuCounters(CPUCounterSample& out, std::string& buffer) {
+    if (!SystemProcFS::ProcFS::readFile("/proc/stat", buffer)) {
         throw std::runtime_error("Failed to open /proc/stat.");
     }
-    CPUStats stats = parseProcStatLine(proc_stat); // Reuses the parsing logic
-    proc_stat.close();
-    stats.usage_percent = 0.0; // Not calculated by this raw data retrieval
-    return stats;
+    out.cpus.clear();
+    out.activity = SystemActivity();
+    std::string_view contents(buffer);
+    std::string_view line;
+    bool have_aggregate = false;
+    // The aggregate line comes first, followed by one line per online CPU; offline CPUs have none.
+    while (SystemProcFS::nextLine(contents, line)) {
+        if (line.compare(0, 3, "cpu") != 0) {
+            parseActivityLine(line, out.activity);
+            break;
+        }
+        const SystemProcFS::LineFields fields(line);
+        if (fields.size() == 0) continue;
+        unsigned cpu = 0;
+        if (fields[0] == "cpu") {
+            if (!parseCpuCounters(fields, kMinCounterFields, out.aggregate)) {
+                throw std::runtime_error("Failed to parse CPU time fields: " + std::string(line));
+            }
+            have_aggregate = true;
+        } else if (parseCpuNumber(fields[0], cpu)) {
+            CPUCoreCounters core;
+            core.cpu = cpu;
+            if (!parseCpuCounters(fields, kMinCounterFields, core.counters)) {
+                throw std::runtime_error("Failed to parse CPU time fields: " + std::string(line));
+            }
+            out.cpus.push_back(core);
+        }
+    }
+    // The rest of the file: the long "intr" and "softirq" lines are passed over by their key alone.
+    while (SystemProcFS::nextLine(contents, line)) parseActivityLine(line, out.activity);
+    if (!have_aggregate) {
+        throw std::runtime_error("Invalid CPU stats line format: expected 'cpu' label.");
+    }
+}
+
+void CPUStatsReader::parseActivityLine(std::string_view line, SystemActivity& out) {
+    SystemProcFS::FieldScanner scanner(line);
+    std::string_view key;
+    if (!scanner.next(key)) return;
+    for (const ActivityField& field : kActivityFields) {
+        if (key != field.key) continue;
+        if (!scanner.nextUnsigned(out.*field.member)) {
+            throw std::runtime_error("Failed to parse /proc/stat line: " + std::string(line));
+        }
+        return;
+    }
 }
 
 #elif __APPLE__
-CPUStats CPUStatsReader::getRawMacCpuStats() {
+void CPUStatsReader::getRawMacCpuCounters(CPUCounterSample& out) {
     mach_msg_type_number_t count = HOST_CPU_LOAD_INFO_COUNT;
     host_cpu_load_info_data_t cpu_info;
 
@@ -121,21 +313,35 @@ CPUStats CPUStatsReader::getRawMacCpuStats() {
         throw std::runtime_error("Failed to get CPU load info on macOS.");
     }
 
-    CPUStats currentStats;
     // Mach provides: user, system, idle, nice
-    currentStats.user = static_cast<double>(cpu_info.cpu_ticks[CPU_STATE_USER]);
-    currentStats.system = static_cast<double>(cpu_info.cpu_ticks[CPU_STATE_SYSTEM]);
-    currentStats.idle = static_cast<double>(cpu_info.cpu_ticks[CPU_STATE_IDLE]);
-    currentStats.nice = static_cast<double>(cpu_info.cpu_ticks[CPU_STATE_NICE]);
+    out.aggregate = CPUCounters();
+    out.aggregate.user = cpu_info.cpu_ticks[CPU_STATE_USER];
+    out.aggregate.system = cpu_info.cpu_ticks[CPU_STATE_SYSTEM];
+    out.aggregate.idle = cpu_info.cpu_ticks[CPU_STATE_IDLE];
+    out.aggregate.nice = cpu_info.cpu_ticks[CPU_STATE_NICE];
 
-    currentStats.iowait = 0.0; currentStats.irq = 0.0; currentStats.softirq = 0.0;
-    currentStats.steal = 0.0; currentStats.guest = 0.0; currentStats.guest_nice = 0.0;
-    currentStats.usage_percent = 0.0; // Not calculated by this raw data retrieval
-    return currentStats;
+    out.cpus.clear();
+    natural_t cpu_count = 0;
+    processor_info_array_t info = nullptr;
+    mach_msg_type_number_t info_count = 0;
+    if (host_processor_info(mach_host_self(), PROCESSOR_CPU_LOAD_INFO, &cpu_count, &info, &info_count) == KERN_SUCCESS) {
+        const processor_cpu_load_info_t loads = reinterpret_cast<processor_cpu_load_info_t>(info);
+        for (natural_t cpu = 0; cpu < cpu_count; ++cpu) {
+            CPUCoreCounters core;
+            core.cpu = cpu;
+            core.counters.user = loads[cpu].cpu_ticks[CPU_STATE_USER];
+            core.counters.system = loads[cpu].cpu_ticks[CPU_STATE_SYSTEM];
+            core.counters.idle = loads[cpu].cpu_ticks[CPU_STATE_IDLE];
+            core.counters.nice = loads[cpu].cpu_ticks[CPU_STATE_NICE];
+            out.cpus.push_back(core);
+        }
+        vm_deallocate(mach_task_self(), reinterpret_cast<vm_address_t>(info), info_count * sizeof(integer_t));
+    }
 }
 #else
 // Fallback for unsupported platforms
-CPUStats CPUStatsReader::getRawUnsupportedCpuStats() {
+void CPUStatsReader::getRawUnsupportedCpuCounters(CPUCounterSample& out) {
+    (void)out;
     throw std::runtime_error("CPUStatsReader::getCPUStats() is not implemented for this operating system.");
 }
 #endif
@@ -143,19 +349,114 @@ CPUStats CPUStatsReader::getRawUnsupportedCpuStats() {
 // --- Public API Implementations ---
 
 CPUStats CPUStatsReader::getCPUStats() {
+#ifdef __linux__
+    std::string contents;
+    CPUStats stats;
+    getCPUStats(stats, contents); // Aggregate line only
+    return stats;
+#else
+    return toCPUStats(getCPUCounters().aggregate);
+#endif
+}
+
+CPUStats CPUStatsReader::getCPUStats(std::istream& input) {
+    return parseProcStatLine(input);
+}
+
+void CPUStatsReader::getCPUStats(CPUStats& out, std::string& buffer) {
+#ifdef __linux__
+    if (!SystemProcFS::ProcFS::readFile("/proc/stat", buffer)) {
+        throw std::runtime_error("Failed to open /proc/stat.");
+    }
+    std::string_view contents(buffer);
+    std::string_view line;
+    if (!SystemProcFS::nextLine(contents, line)) {
+        throw std::runtime_error("Failed to read line from CPU stats stream.");
+    }
+    const SystemProcFS::LineFields fields(line);
+    if (fields.size() == 0 || fields[0].substr(0, 3) != "cpu") {
+        throw std::runtime_error("Invalid CPU stats line format: expected 'cpu' label.");
+    }
+    CPUCounters counters;
+    if (!parseCpuCounters(fields, kCounterFields, counters)) {
+        throw std::runtime_error("Failed to parse CPU time fields from stream.");
+    }
+    out = toCPUStats(counters);
+#else
+    (void)buffer;
+    out = getCPUStats();
+#endif
+}
+
+CPUCounterSample CPUStatsReader::getCPUCounters() {
+    CPUCounterSample sample;
+    std::string contents;
+    getCPUCounters(sample, contents);
+    return sample;
+}
+
+void CPUStatsReader::getCPUCounters(CPUCounterSample& out, std::string& buffer) {
 #ifdef _WIN32
-    return getRawWindowsCpuStats();
+    (void)buffer;
+    getRawWindowsCpuCounters(out);
 #elif __linux__
-    return getRawLinuxCpuStats();
+    getRawLinuxCpuCounters(out, buffer);
 #elif __APPLE__
-    return getRawMacCpuStats();
+    (void)buffer;
+    getRawMacCpuCounters(out);
 #else
-    return getRawUnsupportedCpuStats();
+    (void)buffer;
+    getRawUnsupportedCpuCounters(out);
 #endif
 }
 
-CPUStats CPUStatsReader::getCPUStats(std::istream& input) {
-    return parseProcStatLine(input);
+LoadAverage CPUStatsReader::getLoadAverage() {
+    LoadAverage load;
+    std::string contents;
+    getLoadAverage(load, contents);
+    return load;
+}
+
+void CPUStatsReader::getLoadAverage(LoadAverage& out, std::string& buffer) {
+#ifdef __linux__
+    if (!SystemProcFS::ProcFS::readFile("/proc/loadavg", buffer)) {
+        throw std::runtime_error("Failed to open /proc/loadavg.");
+    }
+    out = parseLoadAverage(buffer);
+#elif __APPLE__
+    (void)buffer;
+    double loads[3];
+    if (::getloadavg(loads, 3) != 3) {
+        throw std::runtime_error("Failed to get load averages on macOS.");
+    }
+    out = LoadAverage();
+    out.one = loads[0];
+    out.five = loads[1];
+    out.fifteen = loads[2];
+#else
+    (void)buffer;
+    (void)out;
+    throw std::runtime_error("CPUStatsReader::getLoadAverage() is not implemented for this operating system.");
+#endif
+}
+
+LoadAverage CPUStatsReader::parseLoadAverage(std::string_view text) {
+    LoadAverage load;
+    SystemProcFS::FieldScanner scanner(text);
+    std::string_view one, five, fifteen, tasks, rest;
+    std::size_t slash = std::string_view::npos;
+    const bool valid = scanner.next(one) && scanner.next(five) && scanner.next(fifteen) && scanner.next(tasks) &&
+                       scanner.nextUnsigned(load.last_pid) && !scanner.next(rest) &&
+                       parseLoad(one, load.one) && parseLoad(five, load.five) && parseLoad(fifteen, load.fifteen) &&
+                       (slash = tasks.find('/')) != std::string_view::npos &&
+                       SystemProcFS::parseDecimal(tasks.substr(0, slash), load.runnable) &&
+                       SystemProcFS::parseDecimal(tasks.substr(slash + 1), load.tasks);
+    if (!valid) {
+        std::string_view line;
+        SystemProcFS::nextLine(text, line);
+        throw std::runtime_error("Malformed /proc/loadavg: " + std::string(line));
+    }
+    return load;
 }
 
-} // namespace SystemCPUStats
\ No newline at end of file
+} // namespace SystemCPUStats
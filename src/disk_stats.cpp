@@ -1,10 +1,18 @@
 #include "disk_stats.hpp"
 
+#include <cctype> // For std::isdigit
+#include <memory>
 #include <stdexcept>
 #include <vector>
 #include <string>
+#include <string_view>
 #include <iostream> // For std::cerr in tests
 #include "logger.hpp"
+#include "proc_source.hpp"
+#include "read_cache.hpp"
+#include "name_index.hpp"
+#include "proc_parse.hpp"
+#include "simd_scan.hpp"
 // Platform-specific headers
 #if defined(_WIN32) || defined(__WIN64__)
     #define _WIN32_DCOM
@@ -20,8 +28,6 @@
     #include <fstream>
     #include <istream>
     #include <sstream>
-    #include <string_view>
-    #include <cctype> // For ::isdigit
 #endif
 
 namespace SystemDiskStats {
@@ -49,13 +55,48 @@ static std::vector<DiskStats> getAllStats() {
 }
 
 
+namespace {
+/// @brief One parsed device list plus an index from interned device name to position.
+struct DiskSample {
+    std::vector<DiskStats> stats;
+    std::shared_ptr<const SystemMetricsIndex::NameIndex> index;
+};
+
+/// @brief Shares one platform read between concurrent callers (and, within the configured
+/// staleness window, sequential ones). Every public getter goes through it.
+SystemProcFS::CoalescingCache<DiskSample>& statsCache() {
+    static SystemProcFS::CoalescingCache<DiskSample> cache;
+    return cache;
+}
+
+DiskSample loadSample() {
+    // The cache runs at most one loader at a time, so the previous index needs no lock.
+    static std::shared_ptr<const SystemMetricsIndex::NameIndex> previous_index;
+    DiskSample sample{getAllStats(), nullptr};
+    std::vector<SystemMetricsIndex::NameId> ids;
+    ids.reserve(sample.stats.size());
+    for (const auto& stats : sample.stats) {
+        ids.push_back(SystemMetricsIndex::NameInterner::global().intern(stats.device));
+    }
+    sample.index = SystemMetricsIndex::NameIndex::reuseOrBuild(previous_index, std::move(ids));
+    previous_index = sample.index;
+    return sample;
+}
+
+const DiskStats* findDevice(const DiskSample& sample, std::string_view device_name) {
+    const std::size_t position = sample.index->find(SystemMetricsIndex::NameInterner::global().find(device_name));
+    return position == SystemMetricsIndex::NameIndex::npos ? nullptr : &sample.stats[position];
+}
+} // namespace
+
+
 // --- Public API Implementation ---
 
 DiskStats DiskStatsReader::getDiskStats() {
-    const auto all_stats = getAllStats();
+    const auto sample = statsCache().get(loadSample);
     
     DiskStats aggregated_stats{"aggregated", 0, 0, 0, 0};
-    for (const auto& stats : all_stats) {
+    for (const auto& stats : sample->stats) {
         aggregated_stats.read_bytes += stats.read_bytes;
         aggregated_stats.write_bytes += stats.write_bytes;
         aggregated_stats.read_time_ms += stats.read_time_ms;
@@ -66,37 +107,68 @@ DiskStats DiskStatsReader::getDiskStats() {
 }
 
 DiskStats DiskStatsReader::getDiskStats(const std::string& device_name) {
-    const auto all_stats = getAllStats();
-    
-    for (const auto& stats : all_stats) {
-        if (stats.device == device_name) {
-            return stats;
-        }
+    const auto sample = statsCache().get(loadSample);
+    if (const DiskStats* stats = findDevice(*sample, device_name)) {
+        return *stats;
     }
     
     throw std::runtime_error("Device '" + device_name + "' not found or has no stats.");
 }
 
+std::map<std::string, DiskStats> DiskStatsReader::getDiskStatsForDevices(const std::vector<std::string>& device_names) {
+    const auto sample = statsCache().get(loadSample);
+    std::map<std::string, DiskStats> found;
+    for (const auto& name : device_names) {
+        if (const DiskStats* stats = findDevice(*sample, name)) {
+            found.emplace(name, *stats);
+        }
+    }
+    return found;
+}
+
+std::vector<DiskStats> DiskStatsReader::getAllDiskStats() {
+    return statsCache().get(loadSample)->stats;
+}
+
+void DiskStatsReader::setCacheMaxAge(std::chrono::milliseconds max_age) {
+    statsCache().setMaxAge(max_age);
+}
+
+SystemProcFS::CacheStats DiskStatsReader::cacheStats() {
+    return statsCache().stats();
+}
+
+void DiskStatsReader::invalidateCache() {
+    statsCache().invalidate();
+}
+
+bool DiskStatsReader::parseDiskStatLine(std::string_view line, std::string_view& device, DiskRecord& record) {
+    // Format: major minor name reads merged sectors_read ms_read writes merged sectors_written ms_written
+    //         in_flight ms_io weighted_ms_io [discard and flush fields on newer kernels]
+    const SystemProcFS::LineFields fields(line);
+    std::uint64_t sectors_read = 0, ms_read = 0, sectors_written = 0, ms_written = 0;
+    if (fields.size() < 14 || !fields.unsignedAt(5, sectors_read) || !fields.unsignedAt(6, ms_read) ||
+        !fields.unsignedAt(9, sectors_written) || !fields.unsignedAt(10, ms_written)) {
+        return false;
+    }
+    device = fields[2];
+    // Assuming 512 bytes per sector as is standard for /proc/diskstats
+    record.read_bytes = sectors_read * 512;
+    record.write_bytes = sectors_written * 512;
+    record.read_time_ms = ms_read;
+    record.write_time_ms = ms_written;
+    return true;
+}
+
 #if defined(__linux__)
 // Public parser implementation for Linux
 DiskStats DiskStatsReader::parseDiskStatLine(const std::string& line) {
-    std::istringstream iss(line);
-    unsigned long long major, minor, sectors_read, ms_read, sectors_written, ms_written, dummy;
-    std::string device_name;
-
-    // Attempt to read all 14 fields
-    iss >> major >> minor >> device_name // 3 fields
-        >> dummy >> dummy >> sectors_read >> ms_read // +4 fields = 7
-        >> dummy >> dummy >> sectors_written >> ms_written // +4 fields = 11
-        >> dummy >> dummy >> dummy; // +3 fields = 14
-
-    // Check if any parsing error occurred. iss.fail() is true if an extraction operation failed.
-    // This correctly handles cases like too few fields or non-numeric data where numbers are expected.
-    if (iss.fail()) { // <-- Corrected condition: removed '&& !iss.eof()'
+    std::string_view device;
+    DiskRecord record;
+    if (!parseDiskStatLine(std::string_view(line), device, record)) {
         throw std::runtime_error("Failed to parse diskstat line: " + line + " (Not enough fields or invalid data)");
     }
-    // Assuming 512 bytes per sector as is standard for /proc/diskstats
-    return DiskStats{ std::move(device_name), sectors_read * 512, sectors_written * 512, ms_read, ms_written };
+    return DiskStats{ std::string(device), record.read_bytes, record.write_bytes, record.read_time_ms, record.write_time_ms };
 }
 #else
 // On non-Linux platforms, this function is not applicable.
@@ -106,6 +178,56 @@ DiskStats DiskStatsReader::parseDiskStatLine(const std::string& line) {
 }
 #endif
 
+// Skips loopback devices, ramdisks, device mapper and zvol devices, and partitions
+// (e.g., sda1, nvme0n1p1).
+bool DiskStatsReader::isPhysicalDevice(std::string_view device_name) {
+    // Exclude common non-physical devices by prefix
+    if (device_name.rfind("loop", 0) == 0 || device_name.rfind("ram", 0) == 0 || device_name.rfind("dm-", 0) == 0 || device_name.rfind("zd", 0) == 0) {
+        return false;
+    }
+
+    // Special handling for NVMe devices (e.g., nvme0n1, nvme0n1p1)
+    if (device_name.rfind("nvme", 0) == 0) {
+        // A physical NVMe drive name typically looks like nvmeXnY (e.g., nvme0n1)
+        // A partition on an NVMe drive looks like nvmeXnYpZ (e.g., nvme0n1p1)
+        size_t p_pos = device_name.rfind('p');
+        return !(p_pos != std::string_view::npos && p_pos > 0 && p_pos + 1 < device_name.length() &&
+                 std::isdigit(static_cast<unsigned char>(device_name[p_pos + 1])));
+    }
+
+    // For non-NVMe devices (like sda, hda, vda), exclude if they end in a digit (likely a partition like sda1)
+    return device_name.empty() || !std::isdigit(static_cast<unsigned char>(device_name.back()));
+}
+
+void DiskStatsReader::getAllDiskRecords(std::pmr::vector<DiskRecord>& out, std::string& buffer) {
+    out.clear();
+#if defined(__linux__)
+    if (!SystemProcFS::ProcFS::readFile("/proc/diskstats", buffer)) {
+        throw std::runtime_error("Could not open /proc/diskstats. Ensure you have permissions (e.g., run as root or with sudo).");
+    }
+    std::string_view contents(buffer);
+    std::string_view line;
+    while (SystemProcFS::nextLine(contents, line)) {
+        std::string_view device;
+        DiskRecord record;
+        if (!parseDiskStatLine(line, device, record) || !isPhysicalDevice(device)) continue; // Malformed lines are skipped
+        record.device = SystemMetricsIndex::NameInterner::global().intern(device);
+        out.push_back(record);
+    }
+#else
+    (void)buffer;
+    for (const auto& stats : getAllStats()) {
+        out.push_back(DiskRecord{SystemMetricsIndex::NameInterner::global().intern(stats.device), stats.read_bytes,
+                                 stats.write_bytes, stats.read_time_ms, stats.write_time_ms});
+    }
+#endif
+}
+
+DiskStats toDiskStats(const DiskRecord& record) {
+    return DiskStats{std::string(SystemMetricsIndex::NameInterner::global().name(record.device)), record.read_bytes,
+                     record.write_bytes, record.read_time_ms, record.write_time_ms};
+}
+
 
 // --- Private Platform-Specific Implementations ---
 
@@ -331,71 +453,14 @@ static std::vector<DiskStats> getRawMacDiskStats() {
 }
 
 #elif defined(__linux__)
-namespace { // Anonymous namespace for Linux-only internal helpers
-// Helper function to determine if a device name represents a physical drive
-// Skips loopback devices, ramdisks, and device mapper partitions (e.g., dm-0)
-// Also skips partitions (e.g., sda1, sdb2) by checking if the last char is a digit
-bool isPhysicalDrive(std::string_view device_name) {
-    // Debugging: Show which device name is being checked
-    SystemMetricsLogger::Logger::debug("isPhysicalDrive: Checking '" + std::string(device_name) + "'");
-
-    // Exclude common non-physical devices by prefix
-    if (device_name.rfind("loop", 0) == 0 || device_name.rfind("ram", 0) == 0 || device_name.rfind("dm-", 0) == 0 || device_name.rfind("zd", 0) == 0) {
-        SystemMetricsLogger::Logger::debug("isPhysicalDrive: Excluded by loop/ram/dm-/zd prefix.");
-        return false;
-    }
-
-    // Special handling for NVMe devices (e.g., nvme0n1, nvme0n1p1)
-    if (device_name.rfind("nvme", 0) == 0) {
-        // A physical NVMe drive name typically looks like nvmeXnY (e.g., nvme0n1)
-        // A partition on an NVMe drive looks like nvmeXnYpZ (e.g., nvme0n1p1)
-        size_t p_pos = device_name.rfind('p');
-        if (p_pos != std::string_view::npos && p_pos > 0 && p_pos + 1 < device_name.length() && ::isdigit(device_name[p_pos + 1])) {
-            // Check if the 'p' is followed by a digit (like nvme0n1p1)
-            SystemMetricsLogger::Logger::debug("isPhysicalDrive: Excluded as NVMe partition ('p' followed by digit).");
-            return false;
-        }
-        // If it's an NVMe device and not identified as a partition by the above rule, include it.
-        SystemMetricsLogger::Logger::debug("isPhysicalDrive: Included as NVMe drive.");
-        return true;
-    }
-
-    // For non-NVMe devices (like sda, hda, vda), exclude if they end in a digit (likely a partition like sda1)
-    if (!device_name.empty() && ::isdigit(device_name.back())) {
-        // We've already handled NVMe devices, so this applies to others like 'sda1'
-        SystemMetricsLogger::Logger::debug("isPhysicalDrive: Excluded because it ends with a digit (likely a non-NVMe partition).");
-        return false;
-    }
-
-    // Default: include if it doesn't match any exclusion rules. (e.g., sda, hda)
-    SystemMetricsLogger::Logger::debug("isPhysicalDrive: Included (default case).");
-    return true;
-}
-}
 static std::vector<DiskStats> getRawLinuxDiskStats() {
-    std::ifstream file("/proc/diskstats");
-    if (!file.is_open()) {
-        throw std::runtime_error("Could not open /proc/diskstats. Ensure you have permissions (e.g., run as root or with sudo).");
-    }
-    
+    std::string contents;
+    std::pmr::vector<DiskRecord> records;
+    DiskStatsReader::getAllDiskRecords(records, contents);
     std::vector<DiskStats> all_stats;
-    std::string line;
-    while (std::getline(file, line)) {
-        if (line.empty()) continue;
-        try {
-            /// @todo: Remove Add debug output to help with parsing issues
-            DiskStats stats = DiskStatsReader::parseDiskStatLine(line);
-            if (isPhysicalDrive(stats.device)) {
-                all_stats.push_back(std::move(stats));
-            }
-        } catch (const std::runtime_error& e) { 
-            // Ignore malformed lines, but log to stderr for debugging if needed
-            // std::cerr << "Warning: Ignoring malformed diskstat line: " << line << " Error: " << e.what() << std::endl;
-        } catch (const std::logic_error&) {
-            // This should not happen on Linux as parseDiskStatLine is specialized.
-            // If it does, something is wrong with the build environment.
-            std::cerr << "Fatal Error: logic_error from parseDiskStatLine on Linux!" << std::endl;
-        }
+    all_stats.reserve(records.size());
+    for (const auto& record : records) {
+        all_stats.push_back(toDiskStats(record));
     }
     return all_stats;
 }
@@ -0,0 +1,586 @@
+#include "forwarder.hpp"
+#include "logger.hpp"
+
+#include <algorithm>  // For std::min, std::max
+#include <cerrno>
+#include <cstring>    // For std::memcpy, std::strerror
+#include <stdexcept>
+
+#if defined(METRICS_AGENT_HAVE_ZLIB)
+    #include <zlib.h>
+#endif
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+namespace SystemMetricsForwarder {
+
+using SystemMetricsCodec::ByteSpan;
+using SystemMetricsSnapshot::MetricsSnapshot;
+
+namespace { // Anonymous namespace for internal helpers
+constexpr std::uint8_t kBatchMagic0 = 'M';
+constexpr std::uint8_t kBatchMagic1 = 'B';
+constexpr std::uint8_t kBatchVersion = 1;
+constexpr std::uint64_t kMaxRawBatchSize = 256u << 20; // Sanity bound for decodeBatch
+constexpr auto kMinRetryBackoff = std::chrono::milliseconds(100);
+
+void putVarint(std::vector<std::uint8_t>& out, std::uint64_t value) {
+    while (value >= 0x80) {
+        out.push_back(static_cast<std::uint8_t>(value | 0x80));
+        value >>= 7;
+    }
+    out.push_back(static_cast<std::uint8_t>(value));
+}
+
+std::uint64_t getVarint(const std::uint8_t*& pos, const std::uint8_t* end) {
+    std::uint64_t value = 0;
+    for (int shift = 0; shift < 64; shift += 7) {
+        if (pos == end) {
+            throw std::runtime_error("Forwarder batch is truncated.");
+        }
+        std::uint8_t byte = *pos++;
+        value |= static_cast<std::uint64_t>(byte & 0x7F) << shift;
+        if ((byte & 0x80) == 0) {
+            return value;
+        }
+    }
+    throw std::runtime_error("Forwarder batch contains an invalid varint.");
+}
+
+#if defined(__unix__) || defined(__APPLE__)
+// Writes a 4-byte big-endian length followed by `batch`, retrying on partial writes.
+void writeFrame(int fd, ByteSpan batch, bool is_socket) {
+    const std::uint32_t length = static_cast<std::uint32_t>(batch.size);
+    std::uint8_t prefix[4] = {static_cast<std::uint8_t>(length >> 24), static_cast<std::uint8_t>(length >> 16),
+                              static_cast<std::uint8_t>(length >> 8), static_cast<std::uint8_t>(length)};
+    struct iovec iov[2];
+    iov[0].iov_base = prefix;
+    iov[0].iov_len = sizeof(prefix);
+    iov[1].iov_base = const_cast<std::uint8_t*>(batch.data);
+    iov[1].iov_len = batch.size;
+    struct iovec* current = iov;
+    int count = 2;
+    while (count > 0) {
+        ssize_t written;
+        if (is_socket) {
+            struct msghdr msg{};
+            msg.msg_iov = current;
+            msg.msg_iovlen = static_cast<decltype(msg.msg_iovlen)>(count);
+#if defined(MSG_NOSIGNAL)
+            written = ::sendmsg(fd, &msg, MSG_NOSIGNAL);
+#else
+            written = ::sendmsg(fd, &msg, 0);
+#endif
+        } else {
+            written = ::writev(fd, current, count);
+        }
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            throw std::runtime_error(std::string("write failed: ") + std::strerror(errno));
+        }
+        std::size_t remaining = static_cast<std::size_t>(written);
+        while (count > 0 && remaining >= current->iov_len) {
+            remaining -= current->iov_len;
+            ++current;
+            --count;
+        }
+        if (count > 0) {
+            current->iov_base = static_cast<std::uint8_t*>(current->iov_base) + remaining;
+            current->iov_len -= remaining;
+        }
+    }
+}
+
+void setSendTimeout(int fd, std::chrono::milliseconds timeout) {
+    struct timeval tv{};
+    tv.tv_sec = static_cast<time_t>(timeout.count() / 1000);
+    tv.tv_usec = static_cast<suseconds_t>((timeout.count() % 1000) * 1000);
+    ::setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &tv, sizeof(tv));
+#if defined(SO_NOSIGPIPE)
+    int one = 1;
+    ::setsockopt(fd, SOL_SOCKET, SO_NOSIGPIPE, &one, sizeof(one));
+#endif
+}
+#endif
+} // namespace
+
+std::size_t decodeBatch(ByteSpan batch, std::vector<MetricsSnapshot>& out) {
+    const std::uint8_t* pos = batch.data;
+    const std::uint8_t* end = batch.data + batch.size;
+    if (batch.size < 4 || pos[0] != kBatchMagic0 || pos[1] != kBatchMagic1) {
+        throw std::runtime_error("Forwarder batch has no valid header.");
+    }
+    if (pos[2] != kBatchVersion) {
+        throw std::runtime_error("Unsupported forwarder batch version " + std::to_string(pos[2]) + ".");
+    }
+    const std::uint8_t compression = pos[3];
+    pos += 4;
+    const std::uint64_t count = getVarint(pos, end);
+    const std::uint64_t raw_size = getVarint(pos, end);
+    if (raw_size > kMaxRawBatchSize) {
+        throw std::runtime_error("Forwarder batch is too large.");
+    }
+
+    std::vector<std::uint8_t> inflated;
+    ByteSpan body(pos, static_cast<std::size_t>(end - pos));
+    if (compression == static_cast<std::uint8_t>(Compression::Deflate)) {
+#if defined(METRICS_AGENT_HAVE_ZLIB)
+        inflated.resize(static_cast<std::size_t>(raw_size));
+        uLongf inflated_size = static_cast<uLongf>(raw_size);
+        if (::uncompress(inflated.data(), &inflated_size, pos, static_cast<uLong>(end - pos)) != Z_OK ||
+            inflated_size != raw_size) {
+            throw std::runtime_error("Forwarder batch failed to decompress.");
+        }
+        body = ByteSpan(inflated);
+#else
+        throw std::runtime_error("Forwarder batch is deflate-compressed but zlib support is not compiled in.");
+#endif
+    } else if (compression != static_cast<std::uint8_t>(Compression::None)) {
+        throw std::runtime_error("Unsupported forwarder batch compression " + std::to_string(compression) + ".");
+    }
+    if (body.size != raw_size) {
+        throw std::runtime_error("Forwarder batch size does not match its header.");
+    }
+
+    SystemMetricsCodec::SnapshotDecoder decoder;
+    std::size_t offset = 0;
+    for (std::uint64_t i = 0; i < count; ++i) {
+        out.emplace_back();
+        offset += decoder.decode(ByteSpan(body.data + offset, body.size - offset), out.back());
+    }
+    if (offset != body.size) {
+        throw std::runtime_error("Forwarder batch has trailing data.");
+    }
+    return static_cast<std::size_t>(count);
+}
+
+// --- Sinks ---
+
+#if defined(__unix__) || defined(__APPLE__)
+FileSink::FileSink(const std::string& path) : path_(path) {
+    fd_ = ::open(path_.c_str(), O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+    if (fd_ < 0) {
+        throw std::runtime_error("FileSink: cannot open " + path_ + ": " + std::strerror(errno));
+    }
+}
+
+FileSink::~FileSink() {
+    if (fd_ >= 0) {
+        ::close(fd_);
+    }
+}
+
+void FileSink::send(ByteSpan batch) {
+    try {
+        writeFrame(fd_, batch, false);
+    } catch (const std::runtime_error& e) {
+        throw std::runtime_error("FileSink " + path_ + ": " + e.what());
+    }
+}
+
+StreamSink::StreamSink(std::chrono::milliseconds send_timeout) : send_timeout_(send_timeout) {}
+
+StreamSink::~StreamSink() {
+    closeSocket();
+}
+
+void StreamSink::closeSocket() {
+    if (fd_ >= 0) {
+        ::close(fd_);
+        fd_ = -1;
+    }
+}
+
+void StreamSink::send(ByteSpan batch) {
+    if (fd_ < 0) {
+        fd_ = connectSocket();
+    }
+    try {
+        writeFrame(fd_, batch, true);
+    } catch (const std::runtime_error& e) {
+        closeSocket(); // A partial frame leaves the stream unusable; reconnect next time
+        throw std::runtime_error(describe() + ": " + e.what());
+    }
+}
+
+UnixSocketSink::UnixSocketSink(std::string path, std::chrono::milliseconds send_timeout)
+    : StreamSink(send_timeout), path_(std::move(path)) {
+    if (path_.size() >= sizeof(sockaddr_un::sun_path)) {
+        throw std::invalid_argument("UnixSocketSink: socket path is too long: " + path_);
+    }
+}
+
+int UnixSocketSink::connectSocket() {
+    int fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0) {
+        throw std::runtime_error(describe() + ": socket() failed: " + std::strerror(errno));
+    }
+    struct sockaddr_un addr{};
+    addr.sun_family = AF_UNIX;
+    std::memcpy(addr.sun_path, path_.c_str(), path_.size() + 1);
+    if (::connect(fd, reinterpret_cast<struct sockaddr*>(&addr), sizeof(addr)) != 0) {
+        std::string error = std::strerror(errno);
+        ::close(fd);
+        throw std::runtime_error(describe() + ": connect failed: " + error);
+    }
+    setSendTimeout(fd, send_timeout_);
+    return fd;
+}
+
+TcpSink::TcpSink(std::string host, std::uint16_t port, std::chrono::milliseconds send_timeout)
+    : StreamSink(send_timeout), host_(std::move(host)), port_(port) {}
+
+int TcpSink::connectSocket() {
+    struct addrinfo hints{};
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    struct addrinfo* results = nullptr;
+    int rc = ::getaddrinfo(host_.c_str(), std::to_string(port_).c_str(), &hints, &results);
+    if (rc != 0) {
+        throw std::runtime_error(describe() + ": cannot resolve host: " + ::gai_strerror(rc));
+    }
+    std::string error = "no addresses";
+    int fd = -1;
+    for (struct addrinfo* ai = results; ai != nullptr; ai = ai->ai_next) {
+        fd = ::socket(ai->ai_family, ai->ai_socktype, ai->ai_protocol);
+        if (fd < 0) {
+            error = std::strerror(errno);
+            continue;
+        }
+        if (::connect(fd, ai->ai_addr, ai->ai_addrlen) == 0) {
+            break;
+        }
+        error = std::strerror(errno);
+        ::close(fd);
+        fd = -1;
+    }
+    ::freeaddrinfo(results);
+    if (fd < 0) {
+        throw std::runtime_error(describe() + ": connect failed: " + error);
+    }
+    int one = 1;
+    ::setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+    setSendTimeout(fd, send_timeout_);
+    return fd;
+}
+#else
+FileSink::FileSink(const std::string& path) : path_(path) {
+    throw std::runtime_error("FileSink is not supported on this platform.");
+}
+FileSink::~FileSink() = default;
+void FileSink::send(ByteSpan) {}
+StreamSink::StreamSink(std::chrono::milliseconds send_timeout) : send_timeout_(send_timeout) {}
+StreamSink::~StreamSink() = default;
+void StreamSink::closeSocket() {}
+void StreamSink::send(ByteSpan) {
+    throw std::runtime_error("Socket sinks are not supported on this platform.");
+}
+UnixSocketSink::UnixSocketSink(std::string path, std::chrono::milliseconds send_timeout)
+    : StreamSink(send_timeout), path_(std::move(path)) {}
+int UnixSocketSink::connectSocket() { return -1; }
+TcpSink::TcpSink(std::string host, std::uint16_t port, std::chrono::milliseconds send_timeout)
+    : StreamSink(send_timeout), host_(std::move(host)), port_(port) {}
+int TcpSink::connectSocket() { return -1; }
+#endif
+
+// --- Forwarder ---
+
+Forwarder::Forwarder(std::shared_ptr<Sink> sink, Options options)
+    : sink_(std::move(sink)), options_(std::move(options)),
+      encoder_(~std::size_t(0)) { // Keyframes are forced at the start of each batch instead
+    if (!sink_) {
+        throw std::invalid_argument("Forwarder requires a sink.");
+    }
+    if (options_.max_batch_snapshots == 0 || options_.max_queued_batches == 0) {
+        throw std::invalid_argument("Forwarder batch and queue limits must be greater than 0.");
+    }
+#if !defined(METRICS_AGENT_HAVE_ZLIB)
+    options_.compression = Compression::None;
+#endif
+    if (!options_.spool_path.empty()) {
+        spool_ = std::make_unique<SystemMetricsHistory::RingLog>(options_.spool_path, options_.spool_capacity);
+        stats_.spool_batches = spool_->size();
+    }
+}
+
+Forwarder::~Forwarder() {
+    stop();
+}
+
+void Forwarder::start() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (running_) {
+        throw std::logic_error("Forwarder is already running.");
+    }
+    running_ = true;
+    stopping_ = false;
+    sender_ = std::thread(&Forwarder::senderLoop, this);
+}
+
+void Forwarder::stop() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!running_ || stopping_) {
+            return;
+        }
+        stopping_ = true;
+        sealLocked();
+    }
+    work_cv_.notify_all();
+    sender_.join();
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (spool_) {
+        // Persist what could not be sent so that the next run picks it up.
+        while (!queue_.empty()) {
+            try {
+                spool_->append(ByteSpan(queue_.front()));
+                ++stats_.spooled_batches;
+            } catch (const std::exception& e) {
+                SystemMetricsLogger::Logger::warning(std::string("Forwarder: cannot spool batch on stop: ") + e.what());
+                ++stats_.dropped_batches;
+            }
+            queue_.pop_front();
+        }
+        spool_->sync();
+    }
+    running_ = false;
+    stopping_ = false;
+    drained_cv_.notify_all();
+}
+
+bool Forwarder::running() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return running_;
+}
+
+void Forwarder::submit(const MetricsSnapshot& snapshot) {
+    bool first = false;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        first = open_count_ == 0;
+        if (first) {
+            open_since_ = std::chrono::steady_clock::now();
+        }
+        encoder_.encode(snapshot, open_raw_, first);
+        ++open_count_;
+        ++stats_.submitted;
+        if (open_count_ >= options_.max_batch_snapshots) {
+            sealLocked();
+            first = true;
+        }
+    }
+    if (first) {
+        work_cv_.notify_one(); // Either a batch is ready or the batch-delay timer must be armed
+    }
+}
+
+void Forwarder::sealLocked() {
+    if (open_count_ == 0) {
+        return;
+    }
+    Batch batch;
+    batch.reserve(16 + open_raw_.size());
+    batch.push_back(kBatchMagic0);
+    batch.push_back(kBatchMagic1);
+    batch.push_back(kBatchVersion);
+    batch.push_back(static_cast<std::uint8_t>(Compression::None));
+    putVarint(batch, open_count_);
+    putVarint(batch, open_raw_.size());
+    const std::size_t header_size = batch.size();
+
+#if defined(METRICS_AGENT_HAVE_ZLIB)
+    if (options_.compression == Compression::Deflate) {
+        uLongf compressed_size = ::compressBound(static_cast<uLong>(open_raw_.size()));
+        batch.resize(header_size + compressed_size);
+        if (::compress2(batch.data() + header_size, &compressed_size, open_raw_.data(),
+                        static_cast<uLong>(open_raw_.size()), options_.compression_level) == Z_OK &&
+            compressed_size < open_raw_.size()) {
+            batch.resize(header_size + compressed_size);
+            batch[3] = static_cast<std::uint8_t>(Compression::Deflate);
+        } else {
+            batch.resize(header_size); // Incompressible: ship the frames as they are
+        }
+    }
+#endif
+    if (batch[3] == static_cast<std::uint8_t>(Compression::None)) {
+        batch.insert(batch.end(), open_raw_.begin(), open_raw_.end());
+    }
+
+    open_raw_.clear();
+    open_count_ = 0;
+    enqueueLocked(std::move(batch));
+}
+
+void Forwarder::enqueueLocked(Batch batch) {
+    queue_.push_back(std::move(batch));
+    spillLocked();
+}
+
+void Forwarder::spillLocked() {
+    if (queue_.size() > options_.max_queued_batches && spool_ && inflight_queued_ && !inflight_spooled_) {
+        // The batch in flight is older than anything queued: it goes to the spool ahead of them,
+        // and is discarded from there again if its send succeeds.
+        try {
+            inflight_seq_ = spool_->append(ByteSpan(*inflight_));
+            inflight_spooled_ = true;
+            ++stats_.spooled_batches;
+        } catch (const std::exception& e) {
+            SystemMetricsLogger::Logger::warning(std::string("Forwarder: cannot spool batch: ") + e.what());
+        }
+    }
+    while (queue_.size() > options_.max_queued_batches) {
+        // Drop-oldest: the oldest batch leaves memory, landing in the spool when one is configured.
+        if (spool_) {
+            try {
+                const std::size_t before = spool_->size();
+                spool_->append(ByteSpan(queue_.front()));
+                ++stats_.spooled_batches;
+                if (spool_->size() <= before) {
+                    stats_.dropped_batches += before + 1 - spool_->size(); // The spool evicted its own oldest
+                }
+            } catch (const std::exception& e) {
+                SystemMetricsLogger::Logger::warning(std::string("Forwarder: cannot spool batch: ") + e.what());
+                ++stats_.dropped_batches;
+            }
+        } else {
+            ++stats_.dropped_batches;
+        }
+        queue_.pop_front();
+    }
+}
+
+bool Forwarder::sendOne(std::unique_lock<std::mutex>& lock) {
+    // Spooled batches are always older than queued ones, so they go first.
+    Batch batch;
+    bool from_spool = false;
+    std::uint64_t spool_seq = 0;
+    if (spool_ && spool_->size() > 0) {
+        std::size_t visited = spool_->forEach([&](std::uint64_t seq, ByteSpan payload) {
+            batch.assign(payload.data, payload.data + payload.size); // Copy: the spool may be appended while unlocked
+            spool_seq = seq;
+            return false;
+        });
+        if (visited == 0) {
+            spool_->discardBefore(spool_->firstSequence() + 1); // Skip a corrupt record
+            ++stats_.dropped_batches;
+            return true;
+        }
+        from_spool = true;
+    } else {
+        batch = std::move(queue_.front());
+        queue_.pop_front();
+        inflight_queued_ = true;
+        inflight_spooled_ = false;
+        inflight_ = &batch;
+    }
+
+    sending_ = true;
+    lock.unlock();
+    bool ok = true;
+    try {
+        sink_->send(ByteSpan(batch));
+    } catch (const std::exception& e) {
+        SystemMetricsLogger::Logger::warning(std::string("Forwarder: send failed: ") + e.what());
+        ok = false;
+    }
+    lock.lock();
+    sending_ = false;
+    const bool spooled = inflight_spooled_;
+    inflight_queued_ = false;
+    inflight_spooled_ = false;
+    inflight_ = nullptr;
+    if (spooled) {
+        // Spilled while in flight: the spool holds it at its place in submission order.
+        from_spool = true;
+        spool_seq = inflight_seq_;
+    }
+
+    if (ok) {
+        ++stats_.batches_sent;
+        stats_.bytes_sent += batch.size();
+        if (from_spool && spool_->firstSequence() == spool_seq) {
+            spool_->discardBefore(spool_seq + 1);
+        }
+        drained_cv_.notify_all();
+        return true;
+    }
+    ++stats_.send_failures;
+    if (!from_spool) {
+        // Put it back at the front; if the queue filled up meanwhile, it is the first to spill.
+        queue_.push_front(std::move(batch));
+        spillLocked();
+    }
+    return false;
+}
+
+void Forwarder::senderLoop() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    std::chrono::milliseconds backoff(0);
+    auto retry_at = std::chrono::steady_clock::time_point::min();
+    while (true) {
+        auto now = std::chrono::steady_clock::now();
+        if (open_count_ != 0 && now - open_since_ >= options_.max_batch_delay) {
+            sealLocked();
+        }
+        const bool have_work = !queue_.empty() || (spool_ && spool_->size() > 0);
+        if (stopping_) {
+            // One last attempt for the in-memory queue unless the sink is already failing.
+            while (!queue_.empty() && backoff.count() == 0 && sendOne(lock)) {}
+            break;
+        }
+        if (have_work && now >= retry_at) {
+            if (sendOne(lock)) {
+                backoff = std::chrono::milliseconds(0);
+            } else {
+                backoff = std::min(std::max(backoff * 2, std::chrono::milliseconds(kMinRetryBackoff)),
+                                   options_.max_retry_backoff);
+                retry_at = std::chrono::steady_clock::now() + backoff;
+            }
+            continue;
+        }
+
+        auto wake = std::chrono::steady_clock::time_point::max();
+        if (open_count_ != 0) {
+            wake = open_since_ + options_.max_batch_delay;
+        }
+        if (have_work) {
+            wake = std::min(wake, retry_at);
+        }
+        if (wake == std::chrono::steady_clock::time_point::max()) {
+            work_cv_.wait(lock);
+        } else {
+            work_cv_.wait_until(lock, wake);
+        }
+    }
+}
+
+bool Forwarder::flush(std::chrono::milliseconds timeout) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    sealLocked();
+    work_cv_.notify_one();
+    return drained_cv_.wait_for(lock, timeout, [this] {
+        return queue_.empty() && !sending_ && open_count_ == 0 && (!spool_ || spool_->size() == 0);
+    });
+}
+
+Forwarder::Stats Forwarder::stats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    Stats stats = stats_;
+    stats.queued_batches = queue_.size();
+    stats.spool_batches = spool_ ? spool_->size() : 0;
+    return stats;
+}
+
+} // namespace SystemMetricsForwarder
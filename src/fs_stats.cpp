@@ -0,0 +1,353 @@
+#include "fs_stats.hpp"
+#include "proc_source.hpp"
+#include "proc_parse.hpp"
+
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+
+#if defined(__unix__) || defined(__APPLE__)
+    #include <sys/statvfs.h>
+#endif
+#if defined(__linux__)
+    #include <cerrno>
+    #include <fcntl.h>
+    #include <poll.h>
+    #include <unistd.h>
+#endif
+
+namespace SystemDiskStats {
+
+namespace { // Anonymous namespace for internal helpers
+
+constexpr std::string_view kMountInfoPath = "/proc/self/mountinfo";
+
+// Filesystem types that never hold user data.
+constexpr std::string_view kPseudoFilesystems[] = {
+    "autofs", "binfmt_misc", "bpf", "cgroup", "cgroup2", "configfs", "debugfs", "devpts", "devtmpfs",
+    "efivarfs", "fusectl", "hugetlbfs", "mqueue", "nsfs", "proc", "pstore", "rpc_pipefs", "securityfs",
+    "selinuxfs", "sysfs", "tracefs",
+};
+
+[[noreturn]] void throwMalformed(std::string_view line) {
+    throw std::runtime_error("Malformed /proc/self/mountinfo line: " + std::string(line));
+}
+
+// Decodes the kernel's octal escapes ("\040" for a space) in a mountinfo path field.
+void unescapeInto(std::string_view field, std::string& out) {
+    out.clear();
+    for (std::size_t i = 0; i < field.size(); ++i) {
+        if (field[i] == '\\' && i + 3 < field.size() && field[i + 1] >= '0' && field[i + 1] <= '3' &&
+            field[i + 2] >= '0' && field[i + 2] <= '7' && field[i + 3] >= '0' && field[i + 3] <= '7') {
+            out.push_back(static_cast<char>((field[i + 1] - '0') * 64 + (field[i + 2] - '0') * 8 + (field[i + 3] - '0')));
+            i += 3;
+        } else {
+            out.push_back(field[i]);
+        }
+    }
+}
+
+bool parseDeviceNumber(std::string_view field, std::uint32_t& major, std::uint32_t& minor) {
+    const std::size_t colon = field.find(':');
+    if (colon == std::string_view::npos) return false;
+    SystemProcFS::FieldScanner major_field(field.substr(0, colon));
+    SystemProcFS::FieldScanner minor_field(field.substr(colon + 1));
+    std::uint64_t major_value = 0, minor_value = 0;
+    if (!major_field.nextUnsigned(major_value) || !minor_field.nextUnsigned(minor_value)) return false;
+    major = static_cast<std::uint32_t>(major_value);
+    minor = static_cast<std::uint32_t>(minor_value);
+    return true;
+}
+
+bool hasOption(std::string_view options, std::string_view option) {
+    while (!options.empty()) {
+        const std::size_t comma = options.find(',');
+        if (options.substr(0, comma) == option) return true;
+        if (comma == std::string_view::npos) break;
+        options.remove_prefix(comma + 1);
+    }
+    return false;
+}
+
+bool statFilesystem(const std::string& mount_point, FilesystemUsage& usage) {
+#if defined(__unix__) || defined(__APPLE__)
+    struct statvfs info{};
+    if (::statvfs(mount_point.c_str(), &info) != 0) return false;
+    const std::uint64_t unit = info.f_frsize ? info.f_frsize : info.f_bsize;
+    usage.size_bytes = static_cast<std::uint64_t>(info.f_blocks) * unit;
+    usage.free_bytes = static_cast<std::uint64_t>(info.f_bfree) * unit;
+    usage.available_bytes = static_cast<std::uint64_t>(info.f_bavail) * unit;
+    usage.used_bytes = usage.size_bytes - std::min(usage.size_bytes, usage.free_bytes);
+    usage.inodes = static_cast<std::uint64_t>(info.f_files);
+    usage.inodes_free = static_cast<std::uint64_t>(info.f_ffree);
+    return true;
+#else
+    (void)mount_point;
+    (void)usage;
+    return false;
+#endif
+}
+
+void copySizes(const FilesystemUsage& from, FilesystemUsage& to) {
+    to.size_bytes = from.size_bytes;
+    to.free_bytes = from.free_bytes;
+    to.available_bytes = from.available_bytes;
+    to.used_bytes = from.used_bytes;
+    to.inodes = from.inodes;
+    to.inodes_free = from.inodes_free;
+}
+
+} // namespace
+
+// --- MountInfoReader ---
+
+void MountInfoReader::parse(std::string_view text, std::vector<MountEntry>& out) {
+    out.clear();
+    std::string_view line;
+    while (SystemProcFS::nextLine(text, line)) {
+        if (line.empty()) continue;
+        // "36 35 98:0 /mnt1 /mnt/parent rw,noatime master:1 - ext3 /dev/root rw,errors=continue"
+        SystemProcFS::FieldScanner fields(line);
+        std::uint64_t mount_id = 0, parent_id = 0;
+        std::string_view device, root, mount_point, options, field, fs_type, source, super_options;
+        MountEntry& entry = out.emplace_back();
+        if (!fields.nextUnsigned(mount_id) || !fields.nextUnsigned(parent_id) || !fields.next(device) ||
+            !parseDeviceNumber(device, entry.major, entry.minor) || !fields.next(root) || !fields.next(mount_point) ||
+            !fields.next(options)) {
+            throwMalformed(line);
+        }
+        // Optional fields ("shared:1", "master:2", ...) run up to a lone "-".
+        do {
+            if (!fields.next(field)) throwMalformed(line);
+        } while (field != "-");
+        if (!fields.next(fs_type)) throwMalformed(line);
+        fields.next(source);
+        fields.next(super_options);
+
+        entry.mount_id = static_cast<std::uint32_t>(mount_id);
+        unescapeInto(root, entry.root);
+        unescapeInto(mount_point, entry.mount_point);
+        entry.fs_type.assign(fs_type);
+        unescapeInto(source, entry.source);
+        entry.read_only = hasOption(options, "ro");
+        entry.super_options.assign(super_options);
+    }
+}
+
+bool MountInfoReader::isPseudoFilesystem(std::string_view fs_type) {
+    return std::find(std::begin(kPseudoFilesystems), std::end(kPseudoFilesystems), fs_type) !=
+           std::end(kPseudoFilesystems);
+}
+
+const char* filesystemStatusName(FilesystemStatus status) {
+    switch (status) {
+        case FilesystemStatus::Ok: return "ok";
+        case FilesystemStatus::Failed: return "failed";
+        case FilesystemStatus::TimedOut: return "timed_out";
+    }
+    return "unknown";
+}
+
+double FilesystemUsage::usedPercent() const {
+    const std::uint64_t usable = used_bytes + available_bytes;
+    return usable == 0 ? 0.0 : 100.0 * static_cast<double>(used_bytes) / static_cast<double>(usable);
+}
+
+// --- FilesystemCollector ---
+
+// Capacity query of one mount point. Everything but mount_point is guarded by Pool::mutex.
+struct FilesystemCollector::Query {
+    explicit Query(std::string path) : mount_point(std::move(path)) {}
+
+    const std::string mount_point;
+    FilesystemUsage last;     // Sizes from the last successful call
+    bool in_flight = false;   // A worker is inside stat() for this mount
+    bool ok = false;          // Result of the last completed call
+    std::uint64_t round = 0;  // collect() round the pending or last call belongs to
+};
+
+// State shared between the collector and its detached workers, which may outlive it.
+struct FilesystemCollector::Pool {
+    std::mutex mutex;
+    std::condition_variable work_ready;
+    std::condition_variable work_done;
+    std::deque<std::shared_ptr<Query>> queue;
+    StatFunction stat;
+    std::size_t workers = 0;
+    std::size_t busy = 0;        // Workers inside stat(), including ones stuck on a hung mount
+    std::size_t outstanding = 0; // Calls of the current round not completed yet
+    std::uint64_t round = 0;
+    bool stopping = false;
+
+    static void work(std::shared_ptr<Pool> pool) {
+        std::unique_lock<std::mutex> lock(pool->mutex);
+        while (true) {
+            pool->work_ready.wait(lock, [&] { return pool->stopping || !pool->queue.empty(); });
+            if (pool->stopping) return;
+            std::shared_ptr<Query> query = std::move(pool->queue.front());
+            pool->queue.pop_front();
+            ++pool->busy;
+            lock.unlock();
+
+            FilesystemUsage usage;
+            bool ok = false;
+            try {
+                ok = pool->stat(query->mount_point, usage);
+            } catch (...) {
+                ok = false;
+            }
+
+            lock.lock();
+            --pool->busy;
+            query->in_flight = false;
+            query->ok = ok;
+            if (ok) copySizes(usage, query->last);
+            if (query->round == pool->round && --pool->outstanding == 0) pool->work_done.notify_all();
+        }
+    }
+};
+
+FilesystemCollector::FilesystemCollector() : FilesystemCollector(Options{}) {}
+
+FilesystemCollector::FilesystemCollector(Options options) : options_(std::move(options)), pool_(std::make_shared<Pool>()) {
+    if (options_.threads == 0) throw std::invalid_argument("FilesystemCollector needs at least one thread.");
+    pool_->stat = options_.stat ? options_.stat : StatFunction(statFilesystem);
+}
+
+FilesystemCollector::~FilesystemCollector() {
+    {
+        std::lock_guard<std::mutex> lock(pool_->mutex);
+        pool_->stopping = true;
+        pool_->queue.clear();
+    }
+    pool_->work_ready.notify_all();
+#if defined(__linux__)
+    if (fd_ >= 0) ::close(fd_);
+#endif
+}
+
+std::vector<FilesystemUsage> FilesystemCollector::collect() {
+    std::vector<FilesystemUsage> usage;
+    collect(usage);
+    return usage;
+}
+
+void FilesystemCollector::collect(std::vector<FilesystemUsage>& out) {
+    refreshMounts();
+    const auto deadline = std::chrono::steady_clock::now() + options_.timeout;
+
+    std::unique_lock<std::mutex> lock(pool_->mutex);
+    const std::uint64_t round = ++pool_->round;
+    pool_->outstanding = 0;
+    for (const auto& query : queries_) {
+        if (query->in_flight) continue; // Still waiting on an earlier round: do not pile up calls
+        query->in_flight = true;
+        query->round = round;
+        pool_->queue.push_back(query);
+        ++pool_->outstanding;
+    }
+    // Workers stuck on hung mounts do not count towards the pool size.
+    const std::size_t wanted = std::min(options_.threads, pool_->outstanding);
+    for (std::size_t free = pool_->workers - pool_->busy; free < wanted; ++free) {
+        try {
+            std::thread(Pool::work, pool_).detach();
+        } catch (const std::system_error&) {
+            break; // Out of threads: the existing workers still drain the queue
+        }
+        ++pool_->workers;
+    }
+    pool_->work_ready.notify_all();
+    pool_->work_done.wait_until(lock, deadline, [&] { return pool_->outstanding == 0; });
+
+    out.resize(mounts_.size());
+    for (std::size_t i = 0; i < mounts_.size(); ++i) {
+        const MountEntry& mount = mounts_[i];
+        const Query& query = *queries_[i];
+        FilesystemUsage& usage = out[i];
+        usage.mount_point = mount.mount_point;
+        usage.fs_type = mount.fs_type;
+        usage.source = mount.source;
+        usage.read_only = mount.read_only;
+        copySizes(query.last, usage);
+        if (query.round != round || query.in_flight) {
+            usage.status = FilesystemStatus::TimedOut;
+        } else if (query.ok) {
+            usage.status = FilesystemStatus::Ok;
+        } else {
+            usage.status = FilesystemStatus::Failed;
+            copySizes(FilesystemUsage{}, usage);
+        }
+    }
+    // Calls still pending are dropped from the queue; they are retried next round.
+    for (const auto& query : pool_->queue) query->in_flight = false;
+    pool_->queue.clear();
+    pool_->outstanding = 0;
+}
+
+void FilesystemCollector::refreshMounts() {
+#if defined(__linux__)
+    if (SystemProcFS::ProcFS::resolvePath(kMountInfoPath) == kMountInfoPath) {
+        if (fd_ < 0) {
+            fd_ = ::open(std::string(kMountInfoPath).c_str(), O_RDONLY | O_CLOEXEC);
+            if (fd_ < 0) throw std::runtime_error("Failed to read /proc/self/mountinfo.");
+        } else if (loaded_) {
+            // The kernel flags POLLPRI (and POLLERR) once the mount table changes after our last read.
+            pollfd event{fd_, POLLPRI, 0};
+            if (::poll(&event, 1, 0) <= 0 || (event.revents & (POLLPRI | POLLERR)) == 0) return;
+        }
+        if (::lseek(fd_, 0, SEEK_SET) != 0) throw std::runtime_error("Failed to read /proc/self/mountinfo.");
+        text_.clear();
+        std::size_t size = 0;
+        while (true) {
+            if (text_.size() - size < 4096) text_.resize(size + 16384);
+            const ssize_t got = ::read(fd_, &text_[size], text_.size() - size);
+            if (got < 0 && errno == EINTR) continue;
+            if (got < 0) throw std::runtime_error("Failed to read /proc/self/mountinfo.");
+            if (got == 0) break;
+            size += static_cast<std::size_t>(got);
+        }
+        text_.resize(size);
+        applyMountTable();
+        return;
+    }
+#endif
+    std::string text;
+    if (!SystemProcFS::ProcFS::readFile(kMountInfoPath, text)) {
+        throw std::runtime_error("Failed to read /proc/self/mountinfo.");
+    }
+    if (loaded_ && text == text_) return;
+    text_.swap(text);
+    applyMountTable();
+}
+
+void FilesystemCollector::applyMountTable() {
+    MountInfoReader::parse(text_, parsed_);
+    ++mount_table_reads_;
+    loaded_ = true;
+
+    // Keep the query of every mount point that is still mounted, so one that is hung stays marked.
+    std::unordered_map<std::string_view, std::shared_ptr<Query>> previous;
+    for (const auto& query : queries_) previous.emplace(query->mount_point, query);
+    std::unordered_set<std::uint64_t> devices;
+    std::vector<std::shared_ptr<Query>> queries;
+    mounts_.clear();
+    for (MountEntry& entry : parsed_) {
+        if (!options_.include_pseudo && MountInfoReader::isPseudoFilesystem(entry.fs_type)) continue;
+        // Further mounts of the same device (bind mounts) report the same capacity.
+        if (!devices.insert((std::uint64_t{entry.major} << 32) | entry.minor).second) continue;
+        const auto found = previous.find(entry.mount_point);
+        queries.push_back(found != previous.end() ? found->second : std::make_shared<Query>(entry.mount_point));
+        mounts_.push_back(std::move(entry));
+    }
+    queries_.swap(queries);
+}
+
+} // namespace SystemDiskStats
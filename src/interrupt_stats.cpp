@@ -0,0 +1,206 @@
+#include "interrupt_stats.hpp"
+#include "proc_source.hpp"
+#include "proc_parse.hpp"
+#include "simd_scan.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+namespace SystemInterruptStats {
+
+namespace { // Anonymous namespace for internal helpers
+
+inline bool isBlank(char c) { return c == ' ' || c == '\t'; }
+
+std::string_view trim(std::string_view text) {
+    while (!text.empty() && isBlank(text.front())) text.remove_prefix(1);
+    while (!text.empty() && (isBlank(text.back()) || text.back() == '\r')) text.remove_suffix(1);
+    return text;
+}
+
+// The kernel prints every per-CPU counter as " %10u".
+constexpr std::size_t kColumnWidth = 11;
+
+// Parses up to `columns` counters from the start of `text` into `row` and zero-fills the rest.
+// Returns the text after the last counter (the chip and handler names, if any). Rows in the
+// kernel's fixed-width layout take the fast path; anything else (system-wide rows such as ERR
+// with a single counter, hand-written fixtures) is tokenized.
+std::string_view parseCounters(std::string_view text, std::uint64_t* row, std::size_t columns) {
+    if (SystemProcFS::parseFixedWidthColumns(text, kColumnWidth, row, columns)) {
+        const std::string_view rest = text.substr(columns * kColumnWidth);
+        if (rest.empty() || isBlank(rest.front())) return rest;
+    }
+    std::size_t consumed = 0;
+    const std::size_t parsed = SystemProcFS::parseUnsignedRun(text, row, columns, consumed);
+    std::fill(row + parsed, row + columns, std::uint64_t{0});
+    return text.substr(consumed);
+}
+
+} // namespace
+
+const char* tablePath(InterruptTable table) {
+    return table == InterruptTable::Soft ? "/proc/softirqs" : "/proc/interrupts";
+}
+
+long InterruptMatrix::find(std::string_view name) const {
+    for (std::size_t r = 0; r < names.size(); ++r) {
+        if (names[r] == name) return static_cast<long>(r);
+    }
+    return -1;
+}
+
+// --- InterruptStatsReader ---
+
+void InterruptStatsReader::parse(std::string_view text, InterruptMatrix& out) {
+    std::string_view line;
+    if (!SystemProcFS::nextLine(text, line)) throw std::runtime_error("Malformed interrupt table: missing CPU header.");
+
+    out.cpus.clear();
+    SystemProcFS::FieldScanner header(line);
+    std::string_view field;
+    while (header.next(field)) {
+        std::uint64_t cpu = 0;
+        if (field.size() <= 3 || field.substr(0, 3) != "CPU" || !SystemProcFS::parseDecimal(field.substr(3), cpu)) {
+            throw std::runtime_error("Malformed interrupt table header: " + std::string(line));
+        }
+        out.cpus.push_back(static_cast<unsigned>(cpu));
+    }
+    if (out.cpus.empty()) throw std::runtime_error("Malformed interrupt table header: " + std::string(line));
+
+    const std::size_t columns = out.cpus.size();
+    std::size_t rows = 0;
+    while (SystemProcFS::nextLine(text, line)) {
+        const std::size_t colon = line.find(':');
+        if (colon == std::string_view::npos) continue;
+        if (rows == out.names.size()) {
+            out.names.emplace_back();
+            out.descriptions.emplace_back();
+        }
+        // Grows only while the table does; a stable layout overwrites the previous counters in place.
+        if (out.counts.size() < (rows + 1) * columns) out.counts.resize((rows + 1) * columns);
+        out.names[rows].assign(trim(line.substr(0, colon)));
+        const std::string_view rest = parseCounters(line.substr(colon + 1), out.counts.data() + rows * columns, columns);
+        out.descriptions[rows].assign(trim(rest));
+        ++rows;
+    }
+    out.names.resize(rows);
+    out.descriptions.resize(rows);
+    out.counts.resize(rows * columns);
+}
+
+void InterruptStatsReader::read(InterruptTable table, InterruptMatrix& out, std::string& buffer) {
+    if (!SystemProcFS::ProcFS::readFile(tablePath(table), buffer)) {
+        throw std::runtime_error(std::string("Failed to read ") + tablePath(table) + ".");
+    }
+    parse(buffer, out);
+}
+
+// --- InterruptCollector ---
+
+InterruptCollector::InterruptCollector(InterruptTable table) : table_(table) {}
+
+void InterruptCollector::sample() {
+    sample(Clock::now());
+}
+
+void InterruptCollector::sample(Clock::time_point now) {
+    // Parse into the older matrix so the previous reading stays intact for the deltas.
+    const std::size_t next = samples_ == 0 ? current_ : current_ ^ 1;
+    InterruptStatsReader::read(table_, matrices_[next], buffer_);
+    current_ = next;
+    ++samples_;
+    const Clock::time_point previous_time = last_time_;
+    last_time_ = now;
+    if (samples_ < 2) return;
+
+    const InterruptMatrix& curr = matrices_[current_];
+    const std::size_t rows = curr.rows();
+    const std::size_t columns = curr.columns();
+    const std::size_t cells = curr.counts.size();
+
+    rates_.elapsed_seconds = std::chrono::duration<double>(now - previous_time).count();
+    rates_.columns = columns;
+    rates_.deltas.resize(cells);
+    SystemProcFS::subtractCounters(alignedPrevious(), curr.counts.data(), rates_.deltas.data(), cells);
+
+    const double scale = rates_.elapsed_seconds > 0.0 ? 1.0 / rates_.elapsed_seconds : 0.0;
+    cpu_totals_.assign(columns, 0);
+    rates_.per_irq.resize(rows);
+    for (std::size_t r = 0; r < rows; ++r) {
+        const std::uint64_t* delta = rates_.deltas.data() + r * columns;
+        std::uint64_t row_total = 0;
+        for (std::size_t c = 0; c < columns; ++c) {
+            row_total += delta[c];
+            cpu_totals_[c] += delta[c];
+        }
+        rates_.per_irq[r] = static_cast<double>(row_total) * scale;
+    }
+    rates_.per_cpu.resize(columns);
+    for (std::size_t c = 0; c < columns; ++c) rates_.per_cpu[c] = static_cast<double>(cpu_totals_[c]) * scale;
+}
+
+const std::uint64_t* InterruptCollector::alignedPrevious() {
+    const InterruptMatrix& prev = matrices_[current_ ^ 1];
+    const InterruptMatrix& curr = matrices_[current_];
+    if (prev.cpus == curr.cpus && prev.names == curr.names) return prev.counts.data();
+
+    // The layout changed: line up the previous counters by row label and CPU number. Cells
+    // with no previous value take the current one, so they contribute no delta this interval.
+    std::unordered_map<std::string_view, std::size_t> prev_rows;
+    prev_rows.reserve(prev.rows());
+    for (std::size_t r = 0; r < prev.rows(); ++r) prev_rows.emplace(prev.names[r], r);
+    std::vector<long> prev_columns(curr.columns(), -1);
+    for (std::size_t c = 0; c < curr.columns(); ++c) {
+        const auto it = std::find(prev.cpus.begin(), prev.cpus.end(), curr.cpus[c]);
+        if (it != prev.cpus.end()) prev_columns[c] = it - prev.cpus.begin();
+    }
+
+    aligned_ = curr.counts;
+    for (std::size_t r = 0; r < curr.rows(); ++r) {
+        const auto found = prev_rows.find(curr.names[r]);
+        if (found == prev_rows.end()) continue;
+        std::uint64_t* out = aligned_.data() + r * curr.columns();
+        const std::uint64_t* in = prev.row(found->second);
+        for (std::size_t c = 0; c < curr.columns(); ++c) {
+            if (prev_columns[c] >= 0) out[c] = in[prev_columns[c]];
+        }
+    }
+    return aligned_.data();
+}
+
+std::vector<HotInterrupt> InterruptCollector::hottest(std::size_t k) const {
+    std::vector<HotInterrupt> result;
+    if (!hasRates() || k == 0) return result;
+
+    std::vector<std::size_t> order;
+    for (std::size_t r = 0; r < rates_.per_irq.size(); ++r) {
+        if (rates_.per_irq[r] > 0.0) order.push_back(r);
+    }
+    k = (std::min)(k, order.size());
+    std::partial_sort(order.begin(), order.begin() + static_cast<std::ptrdiff_t>(k), order.end(),
+                      [this](std::size_t a, std::size_t b) {
+                          if (rates_.per_irq[a] != rates_.per_irq[b]) return rates_.per_irq[a] > rates_.per_irq[b];
+                          return a < b;
+                      });
+
+    const InterruptMatrix& curr = current();
+    result.reserve(k);
+    for (std::size_t i = 0; i < k; ++i) {
+        const std::size_t r = order[i];
+        const std::uint64_t* delta = rates_.deltas.data() + r * rates_.columns;
+        const std::size_t busiest = static_cast<std::size_t>(std::max_element(delta, delta + rates_.columns) - delta);
+        HotInterrupt hot;
+        hot.name = curr.names[r];
+        hot.description = curr.descriptions[r];
+        hot.rate = rates_.per_irq[r];
+        hot.busiest_cpu = curr.cpus[busiest];
+        hot.busiest_cpu_rate = rates_.rate(r, busiest);
+        result.push_back(std::move(hot));
+    }
+    return result;
+}
+
+} // namespace SystemInterruptStats
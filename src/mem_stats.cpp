@@ -1,9 +1,12 @@
 #define _WIN32_WINNT 0x0501 // Required for MEMORYSTATUSEX and GlobalMemoryStatusEx for Windows
 
 #include "mem_stats.hpp" // Ensure this is the correct, latest header
+#include "proc_source.hpp" // For the pluggable /proc source
+#include "key_value_reader.hpp" // Compile-time keyed /proc tables
 #include <stdexcept>
 #include <fstream>
 #include <string>
+#include <string_view>
 #include <sstream>
 #include <vector>
 #include <cctype> // For std::isalnum
@@ -67,6 +70,24 @@ unsigned long long parseMeminfoLineInternal(const std::string& line, const std::
 
     return value;
 }
+
+// /proc/meminfo fields gathered into MemStats; adding a field is one line here.
+struct MeminfoSchema {
+    using Record = MemStats;
+    static constexpr std::string_view name = "meminfo";
+    static constexpr char separator = ':';
+    static constexpr std::string_view unit = "kB";
+    static constexpr SystemProcFS::KeyField<MemStats> fields[] = {
+        {"MemTotal", &MemStats::total},
+        {"MemFree", &MemStats::free},
+        {"MemAvailable", &MemStats::available},
+        {"Buffers", &MemStats::buffers},
+        {"Cached", &MemStats::cached},
+        {"SwapTotal", &MemStats::swap_total},
+        {"SwapFree", &MemStats::swap_free},
+    };
+};
+using MeminfoReader = SystemProcFS::KeyValueProcReader<MeminfoSchema>;
 } // anonymous namespace
 #endif // __linux__
 
@@ -101,24 +122,9 @@ MemStats MeMStatsReader::getRawWindowsMemStats() {
 
 MemStats MeMStatsReader::getRawLinuxMemStats() {
 #if defined(__linux__)
-    std::ifstream file("/proc/meminfo");
-    if (!file.is_open()) {
-        throw std::runtime_error("Could not open /proc/meminfo.");
-    }
-
+    std::string contents;
     MemStats stats;
-    std::string line;
-    while (std::getline(file, line)) {
-        if (line.empty()) continue;
-
-        if (line.rfind("MemTotal:", 0) == 0) stats.total = parseMeminfoLineInternal(line, "MemTotal:");
-        else if (line.rfind("MemFree:", 0) == 0) stats.free = parseMeminfoLineInternal(line, "MemFree:");
-        else if (line.rfind("MemAvailable:", 0) == 0) stats.available = parseMeminfoLineInternal(line, "MemAvailable:");
-        else if (line.rfind("Buffers:", 0) == 0) stats.buffers = parseMeminfoLineInternal(line, "Buffers:");
-        else if (line.rfind("Cached:", 0) == 0) stats.cached = parseMeminfoLineInternal(line, "Cached:");
-        else if (line.rfind("SwapTotal:", 0) == 0) stats.swap_total = parseMeminfoLineInternal(line, "SwapTotal:");
-        else if (line.rfind("SwapFree:", 0) == 0) stats.swap_free = parseMeminfoLineInternal(line, "SwapFree:");
-    }
+    getMemStats(stats, contents);
     return stats; // Return a single MemStats object
 #else
     throw std::runtime_error("Linux memory statistics not supported on this platform.");
@@ -211,6 +217,19 @@ MemStats MeMStatsReader::getMemStats() {
     return getPlatformMemStats();
 }
 
+void MeMStatsReader::getMemStats(MemStats& out, std::string& buffer) {
+#if defined(__linux__)
+    if (!SystemProcFS::ProcFS::readFile("/proc/meminfo", buffer)) {
+        throw std::runtime_error("Could not open /proc/meminfo.");
+    }
+    out = MemStats();
+    MeminfoReader::parse(buffer, out);
+#else
+    (void)buffer;
+    out = getMemStats();
+#endif
+}
+
 #if defined(__linux__)
 // Public parser implementation for Linux
 unsigned long long MeMStatsReader::parseMeminfoLine(const std::string& line, const std::string& key) {
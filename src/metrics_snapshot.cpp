@@ -0,0 +1,54 @@
+#include "metrics_snapshot.hpp"
+
+#include <chrono>
+#include <type_traits>
+
+namespace SystemMetricsSnapshot {
+
+std::uint64_t SnapshotCollector::nowMs() {
+    return static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count());
+}
+
+MetricsSnapshot SnapshotCollector::collect() {
+    MetricsSnapshot snapshot;
+    collect(snapshot);
+    return snapshot;
+}
+
+void SnapshotCollector::collect(MetricsSnapshot& out) {
+    out.timestamp_ms = nowMs();
+    out.cpu = SystemCPUStats::CPUStatsReader::getCPUStats();
+    out.mem = SystemMemoryStats::MeMStatsReader::getMemStats();
+    out.disks = SystemDiskStats::DiskStatsReader::getAllDiskStats();
+    out.nets = SystemNetStats::NetStatsReader::getAllNetStats();
+}
+
+static_assert(std::is_trivially_copyable<SystemDiskStats::DiskRecord>::value, "DiskRecord must stay trivially copyable");
+static_assert(std::is_trivially_copyable<SystemNetStats::NetRecord>::value, "NetRecord must stay trivially copyable");
+
+void FixedSnapshot::expand(MetricsSnapshot& out) const {
+    out.timestamp_ms = timestamp_ms;
+    out.cpu = cpu;
+    out.mem = mem;
+    out.disks.clear();
+    for (const auto& record : disks) out.disks.push_back(SystemDiskStats::toDiskStats(record));
+    out.nets.clear();
+    for (const auto& record : nets) out.nets.push_back(SystemNetStats::toNetStats(record));
+}
+
+void RecordCollector::collect(FixedSnapshot& out) {
+    out.timestamp_ms = SnapshotCollector::nowMs();
+    SystemCPUStats::CPUStatsReader::getCPUStats(out.cpu, buffer_);
+    SystemMemoryStats::MeMStatsReader::getMemStats(out.mem, buffer_);
+    SystemDiskStats::DiskStatsReader::getAllDiskRecords(out.disks, buffer_);
+    SystemNetStats::NetStatsReader::getAllNetRecords(out.nets, buffer_);
+}
+
+FixedSnapshot RecordCollector::collect(SystemMetricsArena::CollectionArena& arena) {
+    FixedSnapshot snapshot(arena.resource());
+    collect(snapshot);
+    return snapshot;
+}
+
+} // namespace SystemMetricsSnapshot
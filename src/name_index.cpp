@@ -0,0 +1,93 @@
+#include "name_index.hpp"
+
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+namespace SystemMetricsIndex {
+
+namespace { // Anonymous namespace for internal helpers
+// Ids are small and dense, so spread them over the table with a Fibonacci multiplier.
+inline std::size_t slotFor(NameId id, std::size_t mask) {
+    return static_cast<std::size_t>((static_cast<std::uint64_t>(id) * 0x9E3779B97F4A7C15ULL) >> 32) & mask;
+}
+} // namespace
+
+// --- NameInterner ---
+
+NameInterner& NameInterner::global() {
+    static NameInterner interner;
+    return interner;
+}
+
+NameId NameInterner::intern(std::string_view name) {
+    {
+        std::shared_lock<std::shared_mutex> lock(mutex_);
+        auto it = ids_.find(name);
+        if (it != ids_.end()) return it->second;
+    }
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+    auto it = ids_.find(name); // Another thread may have interned it in between
+    if (it != ids_.end()) return it->second;
+    if (names_.size() >= kNoName) {
+        throw std::length_error("NameInterner: too many distinct names.");
+    }
+    const NameId id = static_cast<NameId>(names_.size());
+    names_.emplace_back(name);
+    ids_.emplace(names_.back(), id);
+    return id;
+}
+
+NameId NameInterner::find(std::string_view name) const {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    auto it = ids_.find(name);
+    return it == ids_.end() ? kNoName : it->second;
+}
+
+std::string_view NameInterner::name(NameId id) const {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    if (id >= names_.size()) {
+        throw std::out_of_range("NameInterner: unknown name id " + std::to_string(id));
+    }
+    return names_[id];
+}
+
+std::size_t NameInterner::size() const {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    return names_.size();
+}
+
+// --- NameIndex ---
+
+NameIndex::NameIndex(std::vector<NameId> ids) : ids_(std::move(ids)) {
+    std::size_t capacity = 8;
+    while (capacity < ids_.size() * 2) capacity <<= 1;
+    slots_.assign(capacity, Slot{});
+    mask_ = capacity - 1;
+    for (std::size_t position = 0; position < ids_.size(); ++position) {
+        const NameId id = ids_[position];
+        if (id == kNoName) continue;
+        std::size_t i = slotFor(id, mask_);
+        while (slots_[i].id != kNoName && slots_[i].id != id) i = (i + 1) & mask_;
+        if (slots_[i].id == kNoName) {
+            slots_[i] = Slot{id, static_cast<std::uint32_t>(position)};
+        }
+    }
+}
+
+std::size_t NameIndex::find(NameId id) const {
+    if (id == kNoName || slots_.empty()) return npos;
+    for (std::size_t i = slotFor(id, mask_);; i = (i + 1) & mask_) {
+        if (slots_[i].id == id) return slots_[i].position;
+        if (slots_[i].id == kNoName) return npos; // The load factor guarantees an empty slot
+    }
+}
+
+std::shared_ptr<const NameIndex> NameIndex::reuseOrBuild(const std::shared_ptr<const NameIndex>& previous,
+                                                         std::vector<NameId> ids) {
+    if (previous && previous->ids_ == ids) return previous;
+    return std::make_shared<const NameIndex>(std::move(ids));
+}
+
+} // namespace SystemMetricsIndex
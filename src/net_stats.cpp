@@ -1,7 +1,15 @@
 #include "net_stats.hpp"
-
+#include "proc_source.hpp"
+#include "read_cache.hpp"
+#include "name_index.hpp"
+#include "proc_parse.hpp"
+#include "simd_scan.hpp"
+#include "logger.hpp"
+
+#include <memory>
 #include <stdexcept>
 #include <string>
+#include <string_view>
 #include <vector>
 #include <iostream> // For error logging/debugging
 #include <numeric>  // For std::accumulate in aggregated stats
@@ -92,72 +100,14 @@ std::vector<NetStats> NetStatsReader::getRawWindowsNetStats() {
 }
 
 #elif defined(__linux__)
-namespace { // Anonymous namespace for Linux-only internal helpers
-// Helper to parse a line from /proc/net/dev
-NetStats parseNetDevLine(const std::string& line) {
-    std::istringstream iss(line);
-    std::string interface_name;
-    // Skip initial whitespace
-    iss >> std::ws;
-    iss >> interface_name;
-
-    // Remove the colon from the interface name (e.g., "eth0:")
-    if (!interface_name.empty() && interface_name.back() == ':') {
-        interface_name.pop_back();
-    }
-
-    NetStats stats(interface_name);
-    // The /proc/net/dev format is complex. We'll read specific fields.
-    // Format: "interface:bytes_recieved packets_recieved errs drop fifo frames compressed multicast bytes_sent ..."
-    // The numbers are separated by spaces.
-    // Field indices (0-indexed after interface name, so 0 is bytes_received, 1 is packets_received etc.)
-    // received: bytes(0) packets(1) errs(2) drop(3) fifo(4) frame(5) compressed(6) multicast(7)
-    // transmitted: bytes(8) packets(9) errs(10) drop(11) fifo(12) colls(13) carrier(14) compressed(15)
-
-    // Read received stats
-    if (!(iss >> stats.bytes_received >> stats.packets_received >> stats.errors_in >> stats.drops_in)) {
-        throw std::runtime_error("Failed to parse received stats for interface: " + interface_name);
-    }
-    // Skip 4 dummy fields for received (fifo, frame, compressed, multicast)
-    unsigned long long dummy;
-    for (int i = 0; i < 4; ++i) iss >> dummy;
-
-    // Read transmitted stats
-    if (!(iss >> stats.bytes_sent >> stats.packets_sent >> stats.errors_out >> stats.drops_out)) {
-        throw std::runtime_error("Failed to parse transmitted stats for interface: " + interface_name);
-    }
-
-    return stats;
-}
-} // anonymous namespace
-
 std::vector<NetStats> NetStatsReader::getRawLinuxNetStats() {
-    std::ifstream file("/proc/net/dev");
-    if (!file.is_open()) {
-        throw std::runtime_error("Could not open /proc/net/dev. Ensure you have permissions.");
-    }
-
+    std::string contents;
+    std::pmr::vector<NetRecord> records;
+    getAllNetRecords(records, contents);
     std::vector<NetStats> all_stats;
-    std::string line;
-
-    // Skip header lines (usually 2 lines)
-    std::getline(file, line); // header 1
-    std::getline(file, line); // header 2
-
-    while (std::getline(file, line)) {
-        if (line.empty()) continue;
-        try {
-            NetStats stats = parseNetDevLine(line);
-            // Example filtering for common virtual/non-physical interfaces, keeping "lo" now.
-            if (stats.interface_name.find("veth") == std::string::npos &&
-                stats.interface_name.find("docker") == std::string::npos &&
-                stats.interface_name.find("br-") == std::string::npos) {
-                all_stats.push_back(std::move(stats));
-            }
-        } catch (const std::runtime_error& e) {
-            std::cerr << "Warning: Failed to parse net/dev line: " << line << " - " << e.what() << std::endl;
-            // Continue to next line
-        }
+    all_stats.reserve(records.size());
+    for (const auto& record : records) {
+        all_stats.push_back(toNetStats(record));
     }
     return all_stats;
 }
@@ -218,6 +168,91 @@ std::vector<NetStats> NetStatsReader::getRawUnsupportedNetStats() {
 }
 #endif
 
+bool NetStatsReader::parseNetDevLine(std::string_view line, std::string_view& interface_name, NetRecord& record) {
+    // Format: "  eth0: rx_bytes rx_packets rx_errs rx_drop fifo frame compressed multicast
+    //          tx_bytes tx_packets tx_errs tx_drop fifo colls carrier compressed".
+    // Large counters can run into the colon ("eth0:123456"), so split on it rather than on whitespace.
+    const std::size_t colon = line.find(':');
+    if (colon == std::string_view::npos) return false;
+    SystemProcFS::FieldScanner name_field(line.substr(0, colon));
+    if (!name_field.next(interface_name)) return false;
+
+    const SystemProcFS::LineFields fields(line.substr(colon + 1));
+    std::uint64_t rx_bytes = 0, rx_packets = 0, rx_errs = 0, rx_drop = 0;
+    std::uint64_t tx_bytes = 0, tx_packets = 0, tx_errs = 0, tx_drop = 0;
+    if (fields.size() < 12 ||
+        !fields.unsignedAt(0, rx_bytes) || !fields.unsignedAt(1, rx_packets) || !fields.unsignedAt(2, rx_errs) ||
+        !fields.unsignedAt(3, rx_drop) ||
+        !fields.unsignedAt(8, tx_bytes) || !fields.unsignedAt(9, tx_packets) || !fields.unsignedAt(10, tx_errs) ||
+        !fields.unsignedAt(11, tx_drop)) {
+        return false;
+    }
+    record.bytes_received = rx_bytes;
+    record.packets_received = rx_packets;
+    record.errors_in = rx_errs;
+    record.drops_in = rx_drop;
+    record.bytes_sent = tx_bytes;
+    record.packets_sent = tx_packets;
+    record.errors_out = tx_errs;
+    record.drops_out = tx_drop;
+    return true;
+}
+
+bool NetStatsReader::isReportedInterface(std::string_view interface_name) {
+    // Example filtering for common virtual/non-physical interfaces, keeping "lo".
+    return interface_name.find("veth") == std::string_view::npos &&
+           interface_name.find("docker") == std::string_view::npos &&
+           interface_name.find("br-") == std::string_view::npos;
+}
+
+void NetStatsReader::getAllNetRecords(std::pmr::vector<NetRecord>& out, std::string& buffer) {
+    out.clear();
+#if defined(__linux__)
+    if (!SystemProcFS::ProcFS::readFile("/proc/net/dev", buffer)) {
+        throw std::runtime_error("Could not open /proc/net/dev. Ensure you have permissions.");
+    }
+    std::string_view contents(buffer);
+    std::string_view line;
+    // Skip header lines (usually 2 lines)
+    SystemProcFS::nextLine(contents, line);
+    SystemProcFS::nextLine(contents, line);
+    while (SystemProcFS::nextLine(contents, line)) {
+        std::string_view interface_name;
+        NetRecord record;
+        if (!parseNetDevLine(line, interface_name, record)) {
+            if (line.find_first_not_of(" \t\r") != std::string_view::npos) {
+                SystemMetricsLogger::Logger::warning("Failed to parse net/dev line: " + std::string(line));
+            }
+            continue;
+        }
+        if (!isReportedInterface(interface_name)) continue;
+        record.interface_name = SystemMetricsIndex::NameInterner::global().intern(interface_name);
+        out.push_back(record);
+    }
+#else
+    (void)buffer;
+    for (const auto& stats : getPlatformNetStats()) {
+        NetRecord record;
+        record.interface_name = SystemMetricsIndex::NameInterner::global().intern(stats.interface_name);
+        record.bytes_received = stats.bytes_received;
+        record.bytes_sent = stats.bytes_sent;
+        record.packets_received = stats.packets_received;
+        record.packets_sent = stats.packets_sent;
+        record.errors_in = stats.errors_in;
+        record.errors_out = stats.errors_out;
+        record.drops_in = stats.drops_in;
+        record.drops_out = stats.drops_out;
+        out.push_back(record);
+    }
+#endif
+}
+
+NetStats toNetStats(const NetRecord& record) {
+    return NetStats(std::string(SystemMetricsIndex::NameInterner::global().name(record.interface_name)),
+                    record.bytes_received, record.bytes_sent, record.packets_received, record.packets_sent,
+                    record.errors_in, record.errors_out, record.drops_in, record.drops_out);
+}
+
 /// @brief Private helper to dispatch to the correct platform-specific function.
 /// This centralizes the platform selection logic.
 std::vector<NetStats> NetStatsReader::getPlatformNetStats() {
@@ -232,13 +267,47 @@ std::vector<NetStats> NetStatsReader::getPlatformNetStats() {
 #endif
 }
 
+namespace {
+/// @brief One parsed interface list plus an index from interned interface name to position.
+struct NetSample {
+    std::vector<NetStats> stats;
+    std::shared_ptr<const SystemMetricsIndex::NameIndex> index;
+};
+
+/// @brief Shares one platform read between concurrent callers (and, within the configured
+/// staleness window, sequential ones). Every public getter goes through it.
+SystemProcFS::CoalescingCache<NetSample>& statsCache() {
+    static SystemProcFS::CoalescingCache<NetSample> cache;
+    return cache;
+}
+
+NetSample buildSample(std::vector<NetStats> stats) {
+    // The cache runs at most one loader at a time, so the previous index needs no lock.
+    static std::shared_ptr<const SystemMetricsIndex::NameIndex> previous_index;
+    NetSample sample{std::move(stats), nullptr};
+    std::vector<SystemMetricsIndex::NameId> ids;
+    ids.reserve(sample.stats.size());
+    for (const auto& stats : sample.stats) {
+        ids.push_back(SystemMetricsIndex::NameInterner::global().intern(stats.interface_name));
+    }
+    sample.index = SystemMetricsIndex::NameIndex::reuseOrBuild(previous_index, std::move(ids));
+    previous_index = sample.index;
+    return sample;
+}
+
+const NetStats* findInterface(const NetSample& sample, std::string_view interface_name) {
+    const std::size_t position = sample.index->find(SystemMetricsIndex::NameInterner::global().find(interface_name));
+    return position == SystemMetricsIndex::NameIndex::npos ? nullptr : &sample.stats[position];
+}
+} // namespace
+
 // --- Public API Implementation ---
 
 NetStats NetStatsReader::getNetStats() {
-    const auto all_stats = NetStatsReader::getPlatformNetStats();
+    const auto sample = statsCache().get([] { return buildSample(getPlatformNetStats()); });
 
     NetStats aggregated_stats{"aggregated", 0, 0, 0, 0, 0, 0, 0, 0};
-    for (const auto& stats : all_stats) {
+    for (const auto& stats : sample->stats) {
         aggregated_stats.bytes_received += stats.bytes_received;
         aggregated_stats.bytes_sent += stats.bytes_sent;
         aggregated_stats.packets_received += stats.packets_received;
@@ -258,15 +327,39 @@ NetStats NetStatsReader::getNetStats(const std::string& interface_name) {
         throw std::invalid_argument("Interface name cannot be empty.");
     }
 
-    const auto all_stats = NetStatsReader::getPlatformNetStats();
+    const auto sample = statsCache().get([] { return buildSample(getPlatformNetStats()); });
+    if (const NetStats* stats = findInterface(*sample, interface_name)) {
+        return *stats;
+    }
 
-    for (const auto& stats : all_stats) {
-        if (stats.interface_name == interface_name) {
-            return stats;
+    throw std::runtime_error("Network interface '" + interface_name + "' not found or has no stats.");
+}
+
+std::map<std::string, NetStats> NetStatsReader::getNetStatsForInterfaces(const std::vector<std::string>& interface_names) {
+    const auto sample = statsCache().get([] { return buildSample(getPlatformNetStats()); });
+    std::map<std::string, NetStats> found;
+    for (const auto& name : interface_names) {
+        if (const NetStats* stats = findInterface(*sample, name)) {
+            found.emplace(name, *stats);
         }
     }
+    return found;
+}
 
-    throw std::runtime_error("Network interface '" + interface_name + "' not found or has no stats.");
+std::vector<NetStats> NetStatsReader::getAllNetStats() {
+    return statsCache().get([] { return buildSample(getPlatformNetStats()); })->stats;
+}
+
+void NetStatsReader::setCacheMaxAge(std::chrono::milliseconds max_age) {
+    statsCache().setMaxAge(max_age);
+}
+
+SystemProcFS::CacheStats NetStatsReader::cacheStats() {
+    return statsCache().stats();
+}
+
+void NetStatsReader::invalidateCache() {
+    statsCache().invalidate();
 }
 
 } // namespace SystemNetStats
\ No newline at end of file
@@ -0,0 +1,254 @@
+#include "numa_stats.hpp"
+#include "key_value_reader.hpp"
+#include "proc_parse.hpp"
+#include "proc_source.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+
+namespace SystemNumaStats {
+
+namespace { // Anonymous namespace for internal helpers
+
+constexpr std::string_view kNodeRoot = "/sys/devices/system/node";
+
+struct NodeMeminfoSchema {
+    using Record = NumaMemory;
+    static constexpr std::string_view name = "node meminfo";
+    static constexpr char separator = ':';
+    static constexpr std::string_view unit = "kB";
+    static constexpr SystemProcFS::KeyField<NumaMemory> fields[] = {
+        {"MemTotal", &NumaMemory::total},
+        {"MemFree", &NumaMemory::free},
+        {"MemUsed", &NumaMemory::used},
+        {"Active", &NumaMemory::active},
+        {"Inactive", &NumaMemory::inactive},
+        {"FilePages", &NumaMemory::file_pages},
+        {"AnonPages", &NumaMemory::anon_pages},
+        {"Slab", &NumaMemory::slab},
+    };
+};
+using NodeMeminfoReader = SystemProcFS::KeyValueProcReader<NodeMeminfoSchema>;
+
+struct NumastatSchema {
+    using Record = NumaCounters;
+    static constexpr std::string_view name = "numastat";
+    static constexpr char separator = ' ';
+    static constexpr std::string_view unit = "";
+    static constexpr SystemProcFS::KeyField<NumaCounters> fields[] = {
+        {"numa_hit", &NumaCounters::numa_hit},
+        {"numa_miss", &NumaCounters::numa_miss},
+        {"numa_foreign", &NumaCounters::numa_foreign},
+        {"interleave_hit", &NumaCounters::interleave_hit},
+        {"local_node", &NumaCounters::local_node},
+        {"other_node", &NumaCounters::other_node},
+    };
+};
+using NumastatReader = SystemProcFS::KeyValueProcReader<NumastatSchema>;
+
+std::string nodePath(unsigned node, std::string_view file) {
+    return std::string(kNodeRoot) + "/node" + std::to_string(node) + "/" + std::string(file);
+}
+
+// Strips surrounding whitespace (the sysfs files end in '\n').
+std::string_view trim(std::string_view text) {
+    const std::size_t begin = text.find_first_not_of(" \t\n");
+    if (begin == std::string_view::npos) return std::string_view();
+    return text.substr(begin, text.find_last_not_of(" \t\n") + 1 - begin);
+}
+
+bool parseNumber(std::string_view digits, unsigned& value) {
+    SystemProcFS::FieldScanner scanner(digits);
+    std::uint64_t parsed = 0;
+    std::string_view rest;
+    if (!scanner.nextUnsigned(parsed) || scanner.next(rest) || parsed > 0xFFFFFFFFu) return false;
+    value = static_cast<unsigned>(parsed);
+    return true;
+}
+
+double perSecond(unsigned long long previous, unsigned long long current, double scale) {
+    return static_cast<double>(SystemCPUStats::counterDelta(previous, current)) * scale;
+}
+
+void addCounters(SystemCPUStats::CPUCounters& sum, const SystemCPUStats::CPUCounters& add) {
+    sum.user += add.user;
+    sum.nice += add.nice;
+    sum.system += add.system;
+    sum.idle += add.idle;
+    sum.iowait += add.iowait;
+    sum.irq += add.irq;
+    sum.softirq += add.softirq;
+    sum.steal += add.steal;
+    sum.guest += add.guest;
+    sum.guest_nice += add.guest_nice;
+}
+
+} // namespace
+
+// --- NumaTopology ---
+
+NumaTopology::NumaTopology(std::vector<NumaNodeTopology> nodes) : nodes_(std::move(nodes)) {
+    std::sort(nodes_.begin(), nodes_.end(),
+              [](const NumaNodeTopology& a, const NumaNodeTopology& b) { return a.node < b.node; });
+    for (std::size_t n = 0; n < nodes_.size(); ++n) {
+        for (unsigned cpu : nodes_[n].cpus) {
+            if (cpu >= node_of_cpu_.size()) node_of_cpu_.resize(cpu + 1, -1);
+            node_of_cpu_[cpu] = static_cast<int>(nodes_[n].node);
+        }
+    }
+}
+
+std::vector<unsigned> NumaTopology::parseCpuList(std::string_view text) {
+    std::vector<unsigned> cpus;
+    text = trim(text);
+    while (!text.empty()) {
+        const std::size_t comma = text.find(',');
+        const std::string_view range = text.substr(0, comma);
+        text = comma == std::string_view::npos ? std::string_view() : text.substr(comma + 1);
+        const std::size_t dash = range.find('-');
+        unsigned first = 0, last = 0;
+        if (!parseNumber(range.substr(0, dash), first) ||
+            (dash != std::string_view::npos && !parseNumber(range.substr(dash + 1), last)) ||
+            (dash != std::string_view::npos && last < first)) {
+            throw std::runtime_error("Malformed CPU list: " + std::string(range));
+        }
+        if (dash == std::string_view::npos) last = first;
+        for (unsigned cpu = first; cpu <= last; ++cpu) cpus.push_back(cpu);
+    }
+    std::sort(cpus.begin(), cpus.end());
+    cpus.erase(std::unique(cpus.begin(), cpus.end()), cpus.end());
+    return cpus;
+}
+
+NumaTopology NumaTopology::read() {
+    std::vector<NumaNodeTopology> nodes;
+    std::string buffer;
+    for (const std::string& entry : SystemProcFS::ProcFS::listDirectory(kNodeRoot)) {
+        NumaNodeTopology node;
+        if (entry.compare(0, 4, "node") != 0 || !parseNumber(std::string_view(entry).substr(4), node.node)) continue;
+        if (!SystemProcFS::ProcFS::readFile(nodePath(node.node, "cpulist"), buffer)) {
+            throw std::runtime_error("Failed to read " + nodePath(node.node, "cpulist") + ".");
+        }
+        node.cpus = parseCpuList(buffer);
+        if (SystemProcFS::ProcFS::readFile(nodePath(node.node, "distance"), buffer)) {
+            SystemProcFS::FieldScanner distances(buffer);
+            std::uint64_t distance = 0;
+            while (distances.nextUnsigned(distance)) node.distances.push_back(static_cast<unsigned>(distance));
+            if (!trim(distances.rest()).empty()) {
+                throw std::runtime_error("Malformed " + nodePath(node.node, "distance") + ": " + buffer);
+            }
+        }
+        nodes.push_back(std::move(node));
+    }
+    return NumaTopology(std::move(nodes));
+}
+
+double NumaMemory::usedPercent() const {
+    return total == 0 ? 0.0 : 100.0 * static_cast<double>(used) / static_cast<double>(total);
+}
+
+// --- NumaStatsReader ---
+
+void NumaStatsReader::parseMeminfo(std::string_view text, NumaMemory& out) {
+    std::string_view line;
+    while (SystemProcFS::nextLine(text, line)) {
+        // Drop the "Node 0 " prefix; the rest is a /proc/meminfo line.
+        SystemProcFS::FieldScanner prefix(line);
+        if (!prefix.skip(2)) continue;
+        NodeMeminfoReader::parse(trim(prefix.rest()), out);
+    }
+}
+
+void NumaStatsReader::parseNumastat(std::string_view text, NumaCounters& out) {
+    NumastatReader::parse(text, out);
+}
+
+void NumaStatsReader::read(const NumaTopology& topology, std::vector<NumaNodeStats>& out, std::string& buffer) {
+    out.resize(topology.nodes().size());
+    for (std::size_t n = 0; n < out.size(); ++n) {
+        const unsigned node = topology.nodes()[n].node;
+        NumaNodeStats& stats = out[n];
+        stats = NumaNodeStats{};
+        stats.node = node;
+        if (!SystemProcFS::ProcFS::readFile(nodePath(node, "meminfo"), buffer)) {
+            throw std::runtime_error("Failed to read " + nodePath(node, "meminfo") + ".");
+        }
+        parseMeminfo(buffer, stats.memory);
+        if (!SystemProcFS::ProcFS::readFile(nodePath(node, "numastat"), buffer)) {
+            throw std::runtime_error("Failed to read " + nodePath(node, "numastat") + ".");
+        }
+        parseNumastat(buffer, stats.counters);
+    }
+}
+
+// --- NumaCollector ---
+
+NumaCollector::NumaCollector() : NumaCollector(NumaTopology::read()) {}
+
+NumaCollector::NumaCollector(NumaTopology topology) : topology_(std::move(topology)) {}
+
+void NumaCollector::sample() {
+    sample(Clock::now());
+}
+
+void NumaCollector::sample(Clock::time_point now) {
+    // The node and /proc/stat readings are swapped in together, once both have been read.
+    NumaStatsReader::read(topology_, previous_, buffer_);
+    SystemCPUStats::CPUStatsReader::getCPUCounters(cpu_previous_, buffer_);
+    current_.swap(previous_);
+    std::swap(cpu_current_, cpu_previous_);
+    ++samples_;
+    const Clock::time_point previous_time = last_time_;
+    last_time_ = now;
+    if (samples_ < 2) return;
+    computeRates(std::chrono::duration<double>(now - previous_time).count());
+}
+
+void NumaCollector::computeRates(double elapsed_seconds) {
+    const std::size_t node_count = topology_.nodes().size();
+    rates_.elapsed_seconds = elapsed_seconds;
+    rates_.nodes.assign(node_count, NumaNodeRates{});
+
+    const double scale = elapsed_seconds > 0.0 ? 1.0 / elapsed_seconds : 0.0;
+    for (std::size_t n = 0; n < node_count; ++n) {
+        const NumaCounters& before = previous_[n].counters;
+        const NumaCounters& after = current_[n].counters;
+        NumaNodeRates& rates = rates_.nodes[n];
+        rates.node = current_[n].node;
+        rates.numa_hit = perSecond(before.numa_hit, after.numa_hit, scale);
+        rates.numa_miss = perSecond(before.numa_miss, after.numa_miss, scale);
+        rates.numa_foreign = perSecond(before.numa_foreign, after.numa_foreign, scale);
+        rates.interleave_hit = perSecond(before.interleave_hit, after.interleave_hit, scale);
+        rates.local_node = perSecond(before.local_node, after.local_node, scale);
+        rates.other_node = perSecond(before.other_node, after.other_node, scale);
+    }
+
+    // Join the per-CPU counters with the topology: add up each node's CPUs that are online in both
+    // samples, then take one utilization per node.
+    previous_by_cpu_.clear();
+    for (const auto& core : cpu_previous_.cpus) {
+        if (core.cpu >= previous_by_cpu_.size()) previous_by_cpu_.resize(core.cpu + 1, nullptr);
+        previous_by_cpu_[core.cpu] = &core.counters;
+    }
+    node_sums_.assign(2 * node_count, SystemCPUStats::CPUCounters{});
+    for (const auto& core : cpu_current_.cpus) {
+        const int node = topology_.nodeOfCpu(core.cpu);
+        if (node < 0 || core.cpu >= previous_by_cpu_.size() || previous_by_cpu_[core.cpu] == nullptr) continue;
+        // Nodes are few; a linear search keeps the topology free of a node-number index.
+        for (std::size_t n = 0; n < node_count; ++n) {
+            if (topology_.nodes()[n].node != static_cast<unsigned>(node)) continue;
+            addCounters(node_sums_[2 * n], *previous_by_cpu_[core.cpu]);
+            addCounters(node_sums_[2 * n + 1], core.counters);
+            ++rates_.nodes[n].cpus;
+            break;
+        }
+    }
+    for (std::size_t n = 0; n < node_count; ++n) {
+        if (rates_.nodes[n].cpus == 0) continue;
+        rates_.nodes[n].cpu = SystemCPUStats::computeUtilization(node_sums_[2 * n], node_sums_[2 * n + 1]);
+    }
+}
+
+} // namespace SystemNumaStats
@@ -0,0 +1,53 @@
+#include "proc_parse.hpp"
+#include "simd_scan.hpp"
+
+namespace SystemProcFS {
+
+namespace { // Anonymous namespace for internal helpers
+inline bool isSpace(char c) {
+    return c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == '\v' || c == '\f';
+}
+} // namespace
+
+bool nextLine(std::string_view& text, std::string_view& line) {
+    if (text.empty()) return false;
+    const std::size_t end = findNewline(text);
+    if (end == std::string_view::npos) {
+        line = text;
+        text = std::string_view();
+    } else {
+        line = text.substr(0, end);
+        text.remove_prefix(end + 1);
+    }
+    return true;
+}
+
+bool FieldScanner::next(std::string_view& field) {
+    std::size_t begin = 0;
+    while (begin < text_.size() && isSpace(text_[begin])) ++begin;
+    if (begin == text_.size()) {
+        text_ = std::string_view();
+        return false;
+    }
+    std::size_t end = begin;
+    while (end < text_.size() && !isSpace(text_[end])) ++end;
+    field = text_.substr(begin, end - begin);
+    text_.remove_prefix(end);
+    return true;
+}
+
+bool FieldScanner::nextUnsigned(std::uint64_t& value) {
+    std::string_view field;
+    if (!next(field)) return false;
+    return parseDecimal(field, value);
+}
+
+bool FieldScanner::skip(unsigned count) {
+    std::string_view field;
+    for (unsigned i = 0; i < count; ++i) {
+        if (!next(field)) return false;
+    }
+    return true;
+}
+
+} // namespace SystemProcFS
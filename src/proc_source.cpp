@@ -0,0 +1,290 @@
+#include "proc_source.hpp"
+
+#include <algorithm>
+#include <cstdlib>    // For std::getenv
+#include <cstring>    // For std::memcpy
+#include <set>
+#include <stdexcept>
+
+#if defined(__unix__) || defined(__APPLE__)
+    #include <cerrno>
+    #include <climits>  // For PATH_MAX
+    #include <dirent.h>
+    #include <fcntl.h>
+    #include <unistd.h>
+#else
+    #include <filesystem>
+    #include <fstream>
+    #include <sstream>
+#endif
+
+namespace SystemProcFS {
+
+namespace { // Anonymous namespace for internal helpers
+// Initial capacity reserved for a file read; most /proc files fit in one chunk.
+constexpr size_t kReadChunkSize = 4096;
+
+std::shared_ptr<const ProcSource> makeDefaultSource() {
+    const char* root = std::getenv("METRICS_AGENT_PROC_ROOT");
+    return std::make_shared<DirectoryProcSource>(root ? root : "");
+}
+
+std::shared_ptr<const ProcSource>& defaultSource() {
+    static std::shared_ptr<const ProcSource> source = makeDefaultSource();
+    return source;
+}
+
+std::mutex& activeSourceMutex() {
+    static std::mutex mutex;
+    return mutex;
+}
+
+std::shared_ptr<const ProcSource>& activeSource() {
+    static std::shared_ptr<const ProcSource> source = defaultSource();
+    return source;
+}
+
+std::uint64_t& activeGeneration() {
+    static std::uint64_t generation = 0;
+    return generation;
+}
+
+#if defined(__unix__) || defined(__APPLE__)
+// Joins root and path into a fixed buffer so that reads do not allocate.
+bool buildPath(const std::string& root, std::string_view path, char* buffer, size_t buffer_size) {
+    if (root.size() + path.size() + 1 > buffer_size) {
+        return false;
+    }
+    std::memcpy(buffer, root.data(), root.size());
+    std::memcpy(buffer + root.size(), path.data(), path.size());
+    buffer[root.size() + path.size()] = '\0';
+    return true;
+}
+#endif
+} // anonymous namespace
+
+// --- DirectoryProcSource ---
+
+DirectoryProcSource::DirectoryProcSource(std::string root) : root_(std::move(root)) {
+    // Normalise "fixtures/" to "fixtures" so that root + "/proc/stat" is well formed.
+    while (!root_.empty() && root_.back() == '/') {
+        root_.pop_back();
+    }
+}
+
+bool DirectoryProcSource::readFile(std::string_view path, std::string& out) const {
+    out.clear();
+#if defined(__unix__) || defined(__APPLE__)
+    char full_path[PATH_MAX];
+    if (!buildPath(root_, path, full_path, sizeof(full_path))) {
+        return false;
+    }
+    int fd = ::open(full_path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return false;
+    }
+
+    // /proc files report a size of 0, so read until EOF, growing the buffer as needed.
+    size_t used = 0;
+    for (;;) {
+        if (used == out.size()) {
+            out.resize(std::max(out.capacity(), used == 0 ? kReadChunkSize : used * 2));
+        }
+        ssize_t n = ::read(fd, &out[used], out.size() - used);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            ::close(fd);
+            out.clear();
+            return false;
+        }
+        if (n == 0) break;
+        used += static_cast<size_t>(n);
+    }
+    ::close(fd);
+    out.resize(used);
+    return true;
+#else
+    std::ifstream file(root_ + std::string(path), std::ios::binary);
+    if (!file.is_open()) {
+        return false;
+    }
+    std::ostringstream contents;
+    contents << file.rdbuf();
+    out = contents.str();
+    return true;
+#endif
+}
+
+std::vector<std::string> DirectoryProcSource::listDirectory(std::string_view path) const {
+    std::vector<std::string> entries;
+#if defined(__unix__) || defined(__APPLE__)
+    char full_path[PATH_MAX];
+    if (!buildPath(root_, path, full_path, sizeof(full_path))) {
+        return entries;
+    }
+    DIR* dir = ::opendir(full_path);
+    if (dir == nullptr) {
+        return entries;
+    }
+    while (struct dirent* entry = ::readdir(dir)) {
+        if (std::strcmp(entry->d_name, ".") == 0 || std::strcmp(entry->d_name, "..") == 0) {
+            continue;
+        }
+        entries.emplace_back(entry->d_name);
+    }
+    ::closedir(dir);
+#else
+    std::error_code ec;
+    for (const auto& entry : std::filesystem::directory_iterator(root_ + std::string(path), ec)) {
+        entries.push_back(entry.path().filename().string());
+    }
+#endif
+    return entries;
+}
+
+std::string DirectoryProcSource::resolvePath(std::string_view path) const {
+    return root_ + std::string(path);
+}
+
+// --- VirtualProcSource ---
+
+void VirtualProcSource::setFile(std::string path, std::string contents) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    Entry& entry = files_[std::move(path)];
+    entry = Entry{};
+    entry.contents = std::move(contents);
+}
+
+void VirtualProcSource::setSequence(std::string path, std::vector<std::string> frames) {
+    if (frames.empty()) {
+        throw std::invalid_argument("VirtualProcSource::setSequence requires at least one frame.");
+    }
+    std::lock_guard<std::mutex> lock(mutex_);
+    Entry& entry = files_[std::move(path)];
+    entry = Entry{};
+    entry.frames = std::move(frames);
+}
+
+void VirtualProcSource::setGenerator(std::string path, Generator generator) {
+    if (!generator) {
+        throw std::invalid_argument("VirtualProcSource::setGenerator requires a callable generator.");
+    }
+    std::lock_guard<std::mutex> lock(mutex_);
+    Entry& entry = files_[std::move(path)];
+    entry = Entry{};
+    entry.generator = std::move(generator);
+}
+
+void VirtualProcSource::removeFile(std::string_view path) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = files_.find(path);
+    if (it != files_.end()) {
+        files_.erase(it);
+    }
+}
+
+void VirtualProcSource::advance(std::uint64_t steps) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    tick_ += steps;
+}
+
+std::uint64_t VirtualProcSource::tick() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return tick_;
+}
+
+bool VirtualProcSource::readFile(std::string_view path, std::string& out) const {
+    out.clear();
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = files_.find(path);
+    if (it == files_.end()) {
+        return false;
+    }
+    const Entry& entry = it->second;
+    if (entry.generator) {
+        out.append(entry.generator(tick_));
+    } else if (!entry.frames.empty()) {
+        size_t index = static_cast<size_t>(std::min<std::uint64_t>(tick_, entry.frames.size() - 1));
+        out.append(entry.frames[index]);
+    } else {
+        out.append(entry.contents);
+    }
+    return true;
+}
+
+std::vector<std::string> VirtualProcSource::listDirectory(std::string_view path) const {
+    std::string prefix(path);
+    if (prefix.empty() || prefix.back() != '/') {
+        prefix.push_back('/');
+    }
+
+    // Directories are implicit: every registered file contributes its first path
+    // component below `path`.
+    std::set<std::string> names;
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (auto it = files_.lower_bound(prefix); it != files_.end(); ++it) {
+        const std::string& file_path = it->first;
+        if (file_path.compare(0, prefix.size(), prefix) != 0) {
+            break;
+        }
+        size_t end = file_path.find('/', prefix.size());
+        names.insert(file_path.substr(prefix.size(), end - prefix.size()));
+    }
+    return std::vector<std::string>(names.begin(), names.end());
+}
+
+std::string VirtualProcSource::resolvePath(std::string_view path) const {
+    (void)path; // Virtual files have no on-disk representation
+    return std::string();
+}
+
+// --- ProcFS ---
+
+void ProcFS::setSource(std::shared_ptr<const ProcSource> source) {
+    std::lock_guard<std::mutex> lock(activeSourceMutex());
+    activeSource() = source ? std::move(source) : defaultSource();
+    ++activeGeneration();
+}
+
+void ProcFS::setRoot(const std::string& root) {
+    setSource(std::make_shared<DirectoryProcSource>(root));
+}
+
+void ProcFS::reset() {
+    setSource(nullptr);
+}
+
+std::shared_ptr<const ProcSource> ProcFS::source() {
+    std::lock_guard<std::mutex> lock(activeSourceMutex());
+    return activeSource();
+}
+
+std::uint64_t ProcFS::generation() {
+    std::lock_guard<std::mutex> lock(activeSourceMutex());
+    return activeGeneration();
+}
+
+bool ProcFS::readFile(std::string_view path, std::string& out) {
+    return source()->readFile(path, out);
+}
+
+std::vector<std::string> ProcFS::listDirectory(std::string_view path) {
+    return source()->listDirectory(path);
+}
+
+std::string ProcFS::resolvePath(std::string_view path) {
+    return source()->resolvePath(path);
+}
+
+// --- ScopedProcSource ---
+
+ScopedProcSource::ScopedProcSource(std::shared_ptr<const ProcSource> source)
+    : previous_(ProcFS::source()) {
+    ProcFS::setSource(std::move(source));
+}
+
+ScopedProcSource::~ScopedProcSource() {
+    ProcFS::setSource(std::move(previous_));
+}
+
+} // namespace SystemProcFS
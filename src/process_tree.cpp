@@ -0,0 +1,448 @@
+#include "process_tree.hpp"
+#include "cpu_stats.hpp"
+#include "key_value_reader.hpp"
+#include "proc_parse.hpp"
+#include "proc_source.hpp"
+#include "simd_scan.hpp"
+
+#include <algorithm>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+
+#if defined(__linux__)
+#include <dirent.h>
+#include <unistd.h>
+#endif
+
+namespace SystemProcessStats {
+
+namespace { // Anonymous namespace for internal helpers
+
+// stat lines are a few hundred bytes and io files under 200.
+constexpr std::size_t kFileBufferSize = 1024;
+
+struct ProcessIo {
+    unsigned long long read_bytes = 0;
+    unsigned long long write_bytes = 0;
+};
+
+struct ProcessIoSchema {
+    using Record = ProcessIo;
+    static constexpr std::string_view name = "io";
+    static constexpr char separator = ':';
+    static constexpr std::string_view unit = "";
+    static constexpr SystemProcFS::KeyField<ProcessIo> fields[] = {
+        {"read_bytes", &ProcessIo::read_bytes},
+        {"write_bytes", &ProcessIo::write_bytes},
+    };
+};
+
+bool parsePid(std::string_view text, int& pid) {
+    std::uint64_t value = 0;
+    if (text.empty() || !SystemProcFS::parseDecimal(text, value) || value == 0 || value > 0x7FFFFFFFu) return false;
+    pid = static_cast<int>(value);
+    return true;
+}
+
+SystemProcFS::BatchFileReader::Options readerOptions(std::size_t max_open_files) {
+    SystemProcFS::BatchFileReader::Options options;
+    options.slot_size = kFileBufferSize;
+    options.use_io_uring = false; // /proc: see BatchFileReader
+    options.max_open_files = max_open_files;
+    return options;
+}
+
+std::string processFile(int pid, const char* name) {
+    return "/proc/" + std::to_string(pid) + "/" + name;
+}
+
+bool endsWith(std::string_view text, std::string_view suffix) {
+    return text.size() >= suffix.size() && text.substr(text.size() - suffix.size()) == suffix;
+}
+
+} // namespace
+
+const char* rollupByName(RollupBy by) {
+    switch (by) {
+        case RollupBy::Tree: return "tree";
+        case RollupBy::Executable: return "executable";
+        case RollupBy::Unit: return "unit";
+    }
+    return "unknown";
+}
+
+std::string cgroupServiceName(std::string_view proc_pid_cgroup) {
+    // "hierarchy-ID:controller-list:cgroup-path" per line (cgroups(7)).
+    std::string_view v2, systemd, first;
+    std::string_view text = proc_pid_cgroup, line;
+    while (SystemProcFS::nextLine(text, line)) {
+        const std::size_t colon1 = line.find(':');
+        const std::size_t colon2 = colon1 == std::string_view::npos ? colon1 : line.find(':', colon1 + 1);
+        if (colon2 == std::string_view::npos) continue;
+        const std::string_view id = line.substr(0, colon1);
+        const std::string_view controllers = line.substr(colon1 + 1, colon2 - colon1 - 1);
+        const std::string_view path = line.substr(colon2 + 1);
+        if (first.empty()) first = path;
+        if (id == "0" && controllers.empty()) v2 = path;
+        if (controllers == "name=systemd") systemd = path;
+    }
+    const std::string_view path = !v2.empty() ? v2 : !systemd.empty() ? systemd : first;
+    if (path.empty()) return "/";
+
+    std::string_view unit;
+    for (std::size_t begin = 0; begin < path.size();) {
+        std::size_t end = path.find('/', begin);
+        if (end == std::string_view::npos) end = path.size();
+        const std::string_view component = path.substr(begin, end - begin);
+        if (endsWith(component, ".service") || endsWith(component, ".scope")) unit = component;
+        begin = end + 1;
+    }
+    return std::string(unit.empty() ? path : unit);
+}
+
+// --- ProcessTreeCollector ---
+
+ProcessTreeCollector::ProcessTreeCollector() : ProcessTreeCollector(Options()) {}
+
+ProcessTreeCollector::ProcessTreeCollector(Options options)
+    : options_(options), reader_(readerOptions(options.max_open_files)) {
+#if defined(__linux__)
+    const long page_size = ::sysconf(_SC_PAGESIZE);
+    if (page_size > 0) page_size_ = static_cast<std::uint64_t>(page_size);
+#endif
+}
+
+void ProcessTreeCollector::sample() {
+    sample(Clock::now());
+}
+
+void ProcessTreeCollector::sample(Clock::time_point now) {
+    list(); // Reads and parses everything first, so a malformed file leaves the rollups untouched
+
+    for (Dimension* dimension : {&executables_, &units_}) {
+        for (Usage& usage : dimension->usage) {
+            usage.cpu_ticks = 0;
+            usage.read_bytes = 0;
+            usage.write_bytes = 0;
+        }
+    }
+
+    // Merge the listing with the known processes (both ascending): update, add new, remove gone.
+    merged_.clear();
+    merged_.reserve(pids_.size());
+    auto known = processes_.begin();
+    for (std::size_t k = 0; k < pids_.size(); ++k) {
+        const int pid = pids_[k];
+        while (known != processes_.end() && known->pid < pid) remove(*known++);
+        const Read& read = reads_[k];
+        if (!read.ok) continue; // Exited since the listing; a known entry is removed with the next pid
+        if (known != processes_.end() && known->pid == pid) {
+            if (known->start_time == read.stat.start_time) {
+                update(*known, read);
+                merged_.push_back(std::move(*known++));
+                continue;
+            }
+            remove(*known++); // The pid was reused
+        }
+        add(read, pid);
+    }
+    for (; known != processes_.end(); ++known) remove(*known);
+    processes_.swap(merged_);
+
+    buildTree();
+    elapsed_ = samples_ > 0 ? std::chrono::duration<double>(now - last_time_).count() : 0.0;
+    ++samples_;
+    last_time_ = now;
+    stats_.processes = processes_.size();
+    stats_.groups = executables_.ids.size() + units_.ids.size();
+}
+
+void ProcessTreeCollector::list() {
+    ++stats_.scans;
+    pids_.clear();
+#if defined(__linux__)
+    std::unique_ptr<DIR, int (*)(DIR*)> directory(nullptr, &::closedir);
+    const std::string resolved = SystemProcFS::ProcFS::resolvePath("/proc");
+    if (!resolved.empty()) {
+        directory.reset(::opendir(resolved.c_str()));
+        if (!directory) throw std::runtime_error("Failed to read /proc.");
+        while (const dirent* entry = ::readdir(directory.get())) {
+            int pid = 0;
+            if (parsePid(entry->d_name, pid)) pids_.push_back(pid);
+        }
+    } else
+#endif
+    {
+        for (const std::string& name : SystemProcFS::ProcFS::listDirectory("/proc")) {
+            int pid = 0;
+            if (parsePid(name, pid)) pids_.push_back(pid);
+        }
+    }
+    if (pids_.empty()) throw std::runtime_error("Failed to read /proc.");
+    std::sort(pids_.begin(), pids_.end());
+
+    // Merge the listing with the open files (both ascending): keep, open new, close gone.
+    listed_.clear();
+    auto known = files_.begin();
+    for (int pid : pids_) {
+        while (known != files_.end() && known->pid < pid) closeFiles(*known++);
+        if (known != files_.end() && known->pid == pid) {
+            Files& files = listed_.emplace_back(*known++);
+            if (files.stat == kNoFile) openFiles(files); // Its last read failed: the pid may have been reused
+            continue;
+        }
+        Files& files = listed_.emplace_back();
+        files.pid = pid;
+        openFiles(files);
+    }
+    for (; known != files_.end(); ++known) closeFiles(*known);
+    files_.swap(listed_);
+
+    reader_.readAll();
+    if (reads_.size() < pids_.size()) reads_.resize(pids_.size());
+    for (std::size_t k = 0; k < pids_.size(); ++k) readProcess(files_[k], reads_[k]);
+}
+
+void ProcessTreeCollector::openFiles(Files& files) {
+    files.stat = reader_.add(processFile(files.pid, "stat"));
+    if (options_.read_io) files.io = reader_.add(processFile(files.pid, "io"));
+}
+
+void ProcessTreeCollector::closeFiles(Files& files) {
+    for (std::size_t* file : {&files.stat, &files.io}) {
+        if (*file != kNoFile) reader_.remove(*file);
+        *file = kNoFile;
+    }
+}
+
+void ProcessTreeCollector::readProcess(Files& files, Read& out) {
+    out.ok = false;
+    if (files.stat == kNoFile) return;
+    ++stats_.stat_reads;
+    if (!reader_.ok(files.stat)) {
+        // Exited. Its descriptors fail every later read even if the pid is reused, so they are
+        // closed and reopened if a later listing still has the pid.
+        closeFiles(files);
+        return;
+    }
+    TaskStatReader::parse(reader_.contents(files.stat), out.stat);
+    ProcessIo io;
+    if (files.io != kNoFile) {
+        ++stats_.io_reads;
+        // Unreadable without ptrace access to the process: it reports no IO.
+        if (reader_.ok(files.io)) {
+            SystemProcFS::KeyValueProcReader<ProcessIoSchema>::parse(reader_.contents(files.io), io);
+        }
+    }
+    out.read_bytes = io.read_bytes;
+    out.write_bytes = io.write_bytes;
+    out.ok = true;
+}
+
+void ProcessTreeCollector::add(const Read& read, int pid) {
+    Process& process = merged_.emplace_back();
+    process.pid = pid;
+    process.ppid = read.stat.ppid;
+    process.start_time = read.stat.start_time;
+    process.comm = read.stat.comm;
+    process.cpu_ticks = read.stat.utime + read.stat.stime;
+    process.read_bytes = read.read_bytes;
+    process.write_bytes = read.write_bytes;
+    process.usage.rss_bytes = read.stat.rss_pages * page_size_;
+    process.usage.processes = 1;
+
+    // The unit is looked up once per process; a process moved to another cgroup keeps its first one.
+    ++stats_.cgroup_reads;
+    if (!SystemProcFS::ProcFS::readFile(processFile(pid, "cgroup"), buffer_)) buffer_.clear();
+    process.executable = join(executables_, process.comm, process.usage.rss_bytes);
+    process.unit = join(units_, cgroupServiceName(buffer_), process.usage.rss_bytes);
+    ++stats_.processes_added;
+}
+
+void ProcessTreeCollector::update(Process& process, const Read& read) {
+    const std::uint64_t cpu_ticks = read.stat.utime + read.stat.stime;
+    const std::uint64_t rss_bytes = read.stat.rss_pages * page_size_;
+    Usage& usage = process.usage;
+    const std::uint64_t old_rss = usage.rss_bytes;
+    usage.cpu_ticks = SystemCPUStats::counterDelta(process.cpu_ticks, cpu_ticks);
+    usage.read_bytes = SystemCPUStats::counterDelta(process.read_bytes, read.read_bytes);
+    usage.write_bytes = SystemCPUStats::counterDelta(process.write_bytes, read.write_bytes);
+    usage.rss_bytes = rss_bytes;
+    process.ppid = read.stat.ppid;
+    process.cpu_ticks = cpu_ticks;
+    process.read_bytes = read.read_bytes;
+    process.write_bytes = read.write_bytes;
+
+    if (process.comm != read.stat.comm) { // exec()
+        leave(executables_, process.executable, old_rss);
+        process.comm = read.stat.comm;
+        process.executable = join(executables_, process.comm, rss_bytes);
+    } else {
+        Usage& group = executables_.usage[process.executable];
+        group.rss_bytes = group.rss_bytes - old_rss + rss_bytes;
+    }
+    Usage& unit = units_.usage[process.unit];
+    unit.rss_bytes = unit.rss_bytes - old_rss + rss_bytes;
+
+    for (Usage* group : {&executables_.usage[process.executable], &unit}) {
+        group->cpu_ticks += usage.cpu_ticks;
+        group->read_bytes += usage.read_bytes;
+        group->write_bytes += usage.write_bytes;
+    }
+}
+
+void ProcessTreeCollector::remove(const Process& process) {
+    leave(executables_, process.executable, process.usage.rss_bytes);
+    leave(units_, process.unit, process.usage.rss_bytes);
+    ++stats_.processes_removed;
+}
+
+std::uint32_t ProcessTreeCollector::join(Dimension& dimension, std::string_view name, std::uint64_t rss_bytes) {
+    std::string key(name);
+    auto it = dimension.ids.find(key);
+    if (it == dimension.ids.end()) {
+        std::uint32_t id;
+        if (!dimension.free.empty()) {
+            id = dimension.free.back();
+            dimension.free.pop_back();
+            dimension.usage[id] = Usage();
+        } else {
+            id = static_cast<std::uint32_t>(dimension.names.size());
+            dimension.names.emplace_back();
+            dimension.usage.emplace_back();
+        }
+        dimension.names[id] = key;
+        it = dimension.ids.emplace(std::move(key), id).first;
+    }
+    Usage& usage = dimension.usage[it->second];
+    ++usage.processes;
+    usage.rss_bytes += rss_bytes;
+    return it->second;
+}
+
+void ProcessTreeCollector::leave(Dimension& dimension, std::uint32_t id, std::uint64_t rss_bytes) {
+    Usage& usage = dimension.usage[id];
+    usage.rss_bytes -= rss_bytes;
+    if (--usage.processes > 0) return;
+    dimension.ids.erase(dimension.names[id]);
+    dimension.names[id].clear();
+    dimension.free.push_back(id);
+}
+
+void ProcessTreeCollector::buildTree() {
+    const std::size_t n = processes_.size();
+    parent_.assign(n, -1);
+    pending_.assign(n, 0);
+    subtrees_.resize(n);
+    for (std::size_t i = 0; i < n; ++i) {
+        subtrees_[i] = processes_[i].usage;
+        const int ppid = processes_[i].ppid;
+        const auto parent = std::lower_bound(processes_.begin(), processes_.end(), ppid,
+                                             [](const Process& process, int pid) { return process.pid < pid; });
+        if (parent == processes_.end() || parent->pid != ppid || ppid == processes_[i].pid) continue;
+        parent_[i] = static_cast<int>(parent - processes_.begin());
+        ++pending_[static_cast<std::size_t>(parent_[i])];
+    }
+
+    // Leaves first: a process is added into its parent once all of its own children have been.
+    // Entries of a parent cycle (possible only from reads racing pid reuse) are never released.
+    stack_.clear();
+    for (std::size_t i = 0; i < n; ++i) {
+        if (pending_[i] == 0) stack_.push_back(i);
+    }
+    while (!stack_.empty()) {
+        const std::size_t i = stack_.back();
+        stack_.pop_back();
+        if (parent_[i] < 0) continue;
+        const std::size_t parent = static_cast<std::size_t>(parent_[i]);
+        Usage& total = subtrees_[parent];
+        total.cpu_ticks += subtrees_[i].cpu_ticks;
+        total.rss_bytes += subtrees_[i].rss_bytes;
+        total.read_bytes += subtrees_[i].read_bytes;
+        total.write_bytes += subtrees_[i].write_bytes;
+        total.processes += subtrees_[i].processes;
+        if (--pending_[parent] == 0) stack_.push_back(parent);
+    }
+}
+
+Rollup ProcessTreeCollector::toRollup(const Usage& usage) const {
+    Rollup out;
+    out.processes = usage.processes;
+    out.rss_bytes = usage.rss_bytes;
+    if (elapsed_ > 0.0) {
+        out.cpu_percent = SystemCPUStats::ticksToSeconds(usage.cpu_ticks) * 100.0 / elapsed_;
+        out.read_bytes_per_second = static_cast<double>(usage.read_bytes) / elapsed_;
+        out.write_bytes_per_second = static_cast<double>(usage.write_bytes) / elapsed_;
+    }
+    return out;
+}
+
+std::vector<Rollup> ProcessTreeCollector::top(RollupBy by, RollupResource resource, std::size_t count) const {
+    struct Candidate {
+        std::uint64_t value;
+        const Usage* usage;
+        std::size_t index;
+    };
+    const auto value = [resource](const Usage& usage) -> std::uint64_t {
+        switch (resource) {
+            case RollupResource::Cpu: return usage.cpu_ticks;
+            case RollupResource::Rss: return usage.rss_bytes;
+            case RollupResource::Io: return usage.read_bytes + usage.write_bytes;
+        }
+        return 0;
+    };
+
+    std::vector<Candidate> candidates;
+    const Dimension& dimension = by == RollupBy::Unit ? units_ : executables_;
+    if (by == RollupBy::Tree) {
+        for (std::size_t i = 0; i < processes_.size(); ++i) {
+            const int parent = parent_[i];
+            if (parent < 0) {
+                candidates.push_back({value(processes_[i].usage), &processes_[i].usage, i}); // A root: itself
+            } else if (parent_[static_cast<std::size_t>(parent)] < 0) {
+                candidates.push_back({value(subtrees_[i]), &subtrees_[i], i});
+            }
+        }
+    } else {
+        for (std::size_t id = 0; id < dimension.usage.size(); ++id) {
+            if (dimension.usage[id].processes == 0) continue;
+            candidates.push_back({value(dimension.usage[id]), &dimension.usage[id], id});
+        }
+    }
+
+    count = std::min(count, candidates.size());
+    std::partial_sort(candidates.begin(), candidates.begin() + static_cast<std::ptrdiff_t>(count), candidates.end(),
+                      [](const Candidate& a, const Candidate& b) {
+                          return a.value != b.value ? a.value > b.value : a.index < b.index;
+                      });
+    std::vector<Rollup> out;
+    out.reserve(count);
+    for (std::size_t r = 0; r < count; ++r) {
+        Rollup& rollup = out.emplace_back(toRollup(*candidates[r].usage));
+        if (by == RollupBy::Tree) {
+            rollup.name = processes_[candidates[r].index].comm;
+            rollup.pid = processes_[candidates[r].index].pid;
+        } else {
+            rollup.name = dimension.names[candidates[r].index];
+        }
+    }
+    return out;
+}
+
+bool ProcessTreeCollector::subtree(int pid, Rollup& out) const {
+    const auto it = std::lower_bound(processes_.begin(), processes_.end(), pid,
+                                     [](const Process& process, int value) { return process.pid < value; });
+    if (it == processes_.end() || it->pid != pid) return false;
+    out = toRollup(subtrees_[static_cast<std::size_t>(it - processes_.begin())]);
+    out.name = it->comm;
+    out.pid = pid;
+    return true;
+}
+
+ProcessTreeStats ProcessTreeCollector::stats() const {
+    return stats_;
+}
+
+} // namespace SystemProcessStats
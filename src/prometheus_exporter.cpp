@@ -0,0 +1,634 @@
+#include "prometheus_exporter.hpp"
+#include "logger.hpp"
+#include "ring_log.hpp"
+#include "shm_snapshot.hpp"
+
+#include <cctype>     // For std::tolower
+#include <charconv>   // For std::to_chars
+#include <cstring>    // For std::strerror
+#include <stdexcept>
+#include <vector>
+
+#if defined(METRICS_AGENT_HAVE_ZLIB)
+    #include <zlib.h>
+#endif
+
+#if defined(__unix__) || defined(__APPLE__)
+    #include <arpa/inet.h>
+    #include <cerrno>
+    #include <fcntl.h>
+    #include <netinet/in.h>
+    #include <poll.h>
+    #include <sys/socket.h>
+    #include <sys/uio.h>
+    #include <unistd.h>
+#endif
+
+namespace SystemMetricsExporter {
+
+using SystemMetricsSnapshot::MetricsSnapshot;
+
+namespace { // Anonymous namespace for internal helpers
+
+// --- Text rendering helpers ---
+
+void appendUnsigned(std::string& out, unsigned long long value) {
+    char buffer[24];
+    auto result = std::to_chars(buffer, buffer + sizeof(buffer), value);
+    out.append(buffer, result.ptr);
+}
+
+void appendDouble(std::string& out, double value) {
+    char buffer[32];
+    auto result = std::to_chars(buffer, buffer + sizeof(buffer), value);
+    out.append(buffer, result.ptr);
+}
+
+// Escapes a label value as required by the exposition format (backslash, quote, newline).
+void appendLabelValue(std::string& out, const std::string& value) {
+    for (char c : value) {
+        switch (c) {
+            case '\\': out.append("\\\\"); break;
+            case '"': out.append("\\\""); break;
+            case '\n': out.append("\\n"); break;
+            default: out.push_back(c); break;
+        }
+    }
+}
+
+void appendFamilyHeader(std::string& out, const char* name, const char* help, const char* type) {
+    out.append("# HELP ").append(name).push_back(' ');
+    out.append(help).push_back('\n');
+    out.append("# TYPE ").append(name).push_back(' ');
+    out.append(type).push_back('\n');
+}
+
+void appendSampleName(std::string& out, const char* name, const char* label, const std::string& label_value) {
+    out.append(name).push_back('{');
+    out.append(label).append("=\"");
+    appendLabelValue(out, label_value);
+    out.append("\"} ");
+}
+
+struct DiskFamily {
+    const char* name;
+    const char* help;
+    unsigned long long SystemDiskStats::DiskStats::*member;
+    double scale; // Multiplier applied before rendering (e.g. ms -> s)
+};
+
+const DiskFamily kDiskFamilies[] = {
+    {"metrics_agent_disk_read_bytes_total", "Total bytes read from the device.", &SystemDiskStats::DiskStats::read_bytes, 1.0},
+    {"metrics_agent_disk_written_bytes_total", "Total bytes written to the device.", &SystemDiskStats::DiskStats::write_bytes, 1.0},
+    {"metrics_agent_disk_read_time_seconds_total", "Total time spent reading.", &SystemDiskStats::DiskStats::read_time_ms, 0.001},
+    {"metrics_agent_disk_write_time_seconds_total", "Total time spent writing.", &SystemDiskStats::DiskStats::write_time_ms, 0.001},
+};
+
+struct NetFamily {
+    const char* name;
+    const char* help;
+    unsigned long long SystemNetStats::NetStats::*member;
+};
+
+const NetFamily kNetFamilies[] = {
+    {"metrics_agent_network_receive_bytes_total", "Total bytes received.", &SystemNetStats::NetStats::bytes_received},
+    {"metrics_agent_network_transmit_bytes_total", "Total bytes sent.", &SystemNetStats::NetStats::bytes_sent},
+    {"metrics_agent_network_receive_packets_total", "Total packets received.", &SystemNetStats::NetStats::packets_received},
+    {"metrics_agent_network_transmit_packets_total", "Total packets sent.", &SystemNetStats::NetStats::packets_sent},
+    {"metrics_agent_network_receive_errors_total", "Total receive errors.", &SystemNetStats::NetStats::errors_in},
+    {"metrics_agent_network_transmit_errors_total", "Total transmit errors.", &SystemNetStats::NetStats::errors_out},
+    {"metrics_agent_network_receive_drop_total", "Total inbound packets dropped.", &SystemNetStats::NetStats::drops_in},
+    {"metrics_agent_network_transmit_drop_total", "Total outbound packets dropped.", &SystemNetStats::NetStats::drops_out},
+};
+
+struct MemFamily {
+    const char* name;
+    const char* help;
+    unsigned long long SystemMemoryStats::MemStats::*member;
+};
+
+const MemFamily kMemFamilies[] = {
+    {"metrics_agent_memory_total_bytes", "Total physical memory.", &SystemMemoryStats::MemStats::total},
+    {"metrics_agent_memory_free_bytes", "Free physical memory.", &SystemMemoryStats::MemStats::free},
+    {"metrics_agent_memory_available_bytes", "Memory available for applications.", &SystemMemoryStats::MemStats::available},
+    {"metrics_agent_memory_buffers_bytes", "Memory used by kernel buffers.", &SystemMemoryStats::MemStats::buffers},
+    {"metrics_agent_memory_cached_bytes", "Memory used by the page cache.", &SystemMemoryStats::MemStats::cached},
+    {"metrics_agent_memory_swap_total_bytes", "Total swap space.", &SystemMemoryStats::MemStats::swap_total},
+    {"metrics_agent_memory_swap_free_bytes", "Free swap space.", &SystemMemoryStats::MemStats::swap_free},
+};
+
+// --- HTTP helpers ---
+
+const char kContentType[] = "text/plain; version=0.0.4; charset=utf-8";
+
+void renderHeader(std::string& out, size_t content_length, bool gzip) {
+    out.clear();
+    out.append("HTTP/1.1 200 OK\r\nContent-Type: ").append(kContentType).append("\r\n");
+    if (gzip) {
+        out.append("Content-Encoding: gzip\r\n");
+    }
+    out.append("Content-Length: ");
+    appendUnsigned(out, content_length);
+    out.append("\r\nConnection: close\r\n\r\n");
+}
+
+#if defined(METRICS_AGENT_HAVE_ZLIB)
+bool gzipCompress(const std::string& input, std::string& out) {
+    z_stream stream{};
+    // windowBits 15 + 16 selects the gzip wrapper.
+    if (deflateInit2(&stream, Z_DEFAULT_COMPRESSION, Z_DEFLATED, 15 + 16, 8, Z_DEFAULT_STRATEGY) != Z_OK) {
+        return false;
+    }
+    out.resize(deflateBound(&stream, static_cast<uLong>(input.size())) + 32);
+    stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(input.data()));
+    stream.avail_in = static_cast<uInt>(input.size());
+    stream.next_out = reinterpret_cast<Bytef*>(&out[0]);
+    stream.avail_out = static_cast<uInt>(out.size());
+    int result = deflate(&stream, Z_FINISH);
+    out.resize(stream.total_out);
+    deflateEnd(&stream);
+    return result == Z_STREAM_END;
+}
+#endif
+
+} // anonymous namespace
+
+// --- Rendering ---
+
+void renderPrometheusText(const MetricsSnapshot& snapshot, std::string& out) {
+    out.clear();
+
+    appendFamilyHeader(out, "metrics_agent_cpu_time_jiffies_total", "CPU time spent in each mode, in clock ticks.", "counter");
+    const struct { const char* mode; double value; } cpu_modes[] = {
+        {"user", snapshot.cpu.user}, {"nice", snapshot.cpu.nice}, {"system", snapshot.cpu.system},
+        {"idle", snapshot.cpu.idle}, {"iowait", snapshot.cpu.iowait}, {"irq", snapshot.cpu.irq},
+        {"softirq", snapshot.cpu.softirq}, {"steal", snapshot.cpu.steal}, {"guest", snapshot.cpu.guest},
+        {"guest_nice", snapshot.cpu.guest_nice},
+    };
+    for (const auto& mode : cpu_modes) {
+        out.append("metrics_agent_cpu_time_jiffies_total{mode=\"").append(mode.mode).append("\"} ");
+        appendDouble(out, mode.value);
+        out.push_back('\n');
+    }
+
+    for (const auto& family : kMemFamilies) {
+        appendFamilyHeader(out, family.name, family.help, "gauge");
+        out.append(family.name).push_back(' ');
+        appendUnsigned(out, (snapshot.mem.*family.member) * 1024ULL); // MemStats is in KB
+        out.push_back('\n');
+    }
+
+    for (const auto& family : kDiskFamilies) {
+        appendFamilyHeader(out, family.name, family.help, "counter");
+        for (const auto& disk : snapshot.disks) {
+            appendSampleName(out, family.name, "device", disk.device);
+            if (family.scale == 1.0) {
+                appendUnsigned(out, disk.*family.member);
+            } else {
+                appendDouble(out, static_cast<double>(disk.*family.member) * family.scale);
+            }
+            out.push_back('\n');
+        }
+    }
+
+    for (const auto& family : kNetFamilies) {
+        appendFamilyHeader(out, family.name, family.help, "counter");
+        for (const auto& net : snapshot.nets) {
+            appendSampleName(out, family.name, "interface", net.interface_name);
+            appendUnsigned(out, net.*family.member);
+            out.push_back('\n');
+        }
+    }
+
+    appendFamilyHeader(out, "metrics_agent_last_collection_timestamp_seconds", "Time of the collection that produced this exposition.", "gauge");
+    out.append("metrics_agent_last_collection_timestamp_seconds ");
+    appendDouble(out, static_cast<double>(snapshot.timestamp_ms) / 1000.0);
+    out.push_back('\n');
+}
+
+// --- ExpositionCache ---
+
+ExpositionCache::ExpositionCache(bool enable_gzip)
+#if defined(METRICS_AGENT_HAVE_ZLIB)
+    : enable_gzip_(enable_gzip),
+#else
+    : enable_gzip_(false), // Built without zlib: identity bodies only
+#endif
+      front_(std::make_shared<Exposition>()) {
+    (void)enable_gzip;
+}
+
+void ExpositionCache::publish(const MetricsSnapshot& snapshot) {
+    std::lock_guard<std::mutex> publish_lock(publish_mutex_);
+
+    // Recycle the back buffer (and its capacity) only if no scrape still holds it.
+    std::shared_ptr<Exposition> target;
+    if (back_ && back_.use_count() == 1) {
+        target = std::move(back_);
+    } else {
+        target = std::make_shared<Exposition>();
+    }
+
+    renderPrometheusText(snapshot, target->body);
+    renderHeader(target->header, target->body.size(), false);
+    target->gzip_body.clear();
+    target->gzip_header.clear();
+#if defined(METRICS_AGENT_HAVE_ZLIB)
+    if (enable_gzip_ && gzipCompress(target->body, target->gzip_body)) {
+        renderHeader(target->gzip_header, target->gzip_body.size(), true);
+    } else {
+        target->gzip_body.clear();
+    }
+#endif
+    target->generation = ++generation_;
+
+    std::shared_ptr<const Exposition> previous;
+    {
+        std::lock_guard<std::mutex> front_lock(front_mutex_);
+        previous = std::move(front_);
+        front_ = target;
+    }
+    // The previous front becomes the next back buffer. It was created by this class as a
+    // mutable Exposition, so casting away const is safe.
+    back_ = std::const_pointer_cast<Exposition>(previous);
+}
+
+std::shared_ptr<const Exposition> ExpositionCache::current() const {
+    std::lock_guard<std::mutex> lock(front_mutex_);
+    return front_;
+}
+
+// --- PrometheusExporter ---
+
+PrometheusExporter::PrometheusExporter(Options options)
+    : options_(std::move(options)), cache_(options_.enable_gzip) {}
+
+PrometheusExporter::~PrometheusExporter() {
+    stop();
+}
+
+bool PrometheusExporter::collect() {
+    std::lock_guard<std::mutex> lock(collect_mutex_);
+    try {
+        SystemMetricsSnapshot::SnapshotCollector::collect(scratch_);
+    } catch (const std::exception& e) {
+        SystemMetricsLogger::Logger::warning(std::string("PrometheusExporter: collection failed, keeping previous exposition: ") + e.what());
+        return false;
+    }
+    cache_.publish(scratch_);
+    if (shm_) {
+        shm_->publish(scratch_);
+    }
+    if (history_) {
+        try {
+            history_->append(scratch_);
+        } catch (const std::exception& e) {
+            SystemMetricsLogger::Logger::warning(std::string("PrometheusExporter: cannot append to history: ") + e.what());
+        }
+    }
+    return true;
+}
+
+void PrometheusExporter::attachSharedMemory(std::shared_ptr<SystemMetricsShm::ShmPublisher> publisher) {
+    std::lock_guard<std::mutex> lock(collect_mutex_);
+    shm_ = std::move(publisher);
+}
+
+void PrometheusExporter::attachHistory(std::shared_ptr<SystemMetricsHistory::RingLog> history) {
+    std::lock_guard<std::mutex> lock(collect_mutex_);
+    history_ = std::move(history);
+    if (history_ && cache_.current()->generation == 0 && history_->latest(scratch_)) {
+        cache_.publish(scratch_);
+    }
+}
+
+void PrometheusExporter::publish(const MetricsSnapshot& snapshot) {
+    cache_.publish(snapshot);
+}
+
+void PrometheusExporter::collectLoop() {
+    std::unique_lock<std::mutex> lock(stop_mutex_);
+    while (running_.load()) {
+        lock.unlock();
+        collect();
+        lock.lock();
+        stop_cv_.wait_for(lock, options_.collection_interval, [this] { return !running_.load(); });
+    }
+}
+
+#if defined(__unix__) || defined(__APPLE__)
+namespace {
+const char kNotFound[] = "HTTP/1.1 404 Not Found\r\nContent-Type: text/plain\r\nContent-Length: 10\r\nConnection: close\r\n\r\nNot Found\n";
+const char kBadRequest[] = "HTTP/1.1 400 Bad Request\r\nContent-Type: text/plain\r\nContent-Length: 12\r\nConnection: close\r\n\r\nBad Request\n";
+const char kNotAllowed[] = "HTTP/1.1 405 Method Not Allowed\r\nAllow: GET, HEAD\r\nContent-Type: text/plain\r\nContent-Length: 19\r\nConnection: close\r\n\r\nMethod Not Allowed\n";
+const char kUnavailable[] = "HTTP/1.1 503 Service Unavailable\r\nContent-Type: text/plain\r\nContent-Length: 22\r\nConnection: close\r\n\r\nNo metrics collected.\n";
+
+constexpr size_t kMaxRequestSize = 8192;
+constexpr size_t kMaxConnections = 1024;
+constexpr auto kConnectionTimeout = std::chrono::seconds(5);
+
+struct Connection {
+    int fd;
+    std::string request;
+    std::shared_ptr<const Exposition> exposition; // Keeps the served buffers alive during the write
+    struct iovec iov[2];
+    int iov_count;
+    bool writing;
+    std::chrono::steady_clock::time_point deadline;
+};
+
+bool setNonBlocking(int fd) {
+    int flags = ::fcntl(fd, F_GETFL, 0);
+    return flags >= 0 && ::fcntl(fd, F_SETFL, flags | O_NONBLOCK) == 0;
+}
+
+bool equalsIgnoreCase(const char* a, const char* b, size_t length) {
+    for (size_t i = 0; i < length; ++i) {
+        if (std::tolower(static_cast<unsigned char>(a[i])) != std::tolower(static_cast<unsigned char>(b[i]))) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Returns true if a header named `header` (lower case, case-insensitive match) has `token` in its value.
+bool headerContainsToken(const std::string& request, const char* header, const char* token) {
+    const size_t header_length = std::strlen(header);
+    const size_t token_length = std::strlen(token);
+    size_t line_start = request.find("\r\n");
+    while (line_start != std::string::npos) {
+        line_start += 2;
+        size_t line_end = request.find("\r\n", line_start);
+        if (line_end == std::string::npos || line_end == line_start) {
+            break; // End of headers
+        }
+        const char* line = request.data() + line_start;
+        size_t line_length = line_end - line_start;
+        if (line_length > header_length && line[header_length] == ':' && equalsIgnoreCase(line, header, header_length)) {
+            for (size_t i = header_length + 1; i + token_length <= line_length; ++i) {
+                if (equalsIgnoreCase(line + i, token, token_length)) {
+                    return true;
+                }
+            }
+        }
+        line_start = line_end;
+    }
+    return false;
+}
+
+void setStaticResponse(Connection& conn, const char* response, size_t length) {
+    conn.iov[0].iov_base = const_cast<char*>(response);
+    conn.iov[0].iov_len = length;
+    conn.iov_count = 1;
+    conn.writing = true;
+}
+
+// Parses the buffered request and points the connection's iovecs at the response.
+void prepareResponse(Connection& conn, const ExpositionCache& cache) {
+    size_t line_end = conn.request.find("\r\n");
+    size_t method_end = conn.request.find(' ');
+    size_t path_end = method_end == std::string::npos ? std::string::npos : conn.request.find(' ', method_end + 1);
+    if (line_end == std::string::npos || method_end == std::string::npos || path_end == std::string::npos || path_end > line_end) {
+        setStaticResponse(conn, kBadRequest, sizeof(kBadRequest) - 1);
+        return;
+    }
+    std::string method = conn.request.substr(0, method_end);
+    std::string path = conn.request.substr(method_end + 1, path_end - method_end - 1);
+    size_t query = path.find('?');
+    if (query != std::string::npos) {
+        path.resize(query);
+    }
+    if (method != "GET" && method != "HEAD") {
+        setStaticResponse(conn, kNotAllowed, sizeof(kNotAllowed) - 1);
+        return;
+    }
+    if (path != "/metrics") {
+        setStaticResponse(conn, kNotFound, sizeof(kNotFound) - 1);
+        return;
+    }
+
+    conn.exposition = cache.current();
+    if (conn.exposition->generation == 0) {
+        setStaticResponse(conn, kUnavailable, sizeof(kUnavailable) - 1);
+        return;
+    }
+    bool use_gzip = !conn.exposition->gzip_body.empty() && headerContainsToken(conn.request, "accept-encoding", "gzip");
+    const std::string& header = use_gzip ? conn.exposition->gzip_header : conn.exposition->header;
+    const std::string& body = use_gzip ? conn.exposition->gzip_body : conn.exposition->body;
+    conn.iov[0].iov_base = const_cast<char*>(header.data());
+    conn.iov[0].iov_len = header.size();
+    conn.iov[1].iov_base = const_cast<char*>(body.data());
+    conn.iov[1].iov_len = body.size();
+    conn.iov_count = method == "HEAD" ? 1 : 2;
+    conn.writing = true;
+}
+
+// Writes as much of the pending response as the socket accepts.
+// @return true when the connection is finished (fully written or failed).
+bool flushResponse(Connection& conn) {
+    while (conn.iov_count > 0) {
+        struct msghdr msg{};
+        msg.msg_iov = conn.iov;
+        msg.msg_iovlen = static_cast<decltype(msg.msg_iovlen)>(conn.iov_count);
+#if defined(MSG_NOSIGNAL)
+        ssize_t written = ::sendmsg(conn.fd, &msg, MSG_NOSIGNAL);
+#else
+        ssize_t written = ::sendmsg(conn.fd, &msg, 0);
+#endif
+        if (written < 0) {
+            if (errno == EINTR) continue;
+            return errno != EAGAIN && errno != EWOULDBLOCK;
+        }
+        // Advance the iovec array past what was written.
+        size_t remaining = static_cast<size_t>(written);
+        while (conn.iov_count > 0 && remaining >= conn.iov[0].iov_len) {
+            remaining -= conn.iov[0].iov_len;
+            conn.iov[0] = conn.iov[1];
+            --conn.iov_count;
+        }
+        if (conn.iov_count > 0) {
+            conn.iov[0].iov_base = static_cast<char*>(conn.iov[0].iov_base) + remaining;
+            conn.iov[0].iov_len -= remaining;
+        }
+    }
+    return true;
+}
+
+// Reads pending request bytes. @return true when the connection should be closed.
+bool readRequest(Connection& conn, const ExpositionCache& cache) {
+    char buffer[2048];
+    for (;;) {
+        ssize_t n = ::recv(conn.fd, buffer, sizeof(buffer), 0);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            return errno != EAGAIN && errno != EWOULDBLOCK;
+        }
+        if (n == 0) {
+            return true; // Peer closed before sending a full request
+        }
+        conn.request.append(buffer, static_cast<size_t>(n));
+        if (conn.request.find("\r\n\r\n") != std::string::npos) {
+            prepareResponse(conn, cache);
+            return flushResponse(conn);
+        }
+        if (conn.request.size() > kMaxRequestSize) {
+            setStaticResponse(conn, kBadRequest, sizeof(kBadRequest) - 1);
+            return flushResponse(conn);
+        }
+    }
+}
+} // anonymous namespace
+
+void PrometheusExporter::start() {
+    if (running_.load()) {
+        throw std::logic_error("PrometheusExporter is already running.");
+    }
+
+    int fd = ::socket(AF_INET, SOCK_STREAM, 0);
+    if (fd < 0) {
+        throw std::runtime_error(std::string("PrometheusExporter: socket() failed: ") + std::strerror(errno));
+    }
+    int reuse = 1;
+    ::setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+
+    struct sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(options_.port);
+    if (::inet_pton(AF_INET, options_.bind_address.c_str(), &addr.sin_addr) != 1) {
+        ::close(fd);
+        throw std::runtime_error("PrometheusExporter: invalid bind address '" + options_.bind_address + "'.");
+    }
+    if (::bind(fd, reinterpret_cast<struct sockaddr*>(&addr), sizeof(addr)) != 0 || ::listen(fd, 128) != 0) {
+        std::string error = std::strerror(errno);
+        ::close(fd);
+        throw std::runtime_error("PrometheusExporter: cannot listen on " + options_.bind_address + ":" +
+                                 std::to_string(options_.port) + ": " + error);
+    }
+    socklen_t addr_len = sizeof(addr);
+    ::getsockname(fd, reinterpret_cast<struct sockaddr*>(&addr), &addr_len);
+    bound_port_ = ntohs(addr.sin_port);
+    setNonBlocking(fd);
+
+    if (::pipe(wake_fds_) != 0) {
+        ::close(fd);
+        throw std::runtime_error(std::string("PrometheusExporter: pipe() failed: ") + std::strerror(errno));
+    }
+    listen_fd_ = fd;
+    running_.store(true);
+
+    server_thread_ = std::thread(&PrometheusExporter::serveLoop, this);
+    if (options_.collection_interval.count() > 0) {
+        collector_thread_ = std::thread(&PrometheusExporter::collectLoop, this);
+    }
+}
+
+void PrometheusExporter::stop() {
+    {
+        std::lock_guard<std::mutex> lock(stop_mutex_);
+        if (!running_.exchange(false)) {
+            return;
+        }
+    }
+    stop_cv_.notify_all();
+    char byte = 0;
+    (void)!::write(wake_fds_[1], &byte, 1);
+
+    if (server_thread_.joinable()) server_thread_.join();
+    if (collector_thread_.joinable()) collector_thread_.join();
+
+    ::close(listen_fd_);
+    ::close(wake_fds_[0]);
+    ::close(wake_fds_[1]);
+    listen_fd_ = -1;
+    wake_fds_[0] = wake_fds_[1] = -1;
+}
+
+void PrometheusExporter::serveLoop() {
+    std::vector<Connection> connections;
+    std::vector<struct pollfd> poll_fds;
+
+    while (running_.load()) {
+        poll_fds.clear();
+        poll_fds.push_back({wake_fds_[0], POLLIN, 0});
+        poll_fds.push_back({listen_fd_, POLLIN, 0});
+        for (const auto& conn : connections) {
+            poll_fds.push_back({conn.fd, static_cast<short>(conn.writing ? POLLOUT : POLLIN), 0});
+        }
+
+        int ready = ::poll(poll_fds.data(), static_cast<nfds_t>(poll_fds.size()), 1000);
+        if (ready < 0 && errno != EINTR) {
+            SystemMetricsLogger::Logger::error(std::string("PrometheusExporter: poll() failed: ") + std::strerror(errno));
+            break;
+        }
+        if (poll_fds[0].revents & POLLIN) {
+            break; // stop() was called
+        }
+
+        auto now = std::chrono::steady_clock::now();
+        std::vector<bool> finished(connections.size(), false);
+        for (size_t i = 0; i < connections.size(); ++i) {
+            short revents = poll_fds[i + 2].revents;
+            Connection& conn = connections[i];
+            if (revents & (POLLERR | POLLNVAL)) {
+                finished[i] = true;
+            } else if (conn.writing && (revents & (POLLOUT | POLLHUP))) {
+                finished[i] = flushResponse(conn);
+            } else if (!conn.writing && (revents & (POLLIN | POLLHUP))) {
+                finished[i] = readRequest(conn, cache_);
+            }
+            if (!finished[i] && now > conn.deadline) {
+                finished[i] = true; // Slow or idle client
+            }
+        }
+        size_t kept = 0;
+        for (size_t i = 0; i < connections.size(); ++i) {
+            if (finished[i]) {
+                ::close(connections[i].fd);
+            } else {
+                connections[kept++] = std::move(connections[i]);
+            }
+        }
+        connections.resize(kept);
+
+        if (poll_fds[1].revents & POLLIN) {
+            for (;;) {
+                int client = ::accept(listen_fd_, nullptr, nullptr);
+                if (client < 0) {
+                    break; // EAGAIN: no more pending connections
+                }
+                if (connections.size() >= kMaxConnections || !setNonBlocking(client)) {
+                    ::close(client);
+                    continue;
+                }
+                Connection conn{};
+                conn.fd = client;
+                conn.writing = false;
+                conn.iov_count = 0;
+                conn.deadline = now + kConnectionTimeout;
+                // Most requests arrive with the connection; try to serve them right away.
+                if (readRequest(conn, cache_)) {
+                    ::close(client);
+                } else {
+                    connections.push_back(std::move(conn));
+                }
+            }
+        }
+    }
+
+    for (const auto& conn : connections) {
+        ::close(conn.fd);
+    }
+}
+#else
+void PrometheusExporter::start() {
+    throw std::runtime_error("PrometheusExporter is not supported on this platform.");
+}
+
+void PrometheusExporter::stop() {
+    running_.store(false);
+}
+
+void PrometheusExporter::serveLoop() {}
+#endif
+
+} // namespace SystemMetricsExporter
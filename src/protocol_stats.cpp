@@ -0,0 +1,206 @@
+#include "protocol_stats.hpp"
+#include "proc_source.hpp"
+#include "proc_parse.hpp"
+#include "simd_scan.hpp"
+
+#include <stdexcept>
+#include <string>
+#include <string_view>
+
+namespace SystemNetStats {
+
+namespace { // Anonymous namespace for internal helpers
+
+struct CounterKey {
+    ProtocolCounter counter;
+    std::string_view section; // Line label without the colon
+    std::string_view key;     // Column name in the header line
+    const char* name;
+};
+
+// One entry per ProtocolCounter, in enumerator order.
+constexpr CounterKey kCounterKeys[] = {
+    {ProtocolCounter::IpInReceives, "Ip", "InReceives", "Ip.InReceives"},
+    {ProtocolCounter::IpInDiscards, "Ip", "InDiscards", "Ip.InDiscards"},
+    {ProtocolCounter::IpOutRequests, "Ip", "OutRequests", "Ip.OutRequests"},
+    {ProtocolCounter::IpOutDiscards, "Ip", "OutDiscards", "Ip.OutDiscards"},
+    {ProtocolCounter::IpOutNoRoutes, "Ip", "OutNoRoutes", "Ip.OutNoRoutes"},
+    {ProtocolCounter::TcpActiveOpens, "Tcp", "ActiveOpens", "Tcp.ActiveOpens"},
+    {ProtocolCounter::TcpPassiveOpens, "Tcp", "PassiveOpens", "Tcp.PassiveOpens"},
+    {ProtocolCounter::TcpAttemptFails, "Tcp", "AttemptFails", "Tcp.AttemptFails"},
+    {ProtocolCounter::TcpEstabResets, "Tcp", "EstabResets", "Tcp.EstabResets"},
+    {ProtocolCounter::TcpCurrEstab, "Tcp", "CurrEstab", "Tcp.CurrEstab"},
+    {ProtocolCounter::TcpInSegs, "Tcp", "InSegs", "Tcp.InSegs"},
+    {ProtocolCounter::TcpOutSegs, "Tcp", "OutSegs", "Tcp.OutSegs"},
+    {ProtocolCounter::TcpRetransSegs, "Tcp", "RetransSegs", "Tcp.RetransSegs"},
+    {ProtocolCounter::TcpInErrs, "Tcp", "InErrs", "Tcp.InErrs"},
+    {ProtocolCounter::TcpOutRsts, "Tcp", "OutRsts", "Tcp.OutRsts"},
+    {ProtocolCounter::TcpInCsumErrors, "Tcp", "InCsumErrors", "Tcp.InCsumErrors"},
+    {ProtocolCounter::UdpInDatagrams, "Udp", "InDatagrams", "Udp.InDatagrams"},
+    {ProtocolCounter::UdpNoPorts, "Udp", "NoPorts", "Udp.NoPorts"},
+    {ProtocolCounter::UdpInErrors, "Udp", "InErrors", "Udp.InErrors"},
+    {ProtocolCounter::UdpOutDatagrams, "Udp", "OutDatagrams", "Udp.OutDatagrams"},
+    {ProtocolCounter::UdpRcvbufErrors, "Udp", "RcvbufErrors", "Udp.RcvbufErrors"},
+    {ProtocolCounter::UdpSndbufErrors, "Udp", "SndbufErrors", "Udp.SndbufErrors"},
+    {ProtocolCounter::UdpInCsumErrors, "Udp", "InCsumErrors", "Udp.InCsumErrors"},
+    {ProtocolCounter::TcpExtSyncookiesSent, "TcpExt", "SyncookiesSent", "TcpExt.SyncookiesSent"},
+    {ProtocolCounter::TcpExtSyncookiesFailed, "TcpExt", "SyncookiesFailed", "TcpExt.SyncookiesFailed"},
+    {ProtocolCounter::TcpExtListenOverflows, "TcpExt", "ListenOverflows", "TcpExt.ListenOverflows"},
+    {ProtocolCounter::TcpExtListenDrops, "TcpExt", "ListenDrops", "TcpExt.ListenDrops"},
+    {ProtocolCounter::TcpExtTCPReqQFullDrop, "TcpExt", "TCPReqQFullDrop", "TcpExt.TCPReqQFullDrop"},
+    {ProtocolCounter::TcpExtTCPLostRetransmit, "TcpExt", "TCPLostRetransmit", "TcpExt.TCPLostRetransmit"},
+    {ProtocolCounter::TcpExtTCPFastRetrans, "TcpExt", "TCPFastRetrans", "TcpExt.TCPFastRetrans"},
+    {ProtocolCounter::TcpExtTCPSlowStartRetrans, "TcpExt", "TCPSlowStartRetrans", "TcpExt.TCPSlowStartRetrans"},
+    {ProtocolCounter::TcpExtTCPTimeouts, "TcpExt", "TCPTimeouts", "TcpExt.TCPTimeouts"},
+    {ProtocolCounter::TcpExtTCPSynRetrans, "TcpExt", "TCPSynRetrans", "TcpExt.TCPSynRetrans"},
+    {ProtocolCounter::TcpExtTCPAbortOnTimeout, "TcpExt", "TCPAbortOnTimeout", "TcpExt.TCPAbortOnTimeout"},
+    {ProtocolCounter::TcpExtTCPAbortOnMemory, "TcpExt", "TCPAbortOnMemory", "TcpExt.TCPAbortOnMemory"},
+    {ProtocolCounter::TcpExtTCPBacklogDrop, "TcpExt", "TCPBacklogDrop", "TcpExt.TCPBacklogDrop"},
+    {ProtocolCounter::TcpExtTCPRcvQDrop, "TcpExt", "TCPRcvQDrop", "TcpExt.TCPRcvQDrop"},
+    {ProtocolCounter::TcpExtTCPOFODrop, "TcpExt", "TCPOFODrop", "TcpExt.TCPOFODrop"},
+    {ProtocolCounter::TcpExtTCPMemoryPressures, "TcpExt", "TCPMemoryPressures", "TcpExt.TCPMemoryPressures"},
+    {ProtocolCounter::IpExtInOctets, "IpExt", "InOctets", "IpExt.InOctets"},
+    {ProtocolCounter::IpExtOutOctets, "IpExt", "OutOctets", "IpExt.OutOctets"},
+};
+
+constexpr bool keysMatchEnumerators() {
+    if (sizeof(kCounterKeys) / sizeof(kCounterKeys[0]) != kProtocolCounterCount) return false;
+    for (std::size_t i = 0; i < kProtocolCounterCount; ++i) {
+        if (static_cast<std::size_t>(kCounterKeys[i].counter) != i) return false;
+    }
+    return true;
+}
+static_assert(keysMatchEnumerators(), "kCounterKeys must list every ProtocolCounter in enumerator order");
+
+// Splits "Tcp: a b c" into its label ("Tcp") and the rest.
+bool splitLabel(std::string_view line, std::string_view& label, std::string_view& rest) {
+    const std::size_t colon = line.find(':');
+    if (colon == std::string_view::npos) return false;
+    label = line.substr(0, colon);
+    rest = line.substr(colon + 1);
+    return true;
+}
+
+[[noreturn]] void throwMalformed(std::string_view line) {
+    throw std::runtime_error("Malformed protocol statistics line: " + std::string(line));
+}
+
+} // namespace
+
+const char* protocolCounterName(ProtocolCounter counter) {
+    const std::size_t index = static_cast<std::size_t>(counter);
+    return index < kProtocolCounterCount ? kCounterKeys[index].name : "unknown";
+}
+
+bool isProtocolGauge(ProtocolCounter counter) {
+    return counter == ProtocolCounter::TcpCurrEstab;
+}
+
+// --- ProtocolTableLayout ---
+
+void ProtocolTableLayout::buildSection(std::string_view header, Section& section) {
+    section.header.assign(header);
+    section.columns.clear();
+    std::string_view label, rest;
+    splitLabel(header, label, rest);
+    SystemProcFS::FieldScanner keys(rest);
+    std::string_view key;
+    for (std::uint32_t column = 0; keys.next(key); ++column) {
+        for (const CounterKey& entry : kCounterKeys) {
+            if (entry.section == label && entry.key == key) {
+                section.columns.emplace_back(column, static_cast<std::uint32_t>(entry.counter));
+                break;
+            }
+        }
+    }
+}
+
+void ProtocolTableLayout::parse(std::string_view text, ProtocolCounters& out) {
+    std::size_t count = 0;
+    bool rebuilt = false;
+    std::string_view header, values;
+    while (SystemProcFS::nextLine(text, header)) {
+        if (header.empty()) continue;
+        if (!SystemProcFS::nextLine(text, values)) throwMalformed(header);
+        std::string_view header_label, header_rest, value_label, value_rest;
+        if (!splitLabel(header, header_label, header_rest) || !splitLabel(values, value_label, value_rest) ||
+            header_label != value_label) {
+            throwMalformed(values);
+        }
+
+        if (count == sections_.size()) sections_.emplace_back();
+        Section& section = sections_[count++];
+        if (section.header != header) {
+            buildSection(header, section);
+            rebuilt = true;
+        }
+
+        // Walk the value line once, converting only the mapped columns.
+        SystemProcFS::FieldScanner scanner(value_rest);
+        std::uint32_t position = 0;
+        for (const auto& [column, index] : section.columns) {
+            std::uint64_t value = 0;
+            if (!scanner.skip(column - position) || !scanner.nextUnsigned(value)) throwMalformed(values);
+            position = column + 1;
+            out.values[index] = value;
+            out.present[index] = true;
+        }
+    }
+    if (count != sections_.size()) {
+        sections_.resize(count);
+        rebuilt = true;
+    }
+    if (rebuilt) ++builds_;
+}
+
+// --- ProtocolStatsReader ---
+
+void ProtocolStatsReader::parse(std::string_view text, ProtocolCounters& out) {
+    ProtocolTableLayout layout;
+    layout.parse(text, out);
+}
+
+ProtocolCounters ProtocolStatsReader::getProtocolCounters() {
+    ProtocolCounters counters;
+    std::string buffer;
+    if (!SystemProcFS::ProcFS::readFile("/proc/net/snmp", buffer)) {
+        throw std::runtime_error("Failed to read /proc/net/snmp.");
+    }
+    parse(buffer, counters);
+    if (SystemProcFS::ProcFS::readFile("/proc/net/netstat", buffer)) parse(buffer, counters);
+    return counters;
+}
+
+// --- ProtocolStatsCollector ---
+
+void ProtocolStatsCollector::sample() {
+    sample(Clock::now());
+}
+
+void ProtocolStatsCollector::sample(Clock::time_point now) {
+    ProtocolCounters reading;
+    if (!SystemProcFS::ProcFS::readFile("/proc/net/snmp", buffer_)) {
+        throw std::runtime_error("Failed to read /proc/net/snmp.");
+    }
+    snmp_.parse(buffer_, reading);
+    if (SystemProcFS::ProcFS::readFile("/proc/net/netstat", buffer_)) netstat_.parse(buffer_, reading);
+
+    previous_ = current_;
+    current_ = reading;
+    ++samples_;
+    const Clock::time_point previous_time = last_time_;
+    last_time_ = now;
+    if (samples_ < 2) return;
+
+    rates_.elapsed_seconds = std::chrono::duration<double>(now - previous_time).count();
+    SystemProcFS::subtractCounters(previous_.values.data(), current_.values.data(), rates_.deltas.data(),
+                                   kProtocolCounterCount);
+    const double scale = rates_.elapsed_seconds > 0.0 ? 1.0 / rates_.elapsed_seconds : 0.0;
+    for (std::size_t i = 0; i < kProtocolCounterCount; ++i) {
+        const bool counted = current_.present[i] && previous_.present[i] && !isProtocolGauge(static_cast<ProtocolCounter>(i));
+        if (!counted) rates_.deltas[i] = 0;
+        rates_.per_second[i] = static_cast<double>(rates_.deltas[i]) * scale;
+    }
+}
+
+} // namespace SystemNetStats
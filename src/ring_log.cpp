@@ -0,0 +1,463 @@
+#include "ring_log.hpp"
+#include "logger.hpp"
+
+#include <array>
+#include <cerrno>
+#include <cstddef>    // For offsetof
+#include <cstring>    // For std::memcpy, std::strerror
+#include <stdexcept>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace SystemMetricsHistory {
+
+using SystemMetricsCodec::ByteSpan;
+using SystemMetricsSnapshot::MetricsSnapshot;
+
+namespace { // Anonymous namespace for internal helpers
+constexpr std::size_t kHeaderRegion = 4096;
+constexpr std::size_t kSlotSize = 128;
+constexpr std::uint32_t kHeaderMagic = 0x474C524D; // "MRLG" little-endian
+constexpr std::uint16_t kHeaderVersion = 1;
+constexpr std::uint32_t kWrapMarker = 0xFFFFFFFFu;
+constexpr std::size_t kRecordHeader = 16; // length, crc, sequence
+constexpr std::size_t kMinCapacity = 4096;
+constexpr std::uint64_t kMaxCapacity = 1ULL << 32;
+
+// On-disk header slot. Fields are written in host byte order; the file is not meant to move
+// between architectures.
+struct HeaderSlot {
+    std::uint32_t magic;
+    std::uint16_t version;
+    std::uint16_t reserved;
+    std::uint64_t capacity;
+    std::uint64_t commit;
+    std::uint64_t head;
+    std::uint64_t tail;
+    std::uint64_t first_seq;
+    std::uint64_t next_seq;
+    std::uint64_t used;
+    std::uint64_t last;
+    std::uint32_t crc;       // CRC32 of every byte before this field
+    std::uint32_t padding;
+};
+static_assert(sizeof(HeaderSlot) <= kSlotSize, "Header slot must fit its reserved space");
+
+constexpr std::array<std::uint32_t, 256> makeCrcTable() {
+    std::array<std::uint32_t, 256> table{};
+    for (std::uint32_t i = 0; i < 256; ++i) {
+        std::uint32_t c = i;
+        for (int k = 0; k < 8; ++k) {
+            c = (c & 1) ? (0xEDB88320u ^ (c >> 1)) : (c >> 1);
+        }
+        table[i] = c;
+    }
+    return table;
+}
+constexpr std::array<std::uint32_t, 256> kCrcTable = makeCrcTable();
+
+// Standard CRC-32 (IEEE 802.3), continued from `crc`.
+std::uint32_t crc32(const std::uint8_t* data, std::size_t size, std::uint32_t crc = 0) {
+    crc = ~crc;
+    for (std::size_t i = 0; i < size; ++i) {
+        crc = kCrcTable[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+    }
+    return ~crc;
+}
+
+std::uint32_t recordCrc(std::uint64_t sequence, const std::uint8_t* payload, std::size_t size) {
+    std::uint8_t seq_bytes[8];
+    std::memcpy(seq_bytes, &sequence, sizeof(sequence));
+    return crc32(payload, size, crc32(seq_bytes, sizeof(seq_bytes)));
+}
+
+constexpr std::uint64_t alignedRecordSize(std::uint64_t payload_size) {
+    return (kRecordHeader + payload_size + 7) & ~std::uint64_t(7);
+}
+
+std::uint32_t load32(const std::uint8_t* p) {
+    std::uint32_t v;
+    std::memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+std::uint64_t load64(const std::uint8_t* p) {
+    std::uint64_t v;
+    std::memcpy(&v, p, sizeof(v));
+    return v;
+}
+} // namespace
+
+RingLog::RingLog(const std::string& path, std::size_t capacity, Mode mode)
+    : path_(path), mode_(mode) {
+    if (capacity < kMinCapacity || capacity > kMaxCapacity) {
+        throw std::invalid_argument("RingLog capacity must be between 4 KiB and 4 GiB.");
+    }
+    capacity = (capacity + 7) & ~std::size_t(7);
+
+#if defined(__unix__) || defined(__APPLE__)
+    const bool read_only = mode_ == Mode::ReadOnly;
+    fd_ = ::open(path_.c_str(), read_only ? O_RDONLY : (O_RDWR | O_CREAT), 0644);
+    if (fd_ < 0) {
+        throw std::runtime_error("RingLog: cannot open " + path_ + ": " + std::strerror(errno));
+    }
+    struct stat st{};
+    if (::fstat(fd_, &st) != 0) {
+        std::string error = std::strerror(errno);
+        ::close(fd_);
+        throw std::runtime_error("RingLog: cannot stat " + path_ + ": " + error);
+    }
+
+    auto mapFile = [&](std::size_t size) {
+        void* map = ::mmap(nullptr, size, read_only ? PROT_READ : (PROT_READ | PROT_WRITE), MAP_SHARED, fd_, 0);
+        if (map == MAP_FAILED) {
+            std::string error = std::strerror(errno);
+            ::close(fd_);
+            fd_ = -1;
+            throw std::runtime_error("RingLog: cannot map " + path_ + ": " + error);
+        }
+        map_ = static_cast<std::uint8_t*>(map);
+        map_size_ = size;
+    };
+
+    const std::size_t existing = static_cast<std::size_t>(st.st_size);
+    if (existing > kHeaderRegion) {
+        mapFile(existing);
+        if (loadHeader() && capacity_ + kHeaderRegion == existing) {
+            if (!read_only) {
+                recoverUncommitted();
+            }
+            return;
+        }
+        if (read_only) {
+            ::munmap(map_, map_size_);
+            ::close(fd_);
+            map_ = nullptr;
+            fd_ = -1;
+            throw std::runtime_error("RingLog: " + path_ + " has no valid header.");
+        }
+        SystemMetricsLogger::Logger::warning("RingLog: " + path_ + " has no valid header, reinitializing.");
+        ::munmap(map_, map_size_);
+        map_ = nullptr;
+    } else if (read_only) {
+        ::close(fd_);
+        fd_ = -1;
+        throw std::runtime_error("RingLog: " + path_ + " is not a ring log.");
+    }
+
+    if (::ftruncate(fd_, static_cast<off_t>(kHeaderRegion + capacity)) != 0) {
+        std::string error = std::strerror(errno);
+        ::close(fd_);
+        fd_ = -1;
+        throw std::runtime_error("RingLog: cannot size " + path_ + ": " + error);
+    }
+    mapFile(kHeaderRegion + capacity);
+    capacity_ = capacity;
+    initialize();
+#else
+    throw std::runtime_error("RingLog is not supported on this platform.");
+#endif
+}
+
+RingLog::~RingLog() {
+#if defined(__unix__) || defined(__APPLE__)
+    if (map_ != nullptr) {
+        ::munmap(map_, map_size_);
+    }
+    if (fd_ >= 0) {
+        ::close(fd_);
+    }
+#endif
+}
+
+void RingLog::initialize() {
+    std::memset(map_, 0, kHeaderRegion);
+    state_ = State{};
+    commitHeader();
+    commitHeader(); // Write both slots so neither holds stale contents from a previous file
+}
+
+bool RingLog::loadHeader() {
+    bool found = false;
+    for (std::size_t slot = 0; slot < 2; ++slot) {
+        HeaderSlot h;
+        std::memcpy(&h, map_ + slot * kSlotSize, sizeof(h));
+        if (h.magic != kHeaderMagic || h.version != kHeaderVersion ||
+            h.crc != crc32(reinterpret_cast<const std::uint8_t*>(&h), offsetof(HeaderSlot, crc))) {
+            continue;
+        }
+        if (h.capacity < kMinCapacity || h.capacity > kMaxCapacity || h.head >= h.capacity ||
+            h.tail >= h.capacity || h.last >= h.capacity || h.used > h.capacity || h.first_seq > h.next_seq) {
+            continue;
+        }
+        if (!found || h.commit > state_.commit) {
+            state_ = State{h.commit, h.head, h.tail, h.first_seq, h.next_seq, h.used, h.last};
+            capacity_ = static_cast<std::size_t>(h.capacity);
+            found = true;
+        }
+    }
+    return found;
+}
+
+void RingLog::commitHeader() {
+    ++state_.commit;
+    HeaderSlot h{};
+    h.magic = kHeaderMagic;
+    h.version = kHeaderVersion;
+    h.capacity = capacity_;
+    h.commit = state_.commit;
+    h.head = state_.head;
+    h.tail = state_.tail;
+    h.first_seq = state_.first_seq;
+    h.next_seq = state_.next_seq;
+    h.used = state_.used;
+    h.last = state_.last;
+    h.crc = crc32(reinterpret_cast<const std::uint8_t*>(&h), offsetof(HeaderSlot, crc));
+    // Alternate slots: a torn write here leaves the previous commit readable in the other one.
+    std::memcpy(map_ + (state_.commit & 1) * kSlotSize, &h, sizeof(h));
+}
+
+bool RingLog::recordAt(std::uint64_t offset, std::uint64_t expected_seq, std::uint64_t& next_offset,
+                       ByteSpan& payload) const {
+    const std::uint8_t* data = map_ + kHeaderRegion;
+    if (capacity_ - offset >= 4 && load32(data + offset) == kWrapMarker) {
+        offset = 0;
+    }
+    if (capacity_ - offset < kRecordHeader) {
+        return false;
+    }
+    const std::uint32_t length = load32(data + offset);
+    const std::uint64_t size = alignedRecordSize(length);
+    if (size > capacity_ - offset || load64(data + offset + 8) != expected_seq) {
+        return false;
+    }
+    const std::uint8_t* body = data + offset + kRecordHeader;
+    if (load32(data + offset + 4) != recordCrc(expected_seq, body, length)) {
+        return false;
+    }
+    payload = ByteSpan(body, length);
+    next_offset = offset + size == capacity_ ? 0 : offset + size;
+    return true;
+}
+
+void RingLog::recoverUncommitted() {
+    // A crash between writing a record and committing the header leaves a valid record at `head`.
+    // Adopt such records as long as they carry the expected sequence and fit in the free space.
+    bool recovered = false;
+    if (state_.used == 0) {
+        state_.head = state_.tail = 0; // append() restarts empty logs at offset 0
+    }
+    for (;;) {
+        std::uint64_t next_offset = 0;
+        ByteSpan payload;
+        if (state_.used == capacity_ || !recordAt(state_.head, state_.next_seq, next_offset, payload)) {
+            break;
+        }
+        const std::uint64_t start = static_cast<std::uint64_t>(payload.data - (map_ + kHeaderRegion)) - kRecordHeader;
+        const std::uint64_t pad = start == state_.head ? 0 : capacity_ - state_.head;
+        const std::uint64_t size = alignedRecordSize(payload.size);
+        if (state_.used + pad + size > capacity_) {
+            break;
+        }
+        state_.used += pad + size;
+        state_.head = next_offset;
+        state_.last = start;
+        ++state_.next_seq;
+        recovered = true;
+    }
+    if (recovered) {
+        commitHeader();
+    }
+}
+
+void RingLog::evictOldest() {
+    const std::uint8_t* data = map_ + kHeaderRegion;
+    if (capacity_ - state_.tail >= 4 && load32(data + state_.tail) == kWrapMarker) {
+        state_.used -= capacity_ - state_.tail;
+        state_.tail = 0;
+    }
+    if (state_.first_seq < state_.next_seq) {
+        const std::uint64_t size = alignedRecordSize(load32(data + state_.tail));
+        state_.used = size > state_.used ? 0 : state_.used - size;
+        state_.tail = state_.tail + size >= capacity_ ? 0 : state_.tail + size;
+        ++state_.first_seq;
+    }
+    if (state_.first_seq == state_.next_seq) {
+        state_.used = 0;
+        state_.tail = state_.head;
+    }
+}
+
+std::uint64_t RingLog::append(ByteSpan payload) {
+    if (mode_ == Mode::ReadOnly) {
+        throw std::logic_error("RingLog: cannot append to a read-only log.");
+    }
+    const std::uint64_t size = alignedRecordSize(payload.size);
+    if (payload.size >= kWrapMarker || size > capacity_) {
+        throw std::invalid_argument("RingLog: record of " + std::to_string(payload.size) +
+                                    " bytes does not fit in the log.");
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (state_.used == 0) {
+        state_.head = state_.tail = 0;
+    }
+    std::uint64_t offset = state_.head;
+    std::uint64_t pad = 0;
+    if (capacity_ - offset < size) {
+        pad = capacity_ - offset;
+        offset = 0;
+    }
+
+    bool evicted = false;
+    while (state_.used != 0 && state_.used + pad + size > capacity_) {
+        evictOldest();
+        evicted = true;
+        if (state_.used == 0) {
+            // Everything was evicted: restart at the beginning of the region.
+            state_.head = state_.tail = 0;
+            offset = 0;
+            pad = 0;
+        }
+    }
+    if (evicted) {
+        // Commit the new tail before overwriting the evicted records so that a crash in
+        // the middle of the write never leaves the header pointing at clobbered data.
+        commitHeader();
+    }
+
+    std::uint8_t* data = map_ + kHeaderRegion;
+    if (pad >= 4) {
+        const std::uint32_t marker = kWrapMarker;
+        std::memcpy(data + state_.head, &marker, sizeof(marker));
+    }
+    const std::uint32_t length = static_cast<std::uint32_t>(payload.size);
+    const std::uint64_t sequence = state_.next_seq;
+    const std::uint32_t crc = recordCrc(sequence, payload.data, payload.size);
+    std::uint8_t* record = data + offset;
+    std::memcpy(record + kRecordHeader, payload.data, payload.size);
+    std::memcpy(record + 8, &sequence, sizeof(sequence));
+    std::memcpy(record + 4, &crc, sizeof(crc));
+    std::memcpy(record, &length, sizeof(length));
+
+    state_.used += pad + size;
+    state_.head = offset + size == capacity_ ? 0 : offset + size;
+    state_.last = offset;
+    state_.next_seq = sequence + 1;
+    commitHeader();
+    return sequence;
+}
+
+std::uint64_t RingLog::append(const MetricsSnapshot& snapshot) {
+    std::vector<std::uint8_t> frame;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        scratch_.clear();
+        encoder_.encode(snapshot, scratch_, true);
+        frame.swap(scratch_);
+    }
+    std::uint64_t sequence = append(ByteSpan(frame));
+    std::lock_guard<std::mutex> lock(mutex_);
+    scratch_.swap(frame); // Hand the buffer back for the next append
+    return sequence;
+}
+
+std::size_t RingLog::discardBefore(std::uint64_t sequence) {
+    if (mode_ == Mode::ReadOnly) {
+        throw std::logic_error("RingLog: cannot discard from a read-only log.");
+    }
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::size_t dropped = 0;
+    while (state_.first_seq < sequence && state_.first_seq < state_.next_seq) {
+        evictOldest();
+        ++dropped;
+    }
+    if (dropped != 0) {
+        commitHeader();
+    }
+    return dropped;
+}
+
+std::size_t RingLog::forEach(const std::function<bool(std::uint64_t, ByteSpan)>& visitor) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::size_t visited = 0;
+    std::uint64_t offset = state_.tail;
+    for (std::uint64_t seq = state_.first_seq; seq < state_.next_seq; ++seq) {
+        ByteSpan payload;
+        std::uint64_t next_offset = 0;
+        if (!recordAt(offset, seq, next_offset, payload)) {
+            SystemMetricsLogger::Logger::warning("RingLog: record " + std::to_string(seq) + " in " + path_ +
+                                                 " failed validation, stopping replay.");
+            break;
+        }
+        ++visited;
+        if (!visitor(seq, payload)) {
+            break;
+        }
+        offset = next_offset;
+    }
+    return visited;
+}
+
+std::vector<MetricsSnapshot> RingLog::replay(std::size_t max_records) const {
+    const std::uint64_t stored = size();
+    const std::uint64_t skip = (max_records != 0 && stored > max_records) ? stored - max_records : 0;
+    std::vector<MetricsSnapshot> snapshots;
+    snapshots.reserve(static_cast<std::size_t>(stored - skip));
+    SystemMetricsCodec::SnapshotDecoder decoder;
+    std::uint64_t index = 0;
+    forEach([&](std::uint64_t, ByteSpan payload) {
+        if (index++ >= skip) {
+            snapshots.emplace_back();
+            decoder.decode(payload, snapshots.back());
+        }
+        return true;
+    });
+    return snapshots;
+}
+
+bool RingLog::latest(MetricsSnapshot& out) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (state_.first_seq == state_.next_seq) {
+        return false;
+    }
+    ByteSpan payload;
+    std::uint64_t next_offset = 0;
+    if (!recordAt(state_.last, state_.next_seq - 1, next_offset, payload)) {
+        return false;
+    }
+    SystemMetricsCodec::SnapshotDecoder decoder;
+    decoder.decode(payload, out);
+    return true;
+}
+
+void RingLog::sync() {
+#if defined(__unix__) || defined(__APPLE__)
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (map_ != nullptr && mode_ == Mode::ReadWrite && ::msync(map_, map_size_, MS_SYNC) != 0) {
+        throw std::runtime_error("RingLog: msync failed for " + path_ + ": " + std::strerror(errno));
+    }
+#endif
+}
+
+std::uint64_t RingLog::firstSequence() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return state_.first_seq;
+}
+
+std::uint64_t RingLog::nextSequence() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return state_.next_seq;
+}
+
+std::size_t RingLog::size() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return static_cast<std::size_t>(state_.next_seq - state_.first_seq);
+}
+
+} // namespace SystemMetricsHistory
@@ -0,0 +1,214 @@
+#include "sched_stats.hpp"
+#include "cpu_stats.hpp"
+#include "proc_parse.hpp"
+#include "proc_source.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+
+namespace SystemCPUStats {
+
+namespace { // Anonymous namespace for internal helpers
+
+// Versions 15 (2.6.30) to 17 share the cpu line layout read here.
+constexpr unsigned kMinVersion = 15;
+constexpr std::size_t kCpuFields = 9;
+
+std::string taskPath(int pid) {
+    return "/proc/" + std::to_string(pid) + "/schedstat";
+}
+
+SystemProcFS::BatchFileReader::Options readerOptions() {
+    SystemProcFS::BatchFileReader::Options options;
+    options.slot_size = 256; // Three numbers
+    options.use_io_uring = false; // /proc: see BatchFileReader
+    return options;
+}
+
+std::string_view trimTrailing(std::string_view text) {
+    while (!text.empty() && (text.back() == '\n' || text.back() == ' ')) text.remove_suffix(1);
+    return text;
+}
+
+// Latency from the three counter deltas every schedstat line carries.
+SchedLatency latencyOf(std::uint64_t run_time_ns, std::uint64_t run_delay_ns, std::uint64_t timeslices, double scale) {
+    SchedLatency latency;
+    latency.running = static_cast<double>(run_time_ns) * 1e-9 * scale;
+    latency.waiting = static_cast<double>(run_delay_ns) * 1e-9 * scale;
+    latency.timeslices = static_cast<double>(timeslices) * scale;
+    latency.average_wait_us = timeslices == 0 ? 0.0 : static_cast<double>(run_delay_ns) * 1e-3 / static_cast<double>(timeslices);
+    return latency;
+}
+
+} // namespace
+
+// --- SchedStatsReader ---
+
+void SchedStatsReader::parse(std::string_view text, SchedStat& out) {
+    out.version = 0;
+    out.cpus.clear();
+    std::string_view line;
+    while (SystemProcFS::nextLine(text, line)) {
+        SystemProcFS::FieldScanner scanner(line);
+        std::string_view key;
+        if (!scanner.next(key)) continue;
+        if (key == "version") {
+            std::uint64_t version = 0;
+            if (!scanner.nextUnsigned(version)) throw std::runtime_error("Malformed /proc/schedstat line: " + std::string(line));
+            if (version < kMinVersion) {
+                throw std::runtime_error("Unsupported /proc/schedstat version " + std::to_string(version) + ".");
+            }
+            out.version = static_cast<unsigned>(version);
+            continue;
+        }
+        if (key.size() <= 3 || key.compare(0, 3, "cpu") != 0) continue; // timestamp, domainN
+        if (out.version == 0) throw std::runtime_error("Malformed /proc/schedstat: cpu line before version.");
+
+        std::uint64_t cpu = 0;
+        std::uint64_t fields[kCpuFields];
+        SystemProcFS::FieldScanner number(key.substr(3));
+        bool valid = number.nextUnsigned(cpu);
+        for (std::size_t i = 0; valid && i < kCpuFields; ++i) valid = scanner.nextUnsigned(fields[i]);
+        if (!valid) throw std::runtime_error("Malformed /proc/schedstat line: " + std::string(line));
+
+        SchedCPUCounters& counters = out.cpus.emplace_back();
+        counters.cpu = static_cast<unsigned>(cpu);
+        // fields[0] and fields[1] are sched_yield() calls and a retired counter.
+        counters.schedule_calls = fields[2];
+        counters.idle_schedules = fields[3];
+        counters.wakeups = fields[4];
+        counters.local_wakeups = fields[5];
+        counters.run_time_ns = fields[6];
+        counters.run_delay_ns = fields[7];
+        counters.timeslices = fields[8];
+    }
+    if (out.version == 0) throw std::runtime_error("Malformed /proc/schedstat: no version line.");
+}
+
+void SchedStatsReader::parseTask(std::string_view text, TaskSchedCounters& out) {
+    SystemProcFS::FieldScanner scanner(text);
+    std::string_view rest;
+    if (!scanner.nextUnsigned(out.run_time_ns) || !scanner.nextUnsigned(out.run_delay_ns) ||
+        !scanner.nextUnsigned(out.timeslices) || scanner.next(rest)) {
+        throw std::runtime_error("Malformed schedstat line: " + std::string(trimTrailing(text)));
+    }
+}
+
+SchedStat SchedStatsReader::getSchedStats() {
+    std::string buffer;
+    if (!SystemProcFS::ProcFS::readFile("/proc/schedstat", buffer)) {
+        throw std::runtime_error("Failed to read /proc/schedstat.");
+    }
+    SchedStat stats;
+    parse(buffer, stats);
+    return stats;
+}
+
+bool SchedStatsReader::readTask(int pid, TaskSchedCounters& out, std::string& buffer) {
+    if (!SystemProcFS::ProcFS::readFile(taskPath(pid), buffer)) return false;
+    parseTask(buffer, out);
+    return true;
+}
+
+// --- SchedCollector ---
+
+SchedCollector::SchedCollector() : reader_(readerOptions()) {}
+
+void SchedCollector::track(int pid) {
+    if (std::find(pids_.begin(), pids_.end(), pid) != pids_.end()) return;
+    const std::size_t file = reader_.add(taskPath(pid));
+    pids_.push_back(pid);
+    Task& task = tasks_.emplace_back();
+    task.pid = pid;
+    task.file = file;
+}
+
+void SchedCollector::untrack(int pid) {
+    const auto found = std::find(pids_.begin(), pids_.end(), pid);
+    if (found == pids_.end()) return;
+    const auto task = tasks_.begin() + (found - pids_.begin());
+    reader_.remove(task->file);
+    tasks_.erase(task);
+    pids_.erase(found);
+}
+
+void SchedCollector::sample() {
+    sample(Clock::now());
+}
+
+void SchedCollector::sample(Clock::time_point now) {
+    // Every task is parsed into `next` before /proc/schedstat and the tasks are committed together.
+    if (SystemProcFS::ProcFS::readFile("/proc/schedstat", buffer_)) {
+        SchedStatsReader::parse(buffer_, previous_);
+    } else {
+        previous_.version = 0;
+        previous_.cpus.clear();
+    }
+    reader_.readAll();
+    for (Task& task : tasks_) {
+        task.exited = !reader_.ok(task.file);
+        if (!task.exited) SchedStatsReader::parseTask(reader_.contents(task.file), task.next);
+    }
+    std::swap(previous_, current_);
+    std::size_t kept = 0;
+    for (std::size_t i = 0; i < tasks_.size(); ++i) {
+        Task& task = tasks_[i];
+        if (task.exited) {
+            reader_.remove(task.file);
+            continue;
+        }
+        task.previous = task.current;
+        task.current = task.next;
+        ++task.samples;
+        if (kept != i) {
+            tasks_[kept] = task;
+            pids_[kept] = pids_[i];
+        }
+        ++kept;
+    }
+    tasks_.resize(kept);
+    pids_.resize(kept);
+
+    ++samples_;
+    const Clock::time_point previous_time = last_time_;
+    last_time_ = now;
+    if (samples_ < 2) return;
+
+    rates_.elapsed_seconds = std::chrono::duration<double>(now - previous_time).count();
+    const double scale = rates_.elapsed_seconds > 0.0 ? 1.0 / rates_.elapsed_seconds : 0.0;
+    computeCPURates(scale);
+    rates_.tasks.clear();
+    for (const Task& task : tasks_) {
+        if (task.samples < 2) continue;
+        TaskSchedLatency& latency = rates_.tasks.emplace_back();
+        latency.pid = task.pid;
+        latency.latency = latencyOf(counterDelta(task.previous.run_time_ns, task.current.run_time_ns),
+                                    counterDelta(task.previous.run_delay_ns, task.current.run_delay_ns),
+                                    counterDelta(task.previous.timeslices, task.current.timeslices), scale);
+    }
+}
+
+void SchedCollector::computeCPURates(double scale) {
+    rates_.cpus.clear();
+    std::uint64_t run_time = 0, run_delay = 0, timeslices = 0;
+    // The kernel lists CPUs ascending; match by number so hotplugged CPUs are skipped for an interval.
+    auto previous = previous_.cpus.begin();
+    for (const SchedCPUCounters& cpu : current_.cpus) {
+        while (previous != previous_.cpus.end() && previous->cpu < cpu.cpu) ++previous;
+        if (previous == previous_.cpus.end() || previous->cpu != cpu.cpu) continue;
+        const std::uint64_t cpu_run_time = counterDelta(previous->run_time_ns, cpu.run_time_ns);
+        const std::uint64_t cpu_run_delay = counterDelta(previous->run_delay_ns, cpu.run_delay_ns);
+        const std::uint64_t cpu_timeslices = counterDelta(previous->timeslices, cpu.timeslices);
+        SchedCPULatency& latency = rates_.cpus.emplace_back();
+        latency.cpu = cpu.cpu;
+        latency.latency = latencyOf(cpu_run_time, cpu_run_delay, cpu_timeslices, scale);
+        run_time += cpu_run_time;
+        run_delay += cpu_run_delay;
+        timeslices += cpu_timeslices;
+    }
+    rates_.total = latencyOf(run_time, run_delay, timeslices, scale);
+}
+
+} // namespace SystemCPUStats
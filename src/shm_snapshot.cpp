@@ -0,0 +1,416 @@
+#include "shm_snapshot.hpp"
+
+#include <cerrno>
+#include <cstring>    // For std::memcpy, std::strerror, strnlen
+#include <new>        // For placement new
+#include <stdexcept>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace SystemMetricsShm {
+
+using SystemMetricsSnapshot::MetricsSnapshot;
+
+static_assert(std::atomic<std::uint64_t>::is_always_lock_free,
+              "Shared-memory seqlock requires lock-free 64-bit atomics");
+static_assert(std::atomic<std::uint32_t>::is_always_lock_free,
+              "Shared-memory seqlock requires lock-free 32-bit atomics");
+
+struct ShmHeader {
+    std::atomic<std::uint32_t> magic;     // Stored last during initialisation
+    std::uint32_t version;
+    std::uint32_t max_disks;
+    std::uint32_t max_nets;
+    std::uint64_t word_count;
+    std::atomic<std::uint32_t> stale;     // Set when the publisher goes away or is replaced
+    std::uint32_t reserved;
+    std::atomic<std::uint64_t> publishes;
+    alignas(64) std::atomic<std::uint64_t> sequence; // Odd while a write is in progress
+};
+
+namespace { // Anonymous namespace for internal helpers
+constexpr std::uint32_t kShmMagic = 0x534D5341; // "ASMS" little-endian
+constexpr std::uint32_t kShmVersion = 1;
+constexpr std::size_t kWordsOffset = (sizeof(ShmHeader) + 63) & ~std::size_t(63);
+constexpr std::size_t kCpuWords = 11;
+constexpr std::size_t kMemWords = 7;
+constexpr std::size_t kFixedWords = 1 + kCpuWords + kMemWords + 2;
+constexpr std::size_t kNameWords = 4;
+constexpr std::size_t kDiskWords = kNameWords + 4;
+constexpr std::size_t kNetWords = kNameWords + 8;
+
+std::atomic<std::uint64_t>* wordsOf(ShmHeader* header) {
+    return reinterpret_cast<std::atomic<std::uint64_t>*>(reinterpret_cast<char*>(header) + kWordsOffset);
+}
+
+const std::atomic<std::uint64_t>* wordsOf(const ShmHeader* header) {
+    return reinterpret_cast<const std::atomic<std::uint64_t>*>(reinterpret_cast<const char*>(header) + kWordsOffset);
+}
+
+std::uint64_t doubleBits(double value) {
+    std::uint64_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    return bits;
+}
+
+double bitsDouble(std::uint64_t bits) {
+    double value;
+    std::memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+void storeName(std::atomic<std::uint64_t>* words, const std::string& name) {
+    std::uint64_t packed[kNameWords] = {};
+    std::memcpy(packed, name.data(), name.size() < kMaxShmNameLength ? name.size() : kMaxShmNameLength);
+    for (std::size_t i = 0; i < kNameWords; ++i) {
+        words[i].store(packed[i], std::memory_order_relaxed);
+    }
+}
+
+void loadName(const std::atomic<std::uint64_t>* words, std::string& name) {
+    std::uint64_t packed[kNameWords];
+    for (std::size_t i = 0; i < kNameWords; ++i) {
+        packed[i] = words[i].load(std::memory_order_relaxed);
+    }
+    const char* chars = reinterpret_cast<const char*>(packed);
+    name.assign(chars, strnlen(chars, kMaxShmNameLength)); // Reuses the string's capacity
+}
+
+void validateName(const std::string& name) {
+    if (name.size() < 2 || name[0] != '/' || name.find('/', 1) != std::string::npos || name.size() > 255) {
+        throw std::invalid_argument("Shared-memory name must look like '/name': " + name);
+    }
+}
+
+// Counts a ShmReader call as under way while it uses a header loaded from header_, so that
+// reopen() unmaps replaced regions only when none is. seq_cst, paired with reopen().
+class ActiveRead {
+public:
+    explicit ActiveRead(std::atomic<std::size_t>& count) : count_(count) { count_.fetch_add(1); }
+    ~ActiveRead() { count_.fetch_sub(1); }
+    ActiveRead(const ActiveRead&) = delete;
+    ActiveRead& operator=(const ActiveRead&) = delete;
+
+private:
+    std::atomic<std::size_t>& count_;
+};
+} // namespace
+
+#if defined(__unix__) || defined(__APPLE__)
+namespace {
+// Flags an existing region under `name` as stale so that its readers know to reopen.
+void markExistingStale(const std::string& name) {
+    int fd = ::shm_open(name.c_str(), O_RDWR, 0);
+    if (fd < 0) {
+        return;
+    }
+    struct stat st{};
+    if (::fstat(fd, &st) == 0 && static_cast<std::size_t>(st.st_size) >= sizeof(ShmHeader)) {
+        void* map = ::mmap(nullptr, sizeof(ShmHeader), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        if (map != MAP_FAILED) {
+            auto* header = static_cast<ShmHeader*>(map);
+            if (header->magic.load(std::memory_order_acquire) == kShmMagic) {
+                header->stale.store(1, std::memory_order_release);
+            }
+            ::munmap(map, sizeof(ShmHeader));
+        }
+    }
+    ::close(fd);
+}
+
+// Returns the inode currently registered under `name`, or 0.
+std::uint64_t currentInode(const std::string& name) {
+    int fd = ::shm_open(name.c_str(), O_RDONLY, 0);
+    if (fd < 0) {
+        return 0;
+    }
+    struct stat st{};
+    std::uint64_t inode = ::fstat(fd, &st) == 0 ? static_cast<std::uint64_t>(st.st_ino) : 0;
+    ::close(fd);
+    return inode;
+}
+} // namespace
+
+ShmPublisher::ShmPublisher(std::string name, std::size_t max_disks, std::size_t max_nets) : name_(std::move(name)) {
+    validateName(name_);
+    if (max_disks == 0 || max_nets == 0 || max_disks > 65536 || max_nets > 65536) {
+        throw std::invalid_argument("ShmPublisher device limits must be between 1 and 65536.");
+    }
+    markExistingStale(name_);
+    ::shm_unlink(name_.c_str());
+
+    int fd = ::shm_open(name_.c_str(), O_CREAT | O_EXCL | O_RDWR, 0644);
+    if (fd < 0) {
+        throw std::runtime_error("ShmPublisher: cannot create " + name_ + ": " + std::strerror(errno));
+    }
+    const std::size_t word_count = kFixedWords + max_disks * kDiskWords + max_nets * kNetWords;
+    map_size_ = kWordsOffset + word_count * sizeof(std::uint64_t);
+    struct stat st{};
+    void* map = MAP_FAILED;
+    if (::ftruncate(fd, static_cast<off_t>(map_size_)) == 0 && ::fstat(fd, &st) == 0) {
+        map = ::mmap(nullptr, map_size_, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    }
+    std::string error = std::strerror(errno);
+    ::close(fd);
+    if (map == MAP_FAILED) {
+        ::shm_unlink(name_.c_str());
+        throw std::runtime_error("ShmPublisher: cannot map " + name_ + ": " + error);
+    }
+    inode_ = static_cast<std::uint64_t>(st.st_ino);
+
+    header_ = new (map) ShmHeader();
+    header_->version = kShmVersion;
+    header_->max_disks = static_cast<std::uint32_t>(max_disks);
+    header_->max_nets = static_cast<std::uint32_t>(max_nets);
+    header_->word_count = word_count;
+    header_->stale.store(0, std::memory_order_relaxed);
+    header_->publishes.store(0, std::memory_order_relaxed);
+    header_->sequence.store(0, std::memory_order_relaxed);
+    header_->magic.store(kShmMagic, std::memory_order_release);
+}
+
+ShmPublisher::~ShmPublisher() {
+    if (header_ == nullptr) {
+        return;
+    }
+    header_->stale.store(1, std::memory_order_release);
+    ::munmap(header_, map_size_);
+    if (currentInode(name_) == inode_) {
+        ::shm_unlink(name_.c_str()); // Only if a newer publisher has not replaced us
+    }
+}
+#else
+ShmPublisher::ShmPublisher(std::string name, std::size_t, std::size_t) : name_(std::move(name)) {
+    throw std::runtime_error("ShmPublisher is not supported on this platform.");
+}
+
+ShmPublisher::~ShmPublisher() = default;
+#endif
+
+void ShmPublisher::publish(const MetricsSnapshot& snapshot) {
+    std::atomic<std::uint64_t>* words = wordsOf(header_);
+    const std::size_t disks = snapshot.disks.size() < header_->max_disks ? snapshot.disks.size() : header_->max_disks;
+    const std::size_t nets = snapshot.nets.size() < header_->max_nets ? snapshot.nets.size() : header_->max_nets;
+
+    // Seqlock write side: odd sequence, release fence, relaxed data stores, even sequence (release).
+    const std::uint64_t sequence = header_->sequence.load(std::memory_order_relaxed);
+    header_->sequence.store(sequence + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    const auto& c = snapshot.cpu;
+    const double cpu[kCpuWords] = {c.user, c.nice, c.system, c.idle, c.iowait, c.irq,
+                                   c.softirq, c.steal, c.guest, c.guest_nice, c.usage_percent};
+    const auto& m = snapshot.mem;
+    const std::uint64_t mem[kMemWords] = {m.total, m.free, m.available, m.buffers, m.cached, m.swap_total, m.swap_free};
+
+    std::size_t w = 0;
+    words[w++].store(snapshot.timestamp_ms, std::memory_order_relaxed);
+    for (double value : cpu) {
+        words[w++].store(doubleBits(value), std::memory_order_relaxed);
+    }
+    for (std::uint64_t value : mem) {
+        words[w++].store(value, std::memory_order_relaxed);
+    }
+    words[w++].store(disks, std::memory_order_relaxed);
+    words[w++].store(nets, std::memory_order_relaxed);
+    for (std::size_t i = 0; i < disks; ++i) {
+        const auto& d = snapshot.disks[i];
+        storeName(words + w, d.device);
+        w += kNameWords;
+        words[w++].store(d.read_bytes, std::memory_order_relaxed);
+        words[w++].store(d.write_bytes, std::memory_order_relaxed);
+        words[w++].store(d.read_time_ms, std::memory_order_relaxed);
+        words[w++].store(d.write_time_ms, std::memory_order_relaxed);
+    }
+    w = kFixedWords + std::size_t(header_->max_disks) * kDiskWords;
+    for (std::size_t i = 0; i < nets; ++i) {
+        const auto& n = snapshot.nets[i];
+        storeName(words + w, n.interface_name);
+        w += kNameWords;
+        words[w++].store(n.bytes_received, std::memory_order_relaxed);
+        words[w++].store(n.bytes_sent, std::memory_order_relaxed);
+        words[w++].store(n.packets_received, std::memory_order_relaxed);
+        words[w++].store(n.packets_sent, std::memory_order_relaxed);
+        words[w++].store(n.errors_in, std::memory_order_relaxed);
+        words[w++].store(n.errors_out, std::memory_order_relaxed);
+        words[w++].store(n.drops_in, std::memory_order_relaxed);
+        words[w++].store(n.drops_out, std::memory_order_relaxed);
+    }
+
+    header_->sequence.store(sequence + 2, std::memory_order_release);
+    header_->publishes.fetch_add(1, std::memory_order_relaxed);
+}
+
+std::uint64_t ShmPublisher::publishCount() const {
+    return header_->publishes.load(std::memory_order_relaxed);
+}
+
+// --- Reader ---
+
+ShmReader::ShmReader(std::string name) : name_(std::move(name)) {
+    validateName(name_);
+    current_ = map();
+    header_.store(current_.header, std::memory_order_release);
+}
+
+ShmReader::~ShmReader() {
+    unmap(current_);
+    for (const Mapping& mapping : retired_) unmap(mapping);
+}
+
+#if defined(__unix__) || defined(__APPLE__)
+ShmReader::Mapping ShmReader::map() const {
+    int fd = ::shm_open(name_.c_str(), O_RDONLY, 0);
+    if (fd < 0) {
+        throw std::runtime_error("ShmReader: cannot open " + name_ + ": " + std::strerror(errno));
+    }
+    struct stat st{};
+    if (::fstat(fd, &st) != 0 || static_cast<std::size_t>(st.st_size) < kWordsOffset) {
+        ::close(fd);
+        throw std::runtime_error("ShmReader: " + name_ + " is not a snapshot region.");
+    }
+    const std::size_t size = static_cast<std::size_t>(st.st_size);
+    void* map = ::mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+    std::string error = std::strerror(errno);
+    ::close(fd);
+    if (map == MAP_FAILED) {
+        throw std::runtime_error("ShmReader: cannot map " + name_ + ": " + error);
+    }
+    const auto* header = static_cast<const ShmHeader*>(map);
+    if (header->magic.load(std::memory_order_acquire) != kShmMagic || header->version != kShmVersion ||
+        kWordsOffset + header->word_count * sizeof(std::uint64_t) > size ||
+        header->word_count != kFixedWords + std::uint64_t(header->max_disks) * kDiskWords +
+                                  std::uint64_t(header->max_nets) * kNetWords) {
+        ::munmap(map, size);
+        throw std::runtime_error("ShmReader: " + name_ + " is not a snapshot region (or is still being created).");
+    }
+    return Mapping{header, size};
+}
+
+void ShmReader::unmap(const Mapping& mapping) {
+    if (mapping.header != nullptr) {
+        ::munmap(const_cast<ShmHeader*>(mapping.header), mapping.size);
+    }
+}
+#else
+ShmReader::Mapping ShmReader::map() const {
+    throw std::runtime_error("ShmReader is not supported on this platform.");
+}
+
+void ShmReader::unmap(const Mapping&) {}
+#endif
+
+void ShmReader::reopen() {
+    std::lock_guard<std::mutex> lock(reopen_mutex_);
+    const Mapping mapping = map(); // Leaves the current mapping in place if it throws
+    // Other threads may still be reading through the old header, so it is only retired here.
+    retired_.push_back(current_);
+    current_ = mapping;
+    header_.store(mapping.header); // seq_cst, paired with ActiveRead: reads counted after the
+                                   // load below see the new header
+    if (active_reads_.load() == 0) {
+        for (const Mapping& retired : retired_) unmap(retired);
+        retired_.clear();
+    }
+}
+
+std::size_t ShmReader::retired() const {
+    std::lock_guard<std::mutex> lock(reopen_mutex_);
+    return retired_.size();
+}
+
+bool ShmReader::stale() const {
+    ActiveRead active(active_reads_);
+    return header_.load()->stale.load(std::memory_order_acquire) != 0;
+}
+
+std::uint64_t ShmReader::sequence() const {
+    ActiveRead active(active_reads_);
+    return header_.load()->sequence.load(std::memory_order_acquire);
+}
+
+bool ShmReader::readAttempt(const ShmHeader* header, MetricsSnapshot& out, std::uint64_t& sequence) {
+    // Seqlock read side: acquire the sequence, relaxed data loads, acquire fence, re-check.
+    const std::uint64_t before = header->sequence.load(std::memory_order_acquire);
+    if (before & 1) {
+        return false;
+    }
+    const std::atomic<std::uint64_t>* words = wordsOf(header);
+    std::size_t w = 0;
+    out.timestamp_ms = words[w++].load(std::memory_order_relaxed);
+    double cpu[kCpuWords];
+    for (double& value : cpu) {
+        value = bitsDouble(words[w++].load(std::memory_order_relaxed));
+    }
+    out.cpu = SystemCPUStats::CPUStats(cpu[0], cpu[1], cpu[2], cpu[3], cpu[4], cpu[5], cpu[6], cpu[7], cpu[8], cpu[9], cpu[10]);
+    std::uint64_t mem[kMemWords];
+    for (std::uint64_t& value : mem) {
+        value = words[w++].load(std::memory_order_relaxed);
+    }
+    out.mem = SystemMemoryStats::MemStats(mem[0], mem[1], mem[2], mem[3], mem[4], mem[5], mem[6]);
+
+    // Counts may be torn mid-write; clamp them so the copy stays inside the region.
+    std::uint64_t disks = words[w++].load(std::memory_order_relaxed);
+    std::uint64_t nets = words[w++].load(std::memory_order_relaxed);
+    disks = disks < header->max_disks ? disks : header->max_disks;
+    nets = nets < header->max_nets ? nets : header->max_nets;
+    out.disks.resize(static_cast<std::size_t>(disks));
+    out.nets.resize(static_cast<std::size_t>(nets));
+    for (auto& d : out.disks) {
+        loadName(words + w, d.device);
+        w += kNameWords;
+        d.read_bytes = words[w++].load(std::memory_order_relaxed);
+        d.write_bytes = words[w++].load(std::memory_order_relaxed);
+        d.read_time_ms = words[w++].load(std::memory_order_relaxed);
+        d.write_time_ms = words[w++].load(std::memory_order_relaxed);
+    }
+    w = kFixedWords + std::size_t(header->max_disks) * kDiskWords;
+    for (auto& n : out.nets) {
+        loadName(words + w, n.interface_name);
+        w += kNameWords;
+        n.bytes_received = words[w++].load(std::memory_order_relaxed);
+        n.bytes_sent = words[w++].load(std::memory_order_relaxed);
+        n.packets_received = words[w++].load(std::memory_order_relaxed);
+        n.packets_sent = words[w++].load(std::memory_order_relaxed);
+        n.errors_in = words[w++].load(std::memory_order_relaxed);
+        n.errors_out = words[w++].load(std::memory_order_relaxed);
+        n.drops_in = words[w++].load(std::memory_order_relaxed);
+        n.drops_out = words[w++].load(std::memory_order_relaxed);
+    }
+
+    std::atomic_thread_fence(std::memory_order_acquire);
+    sequence = before;
+    return header->sequence.load(std::memory_order_relaxed) == before;
+}
+
+bool ShmReader::read(MetricsSnapshot& out, unsigned max_attempts) const {
+    std::uint64_t ignored = 0;
+    return readIfChanged(out, ignored, max_attempts);
+}
+
+bool ShmReader::readIfChanged(MetricsSnapshot& out, std::uint64_t& last_sequence, unsigned max_attempts) const {
+    ActiveRead active(active_reads_);
+    const ShmHeader* header = header_.load(); // One region for the whole read
+    if (header->stale.load(std::memory_order_acquire) != 0) {
+        return false;
+    }
+    for (unsigned attempt = 0; attempt < max_attempts; ++attempt) {
+        const std::uint64_t current = header->sequence.load(std::memory_order_acquire);
+        if (current == 0 || (current == last_sequence && last_sequence != 0)) {
+            return false; // Nothing published (yet, or since last time)
+        }
+        std::uint64_t sequence = 0;
+        if (readAttempt(header, out, sequence)) {
+            last_sequence = sequence;
+            return true;
+        }
+    }
+    return false;
+}
+
+} // namespace SystemMetricsShm
@@ -0,0 +1,582 @@
+#include "simd_scan.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <charconv>
+#include <cstring>
+
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+    #define METRICS_AGENT_SIMD_X86 1
+    #include <immintrin.h>
+#endif
+
+namespace SystemProcFS {
+
+namespace { // Anonymous namespace for internal helpers
+
+std::atomic<int> g_active_level{-1}; // -1 until first use
+
+// Matches FieldScanner's notion of whitespace: ' ', '\t', '\n', '\v', '\f', '\r'.
+inline bool isSpace(char c) {
+    return c == ' ' || static_cast<unsigned char>(c - '\t') <= '\r' - '\t';
+}
+
+// Accumulates field boundaries one block at a time. `nonspace` has bit i set when byte
+// base + i is part of a field; edges between classes open and close fields.
+struct SplitState {
+    std::uint32_t* begin;
+    std::uint32_t* end;
+    std::size_t max_fields;
+    std::size_t count = 0;
+    bool in_field = false;
+
+    // Returns false once max_fields fields are complete and another one starts.
+    bool consume(std::uint64_t nonspace, std::uint64_t block_mask, std::size_t base) {
+        std::uint64_t edges = (nonspace ^ ((nonspace << 1) | (in_field ? 1u : 0u))) & block_mask;
+        while (edges != 0) {
+            const std::size_t pos = base + static_cast<std::size_t>(countTrailingZeros(edges));
+            edges &= edges - 1;
+            if (!in_field) {
+                if (count == max_fields) return false;
+                begin[count] = static_cast<std::uint32_t>(pos);
+            } else {
+                end[count++] = static_cast<std::uint32_t>(pos);
+            }
+            in_field = !in_field;
+        }
+        return true;
+    }
+
+    std::size_t finish(std::size_t line_size) {
+        if (in_field) end[count++] = static_cast<std::uint32_t>(line_size);
+        return count;
+    }
+
+    static int countTrailingZeros(std::uint64_t v) {
+#if defined(__GNUC__) || defined(__clang__)
+        return __builtin_ctzll(v);
+#else
+        int n = 0;
+        while ((v & 1) == 0) { v >>= 1; ++n; }
+        return n;
+#endif
+    }
+};
+
+// --- Scalar ---
+
+std::size_t findNewlineScalar(std::string_view text) {
+    const void* hit = std::memchr(text.data(), '\n', text.size());
+    return hit == nullptr ? std::string_view::npos : static_cast<const char*>(hit) - text.data();
+}
+
+std::size_t splitScalar(std::string_view line, std::uint32_t* begin, std::uint32_t* end, std::size_t max_fields) {
+    std::size_t count = 0;
+    std::size_t i = 0;
+    const std::size_t n = line.size();
+    while (true) {
+        while (i < n && isSpace(line[i])) ++i;
+        if (i == n || count == max_fields) break;
+        begin[count] = static_cast<std::uint32_t>(i);
+        while (i < n && !isSpace(line[i])) ++i;
+        end[count++] = static_cast<std::uint32_t>(i);
+    }
+    return count;
+}
+
+bool parseDecimalScalar(std::string_view digits, std::uint64_t& value) {
+    if (digits.empty()) return false;
+    std::uint64_t result = 0;
+    const auto parsed = std::from_chars(digits.data(), digits.data() + digits.size(), result);
+    if (parsed.ec != std::errc() || parsed.ptr != digits.data() + digits.size()) return false;
+    value = result;
+    return true;
+}
+
+inline bool isBlank(char c) { return c == ' ' || c == '\t'; }
+
+inline bool isDigit(char c) { return static_cast<unsigned char>(c - '0') <= 9; }
+
+// Parses one number at `p` (which must point at a digit) if it is followed by a blank or the end
+// and fits 64 bits. Returns the end of the number, or nullptr.
+inline const char* parseRunNumberScalar(const char* p, const char* end, std::uint64_t& value) {
+    const char* const digits = p;
+    std::uint64_t result = 0;
+    do {
+        result = result * 10 + static_cast<unsigned char>(*p - '0');
+        ++p;
+    } while (p != end && isDigit(*p));
+    if (p != end && !isBlank(*p)) return nullptr;
+    if (p - digits > 19) { // May have overflowed; let from_chars decide
+        return parseDecimalScalar(std::string_view(digits, static_cast<std::size_t>(p - digits)), value) ? p : nullptr;
+    }
+    value = result;
+    return p;
+}
+
+std::size_t parseUnsignedRunScalar(std::string_view text, std::uint64_t* values, std::size_t max_values,
+                                   std::size_t& consumed) {
+    const char* p = text.data();
+    const char* const end = p + text.size();
+    std::size_t count = 0;
+    while (count < max_values) {
+        const char* q = p;
+        while (q != end && isBlank(*q)) ++q;
+        if (q == end || !isDigit(*q)) break;
+        q = parseRunNumberScalar(q, end, values[count]);
+        if (q == nullptr) break;
+        ++count;
+        p = q;
+    }
+    consumed = static_cast<std::size_t>(p - text.data());
+    return count;
+}
+
+// One fixed-width column: blanks, then at least one digit running to the end of the column.
+bool parseColumnScalar(const char* column, std::size_t width, std::uint64_t& value) {
+    std::size_t i = 0;
+    while (i < width && column[i] == ' ') ++i;
+    if (i == width) return false;
+    return parseDecimalScalar(std::string_view(column + i, width - i), value);
+}
+
+bool parseFixedWidthColumnsScalar(std::string_view text, std::size_t width, std::uint64_t* values, std::size_t count) {
+    for (std::size_t i = 0; i < count; ++i) {
+        if (!parseColumnScalar(text.data() + i * width, width, values[i])) return false;
+    }
+    return true;
+}
+
+// One eight-digit hexadecimal column, a character at a time.
+bool parseHexColumnScalar(const char* column, std::uint64_t& value) {
+    std::uint64_t result = 0;
+    for (std::size_t i = 0; i < 8; ++i) {
+        const char c = column[i];
+        unsigned digit;
+        if (c >= '0' && c <= '9') digit = static_cast<unsigned>(c - '0');
+        else if ((c | 0x20) >= 'a' && (c | 0x20) <= 'f') digit = static_cast<unsigned>((c | 0x20) - 'a' + 10);
+        else return false;
+        result = (result << 4) | digit;
+    }
+    value = result;
+    return true;
+}
+
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__ && (defined(__GNUC__) || defined(__clang__))
+    #define METRICS_AGENT_SWAR_HEX
+// One eight-digit hexadecimal column as a single 64-bit word (SWAR): every byte is classified and
+// converted to its nibble in parallel, then the nibbles are packed pairwise. Byte k of the word is
+// character k, so the first character ends up in the top nibble.
+bool parseHexColumnSWAR(const char* column, std::uint64_t& value) {
+    constexpr std::uint64_t kOnes = 0x0101010101010101ULL;
+    constexpr std::uint64_t kHigh = 0x8080808080808080ULL;
+    std::uint64_t word;
+    std::memcpy(&word, column, 8);
+    if (word & kHigh) return false;
+    // For bytes below 0x80, x + (0x80 - k) sets the byte's top bit exactly when x >= k, without
+    // carrying into the next byte.
+    const auto atLeast = [&](std::uint64_t x, unsigned k) { return (x + (0x80 - k) * kOnes) & kHigh; };
+    const std::uint64_t lower = word | (0x20 * kOnes);
+    const std::uint64_t digit = atLeast(word, '0') & ~atLeast(word, '9' + 1);
+    const std::uint64_t letter = atLeast(lower, 'a') & ~atLeast(lower, 'f' + 1);
+    if ((digit | letter) != kHigh) return false;
+
+    std::uint64_t nibbles = (word & (0x0F * kOnes)) + (letter >> 7) * 9;
+    nibbles = ((nibbles & 0x000F000F000F000FULL) << 4) | ((nibbles >> 8) & 0x000F000F000F000FULL);
+    nibbles = (nibbles | (nibbles >> 8)) & 0x0000FFFF0000FFFFULL;
+    nibbles = (nibbles | (nibbles >> 16)) & 0x00000000FFFFFFFFULL;
+    value = __builtin_bswap32(static_cast<std::uint32_t>(nibbles));
+    return true;
+}
+#endif
+
+inline std::uint64_t counterDeltaScalar(std::uint64_t previous, std::uint64_t current) {
+    constexpr std::uint64_t kWrap32 = 1ULL << 32;
+    if (current >= previous) return current - previous;
+    if (previous < kWrap32 && previous >= kWrap32 / 2 && current < kWrap32 / 2) return kWrap32 - previous + current;
+    return 0;
+}
+
+void subtractCountersScalar(const std::uint64_t* previous, const std::uint64_t* current, std::uint64_t* delta,
+                            std::size_t count) {
+    for (std::size_t i = 0; i < count; ++i) delta[i] = counterDeltaScalar(previous[i], current[i]);
+}
+
+#if defined(METRICS_AGENT_SIMD_X86)
+
+// Keeps the last `len` bytes of a 16-byte vector when loaded from kTailMask + len.
+alignas(16) const unsigned char kTailMask[32] = {
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF};
+
+// --- SSE4.2 ---
+
+__attribute__((target("sse4.2"))) inline unsigned spaceMask16(__m128i v) {
+    const __m128i space = _mm_cmpeq_epi8(v, _mm_set1_epi8(' '));
+    const __m128i shifted = _mm_sub_epi8(v, _mm_set1_epi8('\t'));
+    const __m128i control = _mm_cmpeq_epi8(_mm_min_epu8(shifted, _mm_set1_epi8('\r' - '\t')), shifted);
+    return static_cast<unsigned>(_mm_movemask_epi8(_mm_or_si128(space, control)));
+}
+
+__attribute__((target("sse4.2"))) std::size_t findNewlineSSE42(std::string_view text) {
+    const char* p = text.data();
+    const std::size_t n = text.size();
+    const __m128i newline = _mm_set1_epi8('\n');
+    std::size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        const unsigned mask = static_cast<unsigned>(
+            _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p + i)), newline)));
+        if (mask != 0) return i + static_cast<std::size_t>(__builtin_ctz(mask));
+    }
+    const std::size_t tail = findNewlineScalar(text.substr(i));
+    return tail == std::string_view::npos ? tail : i + tail;
+}
+
+__attribute__((target("sse4.2"))) std::size_t splitSSE42(std::string_view line, std::uint32_t* begin,
+                                                         std::uint32_t* end, std::size_t max_fields) {
+    SplitState state{begin, end, max_fields};
+    const char* p = line.data();
+    const std::size_t n = line.size();
+    for (std::size_t base = 0; base < n; base += 16) {
+        __m128i block;
+        if (base + 16 <= n) {
+            block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + base));
+        } else {
+            char padded[16];
+            std::memset(padded, ' ', sizeof(padded));
+            std::memcpy(padded, p + base, n - base);
+            block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(padded));
+        }
+        if (!state.consume(~spaceMask16(block) & 0xFFFFu, 0xFFFFu, base)) return state.count;
+    }
+    return state.finish(n);
+}
+
+// Converts up to 16 right-aligned ASCII digits (the rest of the vector masked to '0') in three
+// multiply-add steps: pairs, groups of four, groups of eight.
+__attribute__((target("sse4.2"))) inline bool digitsToUint(__m128i chunk, std::size_t len, std::uint64_t& value) {
+    const __m128i keep = _mm_loadu_si128(reinterpret_cast<const __m128i*>(kTailMask + len));
+    const __m128i digits = _mm_and_si128(_mm_sub_epi8(chunk, _mm_set1_epi8('0')), keep);
+    const __m128i nine = _mm_set1_epi8(9);
+    if (_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_max_epu8(digits, nine), nine)) != 0xFFFF) return false;
+
+    const __m128i pairs = _mm_maddubs_epi16(digits, _mm_setr_epi8(10, 1, 10, 1, 10, 1, 10, 1, 10, 1, 10, 1, 10, 1, 10, 1));
+    const __m128i quads = _mm_madd_epi16(pairs, _mm_setr_epi16(100, 1, 100, 1, 100, 1, 100, 1));
+    const __m128i packed = _mm_packus_epi32(quads, quads);
+    const __m128i octets = _mm_madd_epi16(packed, _mm_setr_epi16(10000, 1, 10000, 1, 10000, 1, 10000, 1));
+    const std::uint64_t high = static_cast<std::uint32_t>(_mm_cvtsi128_si32(octets));
+    const std::uint64_t low = static_cast<std::uint32_t>(_mm_extract_epi32(octets, 1));
+    value = high * 100000000ULL + low;
+    return true;
+}
+
+// `readable_begin` bounds how far before the field a 16-byte load may start.
+__attribute__((target("sse4.2"))) bool parseDecimalSSE42(std::string_view digits, const char* readable_begin,
+                                                         std::uint64_t& value) {
+    const std::size_t len = digits.size();
+    if (len == 0 || len > 16) return parseDecimalScalar(digits, value);
+    const char* field_end = digits.data() + len;
+    if (field_end - readable_begin >= 16) {
+        return digitsToUint(_mm_loadu_si128(reinterpret_cast<const __m128i*>(field_end - 16)), len, value);
+    }
+    char padded[16];
+    std::memset(padded, '0', sizeof(padded));
+    std::memcpy(padded + 16 - len, digits.data(), len);
+    return digitsToUint(_mm_loadu_si128(reinterpret_cast<const __m128i*>(padded)), len, value);
+}
+
+// Each number costs two 16-byte loads: one finds the end of the blanks before it, the other
+// its digit run, which is then shifted to the top of the vector for digitsToUint. Numbers
+// within 16 bytes of the end of `text` fall back to the scalar loop, so nothing past the end
+// is ever read.
+__attribute__((target("sse4.2"))) std::size_t parseUnsignedRunSSE42(std::string_view text, std::uint64_t* values,
+                                                                    std::size_t max_values, std::size_t& consumed) {
+    const char* p = text.data();
+    const char* const end = p + text.size();
+    const __m128i space = _mm_set1_epi8(' ');
+    const __m128i tab = _mm_set1_epi8('\t');
+    const __m128i zero = _mm_set1_epi8('0');
+    const __m128i nine = _mm_set1_epi8(9);
+    const __m128i iota = _mm_setr_epi8(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15);
+    std::size_t count = 0;
+    while (count < max_values) {
+        const char* q = p;
+        while (end - q >= 16) {
+            const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(q));
+            const unsigned blank = static_cast<unsigned>(
+                _mm_movemask_epi8(_mm_or_si128(_mm_cmpeq_epi8(v, space), _mm_cmpeq_epi8(v, tab))));
+            if (blank != 0xFFFFu) {
+                q += __builtin_ctz(~blank);
+                break;
+            }
+            q += 16;
+        }
+        while (q != end && isBlank(*q)) ++q;
+        if (q == end || !isDigit(*q)) break;
+
+        if (end - q < 16) {
+            q = parseRunNumberScalar(q, end, values[count]);
+        } else {
+            const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(q));
+            const __m128i digits = _mm_sub_epi8(v, zero);
+            const unsigned digit_mask = static_cast<unsigned>(_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_max_epu8(digits, nine), nine)));
+            const unsigned len = static_cast<unsigned>(__builtin_ctz(~digit_mask)); // 16 if every byte is a digit
+            if (len == 16) {
+                q = parseRunNumberScalar(q, end, values[count]);
+            } else if (!isBlank(q[len])) {
+                q = nullptr;
+            } else {
+                // pshufb zeroes lanes whose index is negative, so this moves byte i to lane i + 16 - len.
+                const __m128i shift = _mm_add_epi8(iota, _mm_set1_epi8(static_cast<char>(static_cast<int>(len) - 16)));
+                digitsToUint(_mm_shuffle_epi8(v, shift), len, values[count]);
+                q += len;
+            }
+        }
+        if (q == nullptr) break;
+        ++count;
+        p = q;
+    }
+    consumed = static_cast<std::size_t>(p - text.data());
+    return count;
+}
+
+// Column positions are known up front, so unlike parseUnsignedRunSSE42 there is no chain of
+// dependent loads: every column is loaded, shifted to the top of the vector, has its blanks
+// turned into leading zeros and is converted.
+__attribute__((target("sse4.2"))) bool parseFixedWidthColumnsSSE42(std::string_view text, std::size_t width,
+                                                                  std::uint64_t* values, std::size_t count) {
+    if (width == 0 || width > 16) return parseFixedWidthColumnsScalar(text, width, values, count);
+    const __m128i shift = _mm_add_epi8(_mm_setr_epi8(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15),
+                                       _mm_set1_epi8(static_cast<char>(static_cast<int>(width) - 16)));
+    const __m128i space = _mm_set1_epi8(' ');
+    const __m128i to_digit = _mm_set1_epi8('0' - ' ');
+    const unsigned keep = (0xFFFFu << (16 - width)) & 0xFFFFu;
+    // The last columns are parsed one by one so no load runs past the end of `text`.
+    const std::size_t vector_columns = text.size() >= 16 ? (std::min)(count, (text.size() - 16) / width + 1) : 0;
+    const char* p = text.data();
+    std::size_t i = 0;
+    for (; i < vector_columns; ++i, p += width) {
+        const __m128i column = _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p)), shift);
+        const __m128i blanks = _mm_cmpeq_epi8(column, space);
+        const unsigned leading = (static_cast<unsigned>(_mm_movemask_epi8(blanks)) & keep) >> (16 - width);
+        // Blanks must all precede the digits, and digitsToUint rejects anything else that is not a digit.
+        if (leading == (keep >> (16 - width)) || (leading & (leading + 1)) != 0) return false;
+        if (!digitsToUint(_mm_add_epi8(column, _mm_and_si128(blanks, to_digit)), width, values[i])) return false;
+    }
+    for (; i < count; ++i, p += width) {
+        if (!parseColumnScalar(p, width, values[i])) return false;
+    }
+    return true;
+}
+
+// Branch-free counterDeltaScalar: plain difference, plus 2^32 where a 32-bit counter wrapped,
+// zeroed where it went backwards otherwise. Unsigned compares flip the sign bit first.
+__attribute__((target("sse4.2"))) void subtractCountersSSE42(const std::uint64_t* previous, const std::uint64_t* current,
+                                                            std::uint64_t* delta, std::size_t count) {
+    const __m128i sign = _mm_set1_epi64x(static_cast<long long>(1ULL << 63));
+    const __m128i wrap = _mm_set1_epi64x(1LL << 32);
+    const __m128i one = _mm_set1_epi64x(1);
+    std::size_t i = 0;
+    for (; i + 2 <= count; i += 2) {
+        const __m128i prev = _mm_loadu_si128(reinterpret_cast<const __m128i*>(previous + i));
+        const __m128i curr = _mm_loadu_si128(reinterpret_cast<const __m128i*>(current + i));
+        const __m128i backwards = _mm_cmpgt_epi64(_mm_xor_si128(prev, sign), _mm_xor_si128(curr, sign));
+        const __m128i wrapped = _mm_and_si128(_mm_and_si128(backwards, _mm_cmpeq_epi64(_mm_srli_epi64(prev, 31), one)),
+                                              _mm_cmpeq_epi64(_mm_srli_epi64(curr, 31), _mm_setzero_si128()));
+        const __m128i diff = _mm_add_epi64(_mm_sub_epi64(curr, prev), _mm_and_si128(wrapped, wrap));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(delta + i), _mm_andnot_si128(_mm_andnot_si128(wrapped, backwards), diff));
+    }
+    subtractCountersScalar(previous + i, current + i, delta + i, count - i);
+}
+
+// --- AVX2 ---
+
+__attribute__((target("avx2"))) inline std::uint32_t spaceMask32(__m256i v) {
+    const __m256i space = _mm256_cmpeq_epi8(v, _mm256_set1_epi8(' '));
+    const __m256i shifted = _mm256_sub_epi8(v, _mm256_set1_epi8('\t'));
+    const __m256i control = _mm256_cmpeq_epi8(_mm256_min_epu8(shifted, _mm256_set1_epi8('\r' - '\t')), shifted);
+    return static_cast<std::uint32_t>(_mm256_movemask_epi8(_mm256_or_si256(space, control)));
+}
+
+__attribute__((target("avx2"))) std::size_t findNewlineAVX2(std::string_view text) {
+    const char* p = text.data();
+    const std::size_t n = text.size();
+    const __m256i newline = _mm256_set1_epi8('\n');
+    std::size_t i = 0;
+    for (; i + 32 <= n; i += 32) {
+        const std::uint32_t mask = static_cast<std::uint32_t>(_mm256_movemask_epi8(
+            _mm256_cmpeq_epi8(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + i)), newline)));
+        if (mask != 0) return i + static_cast<std::size_t>(__builtin_ctz(mask));
+    }
+    const std::size_t tail = findNewlineSSE42(text.substr(i));
+    return tail == std::string_view::npos ? tail : i + tail;
+}
+
+__attribute__((target("avx2"))) std::size_t splitAVX2(std::string_view line, std::uint32_t* begin,
+                                                      std::uint32_t* end, std::size_t max_fields) {
+    SplitState state{begin, end, max_fields};
+    const char* p = line.data();
+    const std::size_t n = line.size();
+    for (std::size_t base = 0; base < n; base += 32) {
+        __m256i block;
+        if (base + 32 <= n) {
+            block = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + base));
+        } else {
+            char padded[32];
+            std::memset(padded, ' ', sizeof(padded));
+            std::memcpy(padded, p + base, n - base);
+            block = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(padded));
+        }
+        if (!state.consume(~std::uint64_t(spaceMask32(block)) & 0xFFFFFFFFu, 0xFFFFFFFFu, base)) return state.count;
+    }
+    return state.finish(n);
+}
+
+__attribute__((target("avx2"))) void subtractCountersAVX2(const std::uint64_t* previous, const std::uint64_t* current,
+                                                          std::uint64_t* delta, std::size_t count) {
+    const __m256i sign = _mm256_set1_epi64x(static_cast<long long>(1ULL << 63));
+    const __m256i wrap = _mm256_set1_epi64x(1LL << 32);
+    const __m256i one = _mm256_set1_epi64x(1);
+    std::size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        const __m256i prev = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(previous + i));
+        const __m256i curr = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(current + i));
+        const __m256i backwards = _mm256_cmpgt_epi64(_mm256_xor_si256(prev, sign), _mm256_xor_si256(curr, sign));
+        const __m256i wrapped = _mm256_and_si256(
+            _mm256_and_si256(backwards, _mm256_cmpeq_epi64(_mm256_srli_epi64(prev, 31), one)),
+            _mm256_cmpeq_epi64(_mm256_srli_epi64(curr, 31), _mm256_setzero_si256()));
+        const __m256i diff = _mm256_add_epi64(_mm256_sub_epi64(curr, prev), _mm256_and_si256(wrapped, wrap));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(delta + i),
+                            _mm256_andnot_si256(_mm256_andnot_si256(wrapped, backwards), diff));
+    }
+    subtractCountersSSE42(previous + i, current + i, delta + i, count - i);
+}
+
+#endif // METRICS_AGENT_SIMD_X86
+
+} // namespace
+
+ScanLevel detectedScanLevel() {
+#if defined(METRICS_AGENT_SIMD_X86)
+    static const ScanLevel detected = [] {
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("avx2")) return ScanLevel::AVX2;
+        if (__builtin_cpu_supports("sse4.2")) return ScanLevel::SSE42;
+        return ScanLevel::Scalar;
+    }();
+    return detected;
+#else
+    return ScanLevel::Scalar;
+#endif
+}
+
+ScanLevel activeScanLevel() {
+    const int level = g_active_level.load(std::memory_order_relaxed);
+    if (level >= 0) return static_cast<ScanLevel>(level);
+    const ScanLevel detected = detectedScanLevel();
+    g_active_level.store(static_cast<int>(detected), std::memory_order_relaxed);
+    return detected;
+}
+
+ScanLevel setScanLevel(ScanLevel level) {
+    const ScanLevel selected = static_cast<int>(level) > static_cast<int>(detectedScanLevel()) ? detectedScanLevel() : level;
+    g_active_level.store(static_cast<int>(selected), std::memory_order_relaxed);
+    return selected;
+}
+
+const char* scanLevelName(ScanLevel level) {
+    switch (level) {
+        case ScanLevel::Scalar: return "scalar";
+        case ScanLevel::SSE42: return "sse4.2";
+        case ScanLevel::AVX2: return "avx2";
+    }
+    return "unknown";
+}
+
+std::size_t findNewline(std::string_view text) {
+#if defined(METRICS_AGENT_SIMD_X86)
+    switch (activeScanLevel()) {
+        case ScanLevel::AVX2: return findNewlineAVX2(text);
+        case ScanLevel::SSE42: return findNewlineSSE42(text);
+        case ScanLevel::Scalar: break;
+    }
+#endif
+    return findNewlineScalar(text);
+}
+
+bool parseDecimal(std::string_view digits, std::uint64_t& value) {
+#if defined(METRICS_AGENT_SIMD_X86)
+    if (activeScanLevel() != ScanLevel::Scalar) return parseDecimalSSE42(digits, digits.data(), value);
+#endif
+    return parseDecimalScalar(digits, value);
+}
+
+std::size_t parseUnsignedRun(std::string_view text, std::uint64_t* values, std::size_t max_values,
+                             std::size_t& consumed) {
+#if defined(METRICS_AGENT_SIMD_X86)
+    if (activeScanLevel() != ScanLevel::Scalar) return parseUnsignedRunSSE42(text, values, max_values, consumed);
+#endif
+    return parseUnsignedRunScalar(text, values, max_values, consumed);
+}
+
+bool parseFixedWidthColumns(std::string_view text, std::size_t width, std::uint64_t* values, std::size_t count) {
+    if (width == 0 || text.size() / width < count) return false;
+#if defined(METRICS_AGENT_SIMD_X86)
+    if (activeScanLevel() != ScanLevel::Scalar) return parseFixedWidthColumnsSSE42(text, width, values, count);
+#endif
+    return parseFixedWidthColumnsScalar(text, width, values, count);
+}
+
+bool parseFixedWidthHex(std::string_view text, std::size_t width, std::uint64_t* values, std::size_t count) {
+    if (count == 0) return true;
+    if (width < 8 || text.size() < 8 || (text.size() - 8) / width < count - 1) return false;
+#if defined(METRICS_AGENT_SWAR_HEX)
+    if (activeScanLevel() != ScanLevel::Scalar) {
+        for (std::size_t i = 0; i < count; ++i) {
+            if (!parseHexColumnSWAR(text.data() + i * width, values[i])) return false;
+        }
+        return true;
+    }
+#endif
+    for (std::size_t i = 0; i < count; ++i) {
+        if (!parseHexColumnScalar(text.data() + i * width, values[i])) return false;
+    }
+    return true;
+}
+
+void subtractCounters(const std::uint64_t* previous, const std::uint64_t* current, std::uint64_t* delta,
+                      std::size_t count) {
+#if defined(METRICS_AGENT_SIMD_X86)
+    switch (activeScanLevel()) {
+        case ScanLevel::AVX2: subtractCountersAVX2(previous, current, delta, count); return;
+        case ScanLevel::SSE42: subtractCountersSSE42(previous, current, delta, count); return;
+        case ScanLevel::Scalar: break;
+    }
+#endif
+    subtractCountersScalar(previous, current, delta, count);
+}
+
+// --- LineFields ---
+
+LineFields::LineFields(std::string_view line) : line_(line) {
+#if defined(METRICS_AGENT_SIMD_X86)
+    switch (activeScanLevel()) {
+        case ScanLevel::AVX2: count_ = splitAVX2(line, begin_, end_, kMaxFields); return;
+        case ScanLevel::SSE42: count_ = splitSSE42(line, begin_, end_, kMaxFields); return;
+        case ScanLevel::Scalar: break;
+    }
+#endif
+    count_ = splitScalar(line, begin_, end_, kMaxFields);
+}
+
+bool LineFields::unsignedAt(std::size_t index, std::uint64_t& value) const {
+    if (index >= count_) return false;
+    const std::string_view field = (*this)[index];
+#if defined(METRICS_AGENT_SIMD_X86)
+    // The whole line is readable, so short fields can be loaded in place rather than copied.
+    if (activeScanLevel() != ScanLevel::Scalar) return parseDecimalSSE42(field, line_.data(), value);
+#endif
+    return parseDecimalScalar(field, value);
+}
+
+} // namespace SystemProcFS
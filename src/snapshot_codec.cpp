@@ -0,0 +1,338 @@
+#include "snapshot_codec.hpp"
+
+#include <cmath>      // For std::llround
+#include <stdexcept>
+
+namespace SystemMetricsCodec {
+
+using SystemMetricsSnapshot::MetricsSnapshot;
+
+namespace { // Anonymous namespace for internal helpers
+constexpr std::uint8_t kMagic0 = 'M';
+constexpr std::uint8_t kMagic1 = 'S';
+constexpr std::uint8_t kFlagKeyframe = 0x01;
+constexpr std::size_t kFixedCounters = 17; // 10 CPU + 7 memory
+constexpr std::size_t kDiskCounters = 4;
+constexpr std::size_t kNetCounters = 8;
+
+void putVarint(std::vector<std::uint8_t>& out, std::uint64_t value) {
+    while (value >= 0x80) {
+        out.push_back(static_cast<std::uint8_t>(value | 0x80));
+        value >>= 7;
+    }
+    out.push_back(static_cast<std::uint8_t>(value));
+}
+
+// Zigzag-encodes the wrapping difference so that small negative deltas stay small.
+std::uint64_t zigzagDelta(std::uint64_t current, std::uint64_t previous) {
+    std::int64_t delta = static_cast<std::int64_t>(current - previous);
+    return (static_cast<std::uint64_t>(delta) << 1) ^ static_cast<std::uint64_t>(delta >> 63);
+}
+
+std::uint64_t applyZigzagDelta(std::uint64_t previous, std::uint64_t encoded) {
+    std::uint64_t delta = (encoded >> 1) ^ (~(encoded & 1) + 1);
+    return previous + delta;
+}
+
+std::uint64_t toTicks(double value) {
+    return value <= 0.0 ? 0 : static_cast<std::uint64_t>(std::llround(value));
+}
+
+// Bounds-checked cursor over the caller's buffer.
+class Reader {
+public:
+    explicit Reader(ByteSpan span) : begin_(span.data), pos_(span.data), end_(span.data + span.size) {}
+
+    std::uint8_t byte() {
+        if (pos_ == end_) {
+            throw std::runtime_error("Snapshot frame is truncated.");
+        }
+        return *pos_++;
+    }
+
+    std::uint64_t varint() {
+        std::uint64_t value = 0;
+        for (unsigned shift = 0; shift < 64; shift += 7) {
+            std::uint8_t b = byte();
+            value |= static_cast<std::uint64_t>(b & 0x7F) << shift;
+            if ((b & 0x80) == 0) {
+                return value;
+            }
+        }
+        throw std::runtime_error("Snapshot frame contains an overlong varint.");
+    }
+
+    // Reads a count and rejects values that could not possibly fit in the remaining bytes.
+    std::size_t count(std::size_t min_bytes_per_item) {
+        std::uint64_t n = varint();
+        if (n > remaining() / min_bytes_per_item) {
+            throw std::runtime_error("Snapshot frame declares more entries than it contains.");
+        }
+        return static_cast<std::size_t>(n);
+    }
+
+    std::string_view bytes(std::size_t n) {
+        if (n > remaining()) {
+            throw std::runtime_error("Snapshot frame is truncated.");
+        }
+        std::string_view view(reinterpret_cast<const char*>(pos_), n);
+        pos_ += n;
+        return view;
+    }
+
+    std::size_t remaining() const { return static_cast<std::size_t>(end_ - pos_); }
+    std::size_t consumed() const { return static_cast<std::size_t>(pos_ - begin_); }
+
+private:
+    const std::uint8_t* begin_;
+    const std::uint8_t* pos_;
+    const std::uint8_t* end_;
+};
+
+void fixedCounters(const MetricsSnapshot& s, std::uint64_t (&values)[kFixedCounters]) {
+    const double cpu[10] = {s.cpu.user, s.cpu.nice, s.cpu.system, s.cpu.idle, s.cpu.iowait,
+                            s.cpu.irq, s.cpu.softirq, s.cpu.steal, s.cpu.guest, s.cpu.guest_nice};
+    for (std::size_t i = 0; i < 10; ++i) {
+        values[i] = toTicks(cpu[i]);
+    }
+    values[10] = s.mem.total;
+    values[11] = s.mem.free;
+    values[12] = s.mem.available;
+    values[13] = s.mem.buffers;
+    values[14] = s.mem.cached;
+    values[15] = s.mem.swap_total;
+    values[16] = s.mem.swap_free;
+}
+
+void storeFixedCounters(const std::uint64_t (&values)[kFixedCounters], MetricsSnapshot& s) {
+    s.cpu = SystemCPUStats::CPUStats(
+        static_cast<double>(values[0]), static_cast<double>(values[1]), static_cast<double>(values[2]),
+        static_cast<double>(values[3]), static_cast<double>(values[4]), static_cast<double>(values[5]),
+        static_cast<double>(values[6]), static_cast<double>(values[7]), static_cast<double>(values[8]),
+        static_cast<double>(values[9]));
+    s.mem = SystemMemoryStats::MemStats(values[10], values[11], values[12], values[13],
+                                        values[14], values[15], values[16]);
+}
+
+void diskCounters(const SystemDiskStats::DiskStats& d, std::uint64_t* values) {
+    values[0] = d.read_bytes;
+    values[1] = d.write_bytes;
+    values[2] = d.read_time_ms;
+    values[3] = d.write_time_ms;
+}
+
+void netCounters(const SystemNetStats::NetStats& n, std::uint64_t* values) {
+    values[0] = n.bytes_received;
+    values[1] = n.bytes_sent;
+    values[2] = n.packets_received;
+    values[3] = n.packets_sent;
+    values[4] = n.errors_in;
+    values[5] = n.errors_out;
+    values[6] = n.drops_in;
+    values[7] = n.drops_out;
+}
+} // anonymous namespace
+
+FrameHeader peekFrameHeader(ByteSpan frame) {
+    if (frame.size < 4 || frame.data[0] != kMagic0 || frame.data[1] != kMagic1) {
+        throw std::runtime_error("Buffer does not start with a snapshot frame.");
+    }
+    return FrameHeader{frame.data[2], (frame.data[3] & kFlagKeyframe) != 0};
+}
+
+// --- SnapshotEncoder ---
+
+SnapshotEncoder::SnapshotEncoder(std::size_t keyframe_interval) : keyframe_interval_(keyframe_interval) {
+    if (keyframe_interval_ == 0) {
+        throw std::invalid_argument("Keyframe interval must be at least 1.");
+    }
+}
+
+void SnapshotEncoder::reset() {
+    have_previous_ = false;
+    frames_since_key_ = 0;
+    name_ids_.clear();
+    disk_bases_.clear();
+    net_bases_.clear();
+}
+
+std::uint32_t SnapshotEncoder::internName(const std::string& name, std::vector<const std::string*>& new_names) {
+    auto it = name_ids_.find(name);
+    if (it != name_ids_.end()) {
+        return it->second;
+    }
+    std::uint32_t id = static_cast<std::uint32_t>(name_ids_.size());
+    name_ids_.emplace(name, id);
+    new_names.push_back(&name);
+    return id;
+}
+
+std::size_t SnapshotEncoder::encode(const MetricsSnapshot& snapshot, std::vector<std::uint8_t>& out, bool force_keyframe) {
+    const std::size_t start = out.size();
+    const bool keyframe = force_keyframe || !have_previous_ || frames_since_key_ >= keyframe_interval_;
+    if (keyframe) {
+        name_ids_.clear();
+        disk_bases_.clear();
+        net_bases_.clear();
+        frames_since_key_ = 1;
+    } else {
+        ++frames_since_key_;
+    }
+
+    out.push_back(kMagic0);
+    out.push_back(kMagic1);
+    out.push_back(kFormatVersion);
+    out.push_back(keyframe ? kFlagKeyframe : 0);
+
+    putVarint(out, keyframe ? snapshot.timestamp_ms : zigzagDelta(snapshot.timestamp_ms, prev_timestamp_));
+    std::uint64_t fixed[kFixedCounters];
+    fixedCounters(snapshot, fixed);
+    for (std::size_t i = 0; i < kFixedCounters; ++i) {
+        putVarint(out, keyframe ? fixed[i] : zigzagDelta(fixed[i], prev_fixed_[i]));
+        prev_fixed_[i] = fixed[i];
+    }
+    prev_timestamp_ = snapshot.timestamp_ms;
+
+    // Intern names first so that the frame can define new ones before they are referenced.
+    std::vector<const std::string*> new_names;
+    scratch_ids_.clear();
+    for (const auto& disk : snapshot.disks) {
+        scratch_ids_.push_back(internName(disk.device, new_names));
+    }
+    for (const auto& net : snapshot.nets) {
+        scratch_ids_.push_back(internName(net.interface_name, new_names));
+    }
+    putVarint(out, new_names.size());
+    for (const std::string* name : new_names) {
+        putVarint(out, name->size());
+        out.insert(out.end(), name->begin(), name->end());
+    }
+
+    auto writeDevices = [&](std::vector<DeviceBase>& bases, std::size_t count, std::size_t id_offset,
+                            std::size_t counters, auto&& extract, const auto& devices) {
+        putVarint(out, count);
+        for (std::size_t i = 0; i < count; ++i) {
+            std::uint32_t id = scratch_ids_[id_offset + i];
+            if (bases.size() <= id) {
+                bases.resize(id + 1, DeviceBase{{}, ~0ULL});
+            }
+            DeviceBase& base = bases[id];
+            const bool has_base = !keyframe && base.frame + 1 == frame_index_;
+            putVarint(out, (static_cast<std::uint64_t>(id) << 1) | (has_base ? 1 : 0));
+            std::uint64_t values[8];
+            extract(devices[i], values);
+            for (std::size_t c = 0; c < counters; ++c) {
+                putVarint(out, has_base ? zigzagDelta(values[c], base.values[c]) : values[c]);
+                base.values[c] = values[c];
+            }
+            base.frame = frame_index_;
+        }
+    };
+    writeDevices(disk_bases_, snapshot.disks.size(), 0, kDiskCounters, diskCounters, snapshot.disks);
+    writeDevices(net_bases_, snapshot.nets.size(), snapshot.disks.size(), kNetCounters, netCounters, snapshot.nets);
+
+    have_previous_ = true;
+    ++frame_index_;
+    return out.size() - start;
+}
+
+// --- SnapshotDecoder ---
+
+void SnapshotDecoder::reset() {
+    have_previous_ = false;
+    names_.clear();
+    disk_bases_.clear();
+    net_bases_.clear();
+}
+
+std::size_t SnapshotDecoder::decode(ByteSpan frame, MetricsSnapshot& out) {
+    FrameHeader header = peekFrameHeader(frame);
+    if (header.version != kFormatVersion) {
+        throw std::runtime_error("Unsupported snapshot format version " + std::to_string(header.version) + ".");
+    }
+    if (!header.keyframe && !have_previous_) {
+        throw std::runtime_error("Cannot decode a delta frame without a preceding keyframe.");
+    }
+    // A frame that fails halfway leaves the delta state inconsistent; require a new keyframe until one succeeds.
+    have_previous_ = false;
+    if (header.keyframe) {
+        names_.clear();
+        disk_bases_.clear();
+        net_bases_.clear();
+    }
+
+    Reader reader(frame);
+    reader.bytes(4);
+
+    std::uint64_t timestamp = reader.varint();
+    out.timestamp_ms = header.keyframe ? timestamp : applyZigzagDelta(prev_timestamp_, timestamp);
+    std::uint64_t fixed[kFixedCounters];
+    for (std::size_t i = 0; i < kFixedCounters; ++i) {
+        std::uint64_t value = reader.varint();
+        fixed[i] = header.keyframe ? value : applyZigzagDelta(prev_fixed_[i], value);
+    }
+
+    std::size_t new_names = reader.count(1);
+    for (std::size_t i = 0; i < new_names; ++i) {
+        std::size_t length = reader.count(1);
+        names_.emplace_back(reader.bytes(length));
+    }
+
+    auto readDevices = [&](std::vector<DeviceBase>& bases, std::size_t counters, auto&& assign, auto& devices) {
+        std::size_t count = reader.count(1 + counters);
+        devices.resize(count);
+        for (std::size_t i = 0; i < count; ++i) {
+            std::uint64_t tagged = reader.varint();
+            std::uint64_t id = tagged >> 1;
+            bool has_base = (tagged & 1) != 0;
+            if (id >= names_.size()) {
+                throw std::runtime_error("Snapshot frame references an unknown name id.");
+            }
+            if (bases.size() <= id) {
+                bases.resize(static_cast<std::size_t>(id) + 1, DeviceBase{{}, ~0ULL});
+            }
+            DeviceBase& base = bases[static_cast<std::size_t>(id)];
+            if (has_base && (header.keyframe || base.frame + 1 != frame_index_)) {
+                throw std::runtime_error("Snapshot frame references a device missing from the previous frame.");
+            }
+            std::uint64_t values[8];
+            for (std::size_t c = 0; c < counters; ++c) {
+                std::uint64_t value = reader.varint();
+                values[c] = has_base ? applyZigzagDelta(base.values[c], value) : value;
+                base.values[c] = values[c];
+            }
+            base.frame = frame_index_;
+            assign(devices[i], names_[static_cast<std::size_t>(id)], values);
+        }
+    };
+    readDevices(disk_bases_, kDiskCounters, [](SystemDiskStats::DiskStats& d, const std::string& name, const std::uint64_t* v) {
+        d.device.assign(name);
+        d.read_bytes = v[0];
+        d.write_bytes = v[1];
+        d.read_time_ms = v[2];
+        d.write_time_ms = v[3];
+    }, out.disks);
+    readDevices(net_bases_, kNetCounters, [](SystemNetStats::NetStats& n, const std::string& name, const std::uint64_t* v) {
+        n.interface_name.assign(name);
+        n.bytes_received = v[0];
+        n.bytes_sent = v[1];
+        n.packets_received = v[2];
+        n.packets_sent = v[3];
+        n.errors_in = v[4];
+        n.errors_out = v[5];
+        n.drops_in = v[6];
+        n.drops_out = v[7];
+    }, out.nets);
+
+    // Commit the fixed counters only once the whole frame decoded successfully.
+    storeFixedCounters(fixed, out);
+    for (std::size_t i = 0; i < kFixedCounters; ++i) {
+        prev_fixed_[i] = fixed[i];
+    }
+    prev_timestamp_ = out.timestamp_ms;
+    have_previous_ = true;
+    ++frame_index_;
+    return reader.consumed();
+}
+
+} // namespace SystemMetricsCodec
@@ -0,0 +1,258 @@
+#include "socket_stats.hpp"
+#include "proc_source.hpp"
+#include "proc_parse.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+
+#if defined(__linux__)
+    #include <arpa/inet.h>
+    #include <linux/inet_diag.h>
+    #include <linux/netlink.h>
+    #include <linux/sock_diag.h>
+    #include <netinet/in.h>
+    #include <sys/socket.h>
+    #include <unistd.h>
+#endif
+
+namespace SystemNetStats {
+
+namespace { // Anonymous namespace for internal helpers
+
+// Large enough for the kernel's biggest dump batch, so each recv() drains a whole batch.
+constexpr std::size_t kReceiveBufferBytes = 64 * 1024;
+
+bool parseHex(std::string_view digits, std::uint64_t& value) {
+    if (digits.empty() || digits.size() > 16) return false;
+    std::uint64_t result = 0;
+    for (char c : digits) {
+        unsigned digit;
+        if (c >= '0' && c <= '9') digit = static_cast<unsigned>(c - '0');
+        else if (c >= 'A' && c <= 'F') digit = static_cast<unsigned>(c - 'A' + 10);
+        else if (c >= 'a' && c <= 'f') digit = static_cast<unsigned>(c - 'a' + 10);
+        else return false;
+        result = (result << 4) | digit;
+    }
+    value = result;
+    return true;
+}
+
+void addListener(SocketSummary& out, std::uint16_t port, std::uint64_t queued, std::uint64_t limit) {
+    ListenBacklog backlog;
+    backlog.port = port;
+    backlog.sockets = 1;
+    backlog.queued = queued;
+    backlog.limit = limit;
+    out.listeners.push_back(backlog);
+}
+
+void resetSummary(SocketSummary& out) {
+    out.states.fill(0);
+    out.listeners.clear();
+}
+
+} // namespace
+
+const char* tcpStateName(TcpState state) {
+    switch (state) {
+        case TcpState::Established: return "ESTABLISHED";
+        case TcpState::SynSent: return "SYN_SENT";
+        case TcpState::SynRecv: return "SYN_RECV";
+        case TcpState::FinWait1: return "FIN_WAIT1";
+        case TcpState::FinWait2: return "FIN_WAIT2";
+        case TcpState::TimeWait: return "TIME_WAIT";
+        case TcpState::Close: return "CLOSE";
+        case TcpState::CloseWait: return "CLOSE_WAIT";
+        case TcpState::LastAck: return "LAST_ACK";
+        case TcpState::Listen: return "LISTEN";
+        case TcpState::Closing: return "CLOSING";
+        case TcpState::NewSynRecv: return "NEW_SYN_RECV";
+    }
+    return "UNKNOWN";
+}
+
+const char* socketBackendName(SocketBackend backend) {
+    return backend == SocketBackend::SockDiag ? "sock_diag" : "proc";
+}
+
+std::uint64_t SocketSummary::total() const {
+    std::uint64_t sum = 0;
+    for (std::uint64_t count : states) sum += count;
+    return sum;
+}
+
+// --- SocketStatsCollector ---
+
+SocketStatsCollector::SocketStatsCollector() : SocketStatsCollector(Options{}) {}
+
+SocketStatsCollector::SocketStatsCollector(Options options)
+    : options_(options), backend_(options.use_sock_diag ? SocketBackend::SockDiag : SocketBackend::ProcNet) {}
+
+SocketStatsCollector::~SocketStatsCollector() {
+#if defined(__linux__)
+    if (fd_ >= 0) ::close(fd_);
+#endif
+}
+
+SocketSummary SocketStatsCollector::collect() {
+    SocketSummary summary;
+    collect(summary);
+    return summary;
+}
+
+void SocketStatsCollector::collect(SocketSummary& out) {
+    resetSummary(out);
+    // sock_diag describes the live host, so replayed sources always go through the text files.
+    const bool live = SystemProcFS::ProcFS::resolvePath("/proc/net/tcp") == "/proc/net/tcp";
+    if (options_.use_sock_diag && live && collectSockDiag(out)) {
+        backend_ = SocketBackend::SockDiag;
+    } else {
+        resetSummary(out);
+        collectProcNet(out);
+        backend_ = SocketBackend::ProcNet;
+    }
+    finishListeners(out);
+}
+
+bool SocketStatsCollector::collectSockDiag(SocketSummary& out) {
+#if defined(__linux__)
+    if (fd_ < 0) {
+        fd_ = ::socket(AF_NETLINK, SOCK_DGRAM | SOCK_CLOEXEC, NETLINK_SOCK_DIAG);
+        if (fd_ < 0) {
+            options_.use_sock_diag = false; // Not permitted or not built into this kernel: stop trying
+            return false;
+        }
+        buffer_.resize(kReceiveBufferBytes / sizeof(std::uint32_t));
+    }
+    try {
+        dumpFamily(AF_INET, out);
+        if (options_.include_ipv6) dumpFamily(AF_INET6, out);
+    } catch (const std::runtime_error&) {
+        // A failed dump leaves the socket mid-stream; start from a fresh one next time.
+        ::close(fd_);
+        fd_ = -1;
+        return false;
+    }
+    return true;
+#else
+    (void)out;
+    return false;
+#endif
+}
+
+void SocketStatsCollector::dumpFamily(unsigned char family, SocketSummary& out) {
+#if defined(__linux__)
+    struct {
+        nlmsghdr header;
+        inet_diag_req_v2 request;
+    } message{};
+    message.header.nlmsg_len = sizeof(message);
+    message.header.nlmsg_type = SOCK_DIAG_BY_FAMILY;
+    message.header.nlmsg_flags = NLM_F_REQUEST | NLM_F_DUMP;
+    message.header.nlmsg_seq = ++sequence_;
+    message.request.sdiag_family = family;
+    message.request.sdiag_protocol = IPPROTO_TCP;
+    message.request.idiag_states = options_.states;
+    message.request.idiag_ext = 0; // No optional attributes: the fixed inet_diag_msg has all we need
+
+    sockaddr_nl kernel{};
+    kernel.nl_family = AF_NETLINK;
+    if (::sendto(fd_, &message, sizeof(message), 0, reinterpret_cast<const sockaddr*>(&kernel), sizeof(kernel)) < 0) {
+        throw std::runtime_error(std::string("sock_diag request failed: ") + std::strerror(errno));
+    }
+
+    char* const data = reinterpret_cast<char*>(buffer_.data());
+    const std::size_t capacity = buffer_.size() * sizeof(std::uint32_t);
+    while (true) {
+        const ssize_t received = ::recv(fd_, data, capacity, 0);
+        if (received < 0) {
+            if (errno == EINTR) continue;
+            throw std::runtime_error(std::string("sock_diag receive failed: ") + std::strerror(errno));
+        }
+        int remaining = static_cast<int>(received);
+        for (const nlmsghdr* header = reinterpret_cast<const nlmsghdr*>(data); NLMSG_OK(header, remaining);
+             header = NLMSG_NEXT(header, remaining)) {
+            if (header->nlmsg_seq != sequence_) continue; // Stale reply to an abandoned dump
+            if (header->nlmsg_type == NLMSG_DONE) return;
+            if (header->nlmsg_type == NLMSG_ERROR) {
+                const auto* error = static_cast<const nlmsgerr*>(NLMSG_DATA(header));
+                throw std::runtime_error(std::string("sock_diag dump failed: ") + std::strerror(-error->error));
+            }
+            if (header->nlmsg_type != SOCK_DIAG_BY_FAMILY || header->nlmsg_len < NLMSG_LENGTH(sizeof(inet_diag_msg))) {
+                continue;
+            }
+            const auto* socket = static_cast<const inet_diag_msg*>(NLMSG_DATA(header));
+            if (socket->idiag_state < kTcpStateSlots) ++out.states[socket->idiag_state];
+            if (socket->idiag_state == static_cast<unsigned>(TcpState::Listen)) {
+                // For listeners the queue fields are the accept queue length and its limit.
+                addListener(out, ntohs(socket->id.idiag_sport), socket->idiag_rqueue, socket->idiag_wqueue);
+            }
+        }
+        if (received == 0) throw std::runtime_error("sock_diag dump ended without NLMSG_DONE");
+    }
+#else
+    (void)family;
+    (void)out;
+#endif
+}
+
+void SocketStatsCollector::collectProcNet(SocketSummary& out) {
+    if (!SystemProcFS::ProcFS::readFile("/proc/net/tcp", text_)) {
+        throw std::runtime_error("Failed to read /proc/net/tcp.");
+    }
+    parseProcNetTcp(text_, options_.states, out);
+    if (options_.include_ipv6 && SystemProcFS::ProcFS::readFile("/proc/net/tcp6", text_)) {
+        parseProcNetTcp(text_, options_.states, out);
+    }
+}
+
+void SocketStatsCollector::parseProcNetTcp(std::string_view text, std::uint32_t states, SocketSummary& out) {
+    std::string_view line;
+    SystemProcFS::nextLine(text, line); // Column header
+    while (SystemProcFS::nextLine(text, line)) {
+        // "  0: 0100007F:0CEA 00000000:0000 0A 00000000:00000001 ..."
+        SystemProcFS::FieldScanner fields(line);
+        std::string_view local, state_field, queues;
+        if (!fields.skip(1)) continue; // Blank line
+        std::uint64_t state = 0;
+        if (!fields.next(local) || !fields.skip(1) || !fields.next(state_field) || !fields.next(queues) ||
+            !parseHex(state_field, state)) {
+            throw std::runtime_error("Malformed /proc/net/tcp line: " + std::string(line));
+        }
+        if (state >= kTcpStateSlots || (states & (1u << state)) == 0) continue;
+        ++out.states[state];
+        if (state != static_cast<std::uint64_t>(TcpState::Listen)) continue;
+
+        const std::size_t port_colon = local.rfind(':');
+        const std::size_t queue_colon = queues.find(':');
+        std::uint64_t port = 0, queued = 0;
+        if (port_colon == std::string_view::npos || queue_colon == std::string_view::npos ||
+            !parseHex(local.substr(port_colon + 1), port) || !parseHex(queues.substr(queue_colon + 1), queued)) {
+            throw std::runtime_error("Malformed /proc/net/tcp line: " + std::string(line));
+        }
+        addListener(out, static_cast<std::uint16_t>(port), queued, 0);
+    }
+}
+
+void SocketStatsCollector::finishListeners(SocketSummary& out) {
+    auto& listeners = out.listeners;
+    std::sort(listeners.begin(), listeners.end(),
+              [](const ListenBacklog& a, const ListenBacklog& b) { return a.port < b.port; });
+    std::size_t merged = 0;
+    for (std::size_t i = 0; i < listeners.size(); ++i) {
+        if (merged > 0 && listeners[merged - 1].port == listeners[i].port) {
+            listeners[merged - 1].sockets += listeners[i].sockets;
+            listeners[merged - 1].queued += listeners[i].queued;
+            listeners[merged - 1].limit += listeners[i].limit;
+        } else {
+            listeners[merged++] = listeners[i];
+        }
+    }
+    listeners.resize(merged);
+}
+
+} // namespace SystemNetStats
@@ -0,0 +1,104 @@
+#include "softnet_stats.hpp"
+#include "cpu_stats.hpp"
+#include "proc_source.hpp"
+#include "proc_parse.hpp"
+#include "simd_scan.hpp"
+
+#include <stdexcept>
+#include <string>
+#include <string_view>
+
+namespace SystemNetStats {
+
+namespace { // Anonymous namespace for internal helpers
+
+constexpr std::size_t kFieldWidth = 9;  // "%08x "
+constexpr std::size_t kMinFields = 11;  // Every kernel since 3.11 (flow_limit_count)
+constexpr std::size_t kMaxFields = 13;  // Fields used; 5.10+ adds the backlog length and CPU number
+
+// Position of each SoftnetCounter in a line; fields 3-8 are always zero (retired counters).
+constexpr std::size_t kCounterFields[kSoftnetCounterCount] = {0, 1, 2, 9, 10};
+constexpr std::size_t kBacklogField = 11;
+constexpr std::size_t kCpuField = 12;
+
+} // namespace
+
+const char* softnetCounterName(SoftnetCounter counter) {
+    switch (counter) {
+        case SoftnetCounter::Processed: return "processed";
+        case SoftnetCounter::Dropped: return "dropped";
+        case SoftnetCounter::TimeSqueeze: return "time_squeeze";
+        case SoftnetCounter::ReceivedRps: return "received_rps";
+        case SoftnetCounter::FlowLimitCount: return "flow_limit_count";
+        case SoftnetCounter::Count: break;
+    }
+    return "unknown";
+}
+
+// --- SoftnetStatsReader ---
+
+void SoftnetStatsReader::parse(std::string_view text, std::vector<SoftnetCPU>& out) {
+    out.clear();
+    std::string_view line;
+    std::uint64_t fields[kMaxFields];
+    while (SystemProcFS::nextLine(text, line)) {
+        if (line.empty()) continue;
+        const std::size_t count = (line.size() + 1) / kFieldWidth;
+        if ((line.size() + 1) % kFieldWidth != 0 || count < kMinFields ||
+            !SystemProcFS::parseFixedWidthHex(line, kFieldWidth, fields, count < kMaxFields ? count : kMaxFields)) {
+            throw std::runtime_error("Malformed /proc/net/softnet_stat line: " + std::string(line));
+        }
+        SoftnetCPU& row = out.emplace_back();
+        row.cpu = count > kCpuField ? static_cast<unsigned>(fields[kCpuField]) : static_cast<unsigned>(out.size() - 1);
+        for (std::size_t i = 0; i < kSoftnetCounterCount; ++i) row.counters[i] = fields[kCounterFields[i]];
+        row.backlog = count > kBacklogField ? fields[kBacklogField] : 0;
+    }
+}
+
+std::vector<SoftnetCPU> SoftnetStatsReader::getSoftnetStats() {
+    std::string buffer;
+    if (!SystemProcFS::ProcFS::readFile("/proc/net/softnet_stat", buffer)) {
+        throw std::runtime_error("Failed to read /proc/net/softnet_stat.");
+    }
+    std::vector<SoftnetCPU> cpus;
+    parse(buffer, cpus);
+    return cpus;
+}
+
+// --- SoftnetCollector ---
+
+void SoftnetCollector::sample() {
+    sample(Clock::now());
+}
+
+void SoftnetCollector::sample(Clock::time_point now) {
+    if (!SystemProcFS::ProcFS::readFile("/proc/net/softnet_stat", buffer_)) {
+        throw std::runtime_error("Failed to read /proc/net/softnet_stat.");
+    }
+    SoftnetStatsReader::parse(buffer_, previous_);
+    previous_.swap(current_);
+    ++samples_;
+    const Clock::time_point previous_time = last_time_;
+    last_time_ = now;
+    if (samples_ < 2) return;
+
+    rates_.elapsed_seconds = std::chrono::duration<double>(now - previous_time).count();
+    const double scale = rates_.elapsed_seconds > 0.0 ? 1.0 / rates_.elapsed_seconds : 0.0;
+    rates_.cpus.clear();
+    rates_.total_per_second.fill(0.0);
+    // Both readings are ascending by CPU number: match them in one merge pass.
+    auto previous = previous_.begin();
+    for (const SoftnetCPU& cpu : current_) {
+        while (previous != previous_.end() && previous->cpu < cpu.cpu) ++previous;
+        if (previous == previous_.end() || previous->cpu != cpu.cpu) continue;
+        SoftnetCPURates& rates = rates_.cpus.emplace_back();
+        rates.cpu = cpu.cpu;
+        for (std::size_t i = 0; i < kSoftnetCounterCount; ++i) {
+            rates.deltas[i] = SystemCPUStats::counterDelta(previous->counters[i], cpu.counters[i]);
+            rates.per_second[i] = static_cast<double>(rates.deltas[i]) * scale;
+            rates_.total_per_second[i] += rates.per_second[i];
+        }
+    }
+}
+
+} // namespace SystemNetStats
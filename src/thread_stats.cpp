@@ -0,0 +1,274 @@
+#include "thread_stats.hpp"
+#include "cpu_stats.hpp"
+#include "proc_parse.hpp"
+#include "proc_source.hpp"
+#include "simd_scan.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+
+#if defined(__linux__)
+#include <dirent.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace SystemProcessStats {
+
+namespace { // Anonymous namespace for internal helpers
+
+// A stat line is a few hundred bytes; the name is at most 64 (TASK_COMM_LEN is 16).
+constexpr std::size_t kStatBufferSize = 1024;
+
+SystemProcFS::BatchFileReader::Options readerOptions(std::size_t max_open_files) {
+    SystemProcFS::BatchFileReader::Options options;
+    options.slot_size = kStatBufferSize;
+    options.use_io_uring = false; // /proc: see BatchFileReader
+    options.max_open_files = max_open_files;
+    return options;
+}
+
+std::string taskDirectory(int pid) {
+    return "/proc/" + std::to_string(pid) + "/task";
+}
+
+bool parseId(std::string_view text, int& id) {
+    std::uint64_t value = 0;
+    if (text.empty() || !SystemProcFS::parseDecimal(text, value) || value > 0x7FFFFFFFu) return false;
+    id = static_cast<int>(value);
+    return true;
+}
+
+[[noreturn]] void throwMalformed(std::string_view text) {
+    std::string_view line;
+    SystemProcFS::nextLine(text, line);
+    throw std::runtime_error("Malformed stat line: " + std::string(line));
+}
+
+} // namespace
+
+// --- TaskStatReader ---
+
+void TaskStatReader::parse(std::string_view text, TaskStat& out) {
+    // "1234 (name) S 1 1234 1234 0 -1 4194560 ..." (proc(5)); the name ends at the last ')'.
+    const std::size_t open = text.find('(');
+    const std::size_t close = text.rfind(')');
+    if (open == std::string_view::npos || close == std::string_view::npos || close < open ||
+        !parseId(text.substr(0, open > 0 ? open - 1 : 0), out.pid)) {
+        throwMalformed(text);
+    }
+    out.comm.assign(text.substr(open + 1, close - open - 1));
+
+    SystemProcFS::FieldScanner fields(text.substr(close + 1));
+    std::string_view state, ppid, processor;
+    std::uint64_t ignored = 0;
+    // Fields 3-4 (state, ppid), 14-15 (utime, stime), 20 (num_threads), 22 (starttime),
+    // 24 (rss) and 39 (processor), counting from 1 as proc(5) does.
+    const bool valid = fields.next(state) && state.size() == 1 && fields.next(ppid) && parseId(ppid, out.ppid) &&
+                       fields.skip(9) && fields.nextUnsigned(out.utime) && fields.nextUnsigned(out.stime) &&
+                       fields.skip(4) && fields.nextUnsigned(out.num_threads) && fields.nextUnsigned(ignored) &&
+                       fields.nextUnsigned(out.start_time) && fields.nextUnsigned(ignored) &&
+                       fields.nextUnsigned(out.rss_pages) && fields.skip(14) && fields.next(processor) &&
+                       parseId(processor, out.processor);
+    if (!valid) throwMalformed(text);
+    out.state = state[0];
+}
+
+// --- ThreadCollector ---
+
+void ThreadCollector::DirectoryCloser::operator()(void* directory) const {
+#if defined(__linux__)
+    ::closedir(static_cast<DIR*>(directory));
+#else
+    (void)directory;
+#endif
+}
+
+ThreadCollector::ThreadCollector() : ThreadCollector(Options()) {}
+
+ThreadCollector::ThreadCollector(Options options) : options_(options), reader_(readerOptions(options.max_open_files)) {}
+
+// The stat files and directories close themselves, before reader_ is destroyed.
+ThreadCollector::~ThreadCollector() = default;
+
+void ThreadCollector::track(int pid) {
+    for (const Process& process : processes_) {
+        if (process.pid == pid) return;
+    }
+    Process& process = processes_.emplace_back();
+    process.pid = pid;
+#if defined(__linux__)
+    const std::string resolved = SystemProcFS::ProcFS::resolvePath(taskDirectory(pid));
+    if (!resolved.empty()) {
+        const int fd = ::open(resolved.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+        if (fd >= 0) {
+            DIR* directory = ::fdopendir(fd);
+            if (directory == nullptr) ::close(fd);
+            process.directory.reset(directory);
+        }
+    }
+#endif
+}
+
+void ThreadCollector::untrack(int pid) {
+    processes_.erase(std::remove_if(processes_.begin(), processes_.end(),
+                                    [pid](const Process& process) { return process.pid == pid; }),
+                     processes_.end());
+}
+
+std::vector<int> ThreadCollector::tracked() const {
+    std::vector<int> pids;
+    pids.reserve(processes_.size());
+    for (const Process& process : processes_) pids.push_back(process.pid);
+    return pids;
+}
+
+void ThreadCollector::sample() {
+    sample(Clock::now());
+}
+
+void ThreadCollector::sample(Clock::time_point now) {
+    // List every task directory first, so all stat files are read in one batch. Processes found
+    // gone are dropped only once every listing succeeded.
+    for (Process& process : processes_) process.exited = !scan(process);
+    processes_.erase(std::remove_if(processes_.begin(), processes_.end(),
+                                    [](const Process& process) { return process.exited; }),
+                     processes_.end());
+    reader_.readAll();
+
+    // Parse every thread into `next` before committing any.
+    for (Process& process : processes_) {
+        for (Thread& thread : process.threads) thread.read = readThread(thread);
+    }
+
+    const double elapsed = samples_ > 0 ? std::chrono::duration<double>(now - last_time_).count() : 0.0;
+    const double scale = elapsed > 0.0 ? 100.0 / elapsed : 0.0;
+    usage_.resize(processes_.size());
+    for (std::size_t i = 0; i < processes_.size(); ++i) {
+        Process& process = processes_[i];
+        ProcessThreads& out = usage_[i];
+        out.pid = process.pid;
+        out.threads.clear();
+        out.cpu_percent = 0.0;
+        out.new_threads = 0;
+        for (Thread& thread : process.threads) {
+            if (!thread.read) continue; // Exited since the listing
+            std::swap(thread.previous, thread.current);
+            std::swap(thread.current, thread.next);
+            // A tid reused by a new thread within the interval starts over.
+            if (thread.current.start_time != thread.previous.start_time) thread.fresh = true;
+            if (thread.fresh) {
+                ++out.new_threads;
+                thread.fresh = false;
+                continue;
+            }
+            const double user = SystemCPUStats::ticksToSeconds(
+                SystemCPUStats::counterDelta(thread.previous.utime, thread.current.utime)) * scale;
+            const double system = SystemCPUStats::ticksToSeconds(
+                SystemCPUStats::counterDelta(thread.previous.stime, thread.current.stime)) * scale;
+            ThreadUsage& usage = out.threads.emplace_back();
+            usage.pid = process.pid;
+            usage.tid = thread.tid;
+            usage.name = thread.current.comm;
+            usage.state = thread.current.state;
+            usage.processor = thread.current.processor;
+            usage.user_percent = user;
+            usage.system_percent = system;
+            usage.cpu_percent = user + system;
+            out.cpu_percent += usage.cpu_percent;
+        }
+    }
+    ++samples_;
+    last_time_ = now;
+}
+
+bool ThreadCollector::scan(Process& process) {
+    ++stats_.directory_scans;
+    tids_.clear();
+#if defined(__linux__)
+    if (process.directory) {
+        DIR* directory = static_cast<DIR*>(process.directory.get());
+        ::rewinddir(directory);
+        while (const dirent* entry = ::readdir(directory)) {
+            int tid = 0;
+            if (parseId(entry->d_name, tid)) tids_.push_back(tid);
+        }
+    } else
+#endif
+    {
+        for (const std::string& name : SystemProcFS::ProcFS::listDirectory(taskDirectory(process.pid))) {
+            int tid = 0;
+            if (parseId(name, tid)) tids_.push_back(tid);
+        }
+    }
+    if (tids_.empty()) return false; // Every live process has at least one thread
+    std::sort(tids_.begin(), tids_.end());
+
+    // Merge the listing with the known threads (both ascending): keep, open new, close gone.
+    merged_.clear();
+    auto known = process.threads.begin();
+    for (int tid : tids_) {
+        while (known != process.threads.end() && known->tid < tid) {
+            ++known;
+            ++stats_.threads_removed;
+        }
+        if (known != process.threads.end() && known->tid == tid) {
+            Thread& thread = merged_.emplace_back(std::move(*known++));
+            if (thread.file.reader == nullptr) { // Its last read failed: the tid may have been reused
+                openThread(process, thread);
+                thread.fresh = true;
+            }
+            continue;
+        }
+        Thread& thread = merged_.emplace_back();
+        thread.tid = tid;
+        openThread(process, thread);
+        ++stats_.threads_added;
+    }
+    stats_.threads_removed += static_cast<std::uint64_t>(process.threads.end() - known);
+    process.threads.swap(merged_);
+    merged_.clear(); // Closes the threads that were not carried over
+    return true;
+}
+
+void ThreadCollector::openThread(const Process& process, Thread& thread) {
+    const std::size_t index = reader_.add(taskDirectory(process.pid) + "/" + std::to_string(thread.tid) + "/stat");
+    thread.file = StatFile(reader_, index);
+}
+
+bool ThreadCollector::readThread(Thread& thread) {
+    if (thread.file.reader == nullptr) return false;
+    ++stats_.reads;
+    if (!reader_.ok(thread.file.index)) {
+        // An exited thread's descriptor fails every later read (ESRCH) even if its tid is reused,
+        // so it is closed and reopened if a later listing still has the tid.
+        thread.file.reset();
+        return false;
+    }
+    TaskStatReader::parse(reader_.contents(thread.file.index), thread.next);
+    return true;
+}
+
+std::vector<ThreadUsage> ThreadCollector::hottest(std::size_t count) const {
+    std::vector<ThreadUsage> threads;
+    for (const ProcessThreads& process : usage_) {
+        threads.insert(threads.end(), process.threads.begin(), process.threads.end());
+    }
+    count = std::min(count, threads.size());
+    std::partial_sort(threads.begin(), threads.begin() + static_cast<std::ptrdiff_t>(count), threads.end(),
+                      [](const ThreadUsage& a, const ThreadUsage& b) { return a.cpu_percent > b.cpu_percent; });
+    threads.resize(count);
+    return threads;
+}
+
+ThreadCollectorStats ThreadCollector::stats() const {
+    ThreadCollectorStats stats = stats_;
+    const SystemProcFS::BatchReaderStats reader = reader_.stats();
+    stats.opens = reader.opens;
+    stats.open_files = reader.open_files;
+    return stats;
+}
+
+} // namespace SystemProcessStats
@@ -0,0 +1,156 @@
+#include <gtest/gtest.h>
+#include "batch_reader.hpp"
+#include "proc_source.hpp"
+
+#include <cstdio>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+using namespace SystemProcFS;
+
+#if defined(__linux__)
+namespace {
+// Temporary fixture root with /proc/<n>/stat files.
+class BatchReaderTest : public ::testing::TestWithParam<bool> {
+protected:
+    void SetUp() override {
+        char root_template[] = "/tmp/batch_reader_testXXXXXX";
+        root_ = ::mkdtemp(root_template);
+        ::mkdir((root_ + "/proc").c_str(), 0755);
+        source_ = std::make_shared<DirectoryProcSource>(root_);
+    }
+
+    void TearDown() override {
+        for (const auto& path : written_) std::remove(path.c_str());
+        ::rmdir((root_ + "/proc").c_str());
+        ::rmdir(root_.c_str());
+    }
+
+    void write(const std::string& name, const std::string& contents) {
+        const std::string path = root_ + "/proc/" + name;
+        std::ofstream(path, std::ios::trunc) << contents;
+        written_.push_back(path);
+    }
+
+    BatchFileReader::Options options() const {
+        BatchFileReader::Options opts;
+        opts.use_io_uring = GetParam();
+        opts.queue_depth = 8;
+        return opts;
+    }
+
+    std::string root_;
+    std::shared_ptr<DirectoryProcSource> source_;
+    std::vector<std::string> written_;
+};
+} // namespace
+
+TEST_P(BatchReaderTest, ReadAll_ReturnsFreshContentsOfEveryFile) {
+    for (int n = 0; n < 20; ++n) write("f" + std::to_string(n), "value " + std::to_string(n) + "\n");
+    ScopedProcSource scoped(source_);
+
+    BatchFileReader reader(options());
+    for (int n = 0; n < 20; ++n) EXPECT_EQ(reader.add("/proc/f" + std::to_string(n)), static_cast<std::size_t>(n));
+    const std::size_t missing = reader.add("/proc/missing");
+    ASSERT_EQ(reader.readAll(), 20u);
+    for (int n = 0; n < 20; ++n) {
+        EXPECT_TRUE(reader.ok(n));
+        EXPECT_EQ(reader.contents(n), "value " + std::to_string(n) + "\n");
+    }
+    EXPECT_FALSE(reader.ok(missing));
+    EXPECT_EQ(reader.contents(missing), "");
+
+    write("f3", "changed\n");
+    ASSERT_EQ(reader.readAll(), 20u);
+    EXPECT_EQ(reader.contents(3), "changed\n");
+    EXPECT_EQ(reader.stats().batches, 2u);
+    EXPECT_EQ(reader.stats().failures, 2u);
+    EXPECT_THROW(reader.contents(99), std::out_of_range);
+}
+
+TEST_P(BatchReaderTest, ReadAll_RereadsFilesLargerThanTheirSlot) {
+    const std::string big(10000, 'x');
+    write("big", big);
+    ScopedProcSource scoped(source_);
+
+    BatchFileReader::Options opts = options();
+    opts.slot_size = 64;
+    BatchFileReader reader(opts);
+    reader.add("/proc/big");
+    ASSERT_EQ(reader.readAll(), 1u);
+    EXPECT_EQ(reader.contents(0), big);
+    EXPECT_EQ(reader.stats().overflows, 1u);
+}
+
+TEST_P(BatchReaderTest, ReadAll_UsesOneSubmissionPerQueueDepthWithIoUring) {
+    for (int n = 0; n < 64; ++n) write("f" + std::to_string(n), "1 2 3\n");
+    ScopedProcSource scoped(source_);
+
+    BatchFileReader reader(options());
+    for (int n = 0; n < 64; ++n) reader.add("/proc/f" + std::to_string(n));
+    reader.readAll(); // Registers the files and slot slab
+    const auto before = reader.stats().syscalls;
+    ASSERT_EQ(reader.readAll(), 64u);
+    const auto used = reader.stats().syscalls - before;
+    if (reader.backend() == BatchBackend::IoUring) {
+        EXPECT_LE(used, 64u / 8u * 2u); // One io_uring_enter per chunk of 8, allowing for retries
+    } else {
+        EXPECT_EQ(used, 64u); // One pread per file
+    }
+}
+
+TEST_P(BatchReaderTest, Remove_ClosesTheFileAndReusesItsIndex) {
+    for (int n = 0; n < 4; ++n) write("f" + std::to_string(n), "value " + std::to_string(n) + "\n");
+    ScopedProcSource scoped(source_);
+
+    BatchFileReader::Options opts = options();
+    opts.max_open_files = 3;
+    BatchFileReader reader(opts);
+    for (int n = 0; n < 3; ++n) reader.add("/proc/f" + std::to_string(n));
+    EXPECT_EQ(reader.stats().open_files, 3u);
+    ASSERT_EQ(reader.readAll(), 3u);
+
+    reader.remove(1);
+    EXPECT_EQ(reader.size(), 2u);
+    EXPECT_EQ(reader.stats().open_files, 2u);
+    EXPECT_THROW(reader.contents(1), std::out_of_range);
+    EXPECT_THROW(reader.remove(1), std::out_of_range);
+    ASSERT_EQ(reader.readAll(), 2u);
+    EXPECT_EQ(reader.contents(2), "value 2\n");
+
+    EXPECT_EQ(reader.add("/proc/f3"), 1u);
+    const std::size_t past_limit = reader.add("/proc/f0"); // Over max_open_files: opened by each read
+    EXPECT_EQ(reader.stats().open_files, 3u);
+    const auto opens = reader.stats().opens;
+    ASSERT_EQ(reader.readAll(), 4u);
+    EXPECT_EQ(reader.contents(1), "value 3\n");
+    EXPECT_EQ(reader.contents(past_limit), "value 0\n");
+    EXPECT_EQ(reader.stats().opens, opens + 1);
+}
+
+INSTANTIATE_TEST_SUITE_P(Backends, BatchReaderTest, ::testing::Values(true, false),
+                         [](const ::testing::TestParamInfo<bool>& info) { return info.param ? "IoUring" : "Pread"; });
+#endif
+
+TEST(BatchReaderVirtualTest, ReadAll_ReadsThroughSourcesWithoutFiles) {
+    auto source = std::make_shared<VirtualProcSource>();
+    source->setGenerator("/proc/stat", [](std::uint64_t tick) { return "tick " + std::to_string(tick) + "\n"; });
+    ScopedProcSource scoped(source);
+
+    BatchFileReader reader;
+    reader.add("/proc/stat");
+    reader.add("/proc/absent");
+    EXPECT_EQ(reader.readAll(), 1u);
+    EXPECT_EQ(reader.contents(0), "tick 0\n");
+    source->advance();
+    reader.readAll();
+    EXPECT_EQ(reader.contents(0), "tick 1\n");
+    EXPECT_FALSE(reader.ok(1));
+}
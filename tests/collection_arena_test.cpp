@@ -0,0 +1,84 @@
+#include <gtest/gtest.h>
+#include "collection_arena.hpp"
+#include "metrics_snapshot.hpp"
+#include "proc_source.hpp"
+
+#include <memory>
+#include <memory_resource>
+#include <string>
+#include <vector>
+
+using namespace SystemMetricsArena;
+
+TEST(CollectionArenaTest, Reset_ReleasesCycleAndKeepsHighWaterMark) {
+    CollectionArena arena(4096);
+    {
+        std::pmr::vector<int> values(arena.resource());
+        values.reserve(100);
+        EXPECT_GE(arena.stats().bytes_in_use, 400u);
+    }
+    const std::size_t first_cycle = arena.stats().bytes_in_use;
+    arena.reset();
+    EXPECT_EQ(arena.stats().bytes_in_use, 0u);
+    EXPECT_EQ(arena.stats().high_water_mark, first_cycle);
+    EXPECT_EQ(arena.stats().cycles, 1u);
+    EXPECT_EQ(arena.stats().upstream_allocations, 0u);
+
+    {
+        std::pmr::vector<char> small(arena.resource());
+        small.reserve(10);
+    }
+    arena.reset();
+    EXPECT_EQ(arena.stats().high_water_mark, first_cycle); // Smaller cycles leave the mark alone
+}
+
+TEST(CollectionArenaTest, OverflowingCycle_GrowsBlockForTheNextOne) {
+    CollectionArena arena(4096);
+    auto fill = [&] {
+        std::pmr::vector<char> big(arena.resource());
+        big.reserve(20000);
+    };
+    fill();
+    EXPECT_GT(arena.stats().upstream_allocations, 0u);
+    arena.reset();
+    EXPECT_GE(arena.stats().capacity, 20000u);
+
+    const auto upstream = arena.stats().upstream_allocations;
+    fill();
+    arena.reset();
+    EXPECT_EQ(arena.stats().upstream_allocations, upstream);
+}
+
+#if defined(__linux__)
+TEST(CollectionArenaTest, RecordCollector_WarmArenaServesWholeCycle) {
+    auto source = std::make_shared<SystemProcFS::VirtualProcSource>();
+    std::string diskstats;
+    for (int n = 0; n < 64; ++n) {
+        diskstats += " 259 " + std::to_string(n) + " nvme" + std::to_string(n) + "n1 1 0 2 3 4 0 5 6 0 0 0 0\n";
+    }
+    source->setFile("/proc/stat", "cpu  10 20 30 40 0 0 0 0 0 0\n");
+    source->setFile("/proc/meminfo", "MemTotal: 1000 kB\n");
+    source->setFile("/proc/diskstats", diskstats);
+    source->setFile("/proc/net/dev", "h1\nh2\n  eth0: 1 2 3 4 0 0 0 0 5 6 7 8 0 0 0 0\n");
+    SystemProcFS::ScopedProcSource scoped(source);
+
+    CollectionArena arena(1024);
+    SystemMetricsSnapshot::RecordCollector collector;
+    for (int cycle = 0; cycle < 3; ++cycle) {
+        {
+            SystemMetricsSnapshot::FixedSnapshot snapshot = collector.collect(arena);
+            EXPECT_EQ(snapshot.disks.size(), 64u);
+            EXPECT_EQ(snapshot.nets.size(), 1u);
+        }
+        arena.reset();
+    }
+    const auto upstream = arena.stats().upstream_allocations;
+    {
+        SystemMetricsSnapshot::FixedSnapshot snapshot = collector.collect(arena);
+        EXPECT_EQ(snapshot.disks.back().write_bytes, 5ULL * 512ULL);
+    }
+    arena.reset();
+    EXPECT_EQ(arena.stats().upstream_allocations, upstream);
+    EXPECT_GE(arena.stats().high_water_mark, 64 * sizeof(SystemDiskStats::DiskRecord));
+}
+#endif
@@ -0,0 +1,190 @@
+#include <gtest/gtest.h>
+#include "container_stats.hpp"
+#include "proc_source.hpp"
+#include "test_clock.hpp"
+
+#include <chrono>
+#include <memory>
+#include <stdexcept>
+#include <string>
+
+using namespace SystemContainerStats;
+using SystemProcFS::ScopedProcSource;
+using SystemProcFS::VirtualProcSource;
+using TestClock::at;
+
+namespace {
+const char* kMeminfo = "MemTotal:       16777216 kB\nMemFree:         8388608 kB\nMemAvailable:   12582912 kB\n";
+
+// A pod on a cgroup v2 host: the cgroup namespace makes its cgroup the root of the mount.
+std::shared_ptr<VirtualProcSource> v2Container() {
+    auto source = std::make_shared<VirtualProcSource>();
+    source->setFile("/proc/self/cgroup", "0::/\n");
+    source->setFile("/proc/self/mountinfo",
+                    "23 28 0:22 / /proc rw,relatime - proc proc rw\n"
+                    "30 28 0:26 / /sys/fs/cgroup ro,nosuid,nodev,noexec,relatime - cgroup2 cgroup2 rw,nsdelegate\n");
+    source->setFile("/proc/meminfo", kMeminfo);
+    source->setFile("/sys/devices/system/cpu/online", "0-127\n");
+    source->setFile("/sys/fs/cgroup/cgroup.controllers", "cpuset cpu io memory pids\n");
+    source->setFile("/sys/fs/cgroup/cpu.max", "200000 100000\n");
+    source->setFile("/sys/fs/cgroup/cpuset.cpus.effective", "0-127\n");
+    source->setFile("/sys/fs/cgroup/memory.max", "4294967296\n");
+    source->setSequence("/sys/fs/cgroup/cpu.stat", {
+        "usage_usec 1000000\nuser_usec 800000\nsystem_usec 200000\nnr_periods 100\nnr_throttled 0\nthrottled_usec 0\n",
+        // Over 2 s: 3 s of CPU (1.5 cores of the 2-core quota), throttled in 10 of 40 periods.
+        "usage_usec 4000000\nuser_usec 3000000\nsystem_usec 1000000\nnr_periods 140\nnr_throttled 10\nthrottled_usec 200000\n",
+    });
+    source->setFile("/sys/fs/cgroup/memory.current", "3221225472\n");
+    source->setFile("/sys/fs/cgroup/memory.stat", "anon 2147483648\nfile 1073741824\ninactive_file 1073741824\n");
+    return source;
+}
+} // namespace
+
+TEST(ContainerStatsTest, Resolver_PrefersV1ControllersAndMapsSubtreeMounts) {
+    std::vector<SystemDiskStats::MountEntry> mounts;
+    SystemDiskStats::MountInfoReader::parse(
+        "33 32 0:29 /docker/abc /sys/fs/cgroup/cpu,cpuacct rw - cgroup cgroup rw,cpu,cpuacct\n"
+        "35 32 0:31 /docker/abc /sys/fs/cgroup/cpuset rw - cgroup cgroup rw,cpuset\n"
+        "36 32 0:32 / /sys/fs/cgroup/memory rw - cgroup cgroup rw,memory\n"
+        "42 32 0:38 / /sys/fs/cgroup/unified rw - cgroup2 cgroup2 rw\n",
+        mounts);
+    const CgroupPaths hybrid = CgroupResolver::parse(
+        "12:memory:/docker/abc\n4:cpu,cpuacct:/docker/abc\n3:cpuset:/docker/abc\n1:name=systemd:/docker/abc\n0::/docker/abc\n",
+        mounts);
+    EXPECT_EQ(hybrid.version, CgroupVersion::V1);
+    EXPECT_EQ(hybrid.cpu, "/sys/fs/cgroup/cpu,cpuacct"); // The mount's root is the cgroup itself
+    EXPECT_EQ(hybrid.cpuacct, "/sys/fs/cgroup/cpu,cpuacct");
+    EXPECT_EQ(hybrid.cpuset, "/sys/fs/cgroup/cpuset");
+    EXPECT_EQ(hybrid.memory, "/sys/fs/cgroup/memory/docker/abc");
+
+    SystemDiskStats::MountInfoReader::parse("30 28 0:26 / /sys/fs/cgroup rw - cgroup2 cgroup2 rw\n", mounts);
+    const CgroupPaths unified = CgroupResolver::parse("0::/system.slice/agent.service\n", mounts);
+    EXPECT_EQ(unified.version, CgroupVersion::V2);
+    EXPECT_EQ(unified.memory, "/sys/fs/cgroup/system.slice/agent.service");
+    EXPECT_EQ(unified.cpu, unified.memory);
+    EXPECT_STREQ(cgroupVersionName(unified.version), "v2");
+
+    EXPECT_EQ(CgroupResolver::parse("0::/\n", {}).version, CgroupVersion::None);
+    EXPECT_THROW(CgroupResolver::parse("garbage\n", mounts), std::runtime_error);
+}
+
+TEST(ContainerStatsTest, CollectorV2_ReportsUsageAgainstQuotaAndCachesLimits) {
+    auto source = v2Container();
+    ScopedProcSource scoped(source);
+
+    ContainerCollector::Options options;
+    options.limits_refresh = std::chrono::seconds(5);
+    ContainerCollector collector(options);
+    collector.sample(at(0));
+    EXPECT_FALSE(collector.hasRates());
+    EXPECT_EQ(collector.paths().version, CgroupVersion::V2);
+    EXPECT_EQ(collector.paths().memory, "/sys/fs/cgroup");
+
+    const CgroupLimits& limits = collector.limits();
+    EXPECT_TRUE(limits.cpu_quota);
+    EXPECT_DOUBLE_EQ(limits.cpu_cores, 2.0);
+    EXPECT_EQ(limits.host_cpus, 128u);
+    EXPECT_EQ(limits.cpuset_cpus, 128u);
+    EXPECT_TRUE(limits.memory_limited);
+    EXPECT_EQ(limits.memory_bytes, 4294967296u);
+    EXPECT_EQ(limits.host_memory_bytes, 16777216ull * 1024);
+
+    source->advance();
+    collector.sample(at(2));
+    ASSERT_TRUE(collector.hasRates());
+    const ContainerUsage& usage = collector.usage();
+    EXPECT_DOUBLE_EQ(usage.cpu_cores, 1.5);
+    EXPECT_DOUBLE_EQ(usage.cpu_percent, 75.0);
+    EXPECT_DOUBLE_EQ(usage.throttled_percent, 25.0);
+    EXPECT_DOUBLE_EQ(usage.throttled_seconds, 0.1);
+    EXPECT_EQ(usage.memory_working_set_bytes, 2147483648u);
+    EXPECT_DOUBLE_EQ(usage.memory_percent, 50.0);
+    EXPECT_EQ(collector.limitReads(), 1u);
+
+    // Limits are not looked at again before the refresh interval, and not re-parsed unless changed.
+    source->setFile("/sys/fs/cgroup/cpu.max", "max 100000\n");
+    collector.sample(at(4));
+    EXPECT_DOUBLE_EQ(collector.limits().cpu_cores, 2.0);
+    source->setFile("/sys/fs/cgroup/cpu.max", "200000 100000\n");
+    collector.sample(at(6));
+    EXPECT_EQ(collector.limitReads(), 1u);
+
+    source->setFile("/sys/fs/cgroup/cpu.max", "max 100000\n");
+    source->setFile("/sys/fs/cgroup/memory.max", "max\n");
+    source->setFile("/sys/fs/cgroup/cpuset.cpus.effective", "0-3\n");
+    collector.sample(at(12));
+    EXPECT_EQ(collector.limitReads(), 2u);
+    EXPECT_FALSE(collector.limits().cpu_quota);
+    EXPECT_DOUBLE_EQ(collector.limits().cpu_cores, 4.0); // Bounded by the cpuset instead
+    EXPECT_FALSE(collector.limits().memory_limited);
+    EXPECT_EQ(collector.limits().memory_bytes, 16777216ull * 1024);
+
+    source->setFile("/sys/fs/cgroup/cpu.max", "lots 100000\n");
+    EXPECT_THROW(collector.sample(at(20)), std::runtime_error);
+
+    // A refresh that fails after the files changed is retried by the next one.
+    source->setFile("/sys/fs/cgroup/cpu.max", "50000 100000\n");
+    source->removeFile("/proc/meminfo");
+    EXPECT_THROW(collector.sample(at(28)), std::runtime_error);
+    EXPECT_DOUBLE_EQ(collector.limits().cpu_cores, 4.0);
+    source->setFile("/proc/meminfo", kMeminfo);
+    collector.sample(at(36));
+    EXPECT_EQ(collector.limitReads(), 3u);
+    EXPECT_DOUBLE_EQ(collector.limits().cpu_cores, 0.5);
+}
+
+TEST(ContainerStatsTest, CollectorV1_FallsBackToNearestVisibleCgroup) {
+    auto source = std::make_shared<VirtualProcSource>();
+    // The host-side path of the memory cgroup is not visible in the container's mount.
+    source->setFile("/proc/self/cgroup", "4:memory:/kubepods/pod1/abc\n3:cpu,cpuacct:/\n0::/\n");
+    source->setFile("/proc/self/mountinfo",
+                    "33 32 0:29 / /sys/fs/cgroup/cpu,cpuacct rw - cgroup cgroup rw,cpu,cpuacct\n"
+                    "36 32 0:32 / /sys/fs/cgroup/memory rw - cgroup cgroup rw,memory\n");
+    source->setFile("/proc/meminfo", kMeminfo);
+    source->setFile("/sys/devices/system/cpu/online", "0-7\n");
+    source->setFile("/sys/fs/cgroup/cpu,cpuacct/cpu.cfs_quota_us", "50000\n");
+    source->setFile("/sys/fs/cgroup/cpu,cpuacct/cpu.cfs_period_us", "100000\n");
+    source->setFile("/sys/fs/cgroup/cpu,cpuacct/cpu.stat", "nr_periods 10\nnr_throttled 5\nthrottled_time 250000000\n");
+    source->setSequence("/sys/fs/cgroup/cpu,cpuacct/cpuacct.usage", {"1000000000\n", "1500000000\n"});
+    source->setFile("/sys/fs/cgroup/memory/memory.limit_in_bytes", "9223372036854771712\n");
+    source->setFile("/sys/fs/cgroup/memory/memory.usage_in_bytes", "1073741824\n");
+    source->setFile("/sys/fs/cgroup/memory/memory.stat", "inactive_file 1\ntotal_inactive_file 536870912\n");
+    ScopedProcSource scoped(source);
+
+    ContainerCollector collector;
+    collector.sample(at(0));
+    EXPECT_EQ(collector.paths().version, CgroupVersion::V1);
+    EXPECT_EQ(collector.paths().memory, "/sys/fs/cgroup/memory");
+    EXPECT_TRUE(collector.paths().cpuset.empty());
+    EXPECT_DOUBLE_EQ(collector.limits().cpu_cores, 0.5);
+    EXPECT_FALSE(collector.limits().memory_limited); // PAGE_COUNTER_MAX means no limit
+
+    source->advance();
+    collector.sample(at(1));
+    EXPECT_DOUBLE_EQ(collector.usage().cpu_cores, 0.5);
+    EXPECT_DOUBLE_EQ(collector.usage().cpu_percent, 100.0);
+    EXPECT_EQ(collector.current().memoryWorkingSetBytes(), 536870912u);
+    EXPECT_DOUBLE_EQ(collector.usage().memory_percent, 100.0 * 536870912 / (16777216.0 * 1024));
+
+    source->removeFile("/sys/fs/cgroup/cpu,cpuacct/cpuacct.usage");
+    EXPECT_THROW(collector.sample(at(2)), std::runtime_error);
+
+    // The failed sample is dropped: the next rate covers the 2 s since the last good one.
+    source->setFile("/sys/fs/cgroup/cpu,cpuacct/cpuacct.usage", "2500000000\n");
+    collector.sample(at(3));
+    EXPECT_DOUBLE_EQ(collector.usage().elapsed_seconds, 2.0);
+    EXPECT_DOUBLE_EQ(collector.usage().cpu_cores, 0.5);
+    EXPECT_EQ(collector.current().memoryWorkingSetBytes(), 536870912u);
+}
+
+#if defined(__linux__)
+TEST(ContainerStatsTest, Collector_ReadsLiveCgroup) {
+    if (CgroupResolver::resolve().version == CgroupVersion::None) GTEST_SKIP() << "No cgroup filesystem";
+    ContainerCollector collector;
+    collector.sample();
+    collector.sample();
+    EXPECT_GT(collector.limits().cpu_cores, 0.0);
+    EXPECT_GT(collector.limits().memory_bytes, 0u);
+    EXPECT_EQ(collector.limitReads(), 1u);
+}
+#endif
@@ -15,6 +15,8 @@
 
 // Include your system stat headers
 #include "cpu_stats.hpp"
+#include "proc_source.hpp"
+#include <memory>
 // --- Test Cases for CPUStats struct ---
 
 TEST(CPUStatsTest, ConstructorInitialization) {
@@ -203,6 +205,147 @@ TEST(CPUStatsReaderTest, GetCPUStats_ReturnsRawValuesAndZeroUsage) {
 }
 
 
+// --- Test Cases for integer CPU counters ---
+
+TEST(CPUCountersTest, CounterDelta_HandlesWrapAndBackwardSteps) {
+    EXPECT_EQ(SystemCPUStats::counterDelta(100, 250), 150u);
+    EXPECT_EQ(SystemCPUStats::counterDelta(0xFFFFFFF0ULL, 0x10ULL), 0x20u); // 32-bit wrap
+    EXPECT_EQ(SystemCPUStats::counterDelta(5000, 4990), 0u);                // iowait stepping back
+    // Full 64-bit precision: a double could not tell these apart.
+    EXPECT_EQ(SystemCPUStats::counterDelta(9007199254740993ULL, 9007199254740995ULL), 2u);
+}
+
+TEST(CPUCountersTest, ComputeUtilization_BreaksDownEveryModeInOnePass) {
+    SystemCPUStats::CPUCounters prev, curr;
+    prev.user = 1000; prev.system = 500; prev.idle = 8000; prev.iowait = 100; prev.steal = 10; prev.guest = 50;
+    curr = prev;
+    curr.user += 300;   // Of which guest 100
+    curr.guest += 100;
+    curr.system += 100;
+    curr.idle += 500;
+    curr.iowait += 50;
+    curr.steal += 50;
+    const SystemCPUStats::CPUUtilization u = SystemCPUStats::computeUtilization(prev, curr);
+    EXPECT_DOUBLE_EQ(u.user, 30.0);
+    EXPECT_DOUBLE_EQ(u.system, 10.0);
+    EXPECT_DOUBLE_EQ(u.idle, 50.0);
+    EXPECT_DOUBLE_EQ(u.iowait, 5.0);
+    EXPECT_DOUBLE_EQ(u.steal, 5.0);
+    EXPECT_DOUBLE_EQ(u.guest, 10.0); // Reported, but not counted twice
+    EXPECT_DOUBLE_EQ(u.busy, 45.0);
+    EXPECT_DOUBLE_EQ(u.elapsed_seconds, SystemCPUStats::ticksToSeconds(1000));
+
+    const SystemCPUStats::CPUUtilization none = SystemCPUStats::computeUtilization(curr, curr);
+    EXPECT_DOUBLE_EQ(none.busy, 0.0);
+    EXPECT_DOUBLE_EQ(none.idle, 0.0);
+}
+
+#if defined(__linux__)
+TEST(CPUCountersTest, GetCPUCounters_ReadsPerCpuLinesAndSurvivesHotplug) {
+    auto source = std::make_shared<SystemProcFS::VirtualProcSource>();
+    source->setSequence("/proc/stat", {
+        "cpu  300 0 100 1600 0 0 0 0 0 0\n"
+        "cpu0 100 0 50 800 0 0 0 0 0 0\n"
+        "cpu1 100 0 25 400 0 0 0 0 0 0\n"
+        "cpu2 100 0 25 400 0 0 0 0 0 0\n"
+        "intr 12345 0 0\n",
+        // cpu1 went offline; its counters stay frozen in the aggregate
+        "cpu  500 0 200 1900 0 0 0 0 0 0\n"
+        "cpu0 200 0 100 900 0 0 0 0 0 0\n"
+        "cpu2 200 0 75 600 0 0 0 0 0 0\n"
+        "intr 12400 0 0\n",
+    });
+    SystemProcFS::ScopedProcSource scoped(source);
+
+    SystemCPUStats::CPUCounterSample prev;
+    std::string buffer;
+    SystemCPUStats::CPUStatsReader::getCPUCounters(prev, buffer);
+    ASSERT_EQ(prev.cpus.size(), 3u);
+    EXPECT_EQ(prev.cpus[2].cpu, 2u);
+    EXPECT_EQ(prev.aggregate.idle, 1600u);
+
+    source->advance();
+    const SystemCPUStats::CPUCounterSample curr = SystemCPUStats::CPUStatsReader::getCPUCounters();
+    ASSERT_EQ(curr.cpus.size(), 2u);
+
+    const auto per_cpu = SystemCPUStats::computeUtilization(prev, curr);
+    ASSERT_EQ(per_cpu.size(), 2u);
+    EXPECT_EQ(per_cpu[0].cpu, 0u);
+    EXPECT_DOUBLE_EQ(per_cpu[0].utilization.busy, 60.0);
+    EXPECT_EQ(per_cpu[1].cpu, 2u);
+    EXPECT_DOUBLE_EQ(per_cpu[1].utilization.user, 100.0 / 350.0 * 100.0);
+
+    const SystemCPUStats::CPUUtilization total = SystemCPUStats::computeUtilization(prev.aggregate, curr.aggregate);
+    EXPECT_DOUBLE_EQ(total.busy, 50.0);
+}
+
+TEST(CPUCountersTest, GetCPUCounters_AcceptsOlderKernelsWithFewerColumns) {
+    auto source = std::make_shared<SystemProcFS::VirtualProcSource>();
+    source->setFile("/proc/stat", "cpu  10 20 30 40 50 60 70\ncpu0 10 20 30 40 50 60 70\n");
+    SystemProcFS::ScopedProcSource scoped(source);
+    const SystemCPUStats::CPUCounterSample sample = SystemCPUStats::CPUStatsReader::getCPUCounters();
+    EXPECT_EQ(sample.aggregate.softirq, 70u);
+    EXPECT_EQ(sample.aggregate.steal, 0u);
+    EXPECT_EQ(sample.aggregate.total(), 280u);
+
+    source->setFile("/proc/stat", "cpu  10 20\n");
+    EXPECT_THROW(SystemCPUStats::CPUStatsReader::getCPUCounters(), std::runtime_error);
+}
+
+TEST(CPUCountersTest, GetCPUCounters_ReadsActivityLinesAndLoadAverage) {
+    auto source = std::make_shared<SystemProcFS::VirtualProcSource>();
+    source->setSequence("/proc/stat", {
+        "cpu  300 0 100 1600 0 0 0 0 0 0\n"
+        "cpu0 300 0 100 1600 0 0 0 0 0 0\n"
+        "intr 12345 0 0 17 0\n"
+        "ctxt 1000000\n"
+        "btime 1760000000\n"
+        "processes 5000\n"
+        "procs_running 3\n"
+        "procs_blocked 1\n"
+        "softirq 999 1 2 3\n",
+        "cpu  400 0 100 1700 0 0 0 0 0 0\n"
+        "cpu0 400 0 100 1700 0 0 0 0 0 0\n"
+        "intr 12400 0 0 17 0\n"
+        "ctxt 1090000\n"
+        "btime 1760000000\n"
+        "processes 5120\n"
+        "procs_running 1\n"
+        "procs_blocked 0\n",
+    });
+    source->setFile("/proc/loadavg", "0.52 1.08 12.50 2/1234 56789\n");
+    SystemProcFS::ScopedProcSource scoped(source);
+
+    const SystemCPUStats::CPUCounterSample prev = SystemCPUStats::CPUStatsReader::getCPUCounters();
+    EXPECT_EQ(prev.aggregate.user, 300u);
+    EXPECT_EQ(prev.activity.context_switches, 1000000u);
+    EXPECT_EQ(prev.activity.forks, 5000u);
+    EXPECT_EQ(prev.activity.procs_running, 3u);
+    EXPECT_EQ(prev.activity.procs_blocked, 1u);
+    EXPECT_EQ(prev.activity.boot_time, 1760000000u);
+
+    source->advance();
+    const SystemCPUStats::CPUCounterSample curr = SystemCPUStats::CPUStatsReader::getCPUCounters();
+    const SystemCPUStats::ActivityRates rates = SystemCPUStats::computeActivityRates(prev.activity, curr.activity, 2.0);
+    EXPECT_DOUBLE_EQ(rates.context_switches, 45000.0);
+    EXPECT_DOUBLE_EQ(rates.forks, 60.0);
+    EXPECT_DOUBLE_EQ(SystemCPUStats::computeActivityRates(prev.activity, curr.activity, 0.0).forks, 0.0);
+
+    const SystemCPUStats::LoadAverage load = SystemCPUStats::CPUStatsReader::getLoadAverage();
+    EXPECT_DOUBLE_EQ(load.one, 0.52);
+    EXPECT_DOUBLE_EQ(load.five, 1.08);
+    EXPECT_DOUBLE_EQ(load.fifteen, 12.5);
+    EXPECT_EQ(load.runnable, 2u);
+    EXPECT_EQ(load.tasks, 1234u);
+    EXPECT_EQ(load.last_pid, 56789u);
+    EXPECT_THROW(SystemCPUStats::CPUStatsReader::parseLoadAverage("0.52 1.08 12.50 2-1234 56789\n"), std::runtime_error);
+    EXPECT_THROW(SystemCPUStats::CPUStatsReader::parseLoadAverage("0.52 1.08\n"), std::runtime_error);
+
+    source->setFile("/proc/stat", "cpu  1 0 1 1 0 0 0 0 0 0\nctxt x\n");
+    EXPECT_THROW(SystemCPUStats::CPUStatsReader::getCPUCounters(), std::runtime_error);
+}
+#endif
+
 // --- Example of how a User/Higher-Level Component would calculate usage ---
 // This is not a unit test of CPUStatsReader directly, but demonstrates its intended use.
 TEST(CPUUsageCalculationDemo, UserCalculatesPercentage) {
@@ -0,0 +1,282 @@
+#include <gtest/gtest.h>
+#include "forwarder.hpp"
+
+#include <atomic>
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+using namespace SystemMetricsForwarder;
+using SystemMetricsCodec::ByteSpan;
+using SystemMetricsSnapshot::MetricsSnapshot;
+
+namespace {
+MetricsSnapshot makeSnapshot(unsigned long long step) {
+    MetricsSnapshot s;
+    s.timestamp_ms = 1700000000000ULL + step;
+    s.cpu = SystemCPUStats::CPUStats(1000 + step, 200, 300, 4000 + step, 0, 0, 0, 0, 0, 0);
+    s.mem = SystemMemoryStats::MemStats(16000000, 4000000, 9000000, 0, 0, 0, 0);
+    s.disks.emplace_back("sda", 512 * step, 1024, step, 1);
+    s.nets.emplace_back("eth0", 1500 * step, 60, step, 1, 0, 0, 0, 0);
+    return s;
+}
+
+// In-memory sink that can be told to fail.
+class RecordingSink : public Sink {
+public:
+    void send(ByteSpan batch) override {
+        if (fail.load()) {
+            throw std::runtime_error("sink unavailable");
+        }
+        std::lock_guard<std::mutex> lock(mutex);
+        batches.emplace_back(batch.data, batch.data + batch.size);
+    }
+    std::string describe() const override { return "recording"; }
+
+    std::vector<std::uint64_t> timestamps() {
+        std::lock_guard<std::mutex> lock(mutex);
+        std::vector<MetricsSnapshot> snapshots;
+        for (const auto& batch : batches) decodeBatch(ByteSpan(batch), snapshots);
+        std::vector<std::uint64_t> result;
+        for (const auto& s : snapshots) result.push_back(s.timestamp_ms - 1700000000000ULL);
+        return result;
+    }
+
+    std::atomic<bool> fail{false};
+    std::mutex mutex;
+    std::vector<std::vector<std::uint8_t>> batches;
+};
+
+// Recording sink whose sends wait at a gate, to hold a batch in flight.
+class GatedSink : public RecordingSink {
+public:
+    void send(ByteSpan batch) override {
+        entered = true;
+        while (!open.load()) std::this_thread::yield();
+        RecordingSink::send(batch);
+    }
+
+    std::atomic<bool> entered{false};
+    std::atomic<bool> open{false};
+};
+
+// Splits a stream of 4-byte big-endian length-prefixed frames.
+std::vector<std::vector<std::uint8_t>> splitFrames(const std::vector<std::uint8_t>& stream) {
+    std::vector<std::vector<std::uint8_t>> frames;
+    size_t pos = 0;
+    while (pos + 4 <= stream.size()) {
+        size_t length = (size_t(stream[pos]) << 24) | (size_t(stream[pos + 1]) << 16) |
+                        (size_t(stream[pos + 2]) << 8) | size_t(stream[pos + 3]);
+        pos += 4;
+        frames.emplace_back(stream.begin() + pos, stream.begin() + pos + length);
+        pos += length;
+    }
+    return frames;
+}
+
+std::string tempPath(const char* prefix) {
+    std::string path = std::string("/tmp/") + prefix + "XXXXXX";
+    int fd = ::mkstemp(&path[0]);
+    if (fd >= 0) ::close(fd);
+    std::remove(path.c_str());
+    return path;
+}
+} // namespace
+
+TEST(ForwarderTest, Forwarder_BatchesBySizeAndDelivers) {
+    auto sink = std::make_shared<RecordingSink>();
+    Forwarder forwarder(sink, Forwarder::Options(3, std::chrono::milliseconds(60000)));
+    forwarder.start();
+    for (unsigned long long i = 0; i < 7; ++i) forwarder.submit(makeSnapshot(i));
+    ASSERT_TRUE(forwarder.flush(std::chrono::milliseconds(5000)));
+
+    EXPECT_EQ(sink->batches.size(), 3u); // 3 + 3 + the partial batch sealed by flush()
+    EXPECT_EQ(sink->timestamps(), (std::vector<std::uint64_t>{0, 1, 2, 3, 4, 5, 6}));
+    Forwarder::Stats stats = forwarder.stats();
+    EXPECT_EQ(stats.submitted, 7u);
+    EXPECT_EQ(stats.batches_sent, 3u);
+    EXPECT_EQ(stats.dropped_batches, 0u);
+    forwarder.stop();
+    EXPECT_FALSE(forwarder.running());
+}
+
+TEST(ForwarderTest, Forwarder_SealsPartialBatchAfterDelay) {
+    auto sink = std::make_shared<RecordingSink>();
+    Forwarder forwarder(sink, Forwarder::Options(1000, std::chrono::milliseconds(20)));
+    forwarder.start();
+    forwarder.submit(makeSnapshot(1));
+    forwarder.submit(makeSnapshot(2));
+    for (int i = 0; i < 200 && forwarder.stats().batches_sent == 0; ++i) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    EXPECT_EQ(forwarder.stats().batches_sent, 1u);
+    EXPECT_EQ(sink->timestamps(), (std::vector<std::uint64_t>{1, 2}));
+}
+
+TEST(ForwarderTest, Forwarder_DropsOldestWhenQueueIsFull) {
+    auto sink = std::make_shared<RecordingSink>();
+    Forwarder forwarder(sink, Forwarder::Options(1, std::chrono::milliseconds(60000), 2));
+    for (unsigned long long i = 0; i < 5; ++i) forwarder.submit(makeSnapshot(i)); // Not started: nothing drains
+    Forwarder::Stats stats = forwarder.stats();
+    EXPECT_EQ(stats.queued_batches, 2u);
+    EXPECT_EQ(stats.dropped_batches, 3u);
+
+    forwarder.start();
+    ASSERT_TRUE(forwarder.flush(std::chrono::milliseconds(5000)));
+    EXPECT_EQ(sink->timestamps(), (std::vector<std::uint64_t>{3, 4}));
+}
+
+#if defined(__unix__) || defined(__APPLE__)
+TEST(ForwarderTest, Forwarder_SpoolsOverflowAndResendsAfterRestart) {
+    const std::string spool = tempPath("forwarder_spool");
+    auto sink = std::make_shared<RecordingSink>();
+    sink->fail = true;
+    {
+        Forwarder forwarder(sink, Forwarder::Options(2, std::chrono::milliseconds(60000), 1, spool, 64 * 1024,
+                                                     Compression::Deflate, 1, std::chrono::milliseconds(10)));
+        forwarder.start();
+        for (unsigned long long i = 0; i < 8; ++i) forwarder.submit(makeSnapshot(i));
+        EXPECT_FALSE(forwarder.flush(std::chrono::milliseconds(50)));
+        forwarder.stop(); // Whatever is still queued lands in the spool
+        Forwarder::Stats stats = forwarder.stats();
+        EXPECT_EQ(stats.dropped_batches, 0u);
+        EXPECT_EQ(stats.spool_batches, 4u);
+        EXPECT_GT(stats.send_failures, 0u);
+    }
+
+    sink->fail = false;
+    Forwarder restarted(sink, Forwarder::Options(2, std::chrono::milliseconds(60000), 1, spool));
+    EXPECT_EQ(restarted.stats().spool_batches, 4u);
+    restarted.start();
+    restarted.submit(makeSnapshot(8));
+    ASSERT_TRUE(restarted.flush(std::chrono::milliseconds(5000)));
+    EXPECT_EQ(sink->timestamps(), (std::vector<std::uint64_t>{0, 1, 2, 3, 4, 5, 6, 7, 8}));
+    EXPECT_EQ(restarted.stats().spool_batches, 0u);
+    restarted.stop();
+    std::remove(spool.c_str());
+}
+
+TEST(ForwarderTest, Forwarder_SpoolsBatchInFlightAheadOfOverflow) {
+    const std::string spool = tempPath("forwarder_inflight");
+    auto sink = std::make_shared<GatedSink>();
+    sink->fail = true;
+    Forwarder forwarder(sink, Forwarder::Options(1, std::chrono::milliseconds(60000), 1, spool, 64 * 1024,
+                                                 Compression::Deflate, 1, std::chrono::milliseconds(10)));
+    forwarder.start();
+    forwarder.submit(makeSnapshot(0));
+    while (!sink->entered.load()) std::this_thread::yield();
+    forwarder.submit(makeSnapshot(1)); // Overflows while 0 is in flight
+    forwarder.submit(makeSnapshot(2));
+    sink->open = true;                 // ... and the send of 0 fails
+
+    while (forwarder.stats().send_failures == 0) std::this_thread::yield();
+    sink->fail = false;
+    ASSERT_TRUE(forwarder.flush(std::chrono::milliseconds(5000)));
+    EXPECT_EQ(sink->timestamps(), (std::vector<std::uint64_t>{0, 1, 2}));
+    EXPECT_EQ(forwarder.stats().dropped_batches, 0u);
+    forwarder.stop();
+    std::remove(spool.c_str());
+}
+
+TEST(ForwarderTest, FileSink_WritesLengthPrefixedBatches) {
+    const std::string path = tempPath("forwarder_file");
+    {
+        Forwarder forwarder(std::make_shared<FileSink>(path), Forwarder::Options(2, std::chrono::milliseconds(60000)));
+        forwarder.start();
+        for (unsigned long long i = 0; i < 5; ++i) forwarder.submit(makeSnapshot(i));
+        ASSERT_TRUE(forwarder.flush(std::chrono::milliseconds(5000)));
+    }
+    std::ifstream in(path, std::ios::binary);
+    std::vector<std::uint8_t> stream((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    std::vector<std::vector<std::uint8_t>> frames = splitFrames(stream);
+    ASSERT_EQ(frames.size(), 3u);
+    std::vector<MetricsSnapshot> snapshots;
+    for (const auto& frame : frames) decodeBatch(ByteSpan(frame), snapshots);
+    ASSERT_EQ(snapshots.size(), 5u);
+    EXPECT_EQ(snapshots[4].nets[0].bytes_received, makeSnapshot(4).nets[0].bytes_received);
+    std::remove(path.c_str());
+}
+
+TEST(ForwarderTest, SocketSinks_DeliverToLocalReceivers) {
+    // TCP
+    int listener = ::socket(AF_INET, SOCK_STREAM, 0);
+    ASSERT_GE(listener, 0);
+    struct sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    ASSERT_EQ(::bind(listener, reinterpret_cast<struct sockaddr*>(&addr), sizeof(addr)), 0);
+    ASSERT_EQ(::listen(listener, 1), 0);
+    socklen_t len = sizeof(addr);
+    ::getsockname(listener, reinterpret_cast<struct sockaddr*>(&addr), &len);
+
+    // Unix domain
+    const std::string unix_path = tempPath("forwarder_sock");
+    int unix_listener = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    ASSERT_GE(unix_listener, 0);
+    struct sockaddr_un unix_addr{};
+    unix_addr.sun_family = AF_UNIX;
+    std::snprintf(unix_addr.sun_path, sizeof(unix_addr.sun_path), "%s", unix_path.c_str());
+    ASSERT_EQ(::bind(unix_listener, reinterpret_cast<struct sockaddr*>(&unix_addr), sizeof(unix_addr)), 0);
+    ASSERT_EQ(::listen(unix_listener, 1), 0);
+
+    auto receive = [](int fd, std::vector<std::uint8_t>& out) {
+        int conn = ::accept(fd, nullptr, nullptr);
+        char buffer[4096];
+        ssize_t n;
+        while ((n = ::recv(conn, buffer, sizeof(buffer), 0)) > 0) out.insert(out.end(), buffer, buffer + n);
+        ::close(conn);
+    };
+    std::vector<std::uint8_t> tcp_stream, unix_stream;
+    std::thread tcp_receiver(receive, listener, std::ref(tcp_stream));
+    std::thread unix_receiver(receive, unix_listener, std::ref(unix_stream));
+    {
+        Forwarder tcp(std::make_shared<TcpSink>("127.0.0.1", ntohs(addr.sin_port)), Forwarder::Options(2));
+        Forwarder unix_forwarder(std::make_shared<UnixSocketSink>(unix_path), Forwarder::Options(2));
+        tcp.start();
+        unix_forwarder.start();
+        for (unsigned long long i = 0; i < 4; ++i) {
+            tcp.submit(makeSnapshot(i));
+            unix_forwarder.submit(makeSnapshot(i));
+        }
+        EXPECT_TRUE(tcp.flush(std::chrono::milliseconds(5000)));
+        EXPECT_TRUE(unix_forwarder.flush(std::chrono::milliseconds(5000)));
+    } // Destroying the sinks closes the connections
+    tcp_receiver.join();
+    unix_receiver.join();
+    ::close(listener);
+    ::close(unix_listener);
+    std::remove(unix_path.c_str());
+
+    for (const auto* stream : {&tcp_stream, &unix_stream}) {
+        std::vector<MetricsSnapshot> snapshots;
+        for (const auto& frame : splitFrames(*stream)) decodeBatch(ByteSpan(frame), snapshots);
+        ASSERT_EQ(snapshots.size(), 4u);
+        EXPECT_EQ(snapshots[3].timestamp_ms, makeSnapshot(3).timestamp_ms);
+    }
+}
+#endif
+
+TEST(ForwarderTest, DecodeBatch_RejectsMalformedInput) {
+    std::vector<MetricsSnapshot> out;
+    std::vector<std::uint8_t> garbage = {'X', 'B', 1, 0, 0, 0};
+    EXPECT_THROW(decodeBatch(ByteSpan(garbage), out), std::runtime_error);
+    std::vector<std::uint8_t> bad_compression = {'M', 'B', 1, 9, 0, 0};
+    EXPECT_THROW(decodeBatch(ByteSpan(bad_compression), out), std::runtime_error);
+    std::vector<std::uint8_t> truncated = {'M', 'B', 1, 0, 2, 50, 1, 2};
+    EXPECT_THROW(decodeBatch(ByteSpan(truncated), out), std::runtime_error);
+    EXPECT_THROW(Forwarder(nullptr), std::invalid_argument);
+}
@@ -0,0 +1,189 @@
+#include <gtest/gtest.h>
+#include "fs_stats.hpp"
+#include "proc_source.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+
+using namespace SystemDiskStats;
+using SystemProcFS::ScopedProcSource;
+using SystemProcFS::VirtualProcSource;
+
+namespace {
+const char* kMountInfo =
+    "23 28 0:22 / /proc rw,relatime - proc proc rw\n"
+    "28 1 254:0 / / rw,relatime shared:1 - ext4 /dev/vda rw,discard\n"
+    "29 28 254:16 / /mnt/My\\040Disk ro,nosuid,nodev,relatime shared:5 master:2 - ext4 /dev/vdb ro\n"
+    "31 26 0:27 / /dev/shm rw,relatime - tmpfs tmpfs rw,size=6147400k\n"
+    "33 32 0:29 / /sys/fs/cgroup/cpu rw,relatime - cgroup cgroup rw,cpu\n"
+    "45 28 254:0 /srv/data /data rw,relatime - ext4 /dev/vda rw,discard\n"
+    "50 28 0:51 / /net/home rw,relatime - nfs4 server:/export/home rw,vers=4.2\n";
+
+// Capacity keyed by mount point; counts calls.
+struct FakeStat {
+    std::map<std::string, std::uint64_t> sizes;
+    std::atomic<int> calls{0};
+
+    FilesystemCollector::StatFunction function() {
+        return [this](const std::string& mount_point, FilesystemUsage& usage) {
+            ++calls;
+            const auto found = sizes.find(mount_point);
+            if (found == sizes.end()) return false;
+            usage.size_bytes = found->second;
+            usage.free_bytes = found->second / 4;
+            usage.available_bytes = found->second / 8;
+            usage.used_bytes = usage.size_bytes - usage.free_bytes;
+            return true;
+        };
+    }
+};
+
+const FilesystemUsage* find(const std::vector<FilesystemUsage>& usage, const std::string& mount_point) {
+    for (const auto& entry : usage) {
+        if (entry.mount_point == mount_point) return &entry;
+    }
+    return nullptr;
+}
+} // namespace
+
+TEST(FsStatsTest, MountInfo_ParsesOptionalFieldsAndEscapes) {
+    std::vector<MountEntry> mounts;
+    MountInfoReader::parse(kMountInfo, mounts);
+    ASSERT_EQ(mounts.size(), 7u);
+    EXPECT_EQ(mounts[1].mount_id, 28u);
+    EXPECT_EQ(mounts[1].major, 254u);
+    EXPECT_EQ(mounts[1].minor, 0u);
+    EXPECT_EQ(mounts[1].mount_point, "/");
+    EXPECT_EQ(mounts[1].fs_type, "ext4");
+    EXPECT_EQ(mounts[1].source, "/dev/vda");
+    EXPECT_FALSE(mounts[1].read_only);
+    EXPECT_EQ(mounts[2].mount_point, "/mnt/My Disk");
+    EXPECT_TRUE(mounts[2].read_only);
+    EXPECT_EQ(mounts[5].root, "/srv/data");
+    EXPECT_EQ(mounts[6].source, "server:/export/home");
+    EXPECT_EQ(mounts[4].super_options, "rw,cpu");
+
+    EXPECT_TRUE(MountInfoReader::isPseudoFilesystem("cgroup2"));
+    EXPECT_TRUE(MountInfoReader::isPseudoFilesystem("proc"));
+    EXPECT_FALSE(MountInfoReader::isPseudoFilesystem("tmpfs"));
+    EXPECT_FALSE(MountInfoReader::isPseudoFilesystem("nfs4"));
+
+    EXPECT_THROW(MountInfoReader::parse("28 1 254:0 / / rw,relatime shared:1 ext4\n", mounts), std::runtime_error);
+    EXPECT_THROW(MountInfoReader::parse("28 1 254 / / rw - ext4 /dev/vda rw\n", mounts), std::runtime_error);
+}
+
+TEST(FsStatsTest, Collect_FiltersPseudoAndBindMountsAndRereadsChangedTable) {
+    auto source = std::make_shared<VirtualProcSource>();
+    source->setSequence("/proc/self/mountinfo",
+                        {kMountInfo, kMountInfo, std::string(kMountInfo) + "60 28 8:1 / /boot rw - xfs /dev/sda1 rw\n"});
+    ScopedProcSource scoped(source);
+
+    FakeStat fake;
+    fake.sizes = {{"/", 8000}, {"/mnt/My Disk", 800}, {"/dev/shm", 80}, {"/boot", 400}};
+    FilesystemCollector::Options options;
+    options.stat = fake.function();
+    FilesystemCollector collector(options);
+
+    std::vector<FilesystemUsage> usage = collector.collect();
+    // proc and cgroup are pseudo; /data is a bind mount of the root device.
+    ASSERT_EQ(usage.size(), 4u);
+    EXPECT_EQ(usage[0].mount_point, "/");
+    EXPECT_EQ(usage[0].status, FilesystemStatus::Ok);
+    EXPECT_EQ(usage[0].size_bytes, 8000u);
+    EXPECT_EQ(usage[0].used_bytes, 6000u);
+    EXPECT_DOUBLE_EQ(usage[0].usedPercent(), 100.0 * 6000 / 7000);
+    EXPECT_TRUE(usage[1].read_only);
+    EXPECT_EQ(usage[3].mount_point, "/net/home");
+    EXPECT_EQ(usage[3].status, FilesystemStatus::Failed);
+    EXPECT_STREQ(filesystemStatusName(usage[3].status), "failed");
+    EXPECT_EQ(usage[3].size_bytes, 0u);
+    EXPECT_EQ(fake.calls.load(), 4);
+    EXPECT_EQ(collector.mountTableReads(), 1u);
+
+    source->advance();
+    collector.collect(usage);
+    EXPECT_EQ(collector.mountTableReads(), 1u); // Unchanged table, not re-parsed
+    EXPECT_EQ(fake.calls.load(), 8);
+
+    source->advance();
+    collector.collect(usage);
+    EXPECT_EQ(collector.mountTableReads(), 2u);
+    ASSERT_EQ(usage.size(), 5u);
+    EXPECT_EQ(usage[4].mount_point, "/boot");
+    EXPECT_EQ(usage[4].size_bytes, 400u);
+
+    FilesystemCollector::Options pseudo_options = options;
+    pseudo_options.include_pseudo = true;
+    FilesystemCollector with_pseudo(pseudo_options);
+    EXPECT_EQ(with_pseudo.collect().size(), 7u);
+}
+
+TEST(FsStatsTest, Collect_TimesOutHungMountWithoutResubmitting) {
+    auto source = std::make_shared<VirtualProcSource>();
+    source->setFile("/proc/self/mountinfo", kMountInfo);
+    ScopedProcSource scoped(source);
+
+    std::mutex mutex;
+    std::condition_variable released;
+    bool release = false;
+    std::atomic<int> hung_calls{0};
+    FilesystemCollector::Options options;
+    options.timeout = std::chrono::milliseconds(100);
+    options.threads = 2;
+    options.stat = [&](const std::string& mount_point, FilesystemUsage& usage) {
+        if (mount_point == "/net/home") {
+            ++hung_calls;
+            std::unique_lock<std::mutex> lock(mutex);
+            released.wait(lock, [&] { return release; });
+        }
+        usage.size_bytes = 1000;
+        usage.available_bytes = 500;
+        usage.used_bytes = 500;
+        return true;
+    };
+    {
+        FilesystemCollector collector(options);
+        const auto start = std::chrono::steady_clock::now();
+        std::vector<FilesystemUsage> usage = collector.collect();
+        EXPECT_LT(std::chrono::steady_clock::now() - start, std::chrono::seconds(5));
+        ASSERT_NE(find(usage, "/net/home"), nullptr);
+        EXPECT_EQ(find(usage, "/net/home")->status, FilesystemStatus::TimedOut);
+        EXPECT_EQ(find(usage, "/")->status, FilesystemStatus::Ok);
+        EXPECT_EQ(find(usage, "/dev/shm")->status, FilesystemStatus::Ok);
+
+        // Still hung: reported without another call, and the other mounts keep being served.
+        usage = collector.collect();
+        EXPECT_EQ(find(usage, "/net/home")->status, FilesystemStatus::TimedOut);
+        EXPECT_EQ(find(usage, "/")->status, FilesystemStatus::Ok);
+        EXPECT_EQ(hung_calls.load(), 1);
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            release = true;
+        }
+        released.notify_all();
+        for (int attempt = 0; attempt < 50; ++attempt) {
+            usage = collector.collect();
+            if (find(usage, "/net/home")->status == FilesystemStatus::Ok) break;
+        }
+        EXPECT_EQ(find(usage, "/net/home")->status, FilesystemStatus::Ok);
+        EXPECT_EQ(find(usage, "/net/home")->size_bytes, 1000u);
+    }
+}
+
+#if defined(__linux__)
+TEST(FsStatsTest, Collect_ReadsLiveMountTableOnce) {
+    FilesystemCollector collector;
+    std::vector<FilesystemUsage> usage = collector.collect();
+    ASSERT_FALSE(usage.empty());
+    for (const auto& entry : usage) EXPECT_FALSE(MountInfoReader::isPseudoFilesystem(entry.fs_type));
+    collector.collect(usage);
+    EXPECT_EQ(collector.mountTableReads(), 1u); // No POLLPRI without a mount or unmount
+}
+#endif
@@ -0,0 +1,167 @@
+#include <gtest/gtest.h>
+#include "interrupt_stats.hpp"
+#include "proc_source.hpp"
+#include "test_clock.hpp"
+
+#include <chrono>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using namespace SystemInterruptStats;
+using SystemProcFS::ScopedProcSource;
+using SystemProcFS::VirtualProcSource;
+using TestClock::at;
+
+namespace {
+const char* kInterrupts =
+    "           CPU0       CPU1       CPU3\n"
+    "  0:         44          0          0   IO-APIC   2-edge      timer\n"
+    " 24:    1000000         10          5  IR-PCI-MSI 1048576-edge      eth0-TxRx-0\n"
+    "NMI:          7          8          9   Non-maskable interrupts\n"
+    "LOC:   12345678   23456789   34567890   Local timer interrupts\n"
+    "ERR:          3\n"
+    "MIS:          0\n";
+
+const char* kSoftirqs =
+    "                    CPU0       CPU1\n"
+    "          HI:          1          0\n"
+    "      NET_RX:     500000        100\n"
+    "       TIMER:       2000       3000\n";
+} // namespace
+
+TEST(InterruptStatsTest, Parse_BuildsRowMajorMatrixWithDescriptions) {
+    InterruptMatrix matrix;
+    InterruptStatsReader::parse(kInterrupts, matrix);
+
+    EXPECT_EQ(matrix.cpus, (std::vector<unsigned>{0, 1, 3}));
+    ASSERT_EQ(matrix.rows(), 6u);
+    EXPECT_EQ(matrix.names[1], "24");
+    EXPECT_EQ(matrix.descriptions[1], "IR-PCI-MSI 1048576-edge      eth0-TxRx-0");
+    EXPECT_EQ(matrix.descriptions[0], "IO-APIC   2-edge      timer");
+    EXPECT_EQ(matrix.at(1, 0), 1000000u);
+    EXPECT_EQ(matrix.at(1, 2), 5u);
+    EXPECT_EQ(matrix.at(3, 2), 34567890u);
+    // System-wide rows carry one counter and are zero-padded.
+    EXPECT_EQ(matrix.find("ERR"), 4);
+    EXPECT_EQ(matrix.at(4, 0), 3u);
+    EXPECT_EQ(matrix.at(4, 1), 0u);
+    EXPECT_EQ(matrix.descriptions[4], "");
+    EXPECT_EQ(matrix.find("nope"), -1);
+
+    // Reparsing a smaller table into the same matrix drops the extra rows and columns.
+    InterruptStatsReader::parse(kSoftirqs, matrix);
+    EXPECT_EQ(matrix.cpus, (std::vector<unsigned>{0, 1}));
+    ASSERT_EQ(matrix.rows(), 3u);
+    EXPECT_EQ(matrix.counts.size(), 6u);
+    EXPECT_EQ(matrix.names[1], "NET_RX");
+    EXPECT_EQ(matrix.at(1, 0), 500000u);
+    EXPECT_EQ(matrix.descriptions[1], "");
+}
+
+TEST(InterruptStatsTest, Parse_RejectsMissingOrMalformedHeader) {
+    InterruptMatrix matrix;
+    EXPECT_THROW(InterruptStatsReader::parse("", matrix), std::runtime_error);
+    EXPECT_THROW(InterruptStatsReader::parse("  0: 1 2\n", matrix), std::runtime_error);
+    EXPECT_THROW(InterruptStatsReader::parse("   CPU0  CPUx\n", matrix), std::runtime_error);
+}
+
+TEST(InterruptStatsTest, Collector_ComputesPerIrqAndPerCpuRates) {
+    auto source = std::make_shared<VirtualProcSource>();
+    source->setSequence("/proc/softirqs", {
+        "        CPU0       CPU1\n"
+        "    HI:          1          0\n"
+        "NET_RX:     500000        100\n"
+        " TIMER:       2000       3000\n",
+        "        CPU0       CPU1\n"
+        "    HI:          1          0\n"
+        "NET_RX:     520000        140\n"
+        " TIMER:       2200       3100\n"});
+    ScopedProcSource scoped(source);
+
+    InterruptCollector collector(InterruptTable::Soft);
+    collector.sample(at(10));
+    EXPECT_FALSE(collector.hasRates());
+    EXPECT_TRUE(collector.hottest(3).empty());
+
+    source->advance();
+    collector.sample(at(12));
+    ASSERT_TRUE(collector.hasRates());
+    const InterruptRates& rates = collector.rates();
+    EXPECT_DOUBLE_EQ(rates.elapsed_seconds, 2.0);
+    EXPECT_EQ(rates.deltas, (std::vector<std::uint64_t>{0, 0, 20000, 40, 200, 100}));
+    EXPECT_DOUBLE_EQ(rates.per_irq[1], 10020.0);
+    EXPECT_DOUBLE_EQ(rates.per_irq[2], 150.0);
+    EXPECT_DOUBLE_EQ(rates.per_cpu[0], 10100.0);
+    EXPECT_DOUBLE_EQ(rates.per_cpu[1], 70.0);
+    EXPECT_DOUBLE_EQ(rates.rate(1, 1), 20.0);
+
+    const auto hot = collector.hottest(5);
+    ASSERT_EQ(hot.size(), 2u); // HI did not fire
+    EXPECT_EQ(hot[0].name, "NET_RX");
+    EXPECT_DOUBLE_EQ(hot[0].rate, 10020.0);
+    EXPECT_EQ(hot[0].busiest_cpu, 0u);
+    EXPECT_DOUBLE_EQ(hot[0].busiest_cpu_rate, 10000.0);
+    EXPECT_EQ(hot[1].name, "TIMER");
+    EXPECT_EQ(collector.hottest(1).size(), 1u);
+}
+
+TEST(InterruptStatsTest, Collector_AlignsRowsAndCpusAcrossLayoutChanges) {
+    auto source = std::make_shared<VirtualProcSource>();
+    source->setSequence("/proc/interrupts", {
+        "      CPU0   CPU1   CPU2\n"
+        " 24:   100    200    300  PCI-MSI eth0\n"
+        " 25:    10     20     30  PCI-MSI eth1\n",
+        // CPU1 went offline, IRQ 25 was freed and IRQ 26 appeared; 24 wrapped on CPU0.
+        "      CPU0   CPU2\n"
+        " 26:     5      6  PCI-MSI nvme0q1\n"
+        " 24:    50    330  PCI-MSI eth0\n"});
+    ScopedProcSource scoped(source);
+
+    InterruptCollector collector(InterruptTable::Hardware);
+    collector.sample(at(0));
+    source->advance();
+    collector.sample(at(1));
+
+    const InterruptMatrix& matrix = collector.current();
+    EXPECT_EQ(matrix.cpus, (std::vector<unsigned>{0, 2}));
+    EXPECT_EQ(matrix.names, (std::vector<std::string>{"26", "24"}));
+    // New row: no delta this interval. Row 24: CPU0 went backwards (reset), CPU2 rose by 30.
+    EXPECT_EQ(collector.rates().deltas, (std::vector<std::uint64_t>{0, 0, 0, 30}));
+    EXPECT_DOUBLE_EQ(collector.rates().per_cpu[1], 30.0);
+}
+
+TEST(InterruptStatsTest, Collector_HandlesThirtyTwoBitWrap) {
+    auto source = std::make_shared<VirtualProcSource>();
+    source->setSequence("/proc/interrupts", {
+        "      CPU0\n LOC: 4294967290  Local timer interrupts\n",
+        "      CPU0\n LOC:         10  Local timer interrupts\n"});
+    ScopedProcSource scoped(source);
+
+    InterruptCollector collector(InterruptTable::Hardware);
+    collector.sample(at(0));
+    source->advance();
+    collector.sample(at(1));
+    EXPECT_EQ(collector.rates().deltas, (std::vector<std::uint64_t>{16}));
+}
+
+TEST(InterruptStatsTest, Read_ThrowsWhenTableIsMissing) {
+    ScopedProcSource scoped(std::make_shared<VirtualProcSource>());
+    InterruptMatrix matrix;
+    std::string buffer;
+    EXPECT_THROW(InterruptStatsReader::read(InterruptTable::Soft, matrix, buffer), std::runtime_error);
+}
+
+#if defined(__linux__)
+TEST(InterruptStatsTest, Collector_ReadsLiveTables) {
+    for (InterruptTable table : {InterruptTable::Hardware, InterruptTable::Soft}) {
+        InterruptCollector collector(table);
+        collector.sample();
+        collector.sample();
+        EXPECT_GT(collector.current().columns(), 0u);
+        EXPECT_GT(collector.current().rows(), 0u);
+        EXPECT_EQ(collector.rates().deltas.size(), collector.current().counts.size());
+    }
+}
+#endif
@@ -0,0 +1,102 @@
+#include <gtest/gtest.h>
+#include "key_value_reader.hpp"
+#include "mem_stats.hpp"
+#include "proc_source.hpp"
+
+#include <memory>
+#include <set>
+#include <stdexcept>
+#include <string>
+
+using SystemProcFS::KeyField;
+using SystemProcFS::KeyValueProcReader;
+
+namespace {
+struct VmCounters {
+    unsigned long long pgfault = 0;
+    unsigned long long pgmajfault = 0;
+    unsigned long long pswpin = 0;
+    unsigned long long pswpout = 0;
+    unsigned long long oom_kill = 0;
+};
+
+// vmstat-style: space-separated key, no unit
+struct VmstatSchema {
+    using Record = VmCounters;
+    static constexpr std::string_view name = "vmstat";
+    static constexpr char separator = ' ';
+    static constexpr std::string_view unit = "";
+    static constexpr KeyField<VmCounters> fields[] = {
+        {"pgfault", &VmCounters::pgfault},
+        {"pgmajfault", &VmCounters::pgmajfault},
+        {"pswpin", &VmCounters::pswpin},
+        {"pswpout", &VmCounters::pswpout},
+        {"oom_kill", &VmCounters::oom_kill},
+    };
+};
+using VmstatReader = KeyValueProcReader<VmstatSchema>;
+} // namespace
+
+TEST(KeyValueReaderTest, Lookup_MapsEverySchemaKeyToItsOwnField) {
+    std::set<int> indices;
+    for (const auto& field : VmstatSchema::fields) {
+        const int index = VmstatReader::lookup(field.key);
+        ASSERT_GE(index, 0) << field.key;
+        EXPECT_EQ(VmstatSchema::fields[index].key, field.key);
+        indices.insert(index);
+    }
+    EXPECT_EQ(indices.size(), VmstatReader::kFieldCount);
+    EXPECT_EQ(VmstatReader::lookup("pgfaul"), -1);
+    EXPECT_EQ(VmstatReader::lookup("pgfaults"), -1);
+    EXPECT_EQ(VmstatReader::lookup("nr_free_pages"), -1);
+    EXPECT_EQ(VmstatReader::lookup(""), -1);
+}
+
+TEST(KeyValueReaderTest, Parse_SkipsUnknownKeysAndKeepsAbsentFields) {
+    VmCounters out;
+    out.oom_kill = 7;
+    const std::size_t assigned = VmstatReader::parse(
+        "nr_free_pages 1000\npgfault 123456\nbogus\npswpin 5\npgmajfault 42\npswpout 6\n", out);
+    EXPECT_EQ(assigned, 4u);
+    EXPECT_EQ(out.pgfault, 123456u);
+    EXPECT_EQ(out.pgmajfault, 42u);
+    EXPECT_EQ(out.pswpin, 5u);
+    EXPECT_EQ(out.pswpout, 6u);
+    EXPECT_EQ(out.oom_kill, 7u); // Not in the text
+}
+
+TEST(KeyValueReaderTest, Parse_RejectsMalformedValueOrUnit) {
+    VmCounters vm;
+    EXPECT_THROW(VmstatReader::parse("pgfault abc\n", vm), std::runtime_error);
+    EXPECT_THROW(VmstatReader::parse("pgfault 12 kB\n", vm), std::runtime_error);
+    EXPECT_THROW(VmstatReader::parse("pgfault 18446744073709551616\n", vm), std::runtime_error); // 2^64
+    EXPECT_THROW(VmstatReader::parse("pgfault 99999999999999999999\n", vm), std::runtime_error);
+    VmstatReader::parse("pgfault 18446744073709551615\n", vm);
+    EXPECT_EQ(vm.pgfault, 18446744073709551615u);
+    EXPECT_NO_THROW(VmstatReader::parse("unknown abc\n", vm)); // Only schema keys are validated
+}
+
+#if defined(__linux__)
+TEST(KeyValueReaderTest, MemStats_ReadsMeminfoThroughSchema) {
+    auto source = std::make_shared<SystemProcFS::VirtualProcSource>();
+    source->setFile("/proc/meminfo",
+                    "MemTotal:       16000000 kB\nMemFree:         2000000 kB\nMemAvailable:    8000000 kB\n"
+                    "Buffers:          300000 kB\nCached:          4000000 kB\nSwapCached:            0 kB\n"
+                    "Active:          5000000 kB\nSwapTotal:       1000000 kB\nSwapFree:         900000 kB\n");
+    SystemProcFS::ScopedProcSource scoped(source);
+
+    std::string buffer;
+    SystemMemoryStats::MemStats stats;
+    SystemMemoryStats::MeMStatsReader::getMemStats(stats, buffer);
+    EXPECT_EQ(stats.total, 16000000u);
+    EXPECT_EQ(stats.free, 2000000u);
+    EXPECT_EQ(stats.available, 8000000u);
+    EXPECT_EQ(stats.buffers, 300000u);
+    EXPECT_EQ(stats.cached, 4000000u); // Not confused with SwapCached
+    EXPECT_EQ(stats.swap_total, 1000000u);
+    EXPECT_EQ(stats.swap_free, 900000u);
+
+    source->setFile("/proc/meminfo", "MemTotal: 100 MB\n");
+    EXPECT_THROW(SystemMemoryStats::MeMStatsReader::getMemStats(stats, buffer), std::runtime_error);
+}
+#endif
@@ -0,0 +1,125 @@
+#include <gtest/gtest.h>
+#include "metrics_snapshot.hpp"
+#include "proc_source.hpp"
+
+#include <atomic>
+#include <cstdlib>
+#include <memory>
+#include <new>
+#include <stdexcept>
+#include <type_traits>
+
+using namespace SystemMetricsSnapshot;
+
+#if defined(__linux__)
+// Global allocation counter for the zero-allocation collection test. Only allocations made by
+// the thread that enabled counting are recorded.
+namespace {
+std::atomic<unsigned long long> g_allocations{0};
+thread_local bool g_count_allocations = false;
+
+class AllocationCounter {
+public:
+    AllocationCounter() : start_(g_allocations.load()) { g_count_allocations = true; }
+    ~AllocationCounter() { g_count_allocations = false; }
+    unsigned long long count() const { return g_allocations.load() - start_; }
+
+private:
+    unsigned long long start_;
+};
+} // namespace
+
+// Kept out of line so that GCC does not pair the inlined malloc/free with new/delete expressions.
+__attribute__((noinline)) void* operator new(std::size_t size) {
+    if (g_count_allocations) ++g_allocations;
+    if (void* p = std::malloc(size ? size : 1)) return p;
+    throw std::bad_alloc();
+}
+__attribute__((noinline)) void operator delete(void* p) noexcept { std::free(p); }
+__attribute__((noinline)) void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+#endif
+
+#if defined(__linux__)
+TEST(SnapshotCollectorTest, Collect_FillsEverySubsystemFromSource) {
+    auto source = std::make_shared<SystemProcFS::VirtualProcSource>();
+    source->setFile("/proc/stat", "cpu  10 20 30 40 0 0 0 0 0 0\n");
+    source->setFile("/proc/meminfo", "MemTotal: 1000 kB\nMemFree: 500 kB\n");
+    source->setFile("/proc/diskstats",
+                    "   8       0 sda 1 0 2 3 4 0 5 6 0 0 0 0\n"
+                    " 259       0 nvme0n1 1 0 10 3 4 0 20 6 0 0 0 0\n");
+    source->setFile("/proc/net/dev",
+                    "header1\nheader2\n"
+                    "    lo: 1 2 3 4 0 0 0 0 5 6 7 8 0 0 0 0\n"
+                    "  eth0: 9 9 9 9 0 0 0 0 9 9 9 9 0 0 0 0\n");
+    SystemProcFS::ScopedProcSource scoped(source);
+
+    MetricsSnapshot snapshot = SnapshotCollector::collect();
+    EXPECT_GT(snapshot.timestamp_ms, 0ULL);
+    EXPECT_DOUBLE_EQ(snapshot.cpu.system, 30.0);
+    EXPECT_EQ(snapshot.mem.total, 1000ULL);
+    ASSERT_EQ(snapshot.disks.size(), 2u);
+    EXPECT_EQ(snapshot.disks[1].device, "nvme0n1");
+    EXPECT_EQ(snapshot.disks[1].write_bytes, 20ULL * 512ULL);
+    ASSERT_EQ(snapshot.nets.size(), 2u);
+    EXPECT_EQ(snapshot.nets[0].interface_name, "lo");
+    EXPECT_EQ(snapshot.nets[0].drops_out, 8ULL);
+
+    // Collecting into an existing snapshot overwrites it.
+    source->removeFile("/proc/diskstats");
+    source->setFile("/proc/diskstats", "   8       0 sda 1 0 2 3 4 0 5 6 0 0 0 0\n");
+    SnapshotCollector::collect(snapshot);
+    EXPECT_EQ(snapshot.disks.size(), 1u);
+}
+
+TEST(SnapshotCollectorTest, RecordCollector_SteadyStateDoesNotAllocate) {
+    static_assert(std::is_trivially_copyable<SystemDiskStats::DiskRecord>::value, "");
+    static_assert(std::is_trivially_copyable<SystemNetStats::NetRecord>::value, "");
+
+    auto source = std::make_shared<SystemProcFS::VirtualProcSource>();
+    source->setFile("/proc/stat", "cpu  10 20 30 40 0 0 0 0 0 0\ncpu0 10 20 30 40 0 0 0 0 0 0\n");
+    source->setFile("/proc/meminfo", "MemTotal:       1000 kB\nMemFree:         500 kB\nSwapFree:          7 kB\n");
+    source->setFile("/proc/diskstats",
+                    "   8       0 sda 1 0 2 3 4 0 5 6 0 0 0 0\n"
+                    "   8       1 sda1 1 0 2 3 4 0 5 6 0 0 0 0\n"
+                    " 259       0 nvme0n1 1 0 10 3 4 0 20 6 0 0 0 0 0 0 0 0 0 0\n");
+    source->setFile("/proc/net/dev",
+                    "header1\nheader2\n"
+                    "    lo: 1 2 3 4 0 0 0 0 5 6 7 8 0 0 0 0\n"
+                    "  eth0:123456789012 9 9 9 0 0 0 0 9 9 9 9 0 0 0 0\n"
+                    "veth1a: 1 1 1 1 0 0 0 0 1 1 1 1 0 0 0 0\n");
+    SystemProcFS::ScopedProcSource scoped(source);
+
+    RecordCollector collector;
+    FixedSnapshot fixed;
+    collector.collect(fixed); // Warm-up grows the buffers and interns the names
+    {
+        AllocationCounter counter;
+        for (int i = 0; i < 100; ++i) collector.collect(fixed);
+        EXPECT_EQ(counter.count(), 0u);
+    }
+    {
+        AllocationCounter counter; // The string-based path allocates; proves the counter is live
+        SnapshotCollector::collect();
+        EXPECT_GT(counter.count(), 0u);
+    }
+
+    EXPECT_DOUBLE_EQ(fixed.cpu.idle, 40.0);
+    EXPECT_EQ(fixed.mem.swap_free, 7ULL);
+    ASSERT_EQ(fixed.disks.size(), 2u);
+    ASSERT_EQ(fixed.nets.size(), 2u);
+    EXPECT_EQ(fixed.nets[1].bytes_received, 123456789012ULL);
+
+    MetricsSnapshot expanded;
+    fixed.expand(expanded);
+    EXPECT_EQ(expanded.disks[1].device, "nvme0n1");
+    EXPECT_EQ(expanded.disks[1].write_bytes, 20ULL * 512ULL);
+    EXPECT_EQ(expanded.nets[1].interface_name, "eth0");
+    EXPECT_EQ(expanded.nets[0].drops_out, 8ULL);
+}
+
+TEST(SnapshotCollectorTest, Collect_PropagatesReaderFailure) {
+    auto source = std::make_shared<SystemProcFS::VirtualProcSource>();
+    SystemProcFS::ScopedProcSource scoped(source);
+    EXPECT_THROW(SnapshotCollector::collect(), std::runtime_error);
+}
+#endif
@@ -0,0 +1,81 @@
+#include <gtest/gtest.h>
+#include "name_index.hpp"
+#include "proc_source.hpp"
+#include "disk_stats.hpp"
+#include "net_stats.hpp"
+
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using namespace SystemMetricsIndex;
+
+TEST(NameIndexTest, Interner_IssuesStableIds) {
+    NameInterner interner;
+    const NameId sda = interner.intern("sda");
+    const NameId nvme = interner.intern("nvme0n1");
+    EXPECT_NE(sda, nvme);
+    EXPECT_EQ(interner.intern(std::string("sda")), sda);
+    EXPECT_EQ(interner.find("nvme0n1"), nvme);
+    EXPECT_EQ(interner.find("sdz"), kNoName);
+    EXPECT_EQ(interner.name(nvme), "nvme0n1");
+    EXPECT_EQ(interner.size(), 2u);
+    EXPECT_THROW(interner.name(99), std::out_of_range);
+}
+
+TEST(NameIndexTest, Index_FindsEveryPositionAndRejectsUnknownIds) {
+    std::vector<NameId> ids;
+    for (NameId id = 0; id < 200; ++id) ids.push_back(id * 7);
+    ids.push_back(14); // Duplicate of position 2; the first occurrence wins
+    NameIndex index(ids);
+    for (std::size_t position = 0; position < 200; ++position) {
+        EXPECT_EQ(index.find(ids[position]), position);
+    }
+    EXPECT_EQ(index.find(3), NameIndex::npos);
+    EXPECT_EQ(index.find(kNoName), NameIndex::npos);
+    EXPECT_EQ(NameIndex().find(0), NameIndex::npos);
+}
+
+TEST(NameIndexTest, ReuseOrBuild_SharesIndexWhileLayoutIsUnchanged) {
+    auto first = NameIndex::reuseOrBuild(nullptr, {1, 2, 3});
+    EXPECT_EQ(NameIndex::reuseOrBuild(first, {1, 2, 3}), first);
+    auto reordered = NameIndex::reuseOrBuild(first, {2, 1, 3});
+    EXPECT_NE(reordered, first);
+    EXPECT_EQ(reordered->find(2), 0u);
+}
+
+#if defined(__linux__)
+TEST(NameIndexTest, BatchLookups_ReturnAllMatchesFromOneRead) {
+    auto source = std::make_shared<SystemProcFS::VirtualProcSource>();
+    std::string diskstats;
+    for (int n = 0; n < 40; ++n) {
+        diskstats += " 259 " + std::to_string(n) + " nvme" + std::to_string(n) + "n1 10 0 " +
+                     std::to_string(n) + " 30 20 0 400 40 0 0 0 0\n";
+    }
+    source->setFile("/proc/diskstats", diskstats);
+    source->setFile("/proc/net/dev",
+                    "Inter-|   Receive\n"
+                    " face |bytes    packets errs drop fifo frame compressed multicast|bytes    packets\n"
+                    "  eth0:    5000      50    1    2    0     0          0         0     3000      30    3    4    0     0       0          0\n"
+                    "  eth1:     100       1    0    0    0     0          0         0      200       2    0    0    0     0       0          0\n");
+    SystemProcFS::ScopedProcSource scoped(source);
+
+    std::vector<std::string> wanted;
+    for (int n = 0; n < 40; n += 2) wanted.push_back("nvme" + std::to_string(n) + "n1");
+    wanted.push_back("nvme4n1"); // Duplicate
+    wanted.push_back("sdq");     // Missing
+
+    const auto loads = SystemDiskStats::DiskStatsReader::cacheStats().loads;
+    const auto disks = SystemDiskStats::DiskStatsReader::getDiskStatsForDevices(wanted);
+    EXPECT_EQ(SystemDiskStats::DiskStatsReader::cacheStats().loads, loads + 1);
+    ASSERT_EQ(disks.size(), 20u);
+    EXPECT_EQ(disks.at("nvme38n1").read_bytes, 38ULL * 512ULL);
+    EXPECT_EQ(disks.count("sdq"), 0u);
+
+    const auto nets = SystemNetStats::NetStatsReader::getNetStatsForInterfaces({"eth1", "wlan0"});
+    ASSERT_EQ(nets.size(), 1u);
+    EXPECT_EQ(nets.at("eth1").bytes_sent, 200ULL);
+    EXPECT_EQ(SystemNetStats::NetStatsReader::getNetStats("eth0").drops_out, 4ULL);
+}
+#endif
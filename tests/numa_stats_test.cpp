@@ -0,0 +1,157 @@
+#include <gtest/gtest.h>
+#include "numa_stats.hpp"
+#include "proc_source.hpp"
+#include "test_clock.hpp"
+
+#include <chrono>
+#include <memory>
+#include <stdexcept>
+#include <string>
+
+using namespace SystemNumaStats;
+using SystemProcFS::ScopedProcSource;
+using SystemProcFS::VirtualProcSource;
+using TestClock::at;
+
+namespace {
+std::string meminfo(unsigned node, unsigned long long total_kb, unsigned long long free_kb) {
+    const std::string prefix = "Node " + std::to_string(node) + " ";
+    return prefix + "MemTotal:       " + std::to_string(total_kb) + " kB\n" +
+           prefix + "MemFree:        " + std::to_string(free_kb) + " kB\n" +
+           prefix + "MemUsed:        " + std::to_string(total_kb - free_kb) + " kB\n" +
+           prefix + "Active:          593296 kB\n" +
+           prefix + "FilePages:       300000 kB\n" +
+           prefix + "HugePages_Total:     0\n";
+}
+
+std::string numastat(unsigned long long hit, unsigned long long miss, unsigned long long foreign) {
+    return "numa_hit " + std::to_string(hit) + "\nnuma_miss " + std::to_string(miss) + "\nnuma_foreign " +
+           std::to_string(foreign) + "\ninterleave_hit 1018\nlocal_node " + std::to_string(hit) +
+           "\nother_node " + std::to_string(miss) + "\n";
+}
+
+// Two nodes: CPUs 0-1 on node 0, CPUs 2-3 on node 1.
+std::shared_ptr<VirtualProcSource> twoNodeHost() {
+    auto source = std::make_shared<VirtualProcSource>();
+    source->setFile("/sys/devices/system/node/online", "0-1\n");
+    source->setFile("/sys/devices/system/node/node0/cpulist", "0-1\n");
+    source->setFile("/sys/devices/system/node/node0/distance", "10 21\n");
+    source->setFile("/sys/devices/system/node/node1/cpulist", "2-3\n");
+    source->setFile("/sys/devices/system/node/node1/distance", "21 10\n");
+    source->setSequence("/sys/devices/system/node/node0/meminfo", {meminfo(0, 8000000, 6000000), meminfo(0, 8000000, 2000000)});
+    source->setSequence("/sys/devices/system/node/node1/meminfo", {meminfo(1, 8000000, 7000000), meminfo(1, 8000000, 7000000)});
+    source->setSequence("/sys/devices/system/node/node0/numastat", {numastat(1000, 0, 10), numastat(3000, 0, 410)});
+    source->setSequence("/sys/devices/system/node/node1/numastat", {numastat(500, 50, 0), numastat(700, 450, 0)});
+    source->setSequence("/proc/stat", {
+        "cpu  400 0 200 3200 0 0 0 0 0 0\n"
+        "cpu0 100 0 50 800 0 0 0 0 0 0\n"
+        "cpu1 100 0 50 800 0 0 0 0 0 0\n"
+        "cpu2 100 0 50 800 0 0 0 0 0 0\n"
+        "cpu3 100 0 50 800 0 0 0 0 0 0\n",
+        // Node 0 fully busy, node 1 idle; CPU 3 went offline.
+        "cpu  600 0 300 3400 0 0 0 0 0 0\n"
+        "cpu0 180 0 70 800 0 0 0 0 0 0\n"
+        "cpu1 180 0 70 800 0 0 0 0 0 0\n"
+        "cpu2 100 0 50 900 0 0 0 0 0 0\n",
+    });
+    return source;
+}
+} // namespace
+
+TEST(NumaStatsTest, Topology_ReadsNodesAndCpuLists) {
+    EXPECT_EQ(NumaTopology::parseCpuList("0-3,8,10-11\n"), (std::vector<unsigned>{0, 1, 2, 3, 8, 10, 11}));
+    EXPECT_TRUE(NumaTopology::parseCpuList("\n").empty());
+    EXPECT_THROW(NumaTopology::parseCpuList("0-x"), std::runtime_error);
+    EXPECT_THROW(NumaTopology::parseCpuList("3-1"), std::runtime_error);
+
+    ScopedProcSource scoped(twoNodeHost());
+    const NumaTopology topology = NumaTopology::read();
+    ASSERT_EQ(topology.nodes().size(), 2u);
+    EXPECT_EQ(topology.nodes()[1].node, 1u);
+    EXPECT_EQ(topology.nodes()[1].cpus, (std::vector<unsigned>{2, 3}));
+    EXPECT_EQ(topology.nodes()[0].distances, (std::vector<unsigned>{10, 21}));
+    EXPECT_EQ(topology.nodeOfCpu(1), 0);
+    EXPECT_EQ(topology.nodeOfCpu(3), 1);
+    EXPECT_EQ(topology.nodeOfCpu(64), -1);
+}
+
+TEST(NumaStatsTest, Readers_ParsePerNodeFiles) {
+    NumaMemory memory;
+    NumaStatsReader::parseMeminfo(meminfo(0, 5865208, 4099744), memory);
+    EXPECT_EQ(memory.total, 5865208u);
+    EXPECT_EQ(memory.free, 4099744u);
+    EXPECT_EQ(memory.used, 5865208u - 4099744u);
+    EXPECT_EQ(memory.active, 593296u);
+    EXPECT_EQ(memory.file_pages, 300000u);
+    EXPECT_NEAR(memory.usedPercent(), 30.1, 0.1);
+
+    NumaCounters counters;
+    NumaStatsReader::parseNumastat(numastat(96062690, 3, 4), counters);
+    EXPECT_EQ(counters.numa_hit, 96062690u);
+    EXPECT_EQ(counters.numa_foreign, 4u);
+    EXPECT_EQ(counters.interleave_hit, 1018u);
+    EXPECT_THROW(NumaStatsReader::parseNumastat("numa_hit x\n", counters), std::runtime_error);
+}
+
+TEST(NumaStatsTest, Collector_JoinsPerCpuTicksWithTopology) {
+    auto source = twoNodeHost();
+    ScopedProcSource scoped(source);
+
+    NumaCollector collector;
+    collector.sample(at(0));
+    EXPECT_FALSE(collector.hasRates());
+    source->advance();
+    collector.sample(at(2));
+    ASSERT_TRUE(collector.hasRates());
+
+    ASSERT_EQ(collector.current().size(), 2u);
+    EXPECT_EQ(collector.current()[0].memory.free, 2000000u);
+    EXPECT_DOUBLE_EQ(collector.current()[0].memory.usedPercent(), 75.0);
+
+    const NumaRates& rates = collector.rates();
+    EXPECT_DOUBLE_EQ(rates.elapsed_seconds, 2.0);
+    ASSERT_EQ(rates.nodes.size(), 2u);
+    EXPECT_DOUBLE_EQ(rates.nodes[0].numa_hit, 1000.0);
+    EXPECT_DOUBLE_EQ(rates.nodes[0].numa_foreign, 200.0);
+    EXPECT_DOUBLE_EQ(rates.nodes[1].numa_miss, 200.0);
+    EXPECT_DOUBLE_EQ(rates.nodes[1].other_node, 200.0);
+
+    EXPECT_EQ(rates.nodes[0].cpus, 2u);
+    EXPECT_DOUBLE_EQ(rates.nodes[0].cpu.busy, 100.0);
+    EXPECT_DOUBLE_EQ(rates.nodes[0].cpu.user, 80.0);
+    EXPECT_EQ(rates.nodes[1].cpus, 1u); // CPU 3 is offline in the second sample
+    EXPECT_DOUBLE_EQ(rates.nodes[1].cpu.idle, 100.0);
+
+    source->removeFile("/sys/devices/system/node/node1/numastat");
+    EXPECT_THROW(collector.sample(at(3)), std::runtime_error);
+
+    // The failed sample is dropped: the next rates cover the interval since the last good one.
+    source->setFile("/sys/devices/system/node/node0/numastat", numastat(6000, 0, 410));
+    source->setFile("/sys/devices/system/node/node1/numastat", numastat(700, 1050, 0));
+    collector.sample(at(5));
+    EXPECT_DOUBLE_EQ(collector.rates().elapsed_seconds, 3.0);
+    EXPECT_DOUBLE_EQ(collector.rates().nodes[0].numa_hit, 1000.0);
+    EXPECT_DOUBLE_EQ(collector.rates().nodes[1].numa_miss, 200.0);
+}
+
+TEST(NumaStatsTest, Collector_WithoutNumaReportsNoNodes) {
+    auto source = std::make_shared<VirtualProcSource>();
+    source->setFile("/proc/stat", "cpu  1 0 1 1 0 0 0 0 0 0\ncpu0 1 0 1 1 0 0 0 0 0 0\n");
+    ScopedProcSource scoped(source);
+
+    NumaCollector collector;
+    EXPECT_TRUE(collector.topology().nodes().empty());
+    collector.sample(at(0));
+    collector.sample(at(1));
+    EXPECT_TRUE(collector.rates().nodes.empty());
+}
+
+#if defined(__linux__)
+TEST(NumaStatsTest, Collector_ReadsLiveHost) {
+    NumaCollector collector;
+    if (collector.topology().nodes().empty()) GTEST_SKIP() << "Kernel without NUMA support";
+    collector.sample();
+    ASSERT_EQ(collector.current().size(), collector.topology().nodes().size());
+    EXPECT_GT(collector.current()[0].memory.total, 0u);
+}
+#endif
@@ -0,0 +1,36 @@
+#include <gtest/gtest.h>
+#include "proc_parse.hpp"
+
+#include <cstdint>
+#include <string_view>
+
+using namespace SystemProcFS;
+
+TEST(ProcParseTest, NextLine_SplitsWithAndWithoutTrailingNewline) {
+    std::string_view text = "first\n\nlast";
+    std::string_view line;
+    ASSERT_TRUE(nextLine(text, line));
+    EXPECT_EQ(line, "first");
+    ASSERT_TRUE(nextLine(text, line));
+    EXPECT_EQ(line, "");
+    ASSERT_TRUE(nextLine(text, line));
+    EXPECT_EQ(line, "last");
+    EXPECT_FALSE(nextLine(text, line));
+}
+
+TEST(ProcParseTest, FieldScanner_ReadsFieldsAndRejectsBadNumbers) {
+    FieldScanner fields("  sda\t12 18446744073709551615 x9 18446744073709551616 -1 ");
+    std::string_view name;
+    std::uint64_t value = 0;
+    ASSERT_TRUE(fields.next(name));
+    EXPECT_EQ(name, "sda");
+    ASSERT_TRUE(fields.nextUnsigned(value));
+    EXPECT_EQ(value, 12u);
+    ASSERT_TRUE(fields.nextUnsigned(value));
+    EXPECT_EQ(value, 18446744073709551615ULL);
+    EXPECT_FALSE(fields.nextUnsigned(value)); // Not numeric
+    EXPECT_FALSE(fields.nextUnsigned(value)); // Overflows
+    EXPECT_FALSE(fields.nextUnsigned(value)); // Signed
+    EXPECT_FALSE(fields.next(name));
+    EXPECT_FALSE(FieldScanner("a b").skip(3));
+}
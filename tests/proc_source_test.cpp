@@ -0,0 +1,178 @@
+#include <gtest/gtest.h>
+#include "proc_source.hpp"
+#include "cpu_stats.hpp"
+#include "mem_stats.hpp"
+#include "disk_stats.hpp"
+#include "net_stats.hpp"
+
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+using namespace SystemProcFS;
+
+namespace {
+const char* kMeminfoFixture =
+    "MemTotal:       16000000 kB\n"
+    "MemFree:         4000000 kB\n"
+    "MemAvailable:    9000000 kB\n"
+    "Buffers:          100000 kB\n"
+    "Cached:          3000000 kB\n"
+    "SwapCached:            0 kB\n"
+    "SwapTotal:       2000000 kB\n"
+    "SwapFree:        1500000 kB\n";
+
+const char* kDiskstatsFixture =
+    "   7       0 loop0 10 0 20 1 0 0 0 0 0 1 1 0 0 0 0\n"
+    "   8       0 sda 100 0 1000 500 200 0 2000 1000 0 0 0 0\n"
+    "   8       1 sda1 50 0 500 250 100 0 1000 500 0 0 0 0\n"
+    " 259       0 nvme0n1 10 0 300 30 20 0 400 40 0 0 0 0\n";
+
+const char* kNetDevFixture =
+    "Inter-|   Receive                                                |  Transmit\n"
+    " face |bytes    packets errs drop fifo frame compressed multicast|bytes    packets errs drop fifo colls carrier compressed\n"
+    "    lo:    1000      10    0    0    0     0          0         0     1000      10    0    0    0     0       0          0\n"
+    "  eth0:    5000      50    1    2    0     0          0         0     3000      30    3    4    0     0       0          0\n"
+    "veth1a:    7777      77    0    0    0     0          0         0     7777      77    0    0    0     0       0          0\n";
+} // namespace
+
+#if defined(__linux__)
+TEST(ProcSourceTest, VirtualSource_DrivesAllReaders) {
+    auto source = std::make_shared<VirtualProcSource>();
+    source->setFile("/proc/stat", "cpu  1000 200 300 4000 50 10 5 0 0 0\ncpu0 1000 200 300 4000 50 10 5 0 0 0\n");
+    source->setFile("/proc/meminfo", kMeminfoFixture);
+    source->setFile("/proc/diskstats", kDiskstatsFixture);
+    source->setFile("/proc/net/dev", kNetDevFixture);
+    ScopedProcSource scoped(source);
+
+    SystemCPUStats::CPUStats cpu = SystemCPUStats::CPUStatsReader::getCPUStats();
+    EXPECT_DOUBLE_EQ(cpu.user, 1000.0);
+    EXPECT_DOUBLE_EQ(cpu.idle, 4000.0);
+
+    SystemMemoryStats::MemStats mem = SystemMemoryStats::MeMStatsReader::getMemStats();
+    EXPECT_EQ(mem.total, 16000000ULL);
+    EXPECT_EQ(mem.available, 9000000ULL);
+    EXPECT_EQ(mem.swap_free, 1500000ULL);
+
+    // loop0 and the sda1 partition are filtered out, sda and nvme0n1 are summed.
+    SystemDiskStats::DiskStats disk = SystemDiskStats::DiskStatsReader::getDiskStats();
+    EXPECT_EQ(disk.read_bytes, (1000ULL + 300ULL) * 512ULL);
+    EXPECT_EQ(disk.write_bytes, (2000ULL + 400ULL) * 512ULL);
+    EXPECT_EQ(SystemDiskStats::DiskStatsReader::getDiskStats("nvme0n1").read_time_ms, 30ULL);
+
+    // veth interfaces are filtered out of the aggregate.
+    SystemNetStats::NetStats net = SystemNetStats::NetStatsReader::getNetStats();
+    EXPECT_EQ(net.bytes_received, 6000ULL);
+    EXPECT_EQ(net.drops_out, 4ULL);
+    EXPECT_EQ(SystemNetStats::NetStatsReader::getNetStats("eth0").errors_in, 1ULL);
+}
+
+TEST(ProcSourceTest, VirtualSource_ScriptedCounterEvolution) {
+    auto source = std::make_shared<VirtualProcSource>();
+    // 25% busy: every tick adds 25 user jiffies and 75 idle jiffies.
+    source->setGenerator("/proc/stat", [](std::uint64_t tick) {
+        return "cpu " + std::to_string(1000 + 25 * tick) + " 0 0 " + std::to_string(4000 + 75 * tick) + " 0 0 0 0 0 0\n";
+    });
+    ScopedProcSource scoped(source);
+
+    SystemCPUStats::CPUStats prev = SystemCPUStats::CPUStatsReader::getCPUStats();
+    source->advance(4);
+    EXPECT_EQ(source->tick(), 4ULL);
+    SystemCPUStats::CPUStats curr = SystemCPUStats::CPUStatsReader::getCPUStats();
+
+    EXPECT_DOUBLE_EQ(curr.user - prev.user, 100.0);
+    EXPECT_DOUBLE_EQ(SystemCPUStats::calculateUsagePercentage(curr, prev, 1000), 25.0);
+}
+
+TEST(ProcSourceTest, VirtualSource_SequenceRepeatsLastFrame) {
+    auto source = std::make_shared<VirtualProcSource>();
+    source->setSequence("/proc/stat", {"cpu 1 0 0 1 0 0 0 0 0 0\n", "cpu 2 0 0 2 0 0 0 0 0 0\n"});
+    ScopedProcSource scoped(source);
+
+    EXPECT_DOUBLE_EQ(SystemCPUStats::CPUStatsReader::getCPUStats().user, 1.0);
+    source->advance();
+    EXPECT_DOUBLE_EQ(SystemCPUStats::CPUStatsReader::getCPUStats().user, 2.0);
+    source->advance(10);
+    EXPECT_DOUBLE_EQ(SystemCPUStats::CPUStatsReader::getCPUStats().user, 2.0);
+
+    EXPECT_THROW(source->setSequence("/proc/empty", {}), std::invalid_argument);
+}
+
+TEST(ProcSourceTest, VirtualSource_MissingFileThrowsFromReader) {
+    auto source = std::make_shared<VirtualProcSource>();
+    ScopedProcSource scoped(source);
+    EXPECT_THROW(SystemCPUStats::CPUStatsReader::getCPUStats(), std::runtime_error);
+    EXPECT_THROW(SystemMemoryStats::MeMStatsReader::getMemStats(), std::runtime_error);
+    EXPECT_THROW(SystemDiskStats::DiskStatsReader::getDiskStats(), std::runtime_error);
+    EXPECT_THROW(SystemNetStats::NetStatsReader::getNetStats(), std::runtime_error);
+}
+#endif
+
+TEST(ProcSourceTest, VirtualSource_ListDirectory) {
+    VirtualProcSource source;
+    source.setFile("/proc/1/stat", "1 (init) S");
+    source.setFile("/proc/1/status", "Name: init");
+    source.setFile("/proc/42/stat", "42 (worker) R");
+    source.setFile("/proc/stat", "cpu 0 0 0 0 0 0 0 0 0 0");
+
+    std::vector<std::string> entries = source.listDirectory("/proc");
+    EXPECT_EQ(entries, (std::vector<std::string>{"1", "42", "stat"}));
+    EXPECT_EQ(source.listDirectory("/proc/1"), (std::vector<std::string>{"stat", "status"}));
+    EXPECT_TRUE(source.listDirectory("/sys").empty());
+
+    source.removeFile("/proc/42/stat");
+    EXPECT_EQ(source.listDirectory("/proc"), (std::vector<std::string>{"1", "stat"}));
+    EXPECT_TRUE(source.resolvePath("/proc/stat").empty());
+}
+
+TEST(ProcSourceTest, ScopedSource_RestoresPreviousAndBumpsGeneration) {
+    auto before = ProcFS::source();
+    std::uint64_t generation = ProcFS::generation();
+    {
+        ScopedProcSource scoped(std::make_shared<VirtualProcSource>());
+        EXPECT_NE(ProcFS::source(), before);
+        EXPECT_GT(ProcFS::generation(), generation);
+    }
+    EXPECT_EQ(ProcFS::source(), before);
+}
+
+#if defined(__unix__) || defined(__APPLE__)
+TEST(ProcSourceTest, DirectorySource_ReadsBelowRoot) {
+    char root_template[] = "/tmp/proc_source_testXXXXXX";
+    char* root = ::mkdtemp(root_template);
+    ASSERT_NE(root, nullptr);
+    std::string root_dir(root);
+    ASSERT_EQ(::mkdir((root_dir + "/proc").c_str(), 0755), 0);
+    {
+        std::ofstream meminfo(root_dir + "/proc/meminfo");
+        meminfo << kMeminfoFixture;
+    }
+
+    DirectoryProcSource source(root_dir + "/");
+    std::string contents;
+    ASSERT_TRUE(source.readFile("/proc/meminfo", contents));
+    EXPECT_EQ(contents, kMeminfoFixture);
+    EXPECT_FALSE(source.readFile("/proc/does_not_exist", contents));
+    EXPECT_EQ(source.listDirectory("/proc"), (std::vector<std::string>{"meminfo"}));
+    EXPECT_EQ(source.resolvePath("/proc/meminfo"), root_dir + "/proc/meminfo");
+
+#if defined(__linux__)
+    ProcFS::setRoot(root_dir);
+    EXPECT_EQ(SystemMemoryStats::MeMStatsReader::getMemStats().total, 16000000ULL);
+    ProcFS::reset();
+#endif
+
+    std::remove((root_dir + "/proc/meminfo").c_str());
+    ::rmdir((root_dir + "/proc").c_str());
+    ::rmdir(root_dir.c_str());
+}
+#endif
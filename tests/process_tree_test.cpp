@@ -0,0 +1,180 @@
+#include <gtest/gtest.h>
+#include "process_tree.hpp"
+#include "cpu_stats.hpp"
+#include "proc_source.hpp"
+#include "test_clock.hpp"
+
+#include <chrono>
+#include <memory>
+#include <stdexcept>
+#include <string>
+
+#if defined(__linux__)
+#include <unistd.h>
+#endif
+
+using namespace SystemProcessStats;
+using SystemProcFS::ScopedProcSource;
+using SystemProcFS::VirtualProcSource;
+using TestClock::at;
+
+namespace {
+std::string statLine(int pid, const std::string& name, int ppid, unsigned long long cpu_ticks,
+                     unsigned long long rss_pages, unsigned long long start_time = 100) {
+    return std::to_string(pid) + " (" + name + ") S " + std::to_string(ppid) + " 1 1 0 -1 4194560 0 0 0 0 " +
+           std::to_string(cpu_ticks) + " 0 0 0 20 0 1 0 " + std::to_string(start_time) + " 1000000 " +
+           std::to_string(rss_pages) + " 18446744073709551615 1 1 0 0 0 0 0 0 0 0 0 0 17 0 0 0 0 0 0 0 0 0 0 0 0 0 0\n";
+}
+
+std::string ioFile(unsigned long long read_bytes, unsigned long long write_bytes) {
+    return "rchar: 1\nwchar: 1\nsyscr: 1\nsyscw: 1\nread_bytes: " + std::to_string(read_bytes) +
+           "\nwrite_bytes: " + std::to_string(write_bytes) + "\ncancelled_write_bytes: 0\n";
+}
+
+void addProcess(VirtualProcSource& source, int pid, const std::string& stat, const std::string& cgroup,
+                const std::string& io = ioFile(0, 0)) {
+    const std::string dir = "/proc/" + std::to_string(pid);
+    source.setFile(dir + "/stat", stat);
+    source.setFile(dir + "/cgroup", cgroup);
+    source.setFile(dir + "/io", io);
+}
+
+void removeProcess(VirtualProcSource& source, int pid) {
+    const std::string dir = "/proc/" + std::to_string(pid);
+    for (const char* name : {"/stat", "/cgroup", "/io"}) source.removeFile(dir + name);
+}
+
+const Rollup* find(const std::vector<Rollup>& rollups, const std::string& name) {
+    for (const Rollup& rollup : rollups) {
+        if (rollup.name == name) return &rollup;
+    }
+    return nullptr;
+}
+} // namespace
+
+TEST(ProcessTreeTest, CgroupServiceName_PicksDeepestUnit) {
+    EXPECT_EQ(cgroupServiceName("0::/system.slice/nginx.service\n"), "nginx.service");
+    EXPECT_EQ(cgroupServiceName("0::/user.slice/user-1000.slice/user@1000.service/app.slice/term.scope\n"), "term.scope");
+    EXPECT_EQ(cgroupServiceName("12:memory:/docker/abc\n1:name=systemd:/system.slice/docker.service\n0::/docker/abc\n"),
+              "/docker/abc");
+    EXPECT_EQ(cgroupServiceName("12:memory:/x\n1:name=systemd:/system.slice/cron.service\n"), "cron.service");
+    EXPECT_EQ(cgroupServiceName("4:cpu:/kubepods/pod1\n"), "/kubepods/pod1");
+    EXPECT_EQ(cgroupServiceName(""), "/");
+    EXPECT_STREQ(rollupByName(RollupBy::Unit), "unit");
+}
+
+TEST(ProcessTreeTest, Collector_RollsUpTreesExecutablesAndUnits) {
+    const unsigned long long hz = SystemCPUStats::ticksPerSecond();
+    const std::string nginx = "0::/system.slice/nginx.service\n";
+    const std::string session = "0::/user.slice/user-1000.slice/session-3.scope\n";
+    auto source = std::make_shared<VirtualProcSource>();
+    addProcess(*source, 1, statLine(1, "systemd", 0, 0, 100), "0::/init.scope\n");
+    addProcess(*source, 2, statLine(2, "kthreadd", 0, 0, 0), "0::/\n");
+    addProcess(*source, 3, statLine(3, "kworker/0:1", 2, 0, 0), "0::/\n");
+    addProcess(*source, 100, statLine(100, "nginx", 1, 0, 1000), nginx);
+    source->setSequence("/proc/101/stat", {statLine(101, "nginx", 100, 0, 2000), statLine(101, "nginx", 100, hz, 3000)});
+    source->setFile("/proc/101/cgroup", nginx);
+    source->setSequence("/proc/101/io", {ioFile(0, 0), ioFile(4096, 8192)});
+    addProcess(*source, 200, statLine(200, "bash", 1, 0, 500), session);
+    source->setSequence("/proc/201/stat", {statLine(201, "make", 200, 0, 500), statLine(201, "make", 200, hz / 2, 500)});
+    source->setFile("/proc/201/cgroup", session);
+    source->setSequence("/proc/202/stat", {statLine(202, "cc1", 201, 0, 4000), statLine(202, "cc1", 201, hz, 6000)});
+    source->setFile("/proc/202/cgroup", session);
+    source->setFile("/proc/meminfo", "MemTotal: 1 kB\n"); // Not a process
+    ScopedProcSource scoped(source);
+
+    ProcessTreeCollector collector;
+    collector.sample(at(0));
+    EXPECT_FALSE(collector.hasRates());
+    EXPECT_EQ(collector.stats().processes, 8u);
+
+    source->advance();
+    collector.sample(at(1));
+    ASSERT_TRUE(collector.hasRates());
+    const std::vector<Rollup> largest = collector.top(RollupBy::Executable, RollupResource::Rss, 1);
+    ASSERT_EQ(largest[0].name, "cc1");
+    const std::uint64_t page = largest[0].rss_bytes / 6000;
+    ASSERT_GT(page, 0u);
+
+    // Trees: nginx and bash below systemd, each with its whole subtree; roots only themselves.
+    const std::vector<Rollup> trees = collector.top(RollupBy::Tree, RollupResource::Cpu, 10);
+    ASSERT_EQ(trees.size(), 5u); // systemd, kthreadd, kworker, nginx, bash
+    EXPECT_EQ(trees[0].name, "bash");
+    EXPECT_EQ(trees[0].pid, 200);
+    EXPECT_EQ(trees[0].processes, 3u);
+    EXPECT_DOUBLE_EQ(trees[0].cpu_percent, 150.0);
+    EXPECT_EQ(trees[0].rss_bytes, 7000 * page);
+    EXPECT_EQ(trees[1].name, "nginx");
+    EXPECT_DOUBLE_EQ(trees[1].cpu_percent, 100.0);
+    EXPECT_DOUBLE_EQ(trees[1].read_bytes_per_second, 4096.0);
+    const Rollup* systemd = find(trees, "systemd");
+    ASSERT_NE(systemd, nullptr);
+    EXPECT_EQ(systemd->processes, 1u);
+
+    Rollup subtree;
+    ASSERT_TRUE(collector.subtree(1, subtree));
+    EXPECT_EQ(subtree.processes, 6u);
+    EXPECT_DOUBLE_EQ(subtree.cpu_percent, 250.0);
+    EXPECT_FALSE(collector.subtree(999, subtree));
+
+    const std::vector<Rollup> units = collector.top(RollupBy::Unit, RollupResource::Rss, 2);
+    ASSERT_EQ(units.size(), 2u);
+    EXPECT_EQ(units[0].name, "session-3.scope");
+    EXPECT_EQ(units[0].rss_bytes, 7000 * page);
+    EXPECT_EQ(units[1].name, "nginx.service");
+    EXPECT_EQ(units[1].processes, 2u);
+    EXPECT_EQ(units[1].rss_bytes, 4000 * page);
+    EXPECT_DOUBLE_EQ(collector.top(RollupBy::Unit, RollupResource::Io, 1)[0].write_bytes_per_second, 8192.0);
+
+    // cc1 exits, make execs ld, and the nginx master exits (its worker is reparented to init) and
+    // its pid is reused by an unrelated process: groups follow.
+    removeProcess(*source, 202);
+    source->setFile("/proc/101/stat", statLine(101, "nginx", 1, hz, 3000));
+    source->setFile("/proc/201/stat", statLine(201, "ld", 200, hz / 2, 500));
+    addProcess(*source, 100, statLine(100, "sleep", 1, 0, 10, 900), session);
+    collector.sample(at(2));
+    const ProcessTreeStats stats = collector.stats();
+    EXPECT_EQ(stats.processes, 7u);
+    EXPECT_EQ(stats.processes_added, 9u);
+    EXPECT_EQ(stats.processes_removed, 2u);
+    EXPECT_EQ(stats.cgroup_reads, 9u); // Only for new processes
+
+    const std::vector<Rollup> executables = collector.top(RollupBy::Executable, RollupResource::Rss, 10);
+    EXPECT_EQ(find(executables, "cc1"), nullptr);
+    EXPECT_EQ(find(executables, "make"), nullptr);
+    ASSERT_NE(find(executables, "ld"), nullptr);
+    ASSERT_NE(find(executables, "nginx"), nullptr);
+    EXPECT_EQ(find(executables, "nginx")->processes, 1u);
+    const std::vector<Rollup> after = collector.top(RollupBy::Unit, RollupResource::Rss, 10);
+    EXPECT_EQ(find(after, "session-3.scope")->rss_bytes, 1010 * page);
+    EXPECT_EQ(find(after, "session-3.scope")->processes, 3u);
+    EXPECT_EQ(find(after, "nginx.service")->rss_bytes, 3000 * page);
+    ASSERT_TRUE(collector.subtree(100, subtree));
+    EXPECT_EQ(subtree.name, "sleep");
+    EXPECT_EQ(subtree.processes, 1u);
+    EXPECT_EQ(collector.top(RollupBy::Tree, RollupResource::Cpu, 10).size(), 6u);
+
+    // A malformed stat file fails the sample and leaves the rollups as they were.
+    source->setFile("/proc/201/stat", "201 (ld) S\n");
+    EXPECT_THROW(collector.sample(at(3)), std::runtime_error);
+    EXPECT_EQ(collector.stats().processes, 7u);
+    EXPECT_EQ(find(collector.top(RollupBy::Unit, RollupResource::Rss, 10), "session-3.scope")->processes, 3u);
+}
+
+#if defined(__linux__)
+TEST(ProcessTreeTest, Collector_ScansLiveProcesses) {
+    ProcessTreeCollector collector;
+    collector.sample();
+    collector.sample();
+    ASSERT_TRUE(collector.hasRates());
+    EXPECT_GT(collector.stats().processes, 0u);
+    EXPECT_EQ(collector.stats().cgroup_reads, collector.stats().processes_added);
+
+    Rollup self;
+    ASSERT_TRUE(collector.subtree(static_cast<int>(getpid()), self));
+    EXPECT_GE(self.processes, 1u);
+    EXPECT_GT(self.rss_bytes, 0u);
+    EXPECT_FALSE(collector.top(RollupBy::Executable, RollupResource::Rss, 5).empty());
+    EXPECT_FALSE(collector.top(RollupBy::Tree, RollupResource::Cpu, 5).empty());
+}
+#endif
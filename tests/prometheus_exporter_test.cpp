@@ -0,0 +1,199 @@
+#include <gtest/gtest.h>
+#include "prometheus_exporter.hpp"
+#include "ring_log.hpp"
+
+#include <atomic>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+
+using namespace SystemMetricsExporter;
+using SystemMetricsSnapshot::MetricsSnapshot;
+
+namespace {
+MetricsSnapshot makeSnapshot(unsigned long long bytes_received = 5000) {
+    MetricsSnapshot snapshot;
+    snapshot.timestamp_ms = 1700000000500ULL;
+    snapshot.cpu = SystemCPUStats::CPUStats(1000, 200, 300, 4000, 50, 10, 5, 0, 0, 0);
+    snapshot.mem = SystemMemoryStats::MemStats(16000000, 4000000, 9000000, 100000, 3000000, 2000000, 1500000);
+    snapshot.disks.emplace_back("sda", 512000, 1024000, 500, 1000);
+    snapshot.nets.emplace_back("eth0", bytes_received, 3000, 50, 30, 1, 3, 2, 4);
+    snapshot.nets.emplace_back("we\"ird", 1, 2, 3, 4, 5, 6, 7, 8);
+    return snapshot;
+}
+
+#if defined(__unix__) || defined(__APPLE__)
+// Sends a raw HTTP request to the exporter and returns the full response.
+std::string httpRequest(std::uint16_t port, const std::string& request) {
+    int fd = ::socket(AF_INET, SOCK_STREAM, 0);
+    if (fd < 0) return "";
+    struct sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(port);
+    ::inet_pton(AF_INET, "127.0.0.1", &addr.sin_addr);
+    if (::connect(fd, reinterpret_cast<struct sockaddr*>(&addr), sizeof(addr)) != 0) {
+        ::close(fd);
+        return "";
+    }
+    ::send(fd, request.data(), request.size(), 0);
+    std::string response;
+    char buffer[4096];
+    ssize_t n;
+    while ((n = ::recv(fd, buffer, sizeof(buffer), 0)) > 0) {
+        response.append(buffer, static_cast<size_t>(n));
+    }
+    ::close(fd);
+    return response;
+}
+
+std::string responseBody(const std::string& response) {
+    size_t pos = response.find("\r\n\r\n");
+    return pos == std::string::npos ? "" : response.substr(pos + 4);
+}
+#endif
+} // namespace
+
+TEST(PrometheusExporterTest, RenderPrometheusText_ContainsAllFamilies) {
+    std::string text;
+    renderPrometheusText(makeSnapshot(), text);
+
+    EXPECT_NE(text.find("# TYPE metrics_agent_cpu_time_jiffies_total counter\n"), std::string::npos);
+    EXPECT_NE(text.find("metrics_agent_cpu_time_jiffies_total{mode=\"user\"} 1000\n"), std::string::npos);
+    EXPECT_NE(text.find("metrics_agent_memory_total_bytes 16384000000\n"), std::string::npos);
+    EXPECT_NE(text.find("metrics_agent_disk_read_bytes_total{device=\"sda\"} 512000\n"), std::string::npos);
+    EXPECT_NE(text.find("metrics_agent_disk_write_time_seconds_total{device=\"sda\"} 1\n"), std::string::npos);
+    EXPECT_NE(text.find("metrics_agent_network_receive_bytes_total{interface=\"eth0\"} 5000\n"), std::string::npos);
+    EXPECT_NE(text.find("metrics_agent_network_transmit_drop_total{interface=\"eth0\"} 4\n"), std::string::npos);
+    // Label values are escaped.
+    EXPECT_NE(text.find("{interface=\"we\\\"ird\"}"), std::string::npos);
+    EXPECT_NE(text.find("metrics_agent_last_collection_timestamp_seconds 1700000000.5\n"), std::string::npos);
+    EXPECT_EQ(text.back(), '\n');
+}
+
+TEST(PrometheusExporterTest, ExpositionCache_SwapsAndRecyclesBuffers) {
+    ExpositionCache cache(false);
+    EXPECT_EQ(cache.current()->generation, 0ULL);
+
+    cache.publish(makeSnapshot(1));
+    std::shared_ptr<const Exposition> first = cache.current();
+    EXPECT_EQ(first->generation, 1ULL);
+    EXPECT_NE(first->header.find("Content-Length: " + std::to_string(first->body.size()) + "\r\n"), std::string::npos);
+
+    // A reader holding the first exposition keeps it intact across later publishes.
+    cache.publish(makeSnapshot(2));
+    cache.publish(makeSnapshot(3));
+    EXPECT_EQ(first->generation, 1ULL);
+    EXPECT_NE(first->body.find("{interface=\"eth0\"} 1\n"), std::string::npos);
+    EXPECT_NE(cache.current()->body.find("{interface=\"eth0\"} 3\n"), std::string::npos);
+
+    // Once released, the two buffers alternate instead of being reallocated.
+    first.reset();
+    cache.publish(makeSnapshot(4));
+    const Exposition* a = cache.current().get();
+    cache.publish(makeSnapshot(5));
+    const Exposition* b = cache.current().get();
+    cache.publish(makeSnapshot(6));
+    EXPECT_NE(a, b);
+    EXPECT_EQ(cache.current().get(), a);
+}
+
+#if defined(__unix__) || defined(__APPLE__)
+TEST(PrometheusExporterTest, Server_ServesMetricsOverLoopback) {
+    PrometheusExporter exporter(PrometheusExporter::Options("127.0.0.1", 0, true, std::chrono::milliseconds(0)));
+    exporter.start();
+    ASSERT_TRUE(exporter.running());
+    ASSERT_NE(exporter.port(), 0);
+
+    // Nothing published yet.
+    EXPECT_EQ(httpRequest(exporter.port(), "GET /metrics HTTP/1.1\r\nHost: x\r\n\r\n").rfind("HTTP/1.1 503", 0), 0u);
+
+    exporter.publish(makeSnapshot());
+    std::string response = httpRequest(exporter.port(), "GET /metrics HTTP/1.1\r\nHost: x\r\n\r\n");
+    EXPECT_EQ(response.rfind("HTTP/1.1 200 OK\r\n", 0), 0u);
+    EXPECT_EQ(responseBody(response), exporter.cache().current()->body);
+
+    std::string head = httpRequest(exporter.port(), "HEAD /metrics HTTP/1.1\r\n\r\n");
+    EXPECT_EQ(head.rfind("HTTP/1.1 200 OK\r\n", 0), 0u);
+    EXPECT_TRUE(responseBody(head).empty());
+
+    EXPECT_EQ(httpRequest(exporter.port(), "GET / HTTP/1.1\r\n\r\n").rfind("HTTP/1.1 404", 0), 0u);
+    EXPECT_EQ(httpRequest(exporter.port(), "POST /metrics HTTP/1.1\r\n\r\n").rfind("HTTP/1.1 405", 0), 0u);
+    EXPECT_EQ(httpRequest(exporter.port(), "garbage\r\n\r\n").rfind("HTTP/1.1 400", 0), 0u);
+
+    exporter.stop();
+    EXPECT_FALSE(exporter.running());
+    EXPECT_NO_THROW(exporter.stop());
+}
+
+TEST(PrometheusExporterTest, Server_ServesCachedGzipWhenAccepted) {
+    PrometheusExporter exporter(PrometheusExporter::Options("127.0.0.1", 0, true, std::chrono::milliseconds(0)));
+    exporter.start();
+    exporter.publish(makeSnapshot());
+
+    std::string response = httpRequest(exporter.port(), "GET /metrics HTTP/1.1\r\nAccept-Encoding: deflate, GZIP\r\n\r\n");
+    auto exposition = exporter.cache().current();
+    if (exporter.cache().gzipEnabled()) {
+        EXPECT_NE(response.find("Content-Encoding: gzip\r\n"), std::string::npos);
+        EXPECT_EQ(responseBody(response), exposition->gzip_body);
+        EXPECT_LT(exposition->gzip_body.size(), exposition->body.size());
+    } else {
+        EXPECT_EQ(response.find("Content-Encoding"), std::string::npos);
+        EXPECT_EQ(responseBody(response), exposition->body);
+    }
+}
+
+TEST(PrometheusExporterTest, Server_HandlesConcurrentScrapesDuringPublishes) {
+    PrometheusExporter exporter(PrometheusExporter::Options("127.0.0.1", 0, false, std::chrono::milliseconds(0)));
+    exporter.start();
+    exporter.publish(makeSnapshot());
+
+    std::atomic<bool> publishing{true};
+    std::thread publisher([&] {
+        unsigned long long i = 0;
+        while (publishing.load()) exporter.publish(makeSnapshot(++i));
+    });
+
+    std::atomic<int> ok{0};
+    std::vector<std::thread> scrapers;
+    for (int t = 0; t < 8; ++t) {
+        scrapers.emplace_back([&] {
+            for (int i = 0; i < 20; ++i) {
+                std::string body = responseBody(httpRequest(exporter.port(), "GET /metrics HTTP/1.1\r\n\r\n"));
+                if (body.find("metrics_agent_last_collection_timestamp_seconds") != std::string::npos) ++ok;
+            }
+        });
+    }
+    for (auto& t : scrapers) t.join();
+    publishing.store(false);
+    publisher.join();
+    EXPECT_EQ(ok.load(), 160);
+}
+
+TEST(PrometheusExporterTest, AttachHistory_PublishesLastSnapshotFromPreviousRun) {
+    char path_template[] = "/tmp/exporter_historyXXXXXX";
+    int fd = ::mkstemp(path_template);
+    ASSERT_GE(fd, 0);
+    ::close(fd);
+    std::remove(path_template);
+    {
+        SystemMetricsHistory::RingLog previous_run(path_template, 64 * 1024);
+        previous_run.append(makeSnapshot(4242));
+    }
+
+    PrometheusExporter exporter(PrometheusExporter::Options("127.0.0.1", 0, false, std::chrono::milliseconds(0)));
+    exporter.attachHistory(std::make_shared<SystemMetricsHistory::RingLog>(path_template, 64 * 1024));
+    EXPECT_EQ(exporter.cache().current()->generation, 1ULL);
+    EXPECT_NE(exporter.cache().current()->body.find("{interface=\"eth0\"} 4242\n"), std::string::npos);
+    exporter.attachHistory(nullptr);
+    std::remove(path_template);
+}
+#endif
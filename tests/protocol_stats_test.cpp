@@ -0,0 +1,137 @@
+#include <gtest/gtest.h>
+#include "protocol_stats.hpp"
+#include "proc_source.hpp"
+#include "test_clock.hpp"
+
+#include <chrono>
+#include <memory>
+#include <stdexcept>
+#include <string>
+
+using namespace SystemNetStats;
+using SystemProcFS::ScopedProcSource;
+using SystemProcFS::VirtualProcSource;
+using TestClock::at;
+
+namespace {
+std::string snmp(unsigned long long retrans, unsigned long long curr_estab, unsigned long long rcvbuf_errors) {
+    return "Ip: Forwarding DefaultTTL InReceives InHdrErrors InAddrErrors ForwDatagrams InUnknownProtos InDiscards "
+           "InDelivers OutRequests OutDiscards OutNoRoutes\n"
+           "Ip: 2 64 220770 0 0 0 0 3 220770 220742 54 1\n"
+           "Icmp: InMsgs InErrors\n"
+           "Icmp: 5 0\n"
+           "Tcp: RtoAlgorithm RtoMin RtoMax MaxConn ActiveOpens PassiveOpens AttemptFails EstabResets CurrEstab "
+           "InSegs OutSegs RetransSegs InErrs OutRsts InCsumErrors\n"
+           "Tcp: 1 200 120000 -1 20584 20585 1 22 " + std::to_string(curr_estab) + " 220553 220553 " +
+           std::to_string(retrans) + " 0 11 0\n"
+           "Udp: InDatagrams NoPorts InErrors OutDatagrams RcvbufErrors SndbufErrors InCsumErrors IgnoredMulti\n"
+           "Udp: 10 108 0 108 " + std::to_string(rcvbuf_errors) + " 0 0 0\n";
+}
+
+std::string netstat(unsigned long long listen_overflows) {
+    return "TcpExt: SyncookiesSent SyncookiesRecv SyncookiesFailed ListenOverflows ListenDrops TCPTimeouts\n"
+           "TcpExt: 4 0 1 " + std::to_string(listen_overflows) + " " + std::to_string(listen_overflows) + " 9\n"
+           "IpExt: InNoRoutes InOctets OutOctets\n"
+           "IpExt: 0 1000000 2000000\n";
+}
+} // namespace
+
+TEST(ProtocolStatsTest, Parse_MapsHeaderColumnsToCounters) {
+    ProtocolCounters counters;
+    ProtocolStatsReader::parse(snmp(17, 2, 5), counters);
+    ProtocolStatsReader::parse(netstat(40), counters);
+
+    EXPECT_EQ(counters[ProtocolCounter::IpInReceives], 220770u);
+    EXPECT_EQ(counters[ProtocolCounter::IpInDiscards], 3u);
+    EXPECT_EQ(counters[ProtocolCounter::IpOutNoRoutes], 1u);
+    EXPECT_EQ(counters[ProtocolCounter::TcpActiveOpens], 20584u);
+    EXPECT_EQ(counters[ProtocolCounter::TcpCurrEstab], 2u);
+    EXPECT_EQ(counters[ProtocolCounter::TcpRetransSegs], 17u);
+    EXPECT_EQ(counters[ProtocolCounter::TcpOutRsts], 11u);
+    EXPECT_EQ(counters[ProtocolCounter::UdpRcvbufErrors], 5u);
+    EXPECT_EQ(counters[ProtocolCounter::TcpExtListenOverflows], 40u);
+    EXPECT_EQ(counters[ProtocolCounter::TcpExtTCPTimeouts], 9u);
+    EXPECT_EQ(counters[ProtocolCounter::IpExtOutOctets], 2000000u);
+    // Columns this kernel does not have stay absent.
+    EXPECT_TRUE(counters.has(ProtocolCounter::UdpInCsumErrors));
+    EXPECT_FALSE(counters.has(ProtocolCounter::TcpExtTCPBacklogDrop));
+    EXPECT_EQ(counters[ProtocolCounter::TcpExtTCPBacklogDrop], 0u);
+
+    EXPECT_STREQ(protocolCounterName(ProtocolCounter::TcpExtListenOverflows), "TcpExt.ListenOverflows");
+    EXPECT_TRUE(isProtocolGauge(ProtocolCounter::TcpCurrEstab));
+    EXPECT_FALSE(isProtocolGauge(ProtocolCounter::TcpRetransSegs));
+}
+
+TEST(ProtocolStatsTest, Parse_RejectsMalformedTables) {
+    ProtocolCounters counters;
+    EXPECT_THROW(ProtocolStatsReader::parse("Tcp: RetransSegs\n", counters), std::runtime_error);
+    EXPECT_THROW(ProtocolStatsReader::parse("Tcp: RetransSegs\nUdp: 5\n", counters), std::runtime_error);
+    EXPECT_THROW(ProtocolStatsReader::parse("Tcp: RetransSegs\nTcp: x\n", counters), std::runtime_error);
+    EXPECT_THROW(ProtocolStatsReader::parse("Tcp: InSegs RetransSegs\nTcp: 5\n", counters), std::runtime_error);
+}
+
+TEST(ProtocolStatsTest, Layout_IsBuiltOnceAndRebuiltWhenHeadersChange) {
+    ProtocolTableLayout layout;
+    ProtocolCounters counters;
+    layout.parse(netstat(1), counters);
+    layout.parse(netstat(2), counters);
+    layout.parse(netstat(3), counters);
+    EXPECT_EQ(layout.builds(), 1u);
+    EXPECT_EQ(counters[ProtocolCounter::TcpExtListenOverflows], 3u);
+
+    // A kernel update that inserts a column moves every later value.
+    layout.parse("TcpExt: SyncookiesSent NewCounter ListenOverflows\nTcpExt: 4 99 7\n", counters);
+    EXPECT_EQ(layout.builds(), 2u);
+    EXPECT_EQ(counters[ProtocolCounter::TcpExtListenOverflows], 7u);
+}
+
+TEST(ProtocolStatsTest, Collector_ComputesRatesAgainstPreviousSample) {
+    auto source = std::make_shared<VirtualProcSource>();
+    source->setSequence("/proc/net/snmp", {snmp(100, 5, 0), snmp(130, 9, 4), snmp(130, 9, 4)});
+    source->setSequence("/proc/net/netstat", {netstat(10), netstat(16), netstat(16)});
+    ScopedProcSource scoped(source);
+
+    ProtocolStatsCollector collector;
+    collector.sample(at(0));
+    EXPECT_FALSE(collector.hasRates());
+    source->advance();
+    collector.sample(at(2));
+    ASSERT_TRUE(collector.hasRates());
+
+    const ProtocolRates& rates = collector.rates();
+    EXPECT_DOUBLE_EQ(rates.elapsed_seconds, 2.0);
+    EXPECT_DOUBLE_EQ(rates[ProtocolCounter::TcpRetransSegs], 15.0);
+    EXPECT_DOUBLE_EQ(rates[ProtocolCounter::UdpRcvbufErrors], 2.0);
+    EXPECT_DOUBLE_EQ(rates[ProtocolCounter::TcpExtListenOverflows], 3.0);
+    EXPECT_DOUBLE_EQ(rates[ProtocolCounter::TcpCurrEstab], 0.0); // Gauge
+    EXPECT_EQ(collector.current()[ProtocolCounter::TcpCurrEstab], 9u);
+    EXPECT_DOUBLE_EQ(rates[ProtocolCounter::TcpExtTCPBacklogDrop], 0.0); // Absent
+
+    source->advance();
+    collector.sample(at(3));
+    EXPECT_DOUBLE_EQ(collector.rates()[ProtocolCounter::TcpRetransSegs], 0.0);
+    EXPECT_EQ(collector.layoutBuilds(), 2u); // One per file, reused by later samples
+}
+
+TEST(ProtocolStatsTest, Collector_WorksWithoutNetstatAndFailsWithoutSnmp) {
+    auto source = std::make_shared<VirtualProcSource>();
+    source->setFile("/proc/net/snmp", snmp(1, 1, 1));
+    ScopedProcSource scoped(source);
+
+    ProtocolStatsCollector collector;
+    collector.sample(at(0));
+    EXPECT_TRUE(collector.current().has(ProtocolCounter::TcpRetransSegs));
+    EXPECT_FALSE(collector.current().has(ProtocolCounter::TcpExtListenOverflows));
+
+    source->removeFile("/proc/net/snmp");
+    EXPECT_THROW(collector.sample(at(1)), std::runtime_error);
+    EXPECT_THROW(ProtocolStatsReader::getProtocolCounters(), std::runtime_error);
+}
+
+#if defined(__linux__)
+TEST(ProtocolStatsTest, GetProtocolCounters_ReadsLiveHost) {
+    const ProtocolCounters counters = ProtocolStatsReader::getProtocolCounters();
+    EXPECT_TRUE(counters.has(ProtocolCounter::TcpInSegs));
+    EXPECT_TRUE(counters.has(ProtocolCounter::UdpInDatagrams));
+}
+#endif
@@ -0,0 +1,155 @@
+#include <gtest/gtest.h>
+#include "read_cache.hpp"
+#include "proc_source.hpp"
+#include "disk_stats.hpp"
+#include "net_stats.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace SystemProcFS;
+
+TEST(ReadCacheTest, ConcurrentCallers_ShareOneLoad) {
+    CoalescingCache<int> cache;
+    std::atomic<int> loads{0};
+    constexpr int kThreads = 8;
+    auto loader = [&] {
+        ++loads;
+        // Hold the load open until every other caller has joined it.
+        const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+        while (cache.stats().coalesced < kThreads - 1 && std::chrono::steady_clock::now() < deadline) {
+            std::this_thread::yield();
+        }
+        return 42;
+    };
+
+    std::vector<std::shared_ptr<const int>> results(kThreads);
+    std::vector<std::thread> threads;
+    for (int t = 0; t < kThreads; ++t) {
+        threads.emplace_back([&, t] { results[t] = cache.get(loader); });
+    }
+    for (auto& t : threads) t.join();
+
+    EXPECT_EQ(loads.load(), 1);
+    EXPECT_EQ(cache.stats().loads, 1u);
+    EXPECT_EQ(cache.stats().coalesced, static_cast<std::uint64_t>(kThreads - 1));
+    for (const auto& r : results) {
+        ASSERT_TRUE(r);
+        EXPECT_EQ(r.get(), results[0].get());
+    }
+}
+
+TEST(ReadCacheTest, Waiters_GetTheLoadTheyJoinedDespiteInvalidation) {
+    CoalescingCache<int> cache;
+    constexpr int kWaiters = 4;
+    std::atomic<bool> stop{false};
+    std::thread invalidator([&] {
+        while (!stop.load(std::memory_order_relaxed)) cache.invalidate();
+    });
+
+    for (int round = 0; round < 200; ++round) {
+        const std::uint64_t joined = cache.stats().coalesced + kWaiters;
+        auto loader = [&] {
+            const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+            while (cache.stats().coalesced < joined && std::chrono::steady_clock::now() < deadline) {
+                std::this_thread::yield();
+            }
+            return round;
+        };
+        std::vector<std::shared_ptr<const int>> results(kWaiters);
+        std::vector<std::thread> threads;
+        // As soon as its load finishes, the loading thread invalidates the cache and loads again,
+        // usually before the waiters have woken.
+        threads.emplace_back([&] {
+            EXPECT_EQ(*cache.get(loader), round);
+            cache.invalidate();
+            EXPECT_EQ(*cache.get([] { return -1; }), -1);
+        });
+        while (cache.stats().loads <= static_cast<std::uint64_t>(2 * round)) std::this_thread::yield();
+        for (int t = 0; t < kWaiters; ++t) {
+            threads.emplace_back([&, t] { results[t] = cache.get(loader); });
+        }
+        for (auto& t : threads) t.join();
+        for (const auto& r : results) {
+            ASSERT_TRUE(r);
+            EXPECT_EQ(*r, round);
+        }
+    }
+    stop = true;
+    invalidator.join();
+}
+
+TEST(ReadCacheTest, StalenessWindow_ControlsReuse) {
+    CoalescingCache<int> cache; // Window of 0: sequential calls reload
+    int loads = 0;
+    auto loader = [&] { return ++loads; };
+    EXPECT_EQ(*cache.get(loader), 1);
+    EXPECT_EQ(*cache.get(loader), 2);
+
+    cache.setMaxAge(std::chrono::hours(1));
+    EXPECT_EQ(*cache.get(loader), 2);
+    EXPECT_EQ(cache.stats().hits, 1u);
+    cache.invalidate();
+    EXPECT_EQ(*cache.get(loader), 3);
+}
+
+TEST(ReadCacheTest, SourceChange_InvalidatesCachedValue) {
+    CoalescingCache<int> cache(std::chrono::hours(1));
+    int loads = 0;
+    auto loader = [&] { return ++loads; };
+    EXPECT_EQ(*cache.get(loader), 1);
+    {
+        ScopedProcSource scoped(std::make_shared<VirtualProcSource>());
+        EXPECT_EQ(*cache.get(loader), 2);
+        EXPECT_EQ(*cache.get(loader), 2);
+    }
+    EXPECT_EQ(*cache.get(loader), 3);
+}
+
+TEST(ReadCacheTest, LoaderFailure_IsNotCached) {
+    CoalescingCache<int> cache(std::chrono::hours(1));
+    EXPECT_THROW(cache.get([]() -> int { throw std::runtime_error("unreadable"); }), std::runtime_error);
+    EXPECT_EQ(*cache.get([] { return 7; }), 7);
+}
+
+#if defined(__linux__)
+TEST(ReadCacheTest, DeviceLookups_AreServedFromOneRead) {
+    auto source = std::make_shared<VirtualProcSource>();
+    source->setFile("/proc/diskstats",
+                    "   8       0 sda 100 0 1000 500 200 0 2000 1000 0 0 0 0\n"
+                    " 259       0 nvme0n1 10 0 300 30 20 0 400 40 0 0 0 0\n");
+    source->setFile("/proc/net/dev",
+                    "Inter-|   Receive\n"
+                    " face |bytes    packets errs drop fifo frame compressed multicast|bytes    packets\n"
+                    "  eth0:    5000      50    1    2    0     0          0         0     3000      30    3    4    0     0       0          0\n"
+                    "  eth1:     100       1    0    0    0     0          0         0      200       2    0    0    0     0       0          0\n");
+    ScopedProcSource scoped(source);
+    SystemDiskStats::DiskStatsReader::setCacheMaxAge(std::chrono::hours(1));
+    SystemNetStats::NetStatsReader::setCacheMaxAge(std::chrono::hours(1));
+
+    const auto disk_loads = SystemDiskStats::DiskStatsReader::cacheStats().loads;
+    EXPECT_EQ(SystemDiskStats::DiskStatsReader::getDiskStats("sda").read_bytes, 1000ULL * 512ULL);
+    EXPECT_EQ(SystemDiskStats::DiskStatsReader::getDiskStats("nvme0n1").write_bytes, 400ULL * 512ULL);
+    EXPECT_EQ(SystemDiskStats::DiskStatsReader::getDiskStats().read_time_ms, 530ULL);
+    EXPECT_EQ(SystemDiskStats::DiskStatsReader::cacheStats().loads, disk_loads + 1);
+
+    const auto net_loads = SystemNetStats::NetStatsReader::cacheStats().loads;
+    EXPECT_EQ(SystemNetStats::NetStatsReader::getNetStats("eth0").bytes_received, 5000ULL);
+    EXPECT_EQ(SystemNetStats::NetStatsReader::getNetStats("eth1").bytes_sent, 200ULL);
+    EXPECT_EQ(SystemNetStats::NetStatsReader::cacheStats().loads, net_loads + 1);
+
+    // Inside the window a changed file is not seen until the cache is invalidated.
+    source->removeFile("/proc/diskstats");
+    EXPECT_NO_THROW(SystemDiskStats::DiskStatsReader::getAllDiskStats());
+    SystemDiskStats::DiskStatsReader::invalidateCache();
+    EXPECT_THROW(SystemDiskStats::DiskStatsReader::getAllDiskStats(), std::runtime_error);
+
+    SystemDiskStats::DiskStatsReader::setCacheMaxAge(std::chrono::milliseconds(0));
+    SystemNetStats::NetStatsReader::setCacheMaxAge(std::chrono::milliseconds(0));
+}
+#endif
@@ -0,0 +1,169 @@
+#include <gtest/gtest.h>
+#include "ring_log.hpp"
+
+#include <cstdio>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <unistd.h>
+
+using namespace SystemMetricsHistory;
+using SystemMetricsCodec::ByteSpan;
+using SystemMetricsSnapshot::MetricsSnapshot;
+
+namespace {
+MetricsSnapshot makeSnapshot(unsigned long long step) {
+    MetricsSnapshot s;
+    s.timestamp_ms = 1700000000000ULL + step * 1000;
+    s.cpu = SystemCPUStats::CPUStats(1000 + step, 200, 300, 4000 + step, 0, 0, 0, 0, 0, 0);
+    s.mem = SystemMemoryStats::MemStats(16000000, 4000000 + step, 9000000, 0, 0, 0, 0);
+    s.disks.emplace_back("sda", 512 * step, 1024 * step, step, step);
+    s.nets.emplace_back("eth0", 1500 * step, 60 * step, step, step, 0, 0, 0, 0);
+    return s;
+}
+
+// Overwrites part of the file at `offset` with `bytes`.
+void patchFile(const std::string& path, std::streamoff offset, const std::string& bytes) {
+    std::fstream file(path, std::ios::in | std::ios::out | std::ios::binary);
+    file.seekp(offset);
+    file.write(bytes.data(), static_cast<std::streamsize>(bytes.size()));
+}
+} // namespace
+
+class RingLogTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        char path_template[] = "/tmp/ring_log_testXXXXXX";
+        int fd = ::mkstemp(path_template);
+        ASSERT_GE(fd, 0);
+        ::close(fd);
+        path_ = path_template;
+        std::remove(path_.c_str()); // Let RingLog create it
+    }
+
+    void TearDown() override {
+        std::remove(path_.c_str());
+    }
+
+    std::string path_;
+};
+
+TEST_F(RingLogTest, AppendAndReplay_RoundTripsSnapshots) {
+    RingLog log(path_, 64 * 1024);
+    EXPECT_EQ(log.size(), 0u);
+    MetricsSnapshot latest;
+    EXPECT_FALSE(log.latest(latest));
+
+    for (unsigned long long step = 0; step < 10; ++step) {
+        EXPECT_EQ(log.append(makeSnapshot(step)), step);
+    }
+    EXPECT_EQ(log.size(), 10u);
+    EXPECT_EQ(log.firstSequence(), 0u);
+    EXPECT_EQ(log.nextSequence(), 10u);
+
+    std::vector<MetricsSnapshot> history = log.replay();
+    ASSERT_EQ(history.size(), 10u);
+    EXPECT_EQ(history[3].timestamp_ms, makeSnapshot(3).timestamp_ms);
+    EXPECT_EQ(history[9].nets[0].bytes_received, makeSnapshot(9).nets[0].bytes_received);
+
+    std::vector<MetricsSnapshot> tail = log.replay(2);
+    ASSERT_EQ(tail.size(), 2u);
+    EXPECT_EQ(tail[0].timestamp_ms, makeSnapshot(8).timestamp_ms);
+
+    ASSERT_TRUE(log.latest(latest));
+    EXPECT_EQ(latest.disks[0].read_bytes, makeSnapshot(9).disks[0].read_bytes);
+}
+
+TEST_F(RingLogTest, Reopen_ResumesWhereItLeftOff) {
+    {
+        RingLog log(path_, 64 * 1024);
+        for (unsigned long long step = 0; step < 5; ++step) log.append(makeSnapshot(step));
+        log.sync();
+    }
+    RingLog reopened(path_, 4096); // Existing files keep their own capacity
+    EXPECT_EQ(reopened.capacity(), 64u * 1024u);
+    EXPECT_EQ(reopened.size(), 5u);
+    EXPECT_EQ(reopened.append(makeSnapshot(5)), 5u);
+
+    MetricsSnapshot latest;
+    ASSERT_TRUE(reopened.latest(latest));
+    EXPECT_EQ(latest.timestamp_ms, makeSnapshot(5).timestamp_ms);
+}
+
+TEST_F(RingLogTest, Append_WrapsAndEvictsOldestRecords) {
+    RingLog log(path_, 4096);
+    std::vector<std::uint8_t> payload(300);
+    for (std::uint64_t i = 0; i < 100; ++i) {
+        payload.assign(100 + (i * 37) % 400, static_cast<std::uint8_t>(i));
+        EXPECT_EQ(log.append(ByteSpan(payload)), i);
+    }
+    EXPECT_EQ(log.nextSequence(), 100u);
+    EXPECT_GT(log.firstSequence(), 80u);
+
+    std::uint64_t expected = log.firstSequence();
+    size_t visited = log.forEach([&](std::uint64_t seq, ByteSpan record) {
+        EXPECT_EQ(seq, expected);
+        EXPECT_EQ(record.size, 100 + (seq * 37) % 400);
+        EXPECT_EQ(record.data[0], static_cast<std::uint8_t>(seq));
+        ++expected;
+        return true;
+    });
+    EXPECT_EQ(visited, log.size());
+    EXPECT_EQ(expected, 100u);
+
+    std::vector<std::uint8_t> too_big(4096);
+    EXPECT_THROW(log.append(ByteSpan(too_big)), std::invalid_argument);
+}
+
+TEST_F(RingLogTest, Reopen_SurvivesTornHeaderAndCorruptRecords) {
+    {
+        RingLog log(path_, 8192);
+        for (unsigned long long step = 0; step < 6; ++step) log.append(makeSnapshot(step));
+    }
+
+    // Clobbering one header slot falls back to the other; the record written after that
+    // commit is recovered from the data region.
+    patchFile(path_, 0, std::string(16, '\xAB'));
+    {
+        RingLog log(path_, 8192, RingLog::Mode::ReadOnly);
+        EXPECT_GE(log.size(), 5u);
+    }
+    {
+        RingLog log(path_, 8192);
+        EXPECT_EQ(log.size(), 6u);
+        MetricsSnapshot latest;
+        ASSERT_TRUE(log.latest(latest));
+        EXPECT_EQ(latest.timestamp_ms, makeSnapshot(5).timestamp_ms);
+    }
+
+    // A corrupt record ends the replay instead of returning garbage.
+    patchFile(path_, 4096 + 20, "\x01\x02\x03");
+    {
+        RingLog log(path_, 8192, RingLog::Mode::ReadOnly);
+        EXPECT_EQ(log.forEach([](std::uint64_t, ByteSpan) { return true; }), 0u);
+    }
+
+    // With both slots gone the file is unreadable: read-only opens fail, read-write opens start over.
+    patchFile(path_, 0, std::string(256, '\0'));
+    EXPECT_THROW(RingLog(path_, 8192, RingLog::Mode::ReadOnly), std::runtime_error);
+    RingLog fresh(path_, 8192);
+    EXPECT_EQ(fresh.size(), 0u);
+    EXPECT_EQ(fresh.append(makeSnapshot(0)), 0u);
+}
+
+TEST_F(RingLogTest, ReadOnly_RejectsAppendsAndMissingFiles) {
+    EXPECT_THROW(RingLog(path_, 8192, RingLog::Mode::ReadOnly), std::runtime_error);
+    EXPECT_THROW(RingLog(path_, 100), std::invalid_argument);
+    {
+        RingLog log(path_, 8192);
+        log.append(makeSnapshot(1));
+    }
+    RingLog reader(path_, 8192, RingLog::Mode::ReadOnly);
+    EXPECT_TRUE(reader.readOnly());
+    EXPECT_EQ(reader.replay().size(), 1u);
+    EXPECT_THROW(reader.append(makeSnapshot(2)), std::logic_error);
+}
+#endif
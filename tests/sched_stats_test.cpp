@@ -0,0 +1,155 @@
+#include <gtest/gtest.h>
+#include "sched_stats.hpp"
+#include "proc_source.hpp"
+#include "test_clock.hpp"
+
+#include <chrono>
+#include <memory>
+#include <stdexcept>
+#include <string>
+
+#if defined(__linux__)
+#include <unistd.h>
+#endif
+
+using namespace SystemCPUStats;
+using SystemProcFS::ScopedProcSource;
+using SystemProcFS::VirtualProcSource;
+using TestClock::at;
+
+namespace {
+// A version 15 file; run_time, run_delay and timeslices are the last three cpu fields.
+std::string schedstat(const std::string& cpus) {
+    return "version 15\ntimestamp 4295234567\n" + cpus;
+}
+
+std::string cpuLine(unsigned cpu, unsigned long long run_time, unsigned long long run_delay, unsigned long long slices) {
+    return "cpu" + std::to_string(cpu) + " 0 0 4000 1500 2600 1200 " + std::to_string(run_time) + " " +
+           std::to_string(run_delay) + " " + std::to_string(slices) + "\n" +
+           "domain0 00000000,00000003 1 2 3 4 5 6 7 8 9 10 11 12 13 14 15 16 17 18 19 20 21 22 23 24 25 26 27 28 "
+           "29 30 31 32 33 34 35 36\n";
+}
+} // namespace
+
+TEST(SchedStatsTest, Parse_ReadsCpuLinesAndSkipsDomains) {
+    SchedStat stats;
+    SchedStatsReader::parse(schedstat(cpuLine(0, 9000000000ULL, 120000000, 30000) + cpuLine(2, 5, 6, 7)), stats);
+    EXPECT_EQ(stats.version, 15u);
+    ASSERT_EQ(stats.cpus.size(), 2u);
+    EXPECT_EQ(stats.cpus[0].cpu, 0u);
+    EXPECT_EQ(stats.cpus[0].schedule_calls, 4000u);
+    EXPECT_EQ(stats.cpus[0].idle_schedules, 1500u);
+    EXPECT_EQ(stats.cpus[0].wakeups, 2600u);
+    EXPECT_EQ(stats.cpus[0].run_time_ns, 9000000000ULL);
+    EXPECT_EQ(stats.cpus[0].run_delay_ns, 120000000u);
+    EXPECT_EQ(stats.cpus[0].timeslices, 30000u);
+    EXPECT_EQ(stats.cpus[1].cpu, 2u);
+    EXPECT_EQ(stats.cpus[1].timeslices, 7u);
+
+    EXPECT_THROW(SchedStatsReader::parse("version 14\n" + cpuLine(0, 1, 2, 3), stats), std::runtime_error);
+    EXPECT_THROW(SchedStatsReader::parse(cpuLine(0, 1, 2, 3), stats), std::runtime_error);
+    EXPECT_THROW(SchedStatsReader::parse(schedstat("cpu0 0 0 1 2 3\n"), stats), std::runtime_error);
+
+    TaskSchedCounters task;
+    SchedStatsReader::parseTask("33431546 120228 17\n", task);
+    EXPECT_EQ(task.run_time_ns, 33431546u);
+    EXPECT_EQ(task.run_delay_ns, 120228u);
+    EXPECT_EQ(task.timeslices, 17u);
+    EXPECT_THROW(SchedStatsReader::parseTask("1 2\n", task), std::runtime_error);
+    EXPECT_THROW(SchedStatsReader::parseTask("1 2 3 4\n", task), std::runtime_error);
+}
+
+TEST(SchedStatsTest, Collector_ComputesRunQueueWaitPerCpuAndTask) {
+    auto source = std::make_shared<VirtualProcSource>();
+    source->setSequence("/proc/schedstat", {
+        schedstat(cpuLine(0, 1000000000, 100000000, 1000) + cpuLine(1, 1000000000, 0, 1000)),
+        // Over 2 s: CPU 0 ran 1.6 s and queued 0.8 s over 2,000 timeslices (400 us each); CPU 1 never queued.
+        schedstat(cpuLine(0, 2600000000ULL, 900000000, 3000) + cpuLine(1, 1500000000, 0, 1500)),
+    });
+    source->setSequence("/proc/100/schedstat", {"5000000 1000000 10\n", "505000000 51000000 110\n"});
+    source->setFile("/proc/200/schedstat", "1 2 3\n");
+    ScopedProcSource scoped(source);
+
+    SchedCollector collector;
+    collector.track(100);
+    collector.track(200);
+    collector.track(100);
+    EXPECT_EQ(collector.tracked().size(), 2u);
+    collector.sample(at(0));
+    EXPECT_FALSE(collector.hasRates());
+    EXPECT_TRUE(collector.hasCPUStats());
+
+    source->advance();
+    source->removeFile("/proc/200/schedstat"); // Exited
+    collector.sample(at(2));
+    ASSERT_TRUE(collector.hasRates());
+
+    const SchedRates& rates = collector.rates();
+    EXPECT_DOUBLE_EQ(rates.elapsed_seconds, 2.0);
+    ASSERT_EQ(rates.cpus.size(), 2u);
+    EXPECT_DOUBLE_EQ(rates.cpus[0].latency.running, 0.8);
+    EXPECT_DOUBLE_EQ(rates.cpus[0].latency.waiting, 0.4);
+    EXPECT_DOUBLE_EQ(rates.cpus[0].latency.timeslices, 1000.0);
+    EXPECT_DOUBLE_EQ(rates.cpus[0].latency.average_wait_us, 400.0);
+    EXPECT_DOUBLE_EQ(rates.cpus[1].latency.average_wait_us, 0.0);
+    // 0.8 s of waiting over 2,500 timeslices on both CPUs.
+    EXPECT_DOUBLE_EQ(rates.total.waiting, 0.4);
+    EXPECT_DOUBLE_EQ(rates.total.average_wait_us, 320.0);
+
+    ASSERT_EQ(rates.tasks.size(), 1u);
+    EXPECT_EQ(rates.tasks[0].pid, 100);
+    EXPECT_DOUBLE_EQ(rates.tasks[0].latency.running, 0.25);
+    EXPECT_DOUBLE_EQ(rates.tasks[0].latency.average_wait_us, 500.0);
+    EXPECT_EQ(collector.tracked(), (std::vector<int>{100}));
+
+    source->setFile("/proc/100/schedstat", "garbage\n");
+    EXPECT_THROW(collector.sample(at(3)), std::runtime_error);
+    EXPECT_EQ(collector.tracked(), (std::vector<int>{100}));
+
+    // A failed sample is dropped, even once CPU 0 was parsed: the next rates cover the interval
+    // since the last good one.
+    source->setFile("/proc/100/schedstat", "605000000 51000000 110\n");
+    source->setFile("/proc/schedstat", schedstat(cpuLine(0, 9000000000ULL, 0, 0) + "cpu1 0 0 1 2 3\n"));
+    EXPECT_THROW(collector.sample(at(4)), std::runtime_error);
+    source->setFile("/proc/schedstat", schedstat(cpuLine(0, 5600000000ULL, 1200000000, 4000) + cpuLine(1, 1500000000, 0, 1500)));
+    collector.sample(at(5));
+    EXPECT_DOUBLE_EQ(collector.rates().elapsed_seconds, 3.0);
+    ASSERT_EQ(collector.rates().cpus.size(), 2u);
+    EXPECT_DOUBLE_EQ(collector.rates().cpus[0].latency.running, 1.0);
+    EXPECT_DOUBLE_EQ(collector.rates().cpus[0].latency.average_wait_us, 300.0);
+    ASSERT_EQ(collector.rates().tasks.size(), 1u);
+    EXPECT_DOUBLE_EQ(collector.rates().tasks[0].latency.running, 0.1 / 3.0);
+}
+
+TEST(SchedStatsTest, Collector_WithoutSchedstatReportsTasksOnly) {
+    auto source = std::make_shared<VirtualProcSource>();
+    source->setSequence("/proc/7/schedstat", {"0 0 0\n", "1000000 2000000 4\n"});
+    ScopedProcSource scoped(source);
+
+    EXPECT_THROW(SchedStatsReader::getSchedStats(), std::runtime_error);
+    SchedCollector collector;
+    collector.track(7);
+    collector.sample(at(0));
+    source->advance();
+    collector.sample(at(1));
+    EXPECT_FALSE(collector.hasCPUStats());
+    EXPECT_TRUE(collector.rates().cpus.empty());
+    ASSERT_EQ(collector.rates().tasks.size(), 1u);
+    EXPECT_DOUBLE_EQ(collector.rates().tasks[0].latency.waiting, 0.002);
+    EXPECT_DOUBLE_EQ(collector.rates().tasks[0].latency.average_wait_us, 500.0);
+}
+
+#if defined(__linux__)
+TEST(SchedStatsTest, Collector_ReadsLiveHost) {
+    SchedCollector collector;
+    collector.track(static_cast<int>(getpid()));
+    collector.sample();
+    usleep(20000); // Gives up the CPU at least once
+    collector.sample();
+    ASSERT_EQ(collector.rates().tasks.size(), 1u);
+    EXPECT_GT(collector.rates().tasks[0].latency.timeslices, 0.0);
+    if (collector.hasCPUStats()) {
+        EXPECT_FALSE(collector.rates().cpus.empty());
+    }
+}
+#endif
@@ -0,0 +1,179 @@
+#include <gtest/gtest.h>
+#include "shm_snapshot.hpp"
+
+#include <atomic>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <unistd.h>
+
+using namespace SystemMetricsShm;
+using SystemMetricsSnapshot::MetricsSnapshot;
+
+namespace {
+std::string uniqueName(const char* suffix) {
+    return "/metrics_agent_test_" + std::to_string(::getpid()) + "_" + suffix;
+}
+
+// Every field is derived from `i` so that readers can detect torn copies.
+MetricsSnapshot makeSnapshot(unsigned long long i) {
+    MetricsSnapshot s;
+    s.timestamp_ms = i;
+    s.cpu = SystemCPUStats::CPUStats(double(i), double(i + 1), 0, double(i * 2), 0, 0, 0, 0, 0, 0, 12.5);
+    s.mem = SystemMemoryStats::MemStats(i, i + 1, i + 2, 0, 0, 0, 0);
+    for (unsigned long long d = 0; d < 1 + i % 3; ++d) {
+        s.disks.emplace_back("sd" + std::string(1, char('a' + d)), i, i * 2, i * 3, i * 4);
+    }
+    s.nets.emplace_back("eth0", i, i, i, i, i, i, i, i);
+    return s;
+}
+
+bool consistent(const MetricsSnapshot& s) {
+    const unsigned long long i = s.timestamp_ms;
+    if (s.cpu.user != double(i) || s.cpu.idle != double(i * 2) || s.mem.available != i + 2) return false;
+    if (s.disks.size() != 1 + i % 3 || s.nets.size() != 1) return false;
+    for (const auto& d : s.disks) {
+        if (d.read_bytes != i || d.write_time_ms != i * 4) return false;
+    }
+    return s.nets[0].drops_out == i && s.nets[0].interface_name == "eth0";
+}
+} // namespace
+
+TEST(ShmSnapshotTest, PublishAndRead_RoundTripsSnapshot) {
+    ShmPublisher publisher(uniqueName("roundtrip"));
+    ShmReader reader(publisher.name());
+    MetricsSnapshot out;
+    EXPECT_FALSE(reader.read(out)); // Nothing published yet
+    EXPECT_EQ(reader.sequence(), 0u);
+
+    MetricsSnapshot snapshot = makeSnapshot(7);
+    snapshot.nets.emplace_back("a_very_long_interface_name_beyond_the_limit", 1, 2, 3, 4, 5, 6, 7, 8);
+    publisher.publish(snapshot);
+    ASSERT_TRUE(reader.read(out));
+    EXPECT_EQ(out.timestamp_ms, 7u);
+    EXPECT_DOUBLE_EQ(out.cpu.usage_percent, 12.5);
+    EXPECT_EQ(out.mem.free, 8u);
+    ASSERT_EQ(out.disks.size(), 2u);
+    EXPECT_EQ(out.disks[1].device, "sdb");
+    EXPECT_EQ(out.disks[1].write_bytes, 14u);
+    ASSERT_EQ(out.nets.size(), 2u);
+    EXPECT_EQ(out.nets[1].interface_name, snapshot.nets[1].interface_name.substr(0, kMaxShmNameLength));
+    EXPECT_EQ(out.nets[1].drops_out, 8u);
+    EXPECT_EQ(publisher.publishCount(), 1u);
+}
+
+TEST(ShmSnapshotTest, Publish_TruncatesToReservedSlots) {
+    ShmPublisher publisher(uniqueName("slots"), 1, 1);
+    ShmReader reader(publisher.name());
+    publisher.publish(makeSnapshot(2)); // Three disks, one slot
+    MetricsSnapshot out;
+    ASSERT_TRUE(reader.read(out));
+    EXPECT_EQ(out.disks.size(), 1u);
+    EXPECT_EQ(out.nets.size(), 1u);
+    EXPECT_EQ(out.nets[0].bytes_sent, 2u);
+}
+
+TEST(ShmSnapshotTest, ReadIfChanged_SkipsUnchangedSequence) {
+    ShmPublisher publisher(uniqueName("changed"));
+    ShmReader reader(publisher.name());
+    MetricsSnapshot out;
+    std::uint64_t last = 0;
+    publisher.publish(makeSnapshot(1));
+    EXPECT_TRUE(reader.readIfChanged(out, last));
+    EXPECT_FALSE(reader.readIfChanged(out, last));
+    publisher.publish(makeSnapshot(2));
+    EXPECT_TRUE(reader.readIfChanged(out, last));
+    EXPECT_EQ(out.timestamp_ms, 2u);
+    EXPECT_EQ(last, reader.sequence());
+}
+
+TEST(ShmSnapshotTest, Reader_DetectsReplacedPublisherAndReopens) {
+    const std::string name = uniqueName("stale");
+    EXPECT_THROW(ShmReader missing(name), std::runtime_error);
+    EXPECT_THROW(ShmPublisher("no-slash"), std::invalid_argument);
+
+    auto first = std::make_unique<ShmPublisher>(name);
+    first->publish(makeSnapshot(1));
+    ShmReader reader(name);
+    EXPECT_FALSE(reader.stale());
+
+    ShmPublisher second(name);
+    second.publish(makeSnapshot(2));
+    EXPECT_TRUE(reader.stale());
+    MetricsSnapshot out;
+    EXPECT_FALSE(reader.read(out));
+    first.reset(); // Must not unlink the name now owned by `second`
+
+    reader.reopen();
+    EXPECT_EQ(reader.retired(), 0u); // No read was under way: the old region is unmapped at once
+    EXPECT_FALSE(reader.stale());
+    ASSERT_TRUE(reader.read(out));
+    EXPECT_EQ(out.timestamp_ms, 2u);
+}
+
+TEST(ShmSnapshotTest, Reopen_IsSafeWhileOtherThreadsRead) {
+    const std::string name = uniqueName("reopen");
+    auto publisher = std::make_unique<ShmPublisher>(name);
+    publisher->publish(makeSnapshot(1));
+    ShmReader reader(name);
+
+    std::atomic<bool> done{false};
+    std::atomic<unsigned long long> reads{0};
+    std::vector<std::thread> readers;
+    for (int t = 0; t < 2; ++t) {
+        readers.emplace_back([&] {
+            MetricsSnapshot out;
+            while (!done.load()) {
+                if (reader.read(out)) ++reads;
+            }
+        });
+    }
+    for (unsigned long long i = 2; i < 50; ++i) {
+        publisher = std::make_unique<ShmPublisher>(name); // Marks the previous region stale
+        publisher->publish(makeSnapshot(i));
+        reader.reopen();
+    }
+    done = true;
+    for (auto& thread : readers) thread.join();
+
+    // Regions replaced while reads were under way are unmapped by the next quiet reopen().
+    publisher = std::make_unique<ShmPublisher>(name);
+    publisher->publish(makeSnapshot(50));
+    reader.reopen();
+    EXPECT_EQ(reader.retired(), 0u);
+    MetricsSnapshot out;
+    ASSERT_TRUE(reader.read(out));
+    EXPECT_EQ(out.timestamp_ms, 50u);
+}
+
+TEST(ShmSnapshotTest, ConcurrentReaders_NeverObserveTornSnapshots) {
+    ShmPublisher publisher(uniqueName("concurrent"));
+    ShmReader reader(publisher.name());
+    publisher.publish(makeSnapshot(1));
+
+    std::atomic<bool> done{false};
+    std::atomic<unsigned long long> reads{0};
+    std::atomic<unsigned long long> torn{0};
+    std::vector<std::thread> readers;
+    for (int t = 0; t < 4; ++t) {
+        readers.emplace_back([&] {
+            MetricsSnapshot out;
+            while (!done.load()) {
+                if (reader.read(out)) {
+                    ++reads;
+                    if (!consistent(out)) ++torn;
+                }
+            }
+        });
+    }
+    for (unsigned long long i = 2; i < 200000; ++i) publisher.publish(makeSnapshot(i % 1000 + 1));
+    done.store(true);
+    for (auto& t : readers) t.join();
+    EXPECT_GT(reads.load(), 0u);
+    EXPECT_EQ(torn.load(), 0u);
+}
+#endif
@@ -0,0 +1,233 @@
+#include <gtest/gtest.h>
+#include "simd_scan.hpp"
+#include "cpu_stats.hpp"
+
+#include <cstdint>
+#include <cstdio>
+#include <random>
+#include <string>
+#include <string_view>
+#include <vector>
+
+using namespace SystemProcFS;
+
+namespace {
+// Runs `check` once per scan level the CPU supports, restoring the default afterwards.
+template <typename Check>
+void forEachLevel(Check check) {
+    const ScanLevel original = activeScanLevel();
+    for (ScanLevel level : {ScanLevel::Scalar, ScanLevel::SSE42, ScanLevel::AVX2}) {
+        if (setScanLevel(level) != level) continue;
+        SCOPED_TRACE(scanLevelName(level));
+        check();
+    }
+    setScanLevel(original);
+}
+
+std::vector<std::string> referenceSplit(std::string_view line) {
+    std::vector<std::string> fields;
+    std::size_t i = 0;
+    while (i < line.size()) {
+        while (i < line.size() && std::string_view(" \t\n\v\f\r").find(line[i]) != std::string_view::npos) ++i;
+        const std::size_t begin = i;
+        while (i < line.size() && std::string_view(" \t\n\v\f\r").find(line[i]) == std::string_view::npos) ++i;
+        if (i > begin) fields.emplace_back(line.substr(begin, i - begin));
+    }
+    return fields;
+}
+} // namespace
+
+TEST(SimdScanTest, LineFields_MatchesReferenceOnRandomLines) {
+    std::mt19937 rng(1234);
+    const char alphabet[] = "0123456789abc:  \t\r";
+    std::vector<std::string> lines;
+    for (int n = 0; n < 500; ++n) {
+        std::string line(rng() % 120, ' ');
+        for (char& c : line) c = alphabet[rng() % (sizeof(alphabet) - 1)];
+        lines.push_back(line);
+    }
+    forEachLevel([&] {
+        for (const auto& line : lines) {
+            const auto expected = referenceSplit(line);
+            const LineFields fields(line);
+            ASSERT_EQ(fields.size(), std::min(expected.size(), LineFields::kMaxFields)) << '"' << line << '"';
+            for (std::size_t i = 0; i < fields.size(); ++i) {
+                EXPECT_EQ(fields[i], expected[i]);
+            }
+        }
+    });
+}
+
+TEST(SimdScanTest, LineFields_CapsFieldCountAndKeepsRest) {
+    std::string line;
+    for (int n = 0; n < 40; ++n) line += " f" + std::to_string(n);
+    forEachLevel([&] {
+        const LineFields fields(line);
+        ASSERT_EQ(fields.size(), LineFields::kMaxFields);
+        EXPECT_EQ(fields[31], "f31");
+        EXPECT_EQ(referenceSplit(fields.rest()).front(), "f32");
+    });
+}
+
+TEST(SimdScanTest, UnsignedAt_ParsesAllLengthsAndRejectsBadInput) {
+    forEachLevel([&] {
+        std::uint64_t value = 0;
+        std::string digits;
+        std::uint64_t expected = 0;
+        for (int len = 1; len <= 19; ++len) {
+            digits += static_cast<char>('0' + len % 10);
+            expected = expected * 10 + static_cast<unsigned>(len % 10);
+            const std::string line = "x " + digits + " y";
+            const LineFields fields(line);
+            ASSERT_TRUE(fields.unsignedAt(1, value)) << digits;
+            EXPECT_EQ(value, expected);
+            ASSERT_TRUE(parseDecimal(digits, value));
+            EXPECT_EQ(value, expected);
+        }
+        const LineFields fields("18446744073709551615 18446744073709551616 12a4 -1 0000000000000000042");
+        ASSERT_TRUE(fields.unsignedAt(0, value));
+        EXPECT_EQ(value, 18446744073709551615ULL);
+        EXPECT_FALSE(fields.unsignedAt(1, value));
+        EXPECT_FALSE(fields.unsignedAt(2, value));
+        EXPECT_FALSE(fields.unsignedAt(3, value));
+        ASSERT_TRUE(fields.unsignedAt(4, value));
+        EXPECT_EQ(value, 42u);
+        EXPECT_FALSE(fields.unsignedAt(5, value));
+        EXPECT_FALSE(parseDecimal("", value));
+        EXPECT_FALSE(parseDecimal("9/", value));
+        EXPECT_FALSE(parseDecimal(":1", value));
+    });
+}
+
+TEST(SimdScanTest, FindNewline_FindsFirstNewlineAtAnyOffset) {
+    forEachLevel([&] {
+        for (std::size_t pos = 0; pos < 100; ++pos) {
+            std::string text(120, 'a');
+            text[pos] = '\n';
+            text[pos + 5] = '\n';
+            EXPECT_EQ(findNewline(text), pos);
+        }
+        EXPECT_EQ(findNewline(std::string(70, 'a')), std::string_view::npos);
+    });
+}
+
+TEST(SimdScanTest, SubtractCounters_MatchesCounterDelta) {
+    std::mt19937_64 rng(7);
+    const std::uint64_t interesting[] = {0, 1, 5, (1ULL << 31) - 1, 1ULL << 31, (1ULL << 32) - 6, (1ULL << 32) - 1,
+                                         1ULL << 32, (1ULL << 32) + 3, ~0ULL};
+    std::vector<std::uint64_t> previous, current;
+    for (std::uint64_t a : interesting) {
+        for (std::uint64_t b : interesting) {
+            previous.push_back(a);
+            current.push_back(b);
+        }
+    }
+    for (int n = 0; n < 301; ++n) {
+        previous.push_back(rng() >> (rng() % 64));
+        current.push_back(rng() >> (rng() % 64));
+    }
+    forEachLevel([&] {
+        std::vector<std::uint64_t> delta(previous.size());
+        subtractCounters(previous.data(), current.data(), delta.data(), delta.size());
+        for (std::size_t i = 0; i < delta.size(); ++i) {
+            ASSERT_EQ(delta[i], SystemCPUStats::counterDelta(previous[i], current[i])) << previous[i] << " -> " << current[i];
+        }
+    });
+}
+
+TEST(SimdScanTest, ParseUnsignedRun_StopsAtFirstNonNumericField) {
+    forEachLevel([&] {
+        std::string row;
+        std::vector<std::uint64_t> expected;
+        std::mt19937_64 rng(11);
+        for (int n = 0; n < 40; ++n) {
+            const std::uint64_t value = rng() >> (rng() % 60);
+            expected.push_back(value);
+            row += std::string(1 + rng() % 20, n % 7 == 0 ? '\t' : ' ') + std::to_string(value);
+        }
+        const std::string line = row + "  IR-PCI-MSI 524288-edge      eth0-TxRx-0";
+        std::vector<std::uint64_t> values(64);
+        std::size_t consumed = 0;
+        ASSERT_EQ(parseUnsignedRun(line, values.data(), values.size(), consumed), expected.size());
+        values.resize(expected.size());
+        EXPECT_EQ(values, expected);
+        EXPECT_EQ(consumed, row.size());
+
+        // Capped by max_values, and at the end of the text.
+        EXPECT_EQ(parseUnsignedRun(line, values.data(), 3, consumed), 3u);
+        EXPECT_EQ(parseUnsignedRun(row, values.data(), 64, consumed), expected.size());
+        EXPECT_EQ(consumed, row.size());
+
+        // A field that merely starts with digits is not a number; neither is one that overflows.
+        EXPECT_EQ(parseUnsignedRun("          7 2-edge                timer", values.data(), 8, consumed), 1u);
+        EXPECT_EQ(consumed, 11u);
+        EXPECT_EQ(parseUnsignedRun(" 18446744073709551616 1", values.data(), 8, consumed), 0u);
+        EXPECT_EQ(consumed, 0u);
+        EXPECT_EQ(parseUnsignedRun(" 18446744073709551615 1", values.data(), 8, consumed), 2u);
+        EXPECT_EQ(values[0], 18446744073709551615ULL);
+        EXPECT_EQ(parseUnsignedRun(" 1234567890123456789                   ", values.data(), 8, consumed), 1u);
+        EXPECT_EQ(values[0], 1234567890123456789ULL);
+        EXPECT_EQ(parseUnsignedRun("", values.data(), 8, consumed), 0u);
+    });
+}
+
+TEST(SimdScanTest, ParseFixedWidthColumns_ParsesRightAlignedColumns) {
+    forEachLevel([&] {
+        std::string text;
+        std::vector<std::uint64_t> expected;
+        char column[32];
+        for (unsigned n = 0; n < 37; ++n) {
+            const unsigned value = n == 5 ? 4294967295u : n * n * 7919u;
+            std::snprintf(column, sizeof(column), " %10u", value);
+            text += column;
+            expected.push_back(value);
+        }
+        std::vector<std::uint64_t> values(expected.size());
+        ASSERT_TRUE(parseFixedWidthColumns(text, 11, values.data(), values.size()));
+        EXPECT_EQ(values, expected);
+        ASSERT_TRUE(parseFixedWidthColumns(text + "  IO-APIC 2-edge timer", 11, values.data(), values.size()));
+        EXPECT_EQ(values, expected);
+
+        EXPECT_FALSE(parseFixedWidthColumns(text, 11, values.data(), values.size() + 1)); // Too short
+        for (const char* bad : {"        1 2", "           ", "      12x 3", "     -12345", "1234567890 "}) {
+            SCOPED_TRACE(bad);
+            std::string mutated = text;
+            mutated.replace(11 * 20, 11, bad);
+            EXPECT_FALSE(parseFixedWidthColumns(mutated, 11, values.data(), values.size()));
+            mutated = text;
+            mutated.replace(11 * 36, 11, bad); // Last column, past the vectorized part
+            EXPECT_FALSE(parseFixedWidthColumns(mutated, 11, values.data(), values.size()));
+        }
+    });
+}
+
+TEST(SimdScanTest, ParseFixedWidthHex_ParsesEightDigitColumns) {
+    forEachLevel([&] {
+        std::string text;
+        std::vector<std::uint64_t> expected;
+        char column[16];
+        for (unsigned n = 0; n < 15; ++n) {
+            const std::uint32_t value = n == 3 ? 0xFFFFFFFFu : n * 0x9E3779B9u;
+            std::snprintf(column, sizeof(column), n % 2 ? "%08x " : "%08X ", value);
+            text += column;
+            expected.push_back(value);
+        }
+        std::vector<std::uint64_t> values(expected.size());
+        ASSERT_TRUE(parseFixedWidthHex(text, 9, values.data(), values.size()));
+        EXPECT_EQ(values, expected);
+        text.pop_back(); // The last column needs no separator
+        ASSERT_TRUE(parseFixedWidthHex(text, 9, values.data(), values.size()));
+        EXPECT_EQ(values, expected);
+
+        EXPECT_FALSE(parseFixedWidthHex(text, 9, values.data(), values.size() + 1)); // Too short
+        EXPECT_FALSE(parseFixedWidthHex(text, 7, values.data(), 2));
+        // Every byte just outside the digit and letter ranges, in every position of a column.
+        for (char bad : {'/', ':', '@', 'G', '`', 'g', ' ', '\x80', '\xff'}) {
+            for (std::size_t position = 0; position < 8; ++position) {
+                std::string mutated = text;
+                mutated[9 * 4 + position] = bad;
+                EXPECT_FALSE(parseFixedWidthHex(mutated, 9, values.data(), values.size())) << int(bad) << " at " << position;
+            }
+        }
+    });
+}
@@ -0,0 +1,168 @@
+#include <gtest/gtest.h>
+#include "snapshot_codec.hpp"
+
+#include <stdexcept>
+#include <vector>
+
+using namespace SystemMetricsCodec;
+using SystemMetricsSnapshot::MetricsSnapshot;
+
+namespace {
+MetricsSnapshot makeSnapshot(unsigned long long step) {
+    MetricsSnapshot s;
+    s.timestamp_ms = 1700000000000ULL + step * 1000;
+    s.cpu = SystemCPUStats::CPUStats(1000 + 7 * step, 200, 300 + step, 4000 + 90 * step, 50, 10, 5, 0, 0, 0);
+    s.mem = SystemMemoryStats::MemStats(16000000, 4000000 - step * 10, 9000000 + step * 10, 100000, 3000000, 0, 0);
+    s.disks.emplace_back("sda", 512000 + step * 4096, 1024000, 500 + step, 1000);
+    s.disks.emplace_back("nvme0n1", 1ULL << 40, 1ULL << 41, 123456789ULL, 987654321ULL);
+    s.nets.emplace_back("lo", 1000 + step, 1000 + step, 10, 10, 0, 0, 0, 0);
+    s.nets.emplace_back("eth0", 5000 + step * 1500, 3000 + step * 60, 50 + step, 30 + step, 1, 3, 2, 4);
+    return s;
+}
+
+void expectSnapshotsEqual(const MetricsSnapshot& a, const MetricsSnapshot& b) {
+    EXPECT_EQ(a.timestamp_ms, b.timestamp_ms);
+    EXPECT_DOUBLE_EQ(a.cpu.user, b.cpu.user);
+    EXPECT_DOUBLE_EQ(a.cpu.system, b.cpu.system);
+    EXPECT_DOUBLE_EQ(a.cpu.idle, b.cpu.idle);
+    EXPECT_DOUBLE_EQ(a.cpu.softirq, b.cpu.softirq);
+    EXPECT_EQ(a.mem.free, b.mem.free);
+    EXPECT_EQ(a.mem.available, b.mem.available);
+    ASSERT_EQ(a.disks.size(), b.disks.size());
+    for (size_t i = 0; i < a.disks.size(); ++i) {
+        EXPECT_EQ(a.disks[i].device, b.disks[i].device);
+        EXPECT_EQ(a.disks[i].read_bytes, b.disks[i].read_bytes);
+        EXPECT_EQ(a.disks[i].write_bytes, b.disks[i].write_bytes);
+        EXPECT_EQ(a.disks[i].read_time_ms, b.disks[i].read_time_ms);
+        EXPECT_EQ(a.disks[i].write_time_ms, b.disks[i].write_time_ms);
+    }
+    ASSERT_EQ(a.nets.size(), b.nets.size());
+    for (size_t i = 0; i < a.nets.size(); ++i) {
+        EXPECT_EQ(a.nets[i].interface_name, b.nets[i].interface_name);
+        EXPECT_EQ(a.nets[i].bytes_received, b.nets[i].bytes_received);
+        EXPECT_EQ(a.nets[i].packets_sent, b.nets[i].packets_sent);
+        EXPECT_EQ(a.nets[i].drops_out, b.nets[i].drops_out);
+    }
+}
+} // namespace
+
+TEST(SnapshotCodecTest, RoundTrip_KeyframeThenDeltas) {
+    SnapshotEncoder encoder(10);
+    SnapshotDecoder decoder;
+    MetricsSnapshot decoded;
+
+    std::vector<std::uint8_t> key;
+    encoder.encode(makeSnapshot(0), key);
+    EXPECT_TRUE(peekFrameHeader(key).keyframe);
+    EXPECT_EQ(peekFrameHeader(key).version, kFormatVersion);
+    EXPECT_EQ(decoder.decode(key, decoded), key.size());
+    expectSnapshotsEqual(decoded, makeSnapshot(0));
+
+    for (unsigned long long step = 1; step < 5; ++step) {
+        std::vector<std::uint8_t> delta;
+        encoder.encode(makeSnapshot(step), delta);
+        EXPECT_FALSE(peekFrameHeader(delta).keyframe);
+        // Deltas carry no names and only small numbers.
+        EXPECT_LT(delta.size(), key.size() / 2);
+        decoder.decode(delta, decoded);
+        expectSnapshotsEqual(decoded, makeSnapshot(step));
+    }
+}
+
+TEST(SnapshotCodecTest, RoundTrip_DevicesAppearAndDisappear) {
+    SnapshotEncoder encoder;
+    SnapshotDecoder decoder;
+    MetricsSnapshot decoded;
+    std::vector<std::uint8_t> buffer;
+
+    MetricsSnapshot s0 = makeSnapshot(0);
+    MetricsSnapshot s1 = makeSnapshot(1);
+    s1.disks.erase(s1.disks.begin());                  // sda goes away
+    s1.nets.emplace_back("wlan0", 1, 2, 3, 4, 5, 6, 7, 8); // new interface
+    MetricsSnapshot s2 = makeSnapshot(2);               // sda comes back without a base
+    s2.nets.emplace_back("wlan0", 10, 20, 30, 40, 50, 60, 70, 80);
+
+    for (const MetricsSnapshot* s : {&s0, &s1, &s2}) {
+        buffer.clear();
+        encoder.encode(*s, buffer);
+        decoder.decode(buffer, decoded);
+        expectSnapshotsEqual(decoded, *s);
+    }
+}
+
+TEST(SnapshotCodecTest, RoundTrip_CounterResetAndWrap) {
+    SnapshotEncoder encoder;
+    SnapshotDecoder decoder;
+    MetricsSnapshot decoded;
+    std::vector<std::uint8_t> buffer;
+
+    MetricsSnapshot s0 = makeSnapshot(5);
+    s0.nets[1].bytes_received = ~0ULL - 10;
+    MetricsSnapshot s1 = makeSnapshot(6);
+    s1.nets[1].bytes_received = 20;   // wrapped
+    s1.disks[0].read_bytes = 0;       // reset (e.g. device re-attached)
+    s1.timestamp_ms = s0.timestamp_ms - 5; // clock stepped backwards
+
+    for (const MetricsSnapshot* s : {&s0, &s1}) {
+        buffer.clear();
+        encoder.encode(*s, buffer);
+        decoder.decode(buffer, decoded);
+        expectSnapshotsEqual(decoded, *s);
+    }
+}
+
+TEST(SnapshotCodecTest, KeyframeInterval_AndConcatenatedFrames) {
+    SnapshotEncoder encoder(3);
+    std::vector<std::uint8_t> stream;
+    std::vector<bool> keyframes;
+    for (unsigned long long step = 0; step < 7; ++step) {
+        size_t offset = stream.size();
+        encoder.encode(makeSnapshot(step), stream, step == 5);
+        keyframes.push_back(peekFrameHeader(ByteSpan(stream.data() + offset, stream.size() - offset)).keyframe);
+    }
+    EXPECT_EQ(keyframes, (std::vector<bool>{true, false, false, true, false, true, false}));
+
+    SnapshotDecoder decoder;
+    MetricsSnapshot decoded;
+    size_t offset = 0;
+    for (unsigned long long step = 0; step < 7; ++step) {
+        offset += decoder.decode(ByteSpan(stream.data() + offset, stream.size() - offset), decoded);
+        expectSnapshotsEqual(decoded, makeSnapshot(step));
+    }
+    EXPECT_EQ(offset, stream.size());
+
+    // A fresh decoder can join the stream at any keyframe.
+    SnapshotDecoder late_joiner;
+    std::vector<std::uint8_t> key;
+    SnapshotEncoder fresh;
+    fresh.encode(makeSnapshot(9), key);
+    late_joiner.decode(key, decoded);
+    expectSnapshotsEqual(decoded, makeSnapshot(9));
+}
+
+TEST(SnapshotCodecTest, Decode_RejectsMalformedInput) {
+    SnapshotEncoder encoder;
+    std::vector<std::uint8_t> key;
+    std::vector<std::uint8_t> delta;
+    encoder.encode(makeSnapshot(0), key);
+    encoder.encode(makeSnapshot(1), delta);
+
+    MetricsSnapshot decoded;
+    SnapshotDecoder decoder;
+    EXPECT_THROW(decoder.decode(delta, decoded), std::runtime_error); // No keyframe yet
+
+    for (size_t cut = 0; cut < key.size(); ++cut) {
+        SnapshotDecoder d;
+        EXPECT_THROW(d.decode(ByteSpan(key.data(), cut), decoded), std::runtime_error) << "cut at " << cut;
+    }
+
+    std::vector<std::uint8_t> bad_magic = key;
+    bad_magic[0] = 'X';
+    EXPECT_THROW(decoder.decode(bad_magic, decoded), std::runtime_error);
+
+    std::vector<std::uint8_t> bad_version = key;
+    bad_version[2] = kFormatVersion + 1;
+    EXPECT_THROW(decoder.decode(bad_version, decoded), std::runtime_error);
+
+    EXPECT_THROW(SnapshotEncoder(0), std::invalid_argument);
+}
@@ -0,0 +1,137 @@
+#include <gtest/gtest.h>
+#include "socket_stats.hpp"
+#include "proc_source.hpp"
+
+#include <memory>
+#include <stdexcept>
+#include <string>
+
+#if defined(__linux__)
+    #include <arpa/inet.h>
+    #include <netinet/in.h>
+    #include <sys/socket.h>
+    #include <unistd.h>
+#endif
+
+using namespace SystemNetStats;
+using SystemProcFS::ScopedProcSource;
+using SystemProcFS::VirtualProcSource;
+
+namespace {
+const char* kTcpHeader =
+    "  sl  local_address rem_address   st tx_queue rx_queue tr tm->when retrnsmt   uid  timeout inode\n";
+
+// Listener on 127.0.0.1:8080 with 3 connections waiting, two established, one TIME_WAIT.
+std::string procNetTcp() {
+    return std::string(kTcpHeader) +
+           "   0: 0100007F:1F90 00000000:0000 0A 00000000:00000003 00:00000000 00000000  1000        0 101 1\n"
+           "   1: 0100007F:1F90 0100007F:C350 01 00000000:00000000 00:00000000 00000000  1000        0 102 1\n"
+           "   2: 0100007F:C350 0100007F:1F90 01 00000010:00000000 00:00000000 00000000  1000        0 103 1\n"
+           "   3: 0100007F:C351 0100007F:1F90 06 00000000:00000000 03:00000F9F 00000000     0        0 0 3\n";
+}
+
+// A second listener on port 8080 (IPv6, SO_REUSEPORT style) and one CLOSE_WAIT.
+std::string procNetTcp6() {
+    return std::string(kTcpHeader) +
+           "   0: 00000000000000000000000000000000:1F90 00000000000000000000000000000000:0000 0A "
+           "00000000:00000002 00:00000000 00000000  1000        0 201 1\n"
+           "   1: 00000000000000000000000001000000:0016 00000000000000000000000001000000:D431 08 "
+           "00000000:00000000 00:00000000 00000000  1000        0 202 1\n";
+}
+} // namespace
+
+TEST(SocketStatsTest, ParseProcNetTcp_CountsStatesAndListeners) {
+    SocketSummary summary;
+    SocketStatsCollector::parseProcNetTcp(procNetTcp(), kAllTcpStates, summary);
+    SocketStatsCollector::parseProcNetTcp(procNetTcp6(), kAllTcpStates, summary);
+    ASSERT_EQ(summary.listeners.size(), 2u); // Unmerged until finishListeners()
+    SocketStatsCollector::finishListeners(summary);
+
+    EXPECT_EQ(summary.count(TcpState::Established), 2u);
+    EXPECT_EQ(summary.count(TcpState::TimeWait), 1u);
+    EXPECT_EQ(summary.count(TcpState::CloseWait), 1u);
+    EXPECT_EQ(summary.count(TcpState::Listen), 2u);
+    EXPECT_EQ(summary.total(), 6u);
+    ASSERT_EQ(summary.listeners.size(), 1u);
+    EXPECT_EQ(summary.listeners[0].port, 8080u);
+    EXPECT_EQ(summary.listeners[0].sockets, 2u);
+    EXPECT_EQ(summary.listeners[0].queued, 5u);
+    EXPECT_EQ(summary.listeners[0].limit, 0u);
+    EXPECT_STREQ(tcpStateName(TcpState::CloseWait), "CLOSE_WAIT");
+
+    SocketSummary bad;
+    EXPECT_THROW(SocketStatsCollector::parseProcNetTcp(std::string(kTcpHeader) + "   0: 0100007F:1F90\n",
+                                                       kAllTcpStates, bad),
+                 std::runtime_error);
+}
+
+TEST(SocketStatsTest, Collect_UsesProcNetForFixturesAndHonorsStateMask) {
+    auto source = std::make_shared<VirtualProcSource>();
+    source->setFile("/proc/net/tcp", procNetTcp());
+    source->setFile("/proc/net/tcp6", procNetTcp6());
+    ScopedProcSource scoped(source);
+
+    SocketStatsCollector::Options options;
+    options.states = tcpStateBit(TcpState::Established) | tcpStateBit(TcpState::Listen);
+    options.include_ipv6 = false;
+    SocketStatsCollector collector(options);
+    SocketSummary summary = collector.collect();
+    EXPECT_EQ(collector.backend(), SocketBackend::ProcNet);
+    EXPECT_EQ(summary.count(TcpState::Established), 2u);
+    EXPECT_EQ(summary.count(TcpState::TimeWait), 0u);
+    EXPECT_EQ(summary.total(), 3u);
+    ASSERT_EQ(summary.listeners.size(), 1u);
+    EXPECT_EQ(summary.listeners[0].queued, 3u);
+
+    // collect() into an existing summary starts from zero.
+    collector.collect(summary);
+    EXPECT_EQ(summary.total(), 3u);
+
+    source->removeFile("/proc/net/tcp");
+    EXPECT_THROW(collector.collect(), std::runtime_error);
+}
+
+#if defined(__linux__)
+TEST(SocketStatsTest, Collect_SockDiagMatchesProcNetOnLiveHost) {
+    const int listener = ::socket(AF_INET, SOCK_STREAM, 0);
+    ASSERT_GE(listener, 0);
+    sockaddr_in address{};
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    socklen_t length = sizeof(address);
+    ASSERT_EQ(::bind(listener, reinterpret_cast<sockaddr*>(&address), sizeof(address)), 0);
+    ASSERT_EQ(::listen(listener, 128), 0);
+    ASSERT_EQ(::getsockname(listener, reinterpret_cast<sockaddr*>(&address), &length), 0);
+    const int client = ::socket(AF_INET, SOCK_STREAM, 0);
+    ASSERT_GE(client, 0);
+    ASSERT_EQ(::connect(client, reinterpret_cast<sockaddr*>(&address), sizeof(address)), 0);
+    const std::uint16_t port = ntohs(address.sin_port);
+
+    SocketStatsCollector::Options options;
+    options.states = tcpStateBit(TcpState::Established) | tcpStateBit(TcpState::Listen);
+    SocketStatsCollector netlink(options);
+    const SocketSummary live = netlink.collect();
+    options.use_sock_diag = false;
+    SocketStatsCollector text(options);
+    const SocketSummary parsed = text.collect();
+    ::close(client);
+    ::close(listener);
+
+    EXPECT_EQ(text.backend(), SocketBackend::ProcNet);
+    EXPECT_GE(live.count(TcpState::Established), 2u); // Both ends of the connection
+    EXPECT_EQ(live.count(TcpState::TimeWait), 0u);
+    for (const SocketSummary* summary : {&live, &parsed}) {
+        bool found = false;
+        for (const ListenBacklog& backlog : summary->listeners) {
+            if (backlog.port != port) continue;
+            found = true;
+            EXPECT_EQ(backlog.sockets, 1u);
+            EXPECT_EQ(backlog.queued, 1u); // Connected but never accepted
+            if (summary == &live && netlink.backend() == SocketBackend::SockDiag) {
+                EXPECT_EQ(backlog.limit, 128u);
+            }
+        }
+        EXPECT_TRUE(found);
+    }
+}
+#endif
@@ -0,0 +1,118 @@
+#include <gtest/gtest.h>
+#include "softnet_stats.hpp"
+#include "proc_source.hpp"
+#include "test_clock.hpp"
+
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <stdexcept>
+#include <string>
+
+using namespace SystemNetStats;
+using SystemProcFS::ScopedProcSource;
+using SystemProcFS::VirtualProcSource;
+using TestClock::at;
+
+namespace {
+// One 5.10+ line (15 fields) for `cpu`.
+std::string row(unsigned cpu, unsigned processed, unsigned dropped, unsigned squeeze, unsigned backlog = 0) {
+    char line[160];
+    std::snprintf(line, sizeof(line),
+                  "%08x %08x %08x 00000000 00000000 00000000 00000000 00000000 00000000 00000004 00000000 %08x "
+                  "%08x %08x 00000000\n",
+                  processed, dropped, squeeze, backlog, cpu, backlog);
+    return line;
+}
+} // namespace
+
+TEST(SoftnetStatsTest, Parse_ReadsHexFieldsPerCPU) {
+    std::vector<SoftnetCPU> cpus;
+    SoftnetStatsReader::parse(row(0, 0x8097e, 0, 1) + row(2, 0xFFFFFFFF, 12, 300, 7), cpus);
+    ASSERT_EQ(cpus.size(), 2u);
+    EXPECT_EQ(cpus[0].cpu, 0u);
+    EXPECT_EQ(cpus[0][SoftnetCounter::Processed], 0x8097eu);
+    EXPECT_EQ(cpus[0][SoftnetCounter::TimeSqueeze], 1u);
+    EXPECT_EQ(cpus[0][SoftnetCounter::ReceivedRps], 4u);
+    EXPECT_EQ(cpus[1].cpu, 2u); // CPU 1 offline
+    EXPECT_EQ(cpus[1][SoftnetCounter::Processed], 0xFFFFFFFFu);
+    EXPECT_EQ(cpus[1][SoftnetCounter::Dropped], 12u);
+    EXPECT_EQ(cpus[1][SoftnetCounter::TimeSqueeze], 300u);
+    EXPECT_EQ(cpus[1].backlog, 7u);
+
+    // Kernels before 5.10 print 11 fields and no CPU number: rows are numbered in order.
+    SoftnetStatsReader::parse("0000002a 00000001 00000002 00000000 00000000 00000000 00000000 00000000 00000000 "
+                              "00000000 00000003\n"
+                              "0000002b 00000000 00000000 00000000 00000000 00000000 00000000 00000000 00000000 "
+                              "00000000 00000000\n",
+                              cpus);
+    ASSERT_EQ(cpus.size(), 2u);
+    EXPECT_EQ(cpus[1].cpu, 1u);
+    EXPECT_EQ(cpus[0][SoftnetCounter::FlowLimitCount], 3u);
+    EXPECT_EQ(cpus[1][SoftnetCounter::Processed], 0x2bu);
+    EXPECT_EQ(cpus[1].backlog, 0u);
+
+    EXPECT_THROW(SoftnetStatsReader::parse("0000002a 00000001 00000002\n", cpus), std::runtime_error);
+    std::string bad = row(0, 1, 2, 3);
+    bad[4] = 'x';
+    EXPECT_THROW(SoftnetStatsReader::parse(bad, cpus), std::runtime_error);
+    EXPECT_STREQ(softnetCounterName(SoftnetCounter::TimeSqueeze), "time_squeeze");
+}
+
+TEST(SoftnetStatsTest, Collector_ComputesPerCPURatesAcrossWrapAndHotplug) {
+    auto source = std::make_shared<VirtualProcSource>();
+    source->setSequence("/proc/net/softnet_stat", {
+        row(0, 1000, 0, 0) + row(1, 0xFFFFFF00u, 5, 2),
+        row(0, 3000, 40, 0) + row(1, 0x100, 5, 6) + row(2, 99, 99, 99), // CPU 1 wrapped, CPU 2 came online
+        row(1, 0x200, 5, 6) + row(2, 199, 99, 99),                      // CPU 0 went offline
+    });
+    ScopedProcSource scoped(source);
+
+    SoftnetCollector collector;
+    collector.sample(at(0));
+    EXPECT_FALSE(collector.hasRates());
+    source->advance();
+    collector.sample(at(2));
+    ASSERT_TRUE(collector.hasRates());
+
+    const SoftnetRates& rates = collector.rates();
+    EXPECT_DOUBLE_EQ(rates.elapsed_seconds, 2.0);
+    ASSERT_EQ(rates.cpus.size(), 2u);
+    EXPECT_EQ(rates.cpus[0].cpu, 0u);
+    EXPECT_DOUBLE_EQ(rates.cpus[0][SoftnetCounter::Processed], 1000.0);
+    EXPECT_DOUBLE_EQ(rates.cpus[0][SoftnetCounter::Dropped], 20.0);
+    EXPECT_EQ(rates.cpus[1].cpu, 1u);
+    EXPECT_EQ(rates.cpus[1].deltas[0], 0x200u);
+    EXPECT_DOUBLE_EQ(rates.cpus[1][SoftnetCounter::TimeSqueeze], 2.0);
+    EXPECT_DOUBLE_EQ(rates.total(SoftnetCounter::Processed), 1000.0 + 256.0);
+    EXPECT_EQ(collector.current().size(), 3u);
+
+    source->advance();
+    collector.sample(at(3));
+    ASSERT_EQ(collector.rates().cpus.size(), 2u);
+    EXPECT_EQ(collector.rates().cpus[0].cpu, 1u);
+    EXPECT_DOUBLE_EQ(collector.rates().cpus[0][SoftnetCounter::Processed], 256.0);
+    EXPECT_DOUBLE_EQ(collector.rates().cpus[1][SoftnetCounter::Processed], 100.0);
+
+    source->removeFile("/proc/net/softnet_stat");
+    EXPECT_THROW(collector.sample(at(4)), std::runtime_error);
+
+    // A malformed reading is dropped: the next rates cover the interval since the last good one.
+    source->setFile("/proc/net/softnet_stat", row(1, 0x300, 5, 6) + "00000001 00000002\n");
+    EXPECT_THROW(collector.sample(at(5)), std::runtime_error);
+    EXPECT_EQ(collector.current().size(), 2u);
+    source->setFile("/proc/net/softnet_stat", row(1, 0x400, 5, 6) + row(2, 299, 99, 99));
+    collector.sample(at(6));
+    EXPECT_DOUBLE_EQ(collector.rates().elapsed_seconds, 3.0);
+    ASSERT_EQ(collector.rates().cpus.size(), 2u);
+    EXPECT_EQ(collector.rates().cpus[0].deltas[0], 0x200u);
+    EXPECT_DOUBLE_EQ(collector.rates().cpus[1][SoftnetCounter::Processed], 100.0 / 3.0);
+}
+
+#if defined(__linux__)
+TEST(SoftnetStatsTest, GetSoftnetStats_ReadsLiveHost) {
+    const std::vector<SoftnetCPU> cpus = SoftnetStatsReader::getSoftnetStats();
+    ASSERT_FALSE(cpus.empty());
+    for (std::size_t i = 1; i < cpus.size(); ++i) EXPECT_LT(cpus[i - 1].cpu, cpus[i].cpu);
+}
+#endif
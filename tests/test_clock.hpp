@@ -0,0 +1,16 @@
+#ifndef TEST_CLOCK_HPP
+#define TEST_CLOCK_HPP
+
+#include <chrono>
+
+namespace TestClock {
+
+    /// @brief The time point `seconds` after the steady clock's epoch, for driving a collector's
+    /// sample(Clock::time_point) with exact intervals.
+    inline std::chrono::steady_clock::time_point at(int seconds) {
+        return std::chrono::steady_clock::time_point(std::chrono::seconds(seconds));
+    }
+
+} // namespace TestClock
+
+#endif // TEST_CLOCK_HPP
@@ -0,0 +1,179 @@
+#include <gtest/gtest.h>
+#include "thread_stats.hpp"
+#include "cpu_stats.hpp"
+#include "proc_source.hpp"
+#include "test_clock.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <thread>
+
+#if defined(__linux__)
+#include <unistd.h>
+#endif
+
+using namespace SystemProcessStats;
+using SystemProcFS::ScopedProcSource;
+using SystemProcFS::VirtualProcSource;
+using TestClock::at;
+
+namespace {
+std::string statLine(int tid, const std::string& name, unsigned long long utime, unsigned long long stime,
+                     unsigned long long start_time = 5000, int processor = 3) {
+    return std::to_string(tid) + " (" + name + ") S 1 100 100 0 -1 4194368 1523 0 0 0 " + std::to_string(utime) + " " +
+           std::to_string(stime) + " 0 0 20 0 4 0 " + std::to_string(start_time) +
+           " 1285885952 26034 18446744073709551615 1 1 0 0 0 0 0 4096 17638 0 0 0 17 " + std::to_string(processor) +
+           " 0 0 0 0 0 0 0 0 0 0 0 0 0\n";
+}
+
+std::string threadPath(int pid, int tid) {
+    return "/proc/" + std::to_string(pid) + "/task/" + std::to_string(tid) + "/stat";
+}
+} // namespace
+
+TEST(ThreadStatsTest, Parse_ReadsFieldsAroundAwkwardNames) {
+    TaskStat stat;
+    TaskStatReader::parse(statLine(4321, "event loop) S (1", 1500, 250, 777, 11), stat);
+    EXPECT_EQ(stat.pid, 4321);
+    EXPECT_EQ(stat.comm, "event loop) S (1");
+    EXPECT_EQ(stat.state, 'S');
+    EXPECT_EQ(stat.ppid, 1);
+    EXPECT_EQ(stat.utime, 1500u);
+    EXPECT_EQ(stat.stime, 250u);
+    EXPECT_EQ(stat.num_threads, 4u);
+    EXPECT_EQ(stat.start_time, 777u);
+    EXPECT_EQ(stat.rss_pages, 26034u);
+    EXPECT_EQ(stat.processor, 11);
+
+    EXPECT_THROW(TaskStatReader::parse("4321 (name S 1 100\n", stat), std::runtime_error);
+    EXPECT_THROW(TaskStatReader::parse("4321 (name) S 1 100 100\n", stat), std::runtime_error);
+    EXPECT_THROW(TaskStatReader::parse("x (name) S 1\n", stat), std::runtime_error);
+}
+
+TEST(ThreadStatsTest, Collector_TracksThreadsIncrementallyAndRanksHotOnes) {
+    const unsigned long long hz = SystemCPUStats::ticksPerSecond();
+    auto source = std::make_shared<VirtualProcSource>();
+    source->setSequence(threadPath(100, 100), {statLine(100, "server", 10, 10), statLine(100, "server", 10 + hz / 10, 10)});
+    // The event loop keeps one CPU busy: 2 s of CPU time over 2 s.
+    source->setSequence(threadPath(100, 101), {statLine(101, "loop", 100, 50), statLine(101, "loop", 100 + 3 * hz / 2, 50 + hz / 2)});
+    source->setFile(threadPath(200, 200), statLine(200, "other", 0, 0));
+    ScopedProcSource scoped(source);
+
+    ThreadCollector collector;
+    collector.track(100);
+    collector.track(200);
+    collector.track(100);
+    EXPECT_EQ(collector.tracked(), (std::vector<int>{100, 200}));
+    collector.sample(at(0));
+    EXPECT_FALSE(collector.hasRates());
+    ASSERT_EQ(collector.usage().size(), 2u);
+    EXPECT_EQ(collector.usage()[0].new_threads, 2u);
+
+    source->advance();
+    source->setFile(threadPath(100, 102), statLine(102, "worker", 1, 1)); // Started
+    source->removeFile(threadPath(200, 200));                             // Process exited
+    collector.sample(at(2));
+    ASSERT_TRUE(collector.hasRates());
+    ASSERT_EQ(collector.usage().size(), 1u);
+    EXPECT_EQ(collector.tracked(), (std::vector<int>{100}));
+
+    const ProcessThreads& process = collector.usage()[0];
+    EXPECT_EQ(process.pid, 100);
+    EXPECT_EQ(process.new_threads, 1u);
+    ASSERT_EQ(process.threads.size(), 2u);
+    EXPECT_EQ(process.threads[1].tid, 101);
+    EXPECT_EQ(process.threads[1].name, "loop");
+    EXPECT_EQ(process.threads[1].processor, 3);
+    EXPECT_DOUBLE_EQ(process.threads[1].user_percent, 75.0);
+    EXPECT_DOUBLE_EQ(process.threads[1].system_percent, 25.0);
+    EXPECT_DOUBLE_EQ(process.threads[1].cpu_percent, 100.0);
+    EXPECT_DOUBLE_EQ(process.threads[0].cpu_percent, 5.0);
+    EXPECT_DOUBLE_EQ(process.cpu_percent, 105.0);
+
+    const std::vector<ThreadUsage> hottest = collector.hottest(1);
+    ASSERT_EQ(hottest.size(), 1u);
+    EXPECT_EQ(hottest[0].tid, 101);
+
+    // The event loop exits and its tid is reused by a new thread: both start over.
+    source->removeFile(threadPath(100, 101));
+    source->setFile(threadPath(100, 100), statLine(100, "server", 10 + hz / 10, 10, 9999));
+    collector.sample(at(3));
+    EXPECT_EQ(collector.usage()[0].threads.size(), 1u); // Only 102
+    EXPECT_EQ(collector.usage()[0].new_threads, 1u);    // 100, reused
+    const ThreadCollectorStats stats = collector.stats();
+    EXPECT_EQ(stats.threads_added, 4u);
+    EXPECT_EQ(stats.threads_removed, 1u); // Threads of exited processes are not counted
+    EXPECT_EQ(stats.open_files, 0u);      // VirtualProcSource has no files to keep open
+
+    source->setFile(threadPath(100, 102), "garbage\n");
+    EXPECT_THROW(collector.sample(at(4)), std::runtime_error);
+    EXPECT_EQ(collector.tracked(), (std::vector<int>{100}));
+}
+
+TEST(ThreadStatsTest, Collector_FailedSampleLeavesThreadsAsTheyWere) {
+    const unsigned long long hz = SystemCPUStats::ticksPerSecond();
+    auto source = std::make_shared<VirtualProcSource>();
+    source->setFile(threadPath(100, 100), statLine(100, "server", 0, 0));
+    source->setFile(threadPath(100, 101), statLine(101, "loop", 0, 0));
+    source->setFile(threadPath(200, 200), statLine(200, "other", 0, 0));
+    source->setFile(threadPath(300, 300), statLine(300, "idle", 0, 0));
+    ScopedProcSource scoped(source);
+
+    ThreadCollector collector;
+    collector.track(100);
+    collector.track(200);
+    collector.track(300);
+    collector.sample(at(0));
+
+    // 100's loop thread is malformed while 200 exits and 300 is read fine: nothing is committed,
+    // and the exited process is dropped once.
+    source->setFile(threadPath(100, 100), statLine(100, "server", hz, 0));
+    source->setFile(threadPath(100, 101), "garbage\n");
+    source->removeFile(threadPath(200, 200));
+    source->setFile(threadPath(300, 300), statLine(300, "idle", hz, 0));
+    EXPECT_THROW(collector.sample(at(1)), std::runtime_error);
+    EXPECT_EQ(collector.tracked(), (std::vector<int>{100, 300}));
+    EXPECT_FALSE(collector.hasRates());
+
+    // The next good sample is measured from the last good one.
+    source->setFile(threadPath(100, 101), statLine(101, "loop", 2 * hz, 0));
+    collector.sample(at(2));
+    ASSERT_TRUE(collector.hasRates());
+    ASSERT_EQ(collector.usage().size(), 2u);
+    const ProcessThreads& process = collector.usage()[0];
+    ASSERT_EQ(process.threads.size(), 2u);
+    EXPECT_EQ(process.new_threads, 0u);
+    EXPECT_DOUBLE_EQ(process.threads[0].cpu_percent, 50.0);
+    EXPECT_DOUBLE_EQ(process.threads[1].cpu_percent, 100.0);
+    EXPECT_DOUBLE_EQ(collector.usage()[1].threads[0].cpu_percent, 50.0);
+    EXPECT_EQ(collector.stats().threads_added, 4u);
+}
+
+#if defined(__linux__)
+TEST(ThreadStatsTest, Collector_KeepsLiveStatFilesOpen) {
+    std::atomic<bool> stop{false};
+    std::thread spinner([&] {
+        while (!stop.load(std::memory_order_relaxed)) {}
+    });
+    ThreadCollector collector;
+    collector.track(static_cast<int>(getpid()));
+    collector.sample();
+    const ThreadCollectorStats first = collector.stats();
+    EXPECT_GE(first.open_files, 2u);
+    EXPECT_EQ(first.opens, first.open_files);
+    std::this_thread::sleep_for(std::chrono::milliseconds(200));
+    collector.sample();
+    stop = true;
+    spinner.join();
+
+    // Only threads that appeared since the first sample were opened.
+    EXPECT_EQ(collector.stats().opens - first.opens, collector.stats().threads_added - first.threads_added);
+    ASSERT_EQ(collector.usage().size(), 1u);
+    const std::vector<ThreadUsage> hottest = collector.hottest(1);
+    ASSERT_EQ(hottest.size(), 1u);
+    EXPECT_GT(hottest[0].cpu_percent, 0.0);
+}
+#endif